@@ -138,6 +138,7 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexB = indexB;
 
 	m_manifold.pointCount = 0;
+	m_resultIndex = -1;
 
 	m_prev = nullptr;
 	m_next = nullptr;
@@ -164,13 +165,46 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
 void b2Contact::Update(b2ContactListener* listener)
+{
+	b2ContactResult result;
+	Prepare(&result);
+	Update(listener, &result);
+}
+
+void b2Contact::Prepare(b2ContactResult* result) const
+{
+	result->contact = const_cast<b2Contact*>(this);
+	result->manifold = m_manifold;
+
+	const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+	const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
+
+	// Is this contact a sensor?
+	if (m_fixtureA->IsSensor() || m_fixtureB->IsSensor())
+	{
+		const b2Shape* shapeA = m_fixtureA->GetShape();
+		const b2Shape* shapeB = m_fixtureB->GetShape();
+		result->touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+
+		// Sensors don't generate manifolds.
+		result->manifold.pointCount = 0;
+	}
+	else
+	{
+		// Evaluate is const in practice, but not declared so
+		const_cast<b2Contact*>(this)->Evaluate(&result->manifold, xfA, xfB);
+		result->touching = result->manifold.pointCount > 0;
+	}
+}
+
+void b2Contact::Update(b2ContactListener* listener, const b2ContactResult* result)
 {
 	b2Manifold oldManifold = m_manifold;
 
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
-	bool touching = false;
+	bool touching = result->touching;
 	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
 	bool sensorA = m_fixtureA->IsSensor();
@@ -179,24 +213,10 @@ void b2Contact::Update(b2ContactListener* listener)
 
 	b2Body* bodyA = m_fixtureA->GetBody();
 	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
 
-	// Is this contact a sensor?
-	if (sensor)
+	m_manifold = result->manifold;
+	if (sensor == false)
 	{
-		const b2Shape* shapeA = m_fixtureA->GetShape();
-		const b2Shape* shapeB = m_fixtureB->GetShape();
-		touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
-
-		// Sensors don't generate manifolds.
-		m_manifold.pointCount = 0;
-	}
-	else
-	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
-
 		// Match old contact ids to new contact ids and copy the
 		// stored impulses to warm start the solver.
 		for (int32 i = 0; i < m_manifold.pointCount; ++i)
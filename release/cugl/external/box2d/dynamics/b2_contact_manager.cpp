@@ -36,6 +36,101 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = nullptr;
+	m_taskExecutor = nullptr;
+	m_results = nullptr;
+	m_resultCount = 0;
+	m_resultCapacity = 0;
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	if (m_results)
+	{
+		b2Free(m_results);
+	}
+}
+
+// Fewer contacts than this are not worth handing to the task executor.
+static const int32 b2_minParallelContacts = 64;
+
+// Contacts per range given to the task executor.
+static const int32 b2_contactsPerRange = 16;
+
+// Computes the narrow-phase for a range of contact results.
+class b2PrepareTask : public b2RangeTask
+{
+public:
+	explicit b2PrepareTask(b2ContactResult* results) : m_results(results) {}
+
+	void Execute(int32 begin, int32 end) override
+	{
+		for (int32 i = begin; i < end; ++i)
+		{
+			m_results[i].contact->Prepare(m_results + i);
+		}
+	}
+
+	b2ContactResult* m_results;
+};
+
+// The narrow-phase only reads the shapes and body transforms, which are fixed
+// during Collide. So it is computed up front for every contact Collide is
+// expected to update. Collide then applies the results in list order, so the
+// callbacks are the same as for a serial step. Contacts that Collide updates
+// but were not expected (a body woken earlier in the same pass) are evaluated
+// in place, as before.
+void b2ContactManager::PrepareContacts()
+{
+	m_resultCount = 0;
+	if (m_taskExecutor == nullptr || m_contactCount < b2_minParallelContacts)
+	{
+		return;
+	}
+
+	if (m_resultCapacity < m_contactCount)
+	{
+		if (m_results)
+		{
+			b2Free(m_results);
+		}
+		m_resultCapacity = b2Max(2 * m_contactCount, b2_minParallelContacts);
+		m_results = (b2ContactResult*)b2Alloc(m_resultCapacity * sizeof(b2ContactResult));
+	}
+
+	for (b2Contact* c = m_contactList; c; c = c->GetNext())
+	{
+		if (c->m_flags & b2Contact::e_filterFlag)
+		{
+			continue;
+		}
+
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		b2Body* bodyA = fixtureA->GetBody();
+		b2Body* bodyB = fixtureB->GetBody();
+		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+		if (activeA == false && activeB == false)
+		{
+			continue;
+		}
+
+		int32 proxyIdA = fixtureA->m_proxies[c->GetChildIndexA()].proxyId;
+		int32 proxyIdB = fixtureB->m_proxies[c->GetChildIndexB()].proxyId;
+		if (m_broadPhase.TestOverlap(proxyIdA, proxyIdB) == false)
+		{
+			continue;
+		}
+
+		c->m_resultIndex = m_resultCount;
+		m_results[m_resultCount++].contact = c;
+	}
+
+	if (m_resultCount > 0)
+	{
+		b2PrepareTask task(m_results);
+		m_taskExecutor->ParallelFor(m_resultCount, b2_contactsPerRange, &task);
+	}
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -108,10 +203,15 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
+	PrepareContacts();
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
 	{
+		int32 resultIndex = c->m_resultIndex;
+		c->m_resultIndex = -1;
+
 		b2Fixture* fixtureA = c->GetFixtureA();
 		b2Fixture* fixtureB = c->GetFixtureB();
 		int32 indexA = c->GetChildIndexA();
@@ -168,7 +268,14 @@ void b2ContactManager::Collide()
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
+		if (resultIndex >= 0)
+		{
+			c->Update(m_contactListener, m_results + resultIndex);
+		}
+		else
+		{
+			c->Update(m_contactListener);
+		}
 		c = c->GetNext();
 	}
 }
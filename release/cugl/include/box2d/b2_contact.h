@@ -82,6 +82,15 @@ struct B2_API b2ContactEdge
 	b2ContactEdge* next;	///< the next contact edge in the body's contact list
 };
 
+/// The narrow-phase result for a contact, computed before the contact is
+/// updated. This allows the narrow-phase to run in parallel.
+struct B2_API b2ContactResult
+{
+	b2Contact* contact;
+	b2Manifold manifold;
+	bool touching;
+};
+
 /// The class manages contact between two shapes. A contact exists for each overlapping
 /// AABB in the broad-phase (except if filtered). Therefore a contact object may exist
 /// that has no contact points.
@@ -171,6 +180,7 @@ protected:
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2PrepareTask;
 
 	// Flags stored in m_flags
 	enum
@@ -210,6 +220,13 @@ protected:
 
 	void Update(b2ContactListener* listener);
 
+	// Computes the new manifold without changing the contact. This is safe
+	// to call from multiple threads during b2ContactManager::Collide.
+	void Prepare(b2ContactResult* result) const;
+
+	// Finishes the update with a result from Prepare.
+	void Update(b2ContactListener* listener, const b2ContactResult* result);
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
@@ -231,6 +248,9 @@ protected:
 
 	b2Manifold m_manifold;
 
+	// The index of the result prepared for this step, or -1 if none.
+	int32 m_resultIndex;
+
 	int32 m_toiCount;
 	float m_toi;
 
@@ -30,12 +30,15 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2TaskExecutor;
+struct b2ContactResult;
 
 // Delegate of b2World.
 class B2_API b2ContactManager
 {
 public:
 	b2ContactManager();
+	~b2ContactManager();
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -46,12 +49,20 @@ public:
 
 	void Collide();
 
+	// Computes the narrow-phase for the awake contacts with the task executor.
+	void PrepareContacts();
+
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
 	int32 m_contactCount;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	b2TaskExecutor* m_taskExecutor;
+	b2ContactResult* m_results;
+	int32 m_resultCount;
+	int32 m_resultCapacity;
 };
 
 #endif
@@ -66,6 +66,11 @@ public:
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Register a task executor to run parts of the step in parallel. The
+	/// executor is owned by you and must remain in scope. Pass nullptr to
+	/// step on the calling thread only.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DebugDraw method. The debug draw object is owned
 	/// by you and must remain in scope.
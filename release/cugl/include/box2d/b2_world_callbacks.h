@@ -158,4 +158,29 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// A range of work that may be split across threads. Each call to Execute
+/// must be independent of the others.
+class B2_API b2RangeTask
+{
+public:
+	virtual ~b2RangeTask() {}
+
+	/// Execute the work for the items in [begin, end).
+	virtual void Execute(int32 begin, int32 end) = 0;
+};
+
+/// Implement this class to let the world run parts of the step in parallel.
+/// Only work with no side effects is handed to the executor (currently the
+/// narrow-phase of the contacts), so the results and the order of the contact
+/// callbacks are the same as for a single threaded step.
+class B2_API b2TaskExecutor
+{
+public:
+	virtual ~b2TaskExecutor() {}
+
+	/// Execute the task over [0, count), splitting it into ranges of at least
+	/// minRange items. This must not return until every range is done.
+	virtual void ParallelFor(int32 count, int32 minRange, b2RangeTask* task) = 0;
+};
+
 #endif
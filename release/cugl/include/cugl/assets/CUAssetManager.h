@@ -91,6 +91,8 @@ protected:
     std::unordered_map<size_t,std::shared_ptr<BaseLoader>> _handlers;
     /** The central thread for managing all of the loaders */
     std::shared_ptr<ThreadPool> _workers;
+    /** The profiler shared by all of the loaders (may be null) */
+    std::shared_ptr<LoaderProfiler> _profiler;
 
     /** State variable to manage reading JSON directories */
     bool _preload;
@@ -323,6 +325,7 @@ public:
         loader->setThreadPool(_workers);
         _handlers[hash] = loader;
         loader->setManager(this);
+        loader->setProfiler(_profiler);
         return true;
     }
     
@@ -356,6 +359,7 @@ public:
             return false;
         }
         it->second->setThreadPool(nullptr);
+        it->second->setProfiler(nullptr);
         it->second = nullptr;
         _handlers.erase(hash);
         return true;
@@ -393,6 +397,37 @@ public:
         return std::dynamic_pointer_cast<Loader<T>>(it->second);
     }
     
+#pragma mark -
+#pragma mark Profiling
+    /**
+     * Sets the profiler for this asset manager.
+     *
+     * The profiler is shared with every attached loader (including loaders
+     * attached later).  Once set, every asset loaded records its queue time,
+     * decode time, main thread wait time and materialize time.  Set the
+     * profiler to null to stop recording.
+     *
+     * The profiler should be set before loading starts.  Assets that are
+     * already in flight when it is changed may not be recorded.
+     *
+     * @param profiler  The loading profiler
+     */
+    void setProfiler(const std::shared_ptr<LoaderProfiler>& profiler) {
+        _profiler = profiler;
+        for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+            it->second->setProfiler(profiler);
+        }
+    }
+    
+    /**
+     * Returns the profiler for this asset manager (may be null).
+     *
+     * @return the profiler for this asset manager
+     */
+    const std::shared_ptr<LoaderProfiler>& getProfiler() const {
+        return _profiler;
+    }
+    
 #pragma mark -
 #pragma mark Progress Monitoring
     /**
@@ -78,6 +78,8 @@ protected:
     using Loader<T>::_queue;
     /** Access the thread pool in the super class */
     using BaseLoader::_loader;
+    /** Access the loading profiler in the super class */
+    using BaseLoader::_profiler;
     
     /**
      * Finishes loading the generic asset, finalizing any features in the main thread.
@@ -123,7 +125,7 @@ protected:
      *
      * @return true if the asset was successfully loaded
      */
-    virtual bool read(const std::string& key, const std::string& source,
+    virtual bool read(const std::string key, const std::string source,
                       LoaderCallback callback, bool async) override {
         if (_assets.find(key) != _assets.end() || _queue.find(key) != _queue.end()) {
             return false;
@@ -131,20 +133,35 @@ protected:
         _queue.emplace(key);
         
         bool success = false;
+        std::shared_ptr<LoaderProfiler> profiler = _profiler;
+        size_t ticket = LoaderProfiler::INVALID_TICKET;
+        if (profiler) {
+            ticket = profiler->enqueue("Generic",key,source);
+        }
         if (_loader == nullptr || !async) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<T> asset = std::make_shared<T>();
-            if (asset->preload(source)) {
+            bool preloaded = asset->preload(source);
+            if (profiler) {
+                profiler->endDecode(ticket);
+                profiler->beginMaterialize(ticket);
+            }
+            if (preloaded) {
                 success = materialize(key,asset,callback);
             }
+            if (profiler) { profiler->endMaterialize(ticket,success); }
         } else {
             _loader->addTask([=](void) {
+                if (profiler) { profiler->beginDecode(ticket); }
                 std::shared_ptr<T> asset = std::make_shared<T>();
                 if (!asset->preload(source)) {
                     asset = nullptr;
                 }
-                Application::get()->schedule([=](void){
-                    this->materialize(key,asset,callback);
-                    return false;
+                if (profiler) { profiler->endDecode(ticket); }
+                Application::get()->defer([=](void){
+                    if (profiler) { profiler->beginMaterialize(ticket); }
+                    bool loaded = this->materialize(key,asset,callback);
+                    if (profiler) { profiler->endMaterialize(ticket,loaded); }
                 });
             });
         }
@@ -183,20 +200,35 @@ protected:
         _queue.emplace(key);
         
         bool success = false;
+        std::shared_ptr<LoaderProfiler> profiler = _profiler;
+        size_t ticket = LoaderProfiler::INVALID_TICKET;
+        if (profiler) {
+            ticket = profiler->enqueue("Generic",key,json->getString("file",""));
+        }
         if (_loader == nullptr || !async) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<T> asset = std::make_shared<T>();
-            if (asset->preload(json)) {
+            bool preloaded = asset->preload(json);
+            if (profiler) {
+                profiler->endDecode(ticket);
+                profiler->beginMaterialize(ticket);
+            }
+            if (preloaded) {
                 success = materialize(key,asset,callback);
             }
+            if (profiler) { profiler->endMaterialize(ticket,success); }
         } else {
             _loader->addTask([=](void) {
+                if (profiler) { profiler->beginDecode(ticket); }
                 std::shared_ptr<T> asset = std::make_shared<T>();
                 if (!asset->preload(json)) {
                     asset = nullptr;
                 }
-                Application::get()->schedule([=](void){
-                    this->materialize(key,asset,callback);
-                    return false;
+                if (profiler) { profiler->endDecode(ticket); }
+                Application::get()->defer([=](void){
+                    if (profiler) { profiler->beginMaterialize(ticket); }
+                    bool loaded = this->materialize(key,asset,callback);
+                    if (profiler) { profiler->endMaterialize(ticket,loaded); }
                 });
             });
         }
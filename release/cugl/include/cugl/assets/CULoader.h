@@ -53,6 +53,7 @@
 #include <unordered_set>
 #include <cugl/assets/CUJsonValue.h>
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/assets/CULoaderProfiler.h>
 
 namespace cugl {
 
@@ -111,6 +112,14 @@ protected:
      */
     AssetManager* _manager;
     
+    /**
+     * The profiler recording the loading timeline (may be null)
+     *
+     * Asynchronous tasks should capture a copy of this pointer when they are
+     * created, as it may be changed by the main thread.
+     */
+    std::shared_ptr<LoaderProfiler> _profiler;
+    
     /**
      * Internal method to support asset loading.
      *
@@ -349,6 +358,27 @@ public:
         return _manager;
     }
     
+    /**
+     * Sets the profiler for this loader.
+     *
+     * If the profiler is not null, this loader will record the timeline of
+     * every asset it loads from now on.  Set it to null to stop recording.
+     *
+     * @param profiler  The loading profiler
+     */
+    void setProfiler(const std::shared_ptr<LoaderProfiler>& profiler) {
+        _profiler = profiler;
+    }
+    
+    /**
+     * Returns the profiler for this loader (may be null).
+     *
+     * @return the profiler for this loader
+     */
+    const std::shared_ptr<LoaderProfiler>& getProfiler() const {
+        return _profiler;
+    }
+    
 
 #pragma mark Loading/Unloading
     /**
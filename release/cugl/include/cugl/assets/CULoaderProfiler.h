@@ -0,0 +1,288 @@
+//
+//  CULoaderProfiler.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a profiler for asset loading.  When attached to an
+//  AssetManager, every loader records the lifetime of each asset it loads:
+//  how long the asset waited in the thread pool queue, how long it took to
+//  decode on the worker thread, how long the finished asset waited for the
+//  main thread, and how long it took to materialize (e.g. upload to OpenGL).
+//
+//  The results can be exported as a Chrome trace (load the file in the
+//  chrome://tracing or Perfetto UI) or summarized as a text table ranked by
+//  cost.  This makes it easy to see which assets dominate startup time.
+//
+//  All recording methods are thread safe.  Recording is designed to be cheap,
+//  but it is not free, so only attach a profiler when you need the data.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_LOADER_PROFILER_H__
+#define __CU_LOADER_PROFILER_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CUTimestamp.h>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+namespace cugl {
+
+/**
+ * This class records the loading timeline of assets.
+ *
+ * A profiler is attached to an {@link AssetManager} via the method
+ * {@link AssetManager#setProfiler}, which shares it with every attached
+ * loader.  Each asset load is identified by a ticket returned from
+ * {@link enqueue}.  The loader then marks the beginning and end of the
+ * decode phase (on the worker thread) and the materialize phase (on the
+ * main thread).  Synchronous loads simply perform both phases on the
+ * main thread with no queue time.
+ *
+ * The profiler must be allocated on the main thread, as it uses the
+ * allocating thread to label the main thread in the trace.
+ */
+class LoaderProfiler {
+public:
+    /**
+     * The timeline of a single asset load.
+     *
+     * All times are in microseconds relative to the creation of the profiler.
+     * A value of -1 means that phase has not been reached.
+     */
+    struct Record {
+        /** The asset category (e.g. the loader type) */
+        std::string category;
+        /** The asset key */
+        std::string key;
+        /** The source file for the asset (may be empty) */
+        std::string source;
+        /** The size of the source file in bytes (computed on export) */
+        size_t bytes;
+        /** The time the asset was requested */
+        Sint64 enqueued;
+        /** The time the worker began decoding the asset */
+        Sint64 decodeStart;
+        /** The time the worker finished decoding the asset */
+        Sint64 decodeEnd;
+        /** The time the main thread began materializing the asset */
+        Sint64 materializeStart;
+        /** The time the main thread finished materializing the asset */
+        Sint64 materializeEnd;
+        /** The profiler thread index of the decoding thread */
+        int decodeThread;
+        /** Whether the asset loaded successfully */
+        bool success;
+
+        /** Returns the time spent waiting in the thread pool queue */
+        Sint64 queueTime() const {
+            return decodeStart < 0 ? 0 : decodeStart-enqueued;
+        }
+        /** Returns the time spent decoding the asset */
+        Sint64 decodeTime() const {
+            return decodeEnd < 0 ? 0 : decodeEnd-decodeStart;
+        }
+        /** Returns the time the decoded asset waited for the main thread */
+        Sint64 waitTime() const {
+            return (materializeStart < 0 || decodeEnd < 0) ? 0 : materializeStart-decodeEnd;
+        }
+        /** Returns the time spent materializing the asset on the main thread */
+        Sint64 materializeTime() const {
+            return materializeEnd < 0 ? 0 : materializeEnd-materializeStart;
+        }
+        /** Returns the decode and materialize time (excluding any waiting) */
+        Sint64 cost() const { return decodeTime()+materializeTime(); }
+    };
+
+    /** The ticket for an unrecorded load */
+    static const size_t INVALID_TICKET = (size_t)-1;
+
+private:
+    /** This macro disables the copy constructor (not allowed on profilers) */
+    CU_DISALLOW_COPY_AND_ASSIGN(LoaderProfiler);
+
+protected:
+    /** The time this profiler was initialized */
+    Timestamp _origin;
+    /** The recorded asset loads, indexed by ticket */
+    std::vector<Record> _records;
+    /** Index of every thread seen so far (the main thread is 0) */
+    std::unordered_map<std::thread::id, int> _threads;
+    /** Mutex guarding the records and thread table */
+    mutable std::mutex _mutex;
+
+    /**
+     * Returns the current time in microseconds relative to the origin
+     */
+    Sint64 now() const;
+
+    /**
+     * Returns the profiler index for the current thread
+     *
+     * This method assumes the mutex is held.
+     */
+    int threadIndex();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate profiler.
+     *
+     * This constructor does not initialize the profiler. Use init() instead.
+     */
+    LoaderProfiler() {}
+
+    /**
+     * Deletes this profiler, disposing all resources.
+     */
+    ~LoaderProfiler() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this profiler.
+     */
+    void dispose();
+
+    /**
+     * Initializes a profiler, marking the current thread as the main thread.
+     *
+     * @return true if the profiler was initialized successfully
+     */
+    bool init();
+
+    /**
+     * Returns a newly allocated profiler.
+     *
+     * The current thread is marked as the main thread.
+     *
+     * @return a newly allocated profiler.
+     */
+    static std::shared_ptr<LoaderProfiler> alloc() {
+        std::shared_ptr<LoaderProfiler> result = std::make_shared<LoaderProfiler>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark Recording
+    /**
+     * Records a request to load an asset, returning a ticket for it.
+     *
+     * @param category  The asset category (e.g. "Texture")
+     * @param key       The asset key
+     * @param source    The source file for the asset (may be empty)
+     *
+     * @return the ticket for the subsequent phases of this load
+     */
+    size_t enqueue(const std::string& category, const std::string& key, const std::string& source);
+
+    /**
+     * Marks the start of decoding for the given ticket.
+     *
+     * This should be called on the thread performing the decode.
+     *
+     * @param ticket    The ticket returned by {@link enqueue}
+     */
+    void beginDecode(size_t ticket);
+
+    /**
+     * Marks the end of decoding for the given ticket.
+     *
+     * @param ticket    The ticket returned by {@link enqueue}
+     */
+    void endDecode(size_t ticket);
+
+    /**
+     * Marks the start of materialization for the given ticket.
+     *
+     * @param ticket    The ticket returned by {@link enqueue}
+     */
+    void beginMaterialize(size_t ticket);
+
+    /**
+     * Marks the end of materialization for the given ticket.
+     *
+     * @param ticket    The ticket returned by {@link enqueue}
+     * @param success   Whether the asset loaded successfully
+     */
+    void endMaterialize(size_t ticket, bool success);
+
+    /**
+     * Clears all recorded loads, resetting the origin to now.
+     */
+    void reset();
+
+#pragma mark Reporting
+    /**
+     * Returns a copy of all recorded loads.
+     *
+     * The byte sizes are computed as part of this call, so this method
+     * should not be called while loading is still in progress.
+     *
+     * @return a copy of all recorded loads.
+     */
+    std::vector<Record> getRecords() const;
+
+    /**
+     * Returns the recorded loads as a Chrome trace JSON string.
+     *
+     * Decode and materialize phases appear as complete events on their
+     * threads. Queue and main-thread wait times appear as async events.
+     *
+     * @return the recorded loads as a Chrome trace JSON string.
+     */
+    std::string toTrace() const;
+
+    /**
+     * Writes the recorded loads as a Chrome trace to the given file.
+     *
+     * Relative paths are written to the application save directory.
+     *
+     * @param file  The path to write the trace to
+     *
+     * @return true if the file was written successfully
+     */
+    bool exportTrace(const std::string& file) const;
+
+    /**
+     * Returns a text table of the recorded loads ranked by cost.
+     *
+     * Cost is the decode time plus the materialize time.
+     *
+     * @param limit The maximum number of rows (0 for all)
+     *
+     * @return a text table of the recorded loads ranked by cost.
+     */
+    std::string toSummary(size_t limit=0) const;
+};
+
+}
+
+#endif /* __CU_LOADER_PROFILER_H__ */
@@ -39,5 +39,6 @@
 #include "CUWidgetLoader.h"
 #include "CUScene2Loader.h"
 #include "CUGenericLoader.h"
+#include "CULoaderProfiler.h"
 
 #endif /* __CU_ASSETS_PKG_H__ */
@@ -54,6 +54,7 @@ namespace cugl {
 	    /** Forward references to some graph nodes */
         class AudioOutput;
         class AudioInput;
+        class AudioStreamer;
     }
 
 /**
@@ -95,6 +96,8 @@ private:
     std::unordered_map<std::string, std::shared_ptr<audio::AudioOutput>> _outputs;
     /** The list of all active input devices */
     std::unordered_map<std::string, std::shared_ptr<audio::AudioInput>>  _inputs;
+    /** The background decoder for streamed samples */
+    std::shared_ptr<audio::AudioStreamer> _streamer;
 
 #pragma mark -
 #pragma mark Constructors (Private)
@@ -297,6 +300,16 @@ public:
      */
     Uint32 getWriteSize() const { return _input; }
 
+    /**
+     * Returns the background decoder for streamed samples.
+     *
+     * Every {@link audio::AudioPlayer} for a streamed sample attaches to this
+     * service, so that decoding never happens on the audio thread.
+     *
+     * @return the background decoder for streamed samples.
+     */
+    std::shared_ptr<audio::AudioStreamer> getStreamer() const { return _streamer; }
+
     /**
      * Returns true if the audio device manager is active.
      *
@@ -456,6 +469,24 @@ public:
      */
     bool closeOutput(const std::shared_ptr<audio::AudioOutput>& device);
 
+    /**
+     * Returns an offline output with the given channels and sample rate.
+     *
+     * An offline output is not attached to any device, so it may be used on
+     * machines without sound hardware.  The audio graph is only read when
+     * the programmer calls {@link audio::AudioOutput#render}.  Offline outputs
+     * are not affected by {@link activate} or {@link deactivate}, and do not
+     * need to be closed.
+     *
+     * The output reads {@link getReadSize()} frames at each simulated poll.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     *
+     * @return an offline output with the given channels and sample rate.
+     */
+    std::shared_ptr<audio::AudioOutput> openOfflineOutput(Uint8 channels, Uint32 rate);
+
 #pragma mark -
 #pragma mark Input Devices
     /**
@@ -40,6 +40,7 @@
 #ifndef __CU_AUDIO_ENGINE_H__
 #define __CU_AUDIO_ENGINE_H__
 #include <cugl/audio/CUAudioDevices.h>
+#include <cugl/audio/graph/CUAudioOutput.h>
 #include <cugl/audio/CUSound.h>
 #include <cugl/util/CUTimestamp.h>
 #include <unordered_map>
@@ -54,6 +55,9 @@
 /** The default number of slots */
 #define DEFAULT_SLOTSIZE    16
 
+/** The number of bits in a voice handle reserved for the slot */
+#define VOICE_SLOT_BITS     16
+
 namespace cugl {
     /**
      * The audio graph classes.
@@ -69,6 +73,8 @@ namespace cugl {
         class AudioMixer;
         class AudioFader;
         class AudioPanner;
+        class AudioPlayer;
+        class AudioResampler;
     }
 
     /** AudioQueue for music support */
@@ -92,6 +98,14 @@ namespace cugl {
  * panning, early termination, etc.).  This key eliminates any need for tracking
  * the slot assigned to an effect.
  *
+ * Keys are convenient, but they are not free.  For dense sound effects (such
+ * as the hit and hurt sounds of a combat game) you should use the voice API
+ * instead. A voice is played with {@link #playVoice} and is identified by an
+ * integer {@link Voice} handle. Voices are built once at initialization and
+ * reused, so playing an in-memory sample as a voice allocates nothing. When
+ * all slots are busy, a voice steals the slot of the voice with the lowest
+ * priority, preferring the oldest.
+ *
  * Music is treated separately because seamless playback requires the ability
  * to queue up audio assets in order. As a result, this is supported through
  * the {@link AudioQueue} interface.  However, queues are owned by and acquired
@@ -125,7 +139,60 @@ public:
         PAUSED
     };
 
+    /**
+     * A handle to a sound effect played with {@link #playVoice}.
+     *
+     * The lower bits of a handle identify the slot and the upper bits are a
+     * generation counter.  When a voice completes (or is stolen) the handle
+     * becomes stale, and all methods treat it as inactive.  This means that
+     * handles may be safely stored without any callback bookkeeping.
+     */
+    typedef Uint32 Voice;
+
+    /** The handle for no voice (never returned by a successful play) */
+    static const Voice NO_VOICE = 0;
+
 private:
+    /**
+     * A prebuilt playback chain for a voice.
+     *
+     * The chain is a fader feeding a panner feeding a player (with an optional
+     * resampler).  These nodes are allocated once and rebound to new sounds.
+     */
+    struct VoiceChain {
+        /** The top-level fader attached to the slot */
+        std::shared_ptr<audio::AudioFader> fader;
+        /** The panner for the voice */
+        std::shared_ptr<audio::AudioPanner> panner;
+        /** The reusable player for in-memory samples */
+        std::shared_ptr<audio::AudioPlayer> player;
+        /** The resampler, created only if a sound has a foreign rate */
+        std::shared_ptr<audio::AudioResampler> sampler;
+        /** Whether the chain is in a slot (and may be read by the audio thread) */
+        bool busy;
+    };
+
+    /**
+     * The voice state for a single sound effect slot.
+     *
+     * Each slot has two chains, so that a voice can be stolen while the audio
+     * thread is still finishing with the previous chain.
+     */
+    struct VoiceState {
+        /** The double-buffered playback chains */
+        VoiceChain chains[2];
+        /** The chain of the current voice */
+        Uint32 current;
+        /** The generation counter of the current voice */
+        Uint32 generation;
+        /** The priority of the current voice */
+        Sint32 priority;
+        /** The play order of the current voice (for age-based stealing) */
+        Uint64 stamp;
+        /** Whether the slot is owned by a voice */
+        bool active;
+    };
+
     /** Reference to the audio engine singleton */
     static AudioEngine* _gEngine;
 
@@ -157,6 +224,15 @@ private:
     /** An object pool of panners for panning sound assets */
     std::deque<std::shared_ptr<audio::AudioPanner>> _panPool;
 
+    /** The voice state for each sound effect slot */
+    std::vector<VoiceState> _voices;
+    /** The discarded output of an offline render */
+    std::vector<float> _scratch;
+    /** The number of slots currently owned by a voice */
+    size_t _voiceCount;
+    /** The play counter for voices (for age-based stealing) */
+    Uint64 _voiceClock;
+
     /**
      * Callback function for the sound effects
      *
@@ -285,6 +361,58 @@ private:
      */
     void gcollect(const std::shared_ptr<audio::AudioNode>& sound, bool status);
 
+    /**
+     * Returns the voice state for the given handle, or nullptr if it is stale.
+     *
+     * @param voice The voice handle
+     *
+     * @return the voice state for the given handle, or nullptr if it is stale.
+     */
+    VoiceState* accessVoice(Voice voice);
+
+    /**
+     * Returns the voice state for the given handle, or nullptr if it is stale.
+     *
+     * @param voice The voice handle
+     *
+     * @return the voice state for the given handle, or nullptr if it is stale.
+     */
+    const VoiceState* accessVoice(Voice voice) const;
+
+    /**
+     * Returns true if the node is a voice chain, marking it as idle.
+     *
+     * This method is the voice equivalent of {@link gcollect}.  It is called
+     * when a chain leaves its slot, either because it completed or because
+     * it was interrupted by a steal.
+     *
+     * @param node  The node removed from a slot
+     *
+     * @return true if the node is a voice chain
+     */
+    bool recycleVoice(const std::shared_ptr<audio::AudioNode>& node);
+
+    /**
+     * Rebinds the given voice chain to a new sound.
+     *
+     * In-memory samples reuse the player of the chain, so this allocates
+     * nothing in the common case.  Any other sound creates a new node.
+     *
+     * @param chain     The (idle) voice chain
+     * @param sound     The sound to play
+     *
+     * @return true if the chain was successfully rebound
+     */
+    bool bindVoice(VoiceChain& chain, const std::shared_ptr<Sound>& sound);
+
+    /**
+     * Sets the pan of the given panner as a factor in [-1,1].
+     *
+     * @param panner    The panner to adjust
+     * @param pan       The pan factor
+     */
+    static void applyPan(audio::AudioPanner* panner, float pan);
+
 #pragma mark -
 #pragma mark Static Accessors
 public:
@@ -353,6 +481,24 @@ public:
     static bool start(const std::shared_ptr<audio::AudioOutput>& device,
                       Uint32 slots=DEFAULT_SLOTSIZE);
 
+    /**
+     * Starts the singleton audio engine on an offline output.
+     *
+     * This is the same as {@link #start(Uint32)}, except that the engine is
+     * not attached to any sound hardware.  Instead, the audio is produced
+     * on demand with {@link #render}. This is useful for benchmarking and
+     * for testing on machines without audio devices.
+     *
+     * Like {@link #start(Uint32)}, this method will start up the
+     * {@link AudioDevices} manager and shut it down when done. Hence it will
+     * fail if the audio device manager is already active.
+     *
+     * @param slots  The maximum number of sound slots to support
+     *
+     * @return true if the engine was successfully initialized
+     */
+    static bool startOffline(Uint32 slots=DEFAULT_SLOTSIZE);
+
     /**
      * Shutsdown the singleton audio engine, releasing all resources.
      *
@@ -498,7 +644,8 @@ public:
      * @return the number of slots available for sound effects.
      */
     size_t getAvailableSlots() const {
-        return _capacity-_actives.size();
+        size_t used = _actives.size()+_voiceCount;
+        return used < _capacity ? _capacity-used : 0;
     }
 
     /**
@@ -799,6 +946,91 @@ public:
         return _callback;
     }
 
+#pragma mark -
+#pragma mark Voice Management
+    /**
+     * Plays the given sound as a voice, returning its handle.
+     *
+     * Voices are the allocation-free alternative to keyed sound effects.
+     * Each sound effect slot has prebuilt playback nodes that are reused by
+     * every voice in that slot, so there are no keys to hash and (for
+     * in-memory samples) no audio nodes to allocate.  Use the returned
+     * handle to adjust or stop the voice later.
+     *
+     * If there is no free slot, this method steals the slot of an active
+     * voice whose priority does not exceed the given one.  Of these, it
+     * chooses the lowest priority, and then the oldest voice.  Keyed effects
+     * are never stolen. If no slot can be found, this method returns
+     * {@link NO_VOICE}.
+     *
+     * @param sound     The sound effect to play
+     * @param priority  The voice priority (higher voices are kept longer)
+     * @param volume    The voice volume (relative to the default asset volume)
+     * @param pan       The pan factor in [-1,1]
+     * @param loop      Whether to loop the sound effect continuously
+     *
+     * @return the handle for the new voice, or NO_VOICE on failure
+     */
+    Voice playVoice(const std::shared_ptr<Sound>& sound, Sint32 priority=0,
+                    float volume=1.0f, float pan=0.0f, bool loop=false);
+
+    /**
+     * Returns true if the voice is still playing (or paused).
+     *
+     * A voice is inactive once it completes, is stolen, or is stopped.
+     *
+     * @param voice The voice handle
+     *
+     * @return true if the voice is still playing (or paused).
+     */
+    bool isVoiceActive(Voice voice) const {
+        return accessVoice(voice) != nullptr;
+    }
+
+    /**
+     * Returns the current volume of the given voice.
+     *
+     * If the voice is not active, this method returns 0.
+     *
+     * @param voice The voice handle
+     *
+     * @return the current volume of the given voice.
+     */
+    float getVoiceVolume(Voice voice) const;
+
+    /**
+     * Sets the current volume of the given voice.
+     *
+     * This method has no effect if the voice is not active.
+     *
+     * @param voice     The voice handle
+     * @param volume    The voice volume
+     */
+    void setVoiceVolume(Voice voice, float volume);
+
+    /**
+     * Sets the pan factor of the given voice.
+     *
+     * The pan factor is in the range [-1,1], as in {@link #setPanFactor}.
+     * This method has no effect if the voice is not active.
+     *
+     * @param voice The voice handle
+     * @param pan   The pan factor
+     */
+    void setVoicePan(Voice voice, float pan);
+
+    /**
+     * Stops the given voice, fading it out over the given number of seconds.
+     *
+     * If fade is 0, the voice is stopped immediately. The handle is invalid
+     * once this method is called, and the slot may be stolen by any voice
+     * while it fades.
+     *
+     * @param voice The voice handle
+     * @param fade  The number of seconds to fade out
+     */
+    void stopVoice(Voice voice, float fade=DEFAULT_FADE);
+
 #pragma mark -
 #pragma mark Global Management
     /**
@@ -876,6 +1108,96 @@ public:
      * from the background.
      */
     void resume();
+
+#pragma mark -
+#pragma mark Output Device
+    /**
+     * Returns the output device for this engine.
+     *
+     * @return the output device for this engine.
+     */
+    std::shared_ptr<audio::AudioOutput> getOutput() const { return _output; }
+
+    /**
+     * Renders the given number of seconds from an offline engine.
+     *
+     * This method reads the audio graph on the calling thread, which should
+     * be the main thread. The audio is discarded. Sounds and music played
+     * before this call are processed as if they were playing on a device.
+     * To simulate a game, alternate calls to this method with calls to
+     * play sounds.
+     *
+     * If speed is 0, the graph is pulled as fast as possible.  Otherwise,
+     * the render is paced to the given multiple of real time (so 1 is real
+     * time).  This method fails if the engine was not started offline.
+     *
+     * @param seconds   The number of seconds of audio to render
+     * @param speed     The multiple of real time (0 for unpaced)
+     *
+     * @return the number of frames rendered
+     */
+    Uint64 render(double seconds, double speed=0);
+
+#pragma mark -
+#pragma mark Profiling
+    /**
+     * Returns true if the audio graph is recording timing statistics.
+     *
+     * Profiling is disabled by default. It applies to every audio node, and
+     * not just those managed by this engine.
+     *
+     * @return true if the audio graph is recording timing statistics.
+     */
+    bool isProfiling() const;
+
+    /**
+     * Sets whether the audio graph is recording timing statistics.
+     *
+     * Profiling is disabled by default. It applies to every audio node, and
+     * not just those managed by this engine.
+     *
+     * @param value Whether the audio graph is recording timing statistics
+     */
+    void setProfiling(bool value);
+
+    /**
+     * Returns the timing statistics of each audio node class.
+     *
+     * The statistics are accumulated over every node of each class since
+     * the last call to {@link #resetProfile}.  Only classes that have been
+     * read while profiling are included.  The self time of a class is the
+     * most useful measure, as it excludes the time spent in input nodes.
+     *
+     * @return the timing statistics of each audio node class.
+     */
+    std::vector<audio::AudioNode::Profile> getProfile() const;
+
+    /**
+     * Returns the health statistics of the output device callback.
+     *
+     * These statistics include the number of underruns and late callbacks,
+     * and the headroom of the audio graph.  They are recorded even when
+     * profiling is disabled.
+     *
+     * @return the health statistics of the output device callback.
+     */
+    audio::AudioOutput::Telemetry getTelemetry() const;
+
+    /**
+     * Resets the timing and health statistics of the audio graph.
+     */
+    void resetProfile();
+
+    /**
+     * Returns a text report of the timing and health statistics.
+     *
+     * The report has a summary line for the output device, followed by one
+     * line per node class, sorted by self time.  It is intended for logs
+     * and for offline comparison before and after an optimization.
+     *
+     * @return a text report of the timing and health statistics.
+     */
+    std::string dumpProfile() const;
 };
 
 }
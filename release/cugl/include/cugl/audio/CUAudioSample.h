@@ -98,6 +98,24 @@ public:
         IN_MEMORY = 4
     };
 
+    /**
+     * This enum represents the in-memory storage of a buffered sample.
+     *
+     * Decoded audio is normally stored as floats, which is the format of
+     * the audio graph.  Storing it as 16-bit PCM halves the memory of the
+     * sample, at the cost of a (vectorized) conversion whenever the sample
+     * is read.  The extra precision of floats is rarely audible for sound
+     * effects, so PCM16 is recommended for them on low-memory devices.
+     *
+     * The encoding has no effect on streamed samples.
+     */
+    enum class Encoding : int {
+        /** Store the sample as 32-bit floats */
+        FLOAT = 0,
+        /** Store the sample as signed 16-bit PCM */
+        PCM16 = 1
+    };
+
 protected:
     /** The number of frames in this audio sample */
     Uint64 _frames;
@@ -108,8 +126,13 @@ protected:
     /** Whether or not this sample is streamed or in-memory */
     bool _stream;
 
+    /** The in-memory storage format for this sound source */
+    Encoding _encoding;
+
     /** The in-memory sound buffer for this sound source (OPTIONAL) */
     float* _buffer;
+    /** The in-memory 16-bit sound buffer for this sound source (OPTIONAL) */
+    Sint16* _pcm16;
     
 public:
 #pragma mark Constructors
@@ -131,14 +154,16 @@ public:
      *
      * The choice of buffered or streaming is independent of the file type.
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
-     * this initializer will allocate memory to read the asset into memory.
+     * this initializer will allocate memory to read the asset into memory,
+     * using the given encoding.
      *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param encoding  The in-memory storage format (if not streamed)
      *
      * @return true if the sound source was initialized successfully
      */
-    bool init(const std::string file, bool stream=false);
+    bool init(const std::string file, bool stream=false, Encoding encoding=Encoding::FLOAT);
     
     /**
      * Initializes an empty audio sample of the given size.
@@ -164,11 +189,13 @@ public:
 	 *
 	 *      "file":     The path to the source, relative to the asset directory
 	 *      "stream":   A boolean, indicating whether to stream the sample
+	 *      "encoding": One of "float" or "pcm16" (for samples that are not streamed)
 	 *      "volume":   A float, representing the volume
 	 *
 	 * All attributes are optional.  There are no required attributes. By default,
 	 * audio samples are not streamed, meaning they are fully loaded into memory.
-	 * This is recommended for sound effects, but not for music.
+	 * This is recommended for sound effects, but not for music. Sound effects
+	 * should also consider the "pcm16" encoding, which halves their memory.
 	 *
 	 * @param data      The JSON object specifying the audio sample
 	 *
@@ -216,16 +243,19 @@ public:
      *
      * The choice of buffered or streaming is independent of the file type.
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
-     * this initializer will allocate memory to read the asset into memory.
+     * this initializer will allocate memory to read the asset into memory,
+     * using the given encoding.
      *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param encoding  The in-memory storage format (if not streamed)
      *
      * @return a newly allocated audio sample for the given file.
      */
-    static std::shared_ptr<AudioSample> alloc(const std::string file, bool stream=false) {
+    static std::shared_ptr<AudioSample> alloc(const std::string file, bool stream=false,
+                                              Encoding encoding=Encoding::FLOAT) {
         std::shared_ptr<AudioSample> result = std::make_shared<AudioSample>();
-        return (result->init(file,stream) ? result : nullptr);
+        return (result->init(file,stream,encoding) ? result : nullptr);
     }
     
     /**
@@ -255,11 +285,13 @@ public:
      *
      *      "file":     The path to the source, relative to the asset directory
      *      "stream":   A boolean, indicating whether to stream the sample
+     *      "encoding": One of "float" or "pcm16" (for samples that are not streamed)
      *      "volume":   A float, representing the volume
      *
      * All attributes are optional.  There are no required attributes. By default,
      * audio samples are not streamed, meaning they are fully loaded into memory.
-     * This is recommended for sound effects, but not for music.
+     * This is recommended for sound effects, but not for music. Sound effects
+     * should also consider the "pcm16" encoding, which halves their memory.
      *
      * @param data      The JSON object specifying the audio sample
      *
@@ -289,6 +321,15 @@ public:
      * @return the encoding type for this audio sample
      */
     Type getType() const { return _type; }
+
+    /**
+     * Returns the in-memory storage format of this audio sample
+     *
+     * This value is only meaningful if the sample is not streamed.
+     *
+     * @return the in-memory storage format of this audio sample
+     */
+    Encoding getEncoding() const { return _encoding; }
     
     /**
      * Returns the frame length of this audio sample.
@@ -312,13 +353,35 @@ public:
     /**
      * Returns the underlying PCM data buffer.
      *
-     * This pointer will be null if the sample is streamed.  Otherwise, the
-     * the buffer will contain channels * frames many elements. It is okay to
-     * write data to the buffer, but it cannot be resized or reassigned.
+     * This pointer will be null if the sample is streamed, or if it has the
+     * {@link Encoding#PCM16} encoding.  Otherwise, the buffer will contain
+     * channels * frames many elements. It is okay to write data to the buffer,
+     * but it cannot be resized or reassigned.
      *
      * @return the underlying PCM data buffer.
      */
     float* getBuffer() { return _buffer; }
+
+    /**
+     * Returns the underlying 16-bit PCM data buffer.
+     *
+     * This pointer will be null unless the sample is in memory with the
+     * {@link Encoding#PCM16} encoding.  In that case, the buffer will contain
+     * channels * frames many elements.  Use {@link dsp::DSPMath#decode_pcm16}
+     * to convert it to the float samples of the audio graph.
+     *
+     * @return the underlying 16-bit PCM data buffer.
+     */
+    Sint16* getPCM16Buffer() { return _pcm16; }
+
+    /**
+     * Returns the number of bytes of decoded audio held in memory.
+     *
+     * This value is 0 for a streamed sample.
+     *
+     * @return the number of bytes of decoded audio held in memory.
+     */
+    size_t getMemoryUsage() const;
         
     /**
      * Returns a new decoder for this audio sample
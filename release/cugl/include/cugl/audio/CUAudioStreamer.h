@@ -0,0 +1,397 @@
+//
+//  CUAudioStreamer.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a background decoding service for streamed audio
+//  samples.  Originally, an AudioPlayer for a streamed sample decoded pages
+//  on demand inside the audio callback.  With several streams playing at
+//  once (such as layered music stems), multiple decoders could page in
+//  during the same callback, causing audible dropouts on slower devices.
+//
+//  With this module, each streaming player owns an AudioStream.  This is a
+//  lock-free single-producer/single-consumer ring of decoded frames.  The
+//  AudioStreamer thread is the only producer; it decodes ahead of the read
+//  position, including the start of the next loop.  The audio thread is the
+//  only consumer, and it only ever copies from the ring.
+//
+//  The AudioStreamer is owned by AudioDevices, so it exists whenever audio
+//  nodes may be created.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_AUDIO_STREAMER_H__
+#define __CU_AUDIO_STREAMER_H__
+#include <SDL/SDL.h>
+#include <cugl/util/CUThreadPool.h>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/** The minimum capacity (in frames) of a stream ring */
+#define STREAM_MIN_CAPACITY 16384
+/** The minimum capacity of a stream ring in decoder pages */
+#define STREAM_MIN_PAGES    4
+/** The number of position discontinuities a ring may hold at once */
+#define STREAM_MARKERS      8
+/** How long (in milliseconds) the streamer sleeps when there is no work */
+#define STREAM_POLL_PERIOD  5
+
+namespace cugl {
+    namespace audio {
+        /** Forward reference to the decoder */
+        class AudioDecoder;
+
+#pragma mark -
+#pragma mark Audio Stream
+/**
+ * This class is a ring of decoded frames for a single streaming player.
+ *
+ * The ring has exactly one producer (the {@link AudioStreamer} thread) and
+ * one consumer (the audio thread), and neither side ever blocks.  The ring
+ * is not restricted to contiguous frames.  When the producer reaches the
+ * end of the stream, it continues decoding from the loop start, and when
+ * the consumer requests a seek, the producer decodes from the new position.
+ * In both cases the producer records a marker at the point in the ring
+ * where the stream position jumps.  The consumer uses these markers to
+ * align the ring with the position it wants to read, discarding any frames
+ * it does not need.  This means that loops never stall, and seeks cost at
+ * most a few milliseconds of silence.
+ *
+ * The consumer never waits for data.  If the ring does not have the frames
+ * requested, {@link read} returns fewer frames and the player is expected to
+ * pad with silence.
+ */
+class AudioStream {
+private:
+    /** A discontinuity in the stream position */
+    struct Marker {
+        /** The ring index (total frames written) where the jump occurs */
+        Uint64 index;
+        /** The stream position of the frame at that index */
+        Uint64 frame;
+    };
+
+    /** The decoder for this stream (producer only) */
+    std::shared_ptr<AudioDecoder> _decoder;
+    /** The number of channels in this stream */
+    Uint32 _channels;
+    /** The length of this stream in frames */
+    Uint64 _length;
+    /** The decoder page size in frames */
+    Uint32 _pagesize;
+
+    /** The ring of decoded frames */
+    float* _ring;
+    /** The capacity of the ring in frames */
+    Uint64 _capacity;
+    /** The total number of frames written to the ring (producer owned) */
+    std::atomic<Uint64> _head;
+    /** The total number of frames read from the ring (consumer owned) */
+    std::atomic<Uint64> _tail;
+
+    /** The position discontinuities, as a bounded SPSC queue */
+    Marker _markers[STREAM_MARKERS];
+    /** The number of markers pushed (producer owned) */
+    std::atomic<Uint32> _mhead;
+    /** The number of markers popped (consumer owned) */
+    std::atomic<Uint32> _mtail;
+
+    /** The stream position of the next frame in the ring (consumer only) */
+    Uint64 _cursor;
+    /** The last position requested by the consumer (consumer only) */
+    Uint64 _requested;
+
+    /** The position the consumer wants the producer to seek to */
+    std::atomic<Uint64> _request;
+    /** The position to continue decoding from at the end of the stream */
+    std::atomic<Uint64> _loopStart;
+    /** Whether the owning player has released this stream */
+    std::atomic<bool> _closed;
+
+    /** The most recently decoded page (producer only) */
+    float* _chunk;
+    /** The number of frames in the decoded page (producer only) */
+    Uint32 _chunkLimit;
+    /** The next unused frame of the decoded page (producer only) */
+    Uint32 _chunkLast;
+    /** The stream position of the next frame to write (producer only) */
+    Uint64 _decodePos;
+
+    /**
+     * Moves the decoder to the given position, recording a marker.
+     *
+     * PRODUCER ONLY.
+     *
+     * @param frame The stream position to decode from
+     *
+     * @return false if there is no room for another marker
+     */
+    bool seek(Uint64 frame);
+
+public:
+    /** The value indicating no position */
+    static const Uint64 NO_POSITION = (Uint64)-1;
+
+#pragma mark Constructors
+    /**
+     * Creates an uninitialized stream.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a stream on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioStream();
+
+    /**
+     * Deletes this stream, releasing all resources.
+     */
+    ~AudioStream() { dispose(); }
+
+    /**
+     * Disposes this stream, releasing all resources.
+     */
+    void dispose();
+
+    /**
+     * Initializes a stream for the given decoder.
+     *
+     * The decoder becomes owned by the producer.  No other thread should
+     * access it once the stream has been attached to an {@link AudioStreamer}.
+     *
+     * @param decoder   The decoder for the streamed asset
+     *
+     * @return true if initialization was successful
+     */
+    bool init(const std::shared_ptr<AudioDecoder>& decoder);
+
+    /**
+     * Returns a newly allocated stream for the given decoder.
+     *
+     * @param decoder   The decoder for the streamed asset
+     *
+     * @return a newly allocated stream for the given decoder.
+     */
+    static std::shared_ptr<AudioStream> alloc(const std::shared_ptr<AudioDecoder>& decoder) {
+        std::shared_ptr<AudioStream> result = std::make_shared<AudioStream>();
+        return (result->init(decoder) ? result : nullptr);
+    }
+
+#pragma mark Consumer
+    /**
+     * Reads up to the given number of frames starting at position.
+     *
+     * AUDIO THREAD ONLY: This method is for the owning player.
+     *
+     * If the ring is not aligned with the given position, this method will
+     * discard frames up to the next marker.  If that does not help, it asks
+     * the producer to seek.  The method never blocks, so it may return fewer
+     * frames than requested (including 0).
+     *
+     * @param buffer    The buffer to store the frames
+     * @param position  The stream position of the first frame to read
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the number of frames read
+     */
+    Uint32 read(float* buffer, Uint64 position, Uint32 frames);
+
+    /**
+     * Sets the position to continue decoding from at the end of the stream.
+     *
+     * This should match the position a player returns to when it is reset,
+     * so that loops never wait on the decoder.
+     *
+     * @param frame The loop start position
+     */
+    void setLoopStart(Uint64 frame) { _loopStart.store(frame,std::memory_order_relaxed); }
+
+    /**
+     * Releases this stream from the owning player.
+     *
+     * The streamer will drop a closed stream at its next pass.  This method
+     * is safe to call from any thread, including the audio thread.
+     */
+    void close() { _closed.store(true,std::memory_order_release); }
+
+    /**
+     * Returns true if this stream has been released by its player.
+     *
+     * @return true if this stream has been released by its player.
+     */
+    bool isClosed() const { return _closed.load(std::memory_order_acquire); }
+
+#pragma mark Producer
+    /**
+     * Decodes frames into the ring until it is full or the limit is reached.
+     *
+     * PRODUCER ONLY: This method is for the {@link AudioStreamer} (or for
+     * priming a stream before it is attached).
+     *
+     * @param limit The maximum number of frames to decode
+     *
+     * @return true if any work was performed
+     */
+    bool fill(Uint64 limit=NO_POSITION);
+};
+
+#pragma mark -
+#pragma mark Audio Streamer
+/**
+ * This class is a background service that decodes for all streaming players.
+ *
+ * The streamer owns a single thread.  On each pass it tops up the ring of
+ * every attached {@link AudioStream}, and then sleeps briefly if there was
+ * nothing to do.  A stream is dropped once its player closes it.
+ *
+ * The streamer is owned by {@link AudioDevices}; it should not be necessary
+ * to create one directly.
+ */
+class AudioStreamer {
+private:
+    /** The attached streams */
+    std::vector<std::shared_ptr<AudioStream>> _streams;
+    /** A mutex lock for the attached streams */
+    std::mutex _mutex;
+    /** A condition variable to wake the decoding thread */
+    std::condition_variable _wakeup;
+    /** A mutex lock serializing the decoding passes (the single producer) */
+    std::mutex _filling;
+    /** Whether the decoding thread has been marked for shutdown */
+    std::atomic<bool> _stop;
+#ifdef CU_SDL_THREADS
+    /** The decoding thread */
+    SDL_Thread* _thread;
+#else
+    /** The decoding thread */
+    std::thread _thread;
+#endif
+    /** Whether the decoding thread is running */
+    bool _running;
+
+    /**
+     * The body function of the decoding thread.
+     */
+    void run();
+
+    /**
+     * Performs a single decoding pass over the attached streams.
+     *
+     * Closed streams are dropped first. The pass holds the fill lock, so
+     * that each stream only ever has one producer at a time.
+     *
+     * @return true if any stream received data
+     */
+    bool pass();
+
+    /**
+     * The body function of the decoding thread using the SDL thread API.
+     *
+     * This should be used on Android and Windows, which have special thread
+     * requirements.
+     */
+    static int sdlThreadFunc(void* ptr);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an inactive streamer.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a streamer on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioStreamer();
+
+    /**
+     * Deletes this streamer, stopping the decoding thread.
+     */
+    ~AudioStreamer() { dispose(); }
+
+    /**
+     * Disposes this streamer, stopping the decoding thread.
+     *
+     * Any attached streams stop receiving data.
+     */
+    void dispose();
+
+    /**
+     * Initializes this streamer, starting the decoding thread.
+     *
+     * @return true if initialization was successful
+     */
+    bool init();
+
+    /**
+     * Returns a newly allocated streamer with a running decoding thread.
+     *
+     * @return a newly allocated streamer with a running decoding thread.
+     */
+    static std::shared_ptr<AudioStreamer> alloc() {
+        std::shared_ptr<AudioStreamer> result = std::make_shared<AudioStreamer>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark Streams
+    /**
+     * Returns a new stream for the decoder, attached to this streamer.
+     *
+     * The first page of the stream is decoded on the calling thread, so that
+     * playback can begin immediately. The decoder is owned by the streamer
+     * thread from then on.
+     *
+     * @param decoder   The decoder for the streamed asset
+     *
+     * @return a new stream for the decoder, attached to this streamer.
+     */
+    std::shared_ptr<AudioStream> attach(const std::shared_ptr<AudioDecoder>& decoder);
+
+    /**
+     * Wakes the decoding thread early.
+     *
+     * This is useful after a seek on the main thread.  It should not be
+     * called from the audio thread.
+     */
+    void wake() { _wakeup.notify_one(); }
+
+    /**
+     * Fills every attached stream on the calling thread.
+     *
+     * This is for offline rendering, where the graph is pulled faster than
+     * real time and the decoding thread may fall behind.  The decoding
+     * thread is locked out while this method runs, so it is safe to call
+     * at any time.  It should not be called from the audio thread.
+     *
+     * @return true if any stream received data
+     */
+    bool pump();
+
+    /**
+     * Returns the number of attached streams.
+     *
+     * @return the number of attached streams.
+     */
+    size_t size();
+};
+
+    }
+}
+
+#endif /* __CU_AUDIO_STREAMER_H__ */
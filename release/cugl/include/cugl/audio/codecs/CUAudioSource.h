@@ -0,0 +1,244 @@
+//
+//  CUAudioSource.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the encoded bytes of an audio file for the decoders.
+//  The file is memory mapped when the platform allows it, and read into memory
+//  once otherwise (such as for assets inside an Android APK).  Either way, the
+//  decoders read through an in-memory SDL_RWops, so a decoder never makes a
+//  system call after it is opened.
+//
+//  Sources are shared.  Every decoder for the same file uses the same bytes,
+//  and the same seek index.  The seek index maps frames to byte offsets so
+//  that a decoder can reposition without scanning the file. It is built once
+//  per file by the first decoder that needs it.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_AUDIO_SOURCE_H__
+#define __CU_AUDIO_SOURCE_H__
+#include <SDL/SDL.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cugl {
+    /**
+     * The audio graph classes.
+     *
+     * This internal namespace is for the audio graph clases.  It was chosen
+     * to distinguish this graph from other graph class collections, such as the
+     * scene graph collections in {@link scene2}.
+     */
+    namespace audio {
+/**
+ * This class represents the encoded bytes of an audio file.
+ *
+ * A source is immutable once created.  The bytes are memory mapped if
+ * possible, so that only the pages a decoder touches are ever loaded.
+ * Otherwise the file is read into memory once. Decoders access the bytes
+ * with {@link #open}, which returns an in-memory SDL_RWops. Hence reads
+ * and seeks in the decoder are plain memory operations.
+ *
+ * Sources are cached by file name.  All decoders for the same file share
+ * the same source, and the source is released when the last decoder is
+ * disposed.  Use {@link #acquire} to get a source.
+ *
+ * A source may also hold a seek index for its file.  The index is a list of
+ * {@link SeekPoint} values sorted by frame.  It is built (at most) once per
+ * file, on first use, and it is safe to access from any thread.
+ */
+class AudioSource {
+public:
+    /** A position in the encoded file where decoding may restart */
+    struct SeekPoint {
+        /** The first frame decoded when starting at this offset */
+        Uint64 frame;
+        /** The byte offset in the file */
+        Uint64 offset;
+    };
+
+private:
+    /** The source file */
+    std::string _file;
+    /** The encoded bytes */
+    const Uint8* _data;
+    /** The number of encoded bytes */
+    size_t _size;
+    /** Whether the bytes are memory mapped (as opposed to heap allocated) */
+    bool _mapped;
+#if defined (__WINDOWS__)
+    /** The file mapping handle */
+    void* _mapping;
+#endif
+
+    /** The seek index (sorted by frame) */
+    std::vector<SeekPoint> _index;
+    /** Whether the seek index has been built */
+    bool _indexed;
+    /** A mutex for building the seek index */
+    std::mutex _indexlock;
+
+    /**
+     * Attempts to memory map the given file
+     *
+     * @param file  The file to map
+     *
+     * @return true if the file was mapped
+     */
+    bool map(const std::string& file);
+
+    /**
+     * Reads the given file into memory with SDL
+     *
+     * @param file  The file to read
+     *
+     * @return true if the file was read
+     */
+    bool load(const std::string& file);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty audio source
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. Use {@link #acquire} instead.
+     */
+    AudioSource();
+
+    /**
+     * Deletes this source, unmapping the file.
+     */
+    ~AudioSource() { dispose(); }
+
+    /**
+     * Initializes this source for the given file.
+     *
+     * The file is memory mapped if possible, and read into memory otherwise.
+     *
+     * @param file  The source file
+     *
+     * @return true if the source was initialized successfully
+     */
+    bool init(const std::string& file);
+
+    /**
+     * Releases the bytes of this source.
+     *
+     * Any SDL_RWops returned by {@link #open} is invalid after this call.
+     */
+    void dispose();
+
+    /**
+     * Returns the shared source for the given file
+     *
+     * If there is already a source for this file in use, this method returns
+     * it.  Otherwise it creates a new one.  It returns nullptr if the file
+     * cannot be read.
+     *
+     * @param file  The source file
+     *
+     * @return the shared source for the given file
+     */
+    static std::shared_ptr<AudioSource> acquire(const std::string& file);
+
+#pragma mark Access
+    /**
+     * Returns a new read-only SDL_RWops for the bytes of this source.
+     *
+     * The caller must close the SDL_RWops, and must keep a reference to this
+     * source for as long as the SDL_RWops is open.
+     *
+     * @return a new read-only SDL_RWops for the bytes of this source.
+     */
+    SDL_RWops* open() const;
+
+    /**
+     * Returns the encoded bytes of this source
+     *
+     * @return the encoded bytes of this source
+     */
+    const Uint8* getData() const { return _data; }
+
+    /**
+     * Returns the number of encoded bytes in this source
+     *
+     * @return the number of encoded bytes in this source
+     */
+    size_t getSize() const { return _size; }
+
+    /**
+     * Returns the file of this source
+     *
+     * @return the file of this source
+     */
+    const std::string& getFile() const { return _file; }
+
+    /**
+     * Returns true if the bytes of this source are memory mapped
+     *
+     * @return true if the bytes of this source are memory mapped
+     */
+    bool isMapped() const { return _mapped; }
+
+#pragma mark Seek Index
+    /**
+     * Returns the seek point at or before the given frame.
+     *
+     * If the seek index has not been built, it is built with the given
+     * function first.  The builder is called at most once per source, no
+     * matter how many decoders share it.  This method returns false if the
+     * index is empty or no seek point precedes the frame.
+     *
+     * @param frame     The frame to seek to
+     * @param builder   The function to build the seek index
+     * @param point     The seek point to store the result
+     *
+     * @return true if a seek point was found
+     */
+    bool lookup(Uint64 frame,
+                const std::function<void(const AudioSource*, std::vector<SeekPoint>&)>& builder,
+                SeekPoint& point);
+
+    /**
+     * Returns the seek point before the given one
+     *
+     * This is used when decoding from a seek point overshoots its frame.
+     * This method returns false if there is no earlier seek point.
+     *
+     * @param point     The seek point to replace with its predecessor
+     *
+     * @return true if there was an earlier seek point
+     */
+    bool previous(SeekPoint& point);
+
+private:
+    /** Sources may not be copied */
+    AudioSource(const AudioSource&) = delete;
+    /** Sources may not be copied */
+    AudioSource& operator=(const AudioSource&) = delete;
+};
+    }
+}
+
+#endif /* __CU_AUDIO_SOURCE_H__ */
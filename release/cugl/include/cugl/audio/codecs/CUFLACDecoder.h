@@ -39,6 +39,7 @@
 #define __CU_FLAC_DECODER_H__
 
 #include "CUAudioDecoder.h"
+#include "CUAudioSource.h"
 #include <SDL/SDL.h>
 #include <codecs/FLAC/stream_decoder.h>
 
@@ -71,6 +72,8 @@ namespace cugl {
  */
 class FLACDecoder : public AudioDecoder {
 protected:
+    /** The shared (memory mapped) bytes of the file */
+    std::shared_ptr<AudioSource> _input;
     /** The file for loading in information */
     SDL_RWops* _source;
     /** The FLAC decoder struct */
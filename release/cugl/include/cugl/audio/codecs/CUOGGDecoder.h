@@ -39,6 +39,7 @@
 #ifndef __CU_OGG_DECODER_H__
 #define __CU_OGG_DECODER_H__
 #include "CUAudioDecoder.h"
+#include "CUAudioSource.h"
 #include <SDL/SDL.h>
 #include <codecs/vorbis/vorbisfile.h>
 
@@ -67,11 +68,18 @@ namespace cugl {
  * OGG files are not guaranteed to have uniform page sizes. This decoder tries
  * to balance memory requirements with efficiency in paging frame data.
  *
+ * The file is accessed through a shared {@link AudioSource}, so it is only
+ * mapped once no matter how many decoders use it.  The Ogg page table of the
+ * file is indexed on the first seek, so later seeks (such as to loop back to
+ * the start) jump directly to the right page instead of bisecting the file.
+ *
  * A decoder is NOT thread safe.  If a decoder is used by an audio thread, then
  * it should not be accessed directly in the main thread, and vice versa.
  */
 class OGGDecoder : public AudioDecoder {
 protected:
+    /** The shared (memory mapped) bytes of the file */
+    std::shared_ptr<AudioSource> _input;
     /** The file for loading in information */
     SDL_RWops* _source;
     /** The OGG decoder struct */
@@ -79,6 +87,18 @@ protected:
     /** Reference to the logical bitstream for decoding */
     int _bitstream;
 
+    /**
+     * Moves the decoder to the given frame using the page index
+     *
+     * This method returns false if the index cannot be used, in which case
+     * the decoder position is unspecified.
+     *
+     * @param frame The frame to seek to
+     *
+     * @return true if the decoder is at the given frame
+     */
+    bool seek(Uint64 frame);
+
 public:
 #pragma mark Constructors
     /**
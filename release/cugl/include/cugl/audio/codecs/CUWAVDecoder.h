@@ -37,6 +37,7 @@
 #ifndef __CU_WAV_DECODER_H__
 #define __CU_WAV_DECODER_H__
 #include "CUAudioDecoder.h"
+#include "CUAudioSource.h"
 #include <SDL/SDL.h>
 
 namespace cugl {
@@ -205,6 +206,8 @@ public:
     };
     
 protected:
+    /** The shared (memory mapped) bytes of the file */
+    std::shared_ptr<AudioSource> _input;
     /** The file for loading in information */
     SDL_RWops* _source;
     /** The buffer for reading pages */
@@ -32,6 +32,7 @@
 #ifndef __CU_CODECS_H__
 #define __CU_CODECS_H__
 
+#include "CUAudioSource.h"
 #include "CUMP3Decoder.h"
 #include "CUWAVDecoder.h"
 #include "CUOGGDecoder.h"
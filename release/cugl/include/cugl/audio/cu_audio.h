@@ -34,6 +34,7 @@
 #include "CUAudioEngine.h"
 #include "CUAudioQueue.h"
 #include "CUAudioSample.h"
+#include "CUAudioStreamer.h"
 #include "CUAudioWaveform.h"
 #include "CUSound.h"
 
@@ -36,7 +36,8 @@
 #ifndef __CU_AUDIO_MIXER_H__
 #define __CU_AUDIO_MIXER_H__
 #include "CUAudioNode.h"
-#include <mutex>
+#include <cugl/util/CUSnapshotPointer.h>
+#include <vector>
 
 namespace cugl {
 
@@ -62,17 +63,25 @@ namespace cugl {
  * effected, but values outside of this range will asymptotically bend to
  * the range [-1,1].
  *
+ * The input slots are published to the audio thread as an immutable snapshot.
+ * Attaching or detaching a node copies the slots and swaps in the new copy,
+ * so the audio thread never waits on the main thread.  Detached nodes are
+ * released on the main thread, never in the audio thread.
+ *
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
  *
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioMixer : public AudioNode {
-private:
+protected:
+    /** The input slots to be mixed (the size is the mixer width) */
+    typedef std::vector<std::shared_ptr<AudioNode>> Slots;
+
     /** The input nodes to be mixed */
-    std::shared_ptr<AudioNode>* _inputs;
+    SnapshotPointer<Slots> _inputs;
     /** The number of input nodes supported by this mixer */
-    Uint8 _width;
+    std::atomic<Uint8> _width;
 
     /** The intermediate buffer for the mixed result */
     float* _buffer;
@@ -82,12 +91,23 @@ private:
     /** The knee value for clamping */
     std::atomic<float>  _knee;
 
-    /** This class needs a proper lock guard; too many race conditions */
-    std::mutex _mutex;
     /** The current read position */
     std::atomic<Uint64> _offset;
     /** The last marked position (starts at 0) */
     std::atomic<Uint64> _marked;
+    /** A position set by the main thread for the next read (-1 if none) */
+    std::atomic<Sint64> _moved;
+
+    /**
+     * Moves the read position from the main thread.
+     *
+     * The position is stored immediately, but it is also applied by the
+     * audio thread at the start of its next read.  This keeps a read in
+     * progress from overwriting the new position when it finishes.
+     *
+     * @param position  The new read position
+     */
+    void move(Uint64 position);
 
 public:
 #pragma mark Constructors
@@ -288,13 +308,14 @@ public:
      *
      * @return the width of this mixer.
      */
-    Uint8 getWidth() const { return _width; }
+    Uint8 getWidth() const { return _width.load(std::memory_order_relaxed); }
 
     /**
      * Sets the width of this mixer.
      *
-     * The width is the number of supported input slots. This method will only
-     * succeed if the mixer is paused.  Otherwise, it will fail.
+     * The width is the number of supported input slots. This method may be
+     * called at any time; the audio thread picks up the new slots on its
+     * next read.
      *
      * Once the width is adjusted, the children will be reassigned in order.
      * If the new width is less than the old width, children at the end of
@@ -302,7 +323,7 @@ public:
      *
      * @return true if the mixer width was reset
      */
-    bool setWidth(Uint8 width);
+    virtual bool setWidth(Uint8 width);
 
 #pragma mark -
 #pragma mark Anticlipping Methods
@@ -44,10 +44,15 @@
 #ifndef __CU_AUDIO_NODE_H__
 #define __CU_AUDIO_NODE_H__
 #include <SDL/SDL.h>
+#include <cugl/util/CUTimestamp.h>
 #include <atomic>
 #include <memory>
 #include <functional>
 #include <string>
+#include <vector>
+
+/** The maximum number of node classes with profiling statistics */
+#define AUDIO_PROFILE_CLASSES   32
 
 namespace cugl {
     
@@ -139,6 +144,129 @@ public:
      */
     typedef std::function<void (const std::shared_ptr<AudioNode>& node, Action type)> Callback;
 
+    /**
+     * The timing statistics for a node (or for every node of a class).
+     *
+     * All times are in nanoseconds. The total time includes the time spent
+     * reading from input nodes, while the self time does not.  Hence the
+     * self time is the best measure of which node in a graph is expensive.
+     */
+    struct Profile {
+        /** The class name (or node name) of these statistics */
+        std::string name;
+        /** The number of calls to {@link AudioNode#read} */
+        Uint64 calls;
+        /** The number of frames requested by those calls */
+        Uint64 frames;
+        /** The accumulated time of those calls, including the input nodes */
+        Uint64 total;
+        /** The accumulated time of those calls, excluding the input nodes */
+        Uint64 self;
+        /** The longest single call, including the input nodes */
+        Uint64 peak;
+
+        /** Creates empty statistics */
+        Profile() : calls(0), frames(0), total(0), self(0), peak(0) {}
+    };
+
+private:
+    /**
+     * The profiling counters updated by the audio thread.
+     */
+    struct ProfileCounters {
+        /** The number of calls to read */
+        std::atomic<Uint64> calls;
+        /** The number of frames requested */
+        std::atomic<Uint64> frames;
+        /** The accumulated time, including the input nodes */
+        std::atomic<Uint64> total;
+        /** The accumulated time, excluding the input nodes */
+        std::atomic<Uint64> self;
+        /** The longest single call */
+        std::atomic<Uint64> peak;
+
+        /** Creates zeroed counters */
+        ProfileCounters() : calls(0), frames(0), total(0), self(0), peak(0) {}
+
+        /**
+         * Records a single call to read.
+         *
+         * @param amount    The number of frames requested
+         * @param elapsed   The time of the call, including the input nodes
+         * @param exclusive The time of the call, excluding the input nodes
+         */
+        void record(Uint32 amount, Uint64 elapsed, Uint64 exclusive);
+
+        /**
+         * Returns a copy of these counters with the given name.
+         *
+         * @param name  The name for the statistics
+         *
+         * @return a copy of these counters with the given name.
+         */
+        Profile snapshot(const std::string& name) const;
+
+        /**
+         * Resets all counters to zero.
+         */
+        void reset();
+    };
+
+    /** The statistics for each registered node class */
+    static ProfileCounters _classProfiles[AUDIO_PROFILE_CLASSES];
+    /** The profiling statistics for this node */
+    ProfileCounters _profile;
+    /** The index of the class statistics for this node */
+    Uint32 _profclass;
+
+protected:
+    /**
+     * A scoped timer for the {@link #read} method of a node.
+     *
+     * Every implementation of read should begin by creating one of these on
+     * the stack.  When profiling is disabled, it does nothing.  Otherwise, it
+     * records the time of the call to both the node and its class when it
+     * goes out of scope.  Timers nest, so the time spent in the timers of
+     * input nodes is subtracted from the self time of this node.
+     *
+     * Timers are strictly for the audio thread. They never lock or allocate.
+     */
+    class ProfileScope {
+    private:
+        /** The innermost active timer on this thread */
+        static thread_local ProfileScope* _current;
+        /** The node being timed (nullptr if profiling is disabled) */
+        AudioNode* _node;
+        /** The enclosing timer on this thread */
+        ProfileScope* _parent;
+        /** The time the read started */
+        timestamp_t _start;
+        /** The time spent in nested timers */
+        Uint64 _inputs;
+        /** The number of frames requested */
+        Uint32 _frames;
+
+    public:
+        /**
+         * Starts timing a call to read for the given node.
+         *
+         * @param node      The node being read
+         * @param frames    The number of frames requested
+         */
+        ProfileScope(AudioNode* node, Uint32 frames);
+
+        /**
+         * Records the time of the call to read.
+         */
+        ~ProfileScope();
+
+    private:
+        /** Timers may not be copied */
+        ProfileScope(const ProfileScope&) = delete;
+        /** Timers may not be copied */
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    };
+
 #pragma mark Values
 protected:
     /** The number of channels output by this node */
@@ -198,6 +326,19 @@ protected:
      * unexpected side effects.
      */
     void notify(const std::shared_ptr<AudioNode>& node, Action action);
+
+    /**
+     * Sets whether callbacks raised on this thread are held for later.
+     *
+     * AUDIO THREAD ONLY: This method is for offline rendering, where the
+     * audio graph is read on the main thread.  Held callbacks are executed
+     * by {@link #flushCallbacks}, instead of being scheduled with the
+     * {@link Application}.  That way they run between two reads, and not
+     * in the middle of one.
+     *
+     * @param value Whether callbacks raised on this thread are held
+     */
+    static void holdCallbacks(bool value);
     
 #pragma mark -
 #pragma mark Static Attributes
@@ -633,6 +774,70 @@ public:
      */
     virtual double setRemaining(double time) { return -1; }
     
+    /**
+     * Executes any callbacks held for offline rendering.
+     *
+     * These are the callbacks raised during {@link #holdCallbacks}, or at
+     * any time when there is no running {@link Application}. This method
+     * should only be called on the main thread, and never while the audio
+     * graph is being read on the same thread.
+     *
+     * @return the number of callbacks executed
+     */
+    static size_t flushCallbacks();
+
+#pragma mark -
+#pragma mark Profiling
+    /**
+     * Returns true if audio nodes are recording timing statistics.
+     *
+     * Profiling is disabled by default. When it is disabled, the only cost
+     * is a single atomic load per call to {@link #read}.
+     *
+     * @return true if audio nodes are recording timing statistics.
+     */
+    static bool isProfiling();
+
+    /**
+     * Sets whether audio nodes are recording timing statistics.
+     *
+     * Profiling is disabled by default. When it is disabled, the only cost
+     * is a single atomic load per call to {@link #read}.
+     *
+     * @param value Whether audio nodes are recording timing statistics
+     */
+    static void setProfiling(bool value);
+
+    /**
+     * Returns the timing statistics for this node.
+     *
+     * The statistics are named after this node, or after its class if it
+     * does not have a name.
+     *
+     * @return the timing statistics for this node.
+     */
+    Profile getProfile() const;
+
+    /**
+     * Resets the timing statistics for this node.
+     */
+    void resetProfile() { _profile.reset(); }
+
+    /**
+     * Returns the timing statistics of every node class that has been read.
+     *
+     * These statistics are accumulated over every node of the class, so
+     * they include nodes that have since been deleted.  They are named after
+     * the class.
+     *
+     * @return the timing statistics of every node class that has been read.
+     */
+    static std::vector<Profile> getClassProfiles();
+
+    /**
+     * Resets the timing statistics of every node class.
+     */
+    static void resetClassProfiles();
 };
     }
 }
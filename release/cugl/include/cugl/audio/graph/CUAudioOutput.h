@@ -49,6 +49,7 @@
 #include <SDL/SDL.h>
 #include "CUAudioNode.h"
 #include <cugl/math/dsp/CUBiquadIIR.h>
+#include <cugl/util/CUSnapshotPointer.h>
 #include <unordered_set>
 #include <string>
 #include <memory>
@@ -117,12 +118,49 @@ namespace cugl {
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioOutput : public AudioNode {
+public:
+    /**
+     * The health statistics of the device callback.
+     *
+     * The headroom of a callback is the fraction of the duration of the
+     * buffer that was left after the audio graph was processed. A headroom
+     * of 0.75 means the graph used a quarter of its time budget, while a
+     * negative headroom means the callback took longer than the audio it
+     * produced.
+     */
+    struct Telemetry {
+        /** The number of callbacks */
+        Uint64 callbacks;
+        /** The number of callbacks that took longer than their buffer */
+        Uint64 underruns;
+        /** The number of callbacks that started more than a buffer late */
+        Uint64 late;
+        /** The headroom of the last callback */
+        float headroom;
+        /** The smallest headroom of any callback */
+        float minimum;
+    };
+
 private:
     /** The device name for this output node.  Empty string for default */
     std::string _dvname;
     
     /** The processing time required for this device */
     std::atomic<Uint64> _overhd;
+    /** The number of callbacks since the telemetry was reset */
+    std::atomic<Uint64> _callbacks;
+    /** The number of callbacks that took longer than their buffer */
+    std::atomic<Uint64> _underruns;
+    /** The number of callbacks that started more than a buffer late */
+    std::atomic<Uint64> _latecalls;
+    /** The headroom of the last callback */
+    std::atomic<float> _headroom;
+    /** The smallest headroom since the telemetry was reset */
+    std::atomic<float> _minroom;
+    /** Whether the next callback should skip the lateness check */
+    std::atomic<bool> _resync;
+    /** The start time of the previous callback (audio thread only) */
+    timestamp_t _lastpoll;
 
     /** The audio device in use */
     SDL_AudioDeviceID _device;
@@ -131,9 +169,11 @@ private:
     
     /** Whether or not the device is currently active */
     std::atomic<bool> _active;
+    /** Whether this node renders offline (without an SDL device) */
+    bool _offline;
 
     /** The terminal node of the audio graph. This pulls data from the sources */
-    std::shared_ptr<AudioNode> _input;
+    SnapshotPointer<std::shared_ptr<AudioNode>> _input;
     /** A resampler node if necessary */
     std::shared_ptr<AudioResampler> _resampler;
     /** A redistributor node if necessary */
@@ -287,6 +327,24 @@ private:
      * @return true if initialization was successful
      */
     bool init(const std::string& device, Uint8 channels, Uint32 rate, Uint32 buffer);
+
+    /**
+     * Initializes an offline output with the given channels and sample rate.
+     *
+     * An offline output is not attached to any SDL device, and is never read
+     * by the audio thread. Instead, the audio graph is pulled on demand with
+     * {@link #render}.  This allows the audio graph to be processed (and
+     * benchmarked) on machines without any sound hardware.
+     *
+     * The buffer value is the number of frames read at each simulated poll.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     * @param buffer    The size of the buffer to play audio
+     *
+     * @return true if initialization was successful
+     */
+    bool initOffline(Uint8 channels, Uint32 rate, Uint32 buffer);
     
     /**
      * Disposes any resources allocated for this output device node.
@@ -335,6 +393,15 @@ public:
      * @return the audio device identifier associated with this audio output.
      */
     const SDL_AudioDeviceID getAUID() const  { return _device; }
+
+    /**
+     * Returns true if this output renders offline.
+     *
+     * An offline output has no SDL device.  It is only read by {@link #render}.
+     *
+     * @return true if this output renders offline.
+     */
+    bool isOffline() const { return _offline; }
     
     /**
      * Returns the device associated with this output node.
@@ -415,7 +482,10 @@ public:
      *
      * @return the terminal node of the audio graph
      */
-    std::shared_ptr<AudioNode> getInput() { return _input; }
+    std::shared_ptr<AudioNode> getInput() {
+        SnapshotPointer<std::shared_ptr<AudioNode>>::Reader input = _input.read();
+        return input ? *input : nullptr;
+    }
     
 #pragma mark -
 #pragma mark Playback Control
@@ -489,6 +559,45 @@ public:
      */
    	Uint32 poll(Uint8* stream, int len);
 
+#pragma mark -
+#pragma mark Offline Rendering
+    /**
+     * Renders the given number of frames from an offline output.
+     *
+     * The audio graph is read on the calling thread one buffer at a time,
+     * exactly as the SDL callback would read it. Node callbacks raised
+     * while reading are executed between buffers, so the {@link AudioEngine}
+     * and {@link AudioQueue} work as usual.  Hence this method should only
+     * be called from the main thread.
+     *
+     * If speed is 0, the graph is pulled as fast as possible.  Otherwise,
+     * the render is paced to the given multiple of real time (so 1 is real
+     * time).  Streamed assets are decoded on the calling thread before
+     * each buffer, so they never starve.  This method fails if the output
+     * is not offline.
+     *
+     * @param buffer    The buffer to store the interleaved frames
+     * @param frames    The number of frames to render
+     * @param speed     The multiple of real time (0 for unpaced)
+     *
+     * @return the number of frames rendered
+     */
+    Uint64 render(float* buffer, Uint64 frames, double speed=0);
+
+    /**
+     * Renders the given number of frames from an offline output to a file.
+     *
+     * The file is a 16-bit PCM WAV file. Otherwise, this method is the same
+     * as {@link #render}.
+     *
+     * @param file      The path of the WAV file
+     * @param frames    The number of frames to render
+     * @param speed     The multiple of real time (0 for unpaced)
+     *
+     * @return true if the file was successfully written
+     */
+    bool renderToFile(const std::string& file, Uint64 frames, double speed=0);
+
     /**
      * Reboots the audio output node without interrupting any active polling.
      *
@@ -510,6 +619,22 @@ public:
      * @return the number of microseconds needed to render the last audio frame.
      */
     Uint64 getOverhead() const;
+
+    /**
+     * Returns the health statistics of the device callback.
+     *
+     * These statistics are always recorded, as they only cost two clock
+     * reads per callback. The lateness of a callback is not checked after
+     * the device is paused, deactivated or rebooted.
+     *
+     * @return the health statistics of the device callback.
+     */
+    Telemetry getTelemetry() const;
+
+    /**
+     * Resets the health statistics of the device callback.
+     */
+    void resetTelemetry();
     
 #pragma mark -
 #pragma mark Optional Methods
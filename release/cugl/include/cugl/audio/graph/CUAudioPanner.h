@@ -80,6 +80,8 @@ private:
     std::shared_ptr<AudioNode> _input;
     /** The panning matrix */
     std::atomic<float>* _mapper;
+    /** A snapshot of the panning matrix for the mixing kernel (AUDIO THREAD ONLY) */
+    float* _gains;
 
 #pragma mark -
 #pragma mark Constructors
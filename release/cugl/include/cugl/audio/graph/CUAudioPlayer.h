@@ -40,6 +40,7 @@
 #define __CU_AUDIO_PLAYER_H__
 #include <SDL/SDL.h>
 #include <cugl/audio/CUAudioSample.h>
+#include <cugl/audio/CUAudioStreamer.h>
 #include "CUAudioNode.h"
 #include <functional>
 #include <string>
@@ -99,6 +100,8 @@ protected:
     
     /** A reference to the underlying data buffer (IN-MEMORY ACCESS) */
     float* _buffer;
+    /** A reference to the underlying 16-bit data buffer (IN-MEMORY ACCESS) */
+    Sint16* _pcm16;
     
     // Streaming support
     /** A buffer for storing each chunk as we need it */
@@ -113,6 +116,11 @@ protected:
     /** Whether or not we need to reposition (STREAMING ACCESS) */
     std::atomic<bool> _dirty;
 
+    /** The decode-ahead ring, if streamed through the AudioStreamer */
+    std::shared_ptr<AudioStream> _stream;
+    /** The number of reads the decode-ahead ring could not satisfy */
+    std::atomic<Uint32> _underruns;
+
 public:
 #pragma mark Constructors
     /**
@@ -170,6 +178,18 @@ public:
      */
     std::shared_ptr<AudioSample> getSource() { return _source; }
 
+    /**
+     * Returns the number of reads that the decode-ahead stream could not satisfy.
+     *
+     * A streamed player normally copies from a ring that is filled ahead of
+     * time by the {@link AudioStreamer}.  If the ring runs dry, the player
+     * outputs silence rather than decode on the audio thread.  This value
+     * counts those events, and should stay at 0 outside of seeks.
+     *
+     * @return the number of reads that the decode-ahead stream could not satisfy.
+     */
+    Uint32 getUnderruns() const { return _underruns.load(std::memory_order_relaxed); }
+
 #pragma mark Overriden Methods
     /**
      * Reads up to the specified number of frames into the given buffer
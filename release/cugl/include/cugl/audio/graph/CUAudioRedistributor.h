@@ -82,13 +82,12 @@ private:
     /** The currently supported input channels size */
     std::atomic<Uint8> _conduits;
 
-    /** The distribution function for default behavior */
-    std::function<void(const float*, float*, size_t)> _director;
-    
     /** The redistribution matrix (may be nullptr) */
     float* _matrix;
     /** The size of the redistribution matrix (may be 0) */
     std::atomic<Uint32> _matsize;
+    /** The transposed matrix for the mixing kernel (nullptr if not ready) */
+    float* _mixtable;
     
     /** An intermediate buffer for downscaling (may be nullptr) */
     float* _buffer;
@@ -96,24 +95,14 @@ private:
     Uint32 _pagesize;
     
     /**
-     * Redistribute from buffer input to buffer output
-     *
-     * The buffer input should have {@link #getConduits()} channels
-     * worth of data, while output should support {@link #getChannels()}
-     * channels. However, this method is safe to call in-place,
-     * provided that the buffer is large enough to support the
-     * new output data.
+     * Rebuilds the mixing table for the current channel configuration.
      *
-     * This version of the method assumes that output has more channels
-     * than input. This distinction is necessary to support in-place
-     * redistribution. The value size is specified in terms of frames,
-     * not samples, so that it does not include any channel information.
-     *
-     * @param input     The input buffer
-     * @param output    The output buffer
-     * @param size      The number of audio frames to process
+     * If there is a redistribution matrix, the table is its transpose.
+     * Otherwise the table is derived from the default conversion for the
+     * two channel counts.  The buffer mutex must be held when this method
+     * is called.
      */
-    void scaleUp(const float* input, float* output, size_t size);
+    void buildTable();
     
     /**
      * Redistribute from buffer input to buffer output
@@ -122,18 +111,14 @@ private:
      * worth of data, while output should support {@link #getChannels()}
      * channels. However, this method is safe to call in-place,
      * provided that the buffer is large enough to support the
-     * new output data.
-     *
-     * This version of the method assumes that input has more channels
-     * than output. This distinction is necessary to support in-place
-     * redistribution. The value size is specified in terms of frames,
+     * new output data. The value size is specified in terms of frames,
      * not samples, so that it does not include any channel information.
      *
      * @param input     The input buffer
      * @param output    The output buffer
      * @param size      The number of audio frames to process
      */
-    void scaleDown(const float* input, float* output, size_t);
+    void remix(const float* input, float* output, size_t size);
 
 public:
 #pragma mark -
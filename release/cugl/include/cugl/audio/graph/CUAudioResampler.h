@@ -40,10 +40,15 @@
 #ifndef __CU_AUDIO_RESAMPLER_H__
 #define __CU_AUDIO_RESAMPLER_H__
 #include <cugl/audio/graph/CUAudioNode.h>
+#include <cugl/util/CUSnapshotPointer.h>
 #include <SDL/SDL.h>
-#include <mutex>
+#include <memory>
+#include <vector>
 #include <atomic>
 
+/** The maximum number of phases for a polyphase coefficient bank */
+#define RESAMPLER_MAX_PHASES    1024
+
 namespace cugl {
     
     /**
@@ -72,6 +77,20 @@ namespace cugl {
  * input is not.  It will readjust the conversion filter to match the sampling
  * rate of the input node whenever the input node changes.
  *
+ * When the ratio between the two rates reduces to a small fraction (such as
+ * 160/147 for 44.1 kHz to 48 kHz), the sinc filter is evaluated as a fixed
+ * polyphase filter.  The coefficients for every phase are computed once and
+ * shared by all resamplers with the same ratio and filter properties, so
+ * each output sample is a single (vectorized) dot product.  On low-end
+ * devices, the {@link Quality} may be reduced to cubic or linear
+ * interpolation instead.
+ *
+ * The input node and the filter are published to the audio thread as
+ * immutable snapshots.  Changing the input rate or any filter property builds
+ * a new filter on the main thread and swaps it in, so the audio thread never
+ * waits for (or allocates during) a reconfiguration.  Doing so restarts the
+ * intermediate buffer, which may cause a brief discontinuity.
+ *
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the
  * user.
@@ -79,12 +98,109 @@ namespace cugl {
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioResampler : public AudioNode {
+public:
+    /**
+     * This enumeration represents the interpolation quality of a resampler.
+     */
+    enum class Quality : int {
+        /** Linear interpolation between adjacent frames (cheapest) */
+        LINEAR = 0,
+        /** Cubic (Catmull-Rom) interpolation over four frames */
+        CUBIC  = 1,
+        /** A kaiser-windowed sinc filter (polyphase when possible) */
+        SINC   = 2
+    };
+
+    /** The quality assigned to newly initialized resamplers */
+    static Quality DEFAULT_QUALITY;
+
 private:
-    /** Mutex to protect more sophisticated synchronization */
-    mutable std::mutex _buffmtex;
+    /**
+     * The coefficient tables of a kaiser-windowed sinc filter.
+     *
+     * A kernel is immutable once built, and depends only on the filter
+     * properties (not the input rate).
+     */
+    struct Kernel {
+        /** The number of zero crossings */
+        Uint32 zero_cross;
+        /** The number of samples per zero crossing */
+        Uint32 per_crossing;
+        /** The filter (table) size */
+        size_t size;
+        /** The filter coefficients */
+        std::vector<float> table;
+        /** The filter coefficient differences */
+        std::vector<float> diffs;
+    };
+
+    /**
+     * The coefficients of a fixed-ratio polyphase filter.
+     *
+     * A bank is immutable once built, and is shared by every resampler with
+     * the same reduced ratio and filter properties.
+     */
+    struct Bank {
+        /** The number of phases (the reduced output rate) */
+        Uint32 phases;
+        /** The number of input frames used by each output frame */
+        Uint32 taps;
+        /** The row size of each phase (taps padded for vectorization) */
+        Uint32 stride;
+        /** The coefficients, one row of stride elements per phase */
+        std::vector<float> table;
+    };
+
+    /**
+     * The filter state read by the audio thread.
+     *
+     * A new filter is built by the main thread whenever the input rate or
+     * the kernel changes.  The intermediate buffer belongs to the audio
+     * thread once the filter is published; the main thread never copies it.
+     */
+    struct Filter {
+        /** The filter coefficients */
+        std::shared_ptr<const Kernel> kernel;
+        /** The input sample rate for this filter */
+        Uint32 inrate;
+        /** The intermediate sampling buffer */
+        std::vector<float> buffer;
+        /** The capacity of the sampling buffer */
+        Uint32 capacity;
+        /** The amount of data currently available in the sampling buffer */
+        Uint32 avail;
+        /** The offset for the next (unconsumed) bit of data in the buffer */
+        double offset;
+
+        // Fixed-ratio interpolation (everything but the continuous filter)
+        /** The interpolation quality */
+        Quality quality;
+        /** The polyphase coefficients (nullptr unless a polyphase sinc) */
+        std::shared_ptr<const Bank> bank;
+        /** The reduced output rate (the number of phases) */
+        Uint32 outstep;
+        /** The reduced input rate (the phase increment per output frame) */
+        Uint32 instep;
+        /** The number of input frames used by each output frame */
+        Uint32 taps;
+        /** The de-interleaved input history, one row per channel */
+        std::vector<float> planar;
+        /** The number of history frames in each row (excluding padding) */
+        Uint32 rowsize;
+        /** The number of valid frames in each row of the history */
+        Uint32 head;
+        /** The first history frame used by the next output frame */
+        Uint32 base;
+        /** The phase of the next output frame */
+        Uint32 phase;
+    };
 
     /** The input node to resample from */
-    std::shared_ptr<AudioNode> _input;
+    SnapshotPointer<std::shared_ptr<AudioNode>> _input;
+    /** The filter read by the audio thread */
+    SnapshotPointer<Filter> _filter;
+    /** The current filter coefficients (main thread only) */
+    std::shared_ptr<const Kernel> _kernel;
     /** The currently supported input sample rate */
     std::atomic<Uint32> _inputrate;
 
@@ -94,27 +210,12 @@ private:
     std::atomic<Uint32> _bit_precision;
     /** Filter attenuation in decibels */
     std::atomic<float> _stopband;
-    /** The number of samples per zero crossing */
-    Uint32 _per_crossing;
-
-    /** The filter (table) size */
-    size_t _filter_size;
-    /** The filter coefficients */
-    float* _filter_table;
-    /** The filter coefficient differences */
-    float* _filter_diffs;
-    
-    /** Intermediate read buffer */
-    /** The intermediate sampling buffer */
-    float* _cvtbuffer;
-    /** The capacity of the sampling buffer */
-    Uint32 _capacity;
     /** The supported page size for filtering */
     Uint32 _pagesize;
-    /** The amount of data currently available in the sampling buffer */
-    Uint32 _cvtavail;
-    /** The offset for the next (unconsumed) bit of data in the buffer */
-    double _cvtoffset;
+    /** The interpolation quality */
+    std::atomic<Quality> _quality;
+    /** Whether the audio thread should clear the filter history */
+    std::atomic<bool> _flush;
 
 public:
 #pragma mark -
@@ -261,7 +362,10 @@ public:
      *
      * @return the input node of this resampler.
      */
-    std::shared_ptr<AudioNode> getInput() const { return _input; }
+    std::shared_ptr<AudioNode> getInput() const {
+        SnapshotPointer<std::shared_ptr<AudioNode>>::Reader input = _input.read();
+        return input ? *input : nullptr;
+    }
 
 #pragma mark -
 #pragma mark Filter Properties
@@ -404,6 +508,36 @@ public:
      * @param value The number of zero-crossings of this filter.
      */
     void setZeroCrossings(Uint32 value);
+
+    /**
+     * Returns the interpolation quality of this resampler.
+     *
+     * The default is {@link #DEFAULT_QUALITY} at the time of initialization.
+     *
+     * @return the interpolation quality of this resampler.
+     */
+    Quality getQuality() const { return _quality.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the interpolation quality of this resampler.
+     *
+     * Lower qualities are cheaper, but introduce audible aliasing. Changing
+     * the quality publishes a new filter, which may cause a brief
+     * discontinuity.
+     *
+     * @param value The interpolation quality
+     */
+    void setQuality(Quality value);
+
+    /**
+     * Clears the filter history of this resampler.
+     *
+     * The resampler keeps the most recent input frames to interpolate across
+     * reads.  This method discards them, so that a new (unrelated) input does
+     * not start with the tail of the previous one.  The history is cleared by
+     * the audio thread at the start of its next read.
+     */
+    void flush();
     
 
 #pragma mark -
@@ -626,25 +760,76 @@ private:
      * are altered. These properties include {@link #getStopband},
      * {@link #getBitPrecision} and {@link #getZeroCrossings}. However, the table
      * does **not** need to be recomputed when the input rate changes.
+     *
+     * This method does not publish the table.  Call {@link #rebuild} to make
+     * it visible to the audio thread.
      */
     void setup();
+
+    /**
+     * Publishes a new filter for the current kernel and input rate.
+     *
+     * The new filter has a fresh intermediate buffer.  The old filter is
+     * released on this thread once the audio thread is done with it.
+     */
+    void rebuild();
     
     /**
      * Filters a single frame (for all channels) of output audio
      *
      * This method processes all of the channels for the current audio frame and
      * stores the results in buffer (in order by channel). The current audio frame
-     * is determined by the _cvtoffset value.
+     * is determined by the offset of the filter state.
      *
-     * The additional parameters passed to this method are to ensure thread safety.
-     * For example, inrate is the input sampling rate at the time of the buffer
-     * computation, and not necessarily the current input rate.
+     * The filter state is the snapshot pinned by {@link #read}, and not
+     * necessarily the most recently published one.
      *
+     * @param state     The filter state at the time of computation
      * @param buffer    The buffer to store the audio frame
-     * @param inrate    The input rate at the time of computation
      * @param limit     The number of elements in the intermediate buffer
      */
-    void filter(float* buffer, double inrate, Uint32 limit);
+    void filter(Filter* state, float* buffer, Uint32 limit);
+
+    /**
+     * Reads and resamples frames using fixed-ratio interpolation.
+     *
+     * This is the algorithm for every filter except the continuous sinc
+     * filter.  The ratio is tracked exactly as an integer phase, so there
+     * is no drift over long streams.
+     *
+     * @param state     The filter state pinned by {@link #read}
+     * @param input     The input node
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    Uint32 interpolate(Filter* state, AudioNode* input, float* buffer, Uint32 frames);
+
+    /**
+     * Clears the history of the given filter state.
+     *
+     * The state is returned to how it was when the filter was published.
+     *
+     * @param state     The filter state pinned by {@link #read}
+     */
+    void clearHistory(Filter* state);
+
+    /**
+     * Returns the shared polyphase bank for the given ratio and properties.
+     *
+     * Banks are cached for as long as a resampler is using them.  This method
+     * returns nullptr if the ratio has too many phases.
+     *
+     * @param outstep   The reduced output rate
+     * @param instep    The reduced input rate
+     * @param crossings The number of zero crossings
+     * @param stopband  The filter attenuation in decibels
+     *
+     * @return the shared polyphase bank for the given ratio and properties.
+     */
+    static std::shared_ptr<const Bank> acquireBank(Uint32 outstep, Uint32 instep,
+                                                   Uint32 crossings, float stopband);
     
 };
     }
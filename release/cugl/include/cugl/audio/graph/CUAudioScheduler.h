@@ -61,6 +61,10 @@ namespace cugl {
  * This queue is only designed to support two threads. The producer is the main
  * thread, while the consumer is the audio thread.
  *
+ * Entries are only ever deleted by the producer.  The consumer decides when
+ * this is allowed with {@link release}.  This keeps the nodes it popped alive
+ * until it is done with them, so that no node is destroyed in the audio thread.
+ *
  * This queue does not have a lot of bells and whistles because it is only
  * intended for thread synchronization.  We expect the user to maintain what
  * has and has not been appended to the queue.
@@ -101,6 +105,8 @@ private:
     std::atomic<Entry*> _divide;
      /** Pointer to the end of the queue (to add elements) */
     std::atomic<Entry*> _last;
+    /** Pointer to the oldest entry still in use by the consumer */
+    std::atomic<Entry*> _retain;
     
     
 public:
@@ -191,9 +197,19 @@ public:
     /**
      * Clears all elements in this queue.
      *
-     * This method is thread-safe
+     * This method is a consumer method.  It should only be called in the
+     * same thread as {@link pop}.
      */
     void clear();
+
+    /**
+     * Allows the producer to delete every entry before the most recent pop.
+     *
+     * Until this method is called, the nodes returned by {@link pop} are
+     * guaranteed to stay alive.  This method is a consumer method.  It should
+     * only be called in the same thread as {@link pop}.
+     */
+    void release();
 };
     
     
@@ -215,6 +231,12 @@ public:
  * user to look at the contents of the queue.  The user can only look at
  * the currently playing node.
  *
+ * Only the audio thread ever removes nodes from the queue or changes the
+ * current node.  Methods like {@link clear}, {@link skip} and {@link trim}
+ * post a request that the audio thread applies at its next read.  Nodes
+ * removed by the audio thread are released on the main thread at the next
+ * call to {@link play} or {@link append}.
+ *
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
  *
@@ -225,10 +247,12 @@ public:
  */
 class AudioScheduler : public AudioNode {
 private:
-    /** The currently active audio node */
+    /** The currently active audio node (audio thread only) */
     std::shared_ptr<AudioNode> _current;
-    /** The previously active audio node  (for overlaps) */
+    /** The previously active audio node (audio thread only, for overlaps) */
     std::shared_ptr<AudioNode> _previous;
+    /** The currently active audio node, as visible to the main thread */
+    std::atomic<AudioNode*> _active;
     /** The remaining number of loops for the current audio */
     std::atomic<Sint32> _loops;
     /** The desired overlap amount */
@@ -243,6 +267,10 @@ private:
     std::atomic<Uint32> _qsize;
     /** Counter to track queue skips (for clearing or advancement) */
     std::atomic<Uint32> _qskip;
+    /** Counter to track queue removals (without advancement) */
+    std::atomic<Uint32> _qtrim;
+    /** Whether to purge the queue without invoking the callback */
+    std::atomic<bool> _qpurge;
 
     /** Stored results after a mark is set */
     std::deque<std::shared_ptr<AudioNode>> _memory;
@@ -411,19 +439,25 @@ public:
      * nodes removed from the queue (as well as the current node). The complete
      * flag will be false, indicating that they were interrupted.
      *
-     * The optional force argument allows for sounds to be purged immediately
-     * (such as during clean-up).  However, doing so will not invoke the callback
-     * function, even if it is provided.
+     * The optional force argument purges the sounds at the next read without
+     * invoking the callback function, even if it is provided.  It does not
+     * wait for any nodes earlier in the queue.
      *
-     * @param force whether to delete the queue immediately, in the current thread
+     * @param force whether to purge the queue without the callback function
      */
     void clear(bool force=false);
     
     /**
-     * Empties the queue without stopping the current playback.
+     * Removes nodes from the queue without stopping the current playback.
      *
      * This method is useful when we want to clear the queue, but to smoothly
-     * fade-out the current playback.
+     * fade-out the current playback.  The value size is the number of nodes
+     * to remove from the front of the queue.  If it is negative, the queue
+     * is emptied.  The callback function is not invoked for these nodes.
+     *
+     * The nodes are removed at the next read in the audio thread.
+     *
+     * @param size  The number of nodes to remove from the queue
      */
     void trim(Sint32 size = -1);
     
@@ -740,6 +774,24 @@ private:
      * @return the next audio instance for playback
      */
     std::shared_ptr<AudioNode> acquire(Sint32& loop, Uint32 skip=0, Action action=Action::COMPLETE);
+
+    /**
+     * Sets the currently active audio node.
+     *
+     * AUDIO THREAD ONLY: This is an internal method for queue management.
+     *
+     * @param node  The currently active audio node
+     */
+    void setCurrent(const std::shared_ptr<AudioNode>& node);
+
+    /**
+     * Removes all nodes from the queue without invoking the callback.
+     *
+     * AUDIO THREAD ONLY: This is an internal method for queue management.
+     * It is also called by {@link dispose}, when the audio thread can no
+     * longer read from this node.
+     */
+    void purge();
 };
     }
 }
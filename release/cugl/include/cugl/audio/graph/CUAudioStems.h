@@ -0,0 +1,251 @@
+//
+//  CUAudioStems.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an audio graph node for adaptive music.  It mixes a
+//  fixed set of synchronized stems (layers of the same piece of music), each
+//  with its own gain.  The game sets a target gain for each stem, and the
+//  node ramps to that target on the audio thread.  The ramps are computed
+//  per frame, so they are independent of the game frame rate.
+//
+//  The targets are published to the audio thread as an immutable snapshot.
+//  Changing the targets copies the parameter block and swaps in the new copy,
+//  so the audio thread never waits on the main thread.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_AUDIO_STEMS_H__
+#define __CU_AUDIO_STEMS_H__
+#include "CUAudioMixer.h"
+#include <cugl/util/CUSnapshotPointer.h>
+#include <vector>
+
+namespace cugl {
+
+    /**
+     * The audio graph classes.
+     *
+     * This internal namespace is for the audio graph clases.  It was chosen
+     * to distinguish this graph from other graph class collections, such as the
+     * scene graph collections in {@link scene2}.
+     */
+    namespace audio {
+/**
+ * This class represents a mixer for adaptive music stems.
+ *
+ * A stem is one layer of a piece of music, such as the percussion or a
+ * melody that only plays in combat.  The stems are attached when the node
+ * is initialized, and they must all have the same number of channels and
+ * sample rate.  Every stem is read on every buffer, even when its gain is
+ * zero, so the stems never drift out of sync.  Like {@link AudioMixer},
+ * operations such as {@link #reset} and {@link #setPosition} are applied
+ * to all of the stems equally.
+ *
+ * Each stem has a target gain.  When the targets change, each stem ramps
+ * linearly from its current gain to its target over the given fade time.
+ * The ramp is computed per frame on the audio thread, so it is the same no
+ * matter how often (or how rarely) the game updates.  Hence targets should
+ * only be set when the music should change, not every animation frame.
+ *
+ * The targets are kept in a parameter block that is published as an
+ * immutable snapshot.  Setting the targets never blocks the audio thread,
+ * and the audio thread picks up all of the new targets at once.
+ *
+ * The audio graph should only be accessed in the main thread.  In addition,
+ * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
+ *
+ * This class does not support any actions for the {@link AudioNode#setCallback}.
+ */
+class AudioStems : public AudioMixer {
+private:
+    /** The stem parameters published to the audio thread */
+    class Targets {
+    public:
+        /** The target gain of each stem */
+        std::vector<float> gains;
+        /** The fade time (in frames) of each stem to reach its target */
+        std::vector<Uint64> fades;
+        /** The number of times the target of each stem was set */
+        std::vector<Uint32> serials;
+        /** The generation of this block (incremented on each change) */
+        Uint32 generation;
+
+        /** Creates an empty parameter block */
+        Targets() : generation(0) {}
+    };
+
+    /** The current parameter block */
+    SnapshotPointer<Targets> _targets;
+
+    /** The current gain of each stem (AUDIO THREAD ONLY) */
+    std::vector<float> _current;
+    /** The gain each stem is ramping to (AUDIO THREAD ONLY) */
+    std::vector<float> _goals;
+    /** The serial of the last target of each stem (AUDIO THREAD ONLY) */
+    std::vector<Uint32> _serials;
+    /** The per-frame gain change of each stem (AUDIO THREAD ONLY) */
+    std::vector<float> _steps;
+    /** The frames remaining in the ramp of each stem (AUDIO THREAD ONLY) */
+    std::vector<Uint64> _ramps;
+    /** The generation of the last parameter block read (AUDIO THREAD ONLY) */
+    Uint32 _generation;
+
+    /**
+     * Updates the ramps of each stem for the given parameter block
+     *
+     * AUDIO THREAD ONLY: This is called when the audio thread sees a new
+     * parameter block.  Only the stems whose target was set start a new
+     * ramp; the others continue the ramp they are on.
+     *
+     * @param targets   The new parameter block
+     */
+    void retarget(const Targets* targets);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate stem mixer that takes no stems
+     *
+     * The node must be initialized to be used.
+     */
+    AudioStems();
+
+    /**
+     * Deletes this stem mixer, disposing of all resources.
+     */
+    ~AudioStems() { dispose(); }
+
+    /**
+     * Initializes the node for the given stems
+     *
+     * The number of channels and the sample rate are those of the first
+     * stem, and all other stems must agree with it.  Every stem starts at
+     * full gain.  There must be at least one stem.
+     *
+     * @param stems     The stems to mix
+     *
+     * @return true if initialization was successful
+     */
+    bool init(const std::vector<std::shared_ptr<AudioNode>>& stems);
+
+    /**
+     * Disposes any resources allocated for this stem mixer
+     *
+     * The state of the node is reset to that of an uninitialized constructor.
+     * Unlike the destructor, this method allows the node to be reinitialized.
+     */
+    virtual void dispose() override;
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated node for the given stems
+     *
+     * The number of channels and the sample rate are those of the first
+     * stem, and all other stems must agree with it.  Every stem starts at
+     * full gain.  There must be at least one stem.
+     *
+     * @param stems     The stems to mix
+     *
+     * @return a newly allocated node for the given stems
+     */
+    static std::shared_ptr<AudioStems> alloc(const std::vector<std::shared_ptr<AudioNode>>& stems) {
+        std::shared_ptr<AudioStems> result = std::make_shared<AudioStems>();
+        return (result->init(stems) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Stem Targets
+    /**
+     * Returns the target gain of the given stem
+     *
+     * This is the gain the stem is ramping to, which may not yet be the gain
+     * that is heard.
+     *
+     * @param stem  The stem index
+     *
+     * @return the target gain of the given stem
+     */
+    float getTarget(Uint8 stem) const;
+
+    /**
+     * Sets the target gain of the given stem
+     *
+     * The stem ramps linearly from its current gain to the target over the
+     * given number of seconds.  If fade is 0, the gain changes at the start
+     * of the next buffer.  The other stems keep their current targets.
+     *
+     * @param stem  The stem index
+     * @param gain  The target gain
+     * @param fade  The seconds to reach the target
+     */
+    void setTarget(Uint8 stem, float gain, double fade);
+
+    /**
+     * Sets the target gains of all of the stems at once
+     *
+     * Each stem ramps linearly from its current gain to its target over the
+     * given number of seconds.  If fade is 0, the gains change at the start
+     * of the next buffer.  The audio thread sees all of the new targets at
+     * the same time.  Any stem without a target in the vector keeps its
+     * current target (and ramp).
+     *
+     * @param gains The target gains
+     * @param fade  The seconds to reach the targets
+     */
+    void setTargets(const std::vector<float>& gains, double fade);
+
+#pragma mark -
+#pragma mark Overriden Methods
+    /**
+     * Returns false, as the stems of this node are fixed.
+     *
+     * @param width The (ignored) mixer width
+     *
+     * @return false, as the stems of this node are fixed.
+     */
+    virtual bool setWidth(Uint8) override { return false; }
+
+    /**
+     * Reads up to the specified number of frames into the given buffer
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly, unless
+     * part of a custom audio graph node.
+     *
+     * The buffer should have enough room to store frames * channels elements.
+     * The channels are interleaved into the output buffer.
+     *
+     * Reading the buffer has no affect on the read position.  You must manually
+     * move the frame position forward.  This is to allow for a frame window to
+     * be reread if necessary.
+     *
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    virtual Uint32 read(float* buffer, Uint32 frames) override;
+
+};
+    }
+}
+
+#endif /* __CU_AUDIO_STEMS_H__ */
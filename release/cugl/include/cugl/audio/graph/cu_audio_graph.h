@@ -39,6 +39,7 @@
 #include "CUAudioFader.h"
 #include "CUAudioScheduler.h"
 #include "CUAudioMixer.h"
+#include "CUAudioStems.h"
 #include "CUAudioPanner.h"
 #include "CUAudioSpinner.h"
 #include "CUAudioSynchronizer.h"
@@ -36,6 +36,8 @@
 #include <cugl/util/CUTimestamp.h>
 #include <cugl/math/CUColor4.h>
 #include <cugl/math/CURect.h>
+#include <cugl/util/CUMPSCQueue.h>
+#include <cugl/util/CUTaskScheduler.h>
 #include <unordered_map>
 #include <functional>
 #include <deque>
@@ -65,6 +67,9 @@ typedef struct {
     /** The countdown until the next reoccurrence */
     Uint32 timer;
 } scheduable;
+
+/** The default per-frame time budget (in microseconds) for deferred work */
+#define DEFAULT_DEFER_BUDGET 4000
     
 /**
  * This class represents a basic CUGL application
@@ -130,6 +135,27 @@ public:
         SHUTDOWN = 4
     };
     
+    /**
+     * The statistics for the deferred work queue.
+     *
+     * The per-frame values are for the most recent frame.  The remaining
+     * values accumulate until {@link resetDeferredStats} is called.
+     */
+    struct DeferredStats {
+        /** The number of items executed in the last frame */
+        Uint32 executed;
+        /** The number of items left waiting at the end of the last frame */
+        Uint32 pending;
+        /** The time (in microseconds) spent on deferred work in the last frame */
+        Uint64 micros;
+        /** The longest time (in microseconds) spent on deferred work in a frame */
+        Uint64 peak;
+        /** The total number of items executed */
+        Uint64 total;
+        /** The number of frames that exhausted the budget with work remaining */
+        Uint32 overruns;
+    };
+
     
 protected:
     /** The name of this application */
@@ -188,6 +214,14 @@ private:
     std::unordered_map<Uint32, scheduable> _callbacks;
 	/** A mutex lock for the schedule queue */
 	std::mutex _queueMutex;
+
+    /** Deferred work, with one lock-free queue per priority */
+    MPSCQueue<std::function<void()>> _deferred[TaskScheduler::PRIORITIES];
+    /** The per-frame time budget (in microseconds) for deferred work */
+    Uint32 _deferBudget;
+    /** The statistics for deferred work */
+    DeferredStats _deferStats;
+
     /**
      * Processes all of the scheduled callback functions.
      *
@@ -198,6 +232,15 @@ private:
      * @param millis    The number of milliseconds since last called
      */
     void processCallbacks(Uint32 millis);
+
+    /**
+     * Processes the deferred work queue within the frame budget.
+     *
+     * Critical work is always processed in full.  Other work is processed in
+     * priority order until the budget is exhausted, though at least one such
+     * item is processed each frame to guarantee progress.
+     */
+    void processDeferred();
     
 #pragma mark -
 #pragma mark Constructors
@@ -448,6 +491,60 @@ public:
      */
     void unschedule(Uint32 id);
 
+    /**
+     * Defers a one-time function to the main thread.
+     *
+     * Unlike {@link schedule}, this method is lock-free and is intended for
+     * worker threads that hand off results to the main thread in bulk, such
+     * as asset loaders.  Deferred work is processed after the scheduled
+     * callbacks, but before the main {@link update} method.
+     *
+     * To keep frames smooth, deferred work is limited to a per-frame time
+     * budget (see {@link setDeferBudget}).  Work that does not fit in the
+     * budget waits for the next frame.  Work is processed in priority order,
+     * and FIFO order within a priority.  Critical work ignores the budget
+     * and is always processed at the next frame.
+     *
+     * This method may be called from any thread.
+     *
+     * @param work      The function to execute on the main thread
+     * @param priority  The priority of this work
+     */
+    void defer(std::function<void()> work,
+               TaskScheduler::Priority priority=TaskScheduler::Priority::NORMAL);
+
+    /**
+     * Returns the per-frame time budget (in microseconds) for deferred work.
+     *
+     * A budget of 0 means that all deferred work is processed each frame.
+     *
+     * @return the per-frame time budget (in microseconds) for deferred work.
+     */
+    Uint32 getDeferBudget() const { return _deferBudget; }
+
+    /**
+     * Sets the per-frame time budget (in microseconds) for deferred work.
+     *
+     * A budget of 0 means that all deferred work is processed each frame.
+     * The budget is checked between items, so a single expensive item may
+     * overrun it.
+     *
+     * @param micros    The per-frame time budget for deferred work
+     */
+    void setDeferBudget(Uint32 micros) { _deferBudget = micros; }
+
+    /**
+     * Returns the statistics for the deferred work queue.
+     *
+     * @return the statistics for the deferred work queue.
+     */
+    const DeferredStats& getDeferredStats() const { return _deferStats; }
+
+    /**
+     * Resets the accumulated statistics for the deferred work queue.
+     */
+    void resetDeferredStats();
+
     
 #pragma mark -
 #pragma mark Initialization Attributes
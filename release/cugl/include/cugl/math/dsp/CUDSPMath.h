@@ -35,6 +35,9 @@
 #define __CU_DSP_MATH_H__
 #include "../CUMathBase.h"
 
+/** The maximum number of channels supported by the channel methods */
+#define DSP_MAX_CHANNELS    32
+
 namespace cugl {
     namespace dsp {
 
@@ -124,6 +127,19 @@ public:
      * @return the number of elements successfully processed
      */
     static size_t scale_add(float* input1, float* input2, float scalar, float* output, size_t size);
+
+    /**
+     * Returns the dot product of two input signals
+     *
+     * This is the inner loop of a convolution (such as a polyphase filter).
+     *
+     * @param input1    The first input buffer
+     * @param input2    The second input buffer
+     * @param size      The number of elements to process
+     *
+     * @return the dot product of two input signals
+     */
+    static float dot(const float* input1, const float* input2, size_t size);
     
 #pragma mark Fade-In/Out Methods
     /**
@@ -196,6 +212,61 @@ public:
      */
     static size_t ease(float* data, float bound, float knee, size_t size);
 
+#pragma mark Conversion Methods
+    /**
+     * Converts 16-bit PCM samples to floats, storing the result in output
+     *
+     * The samples are scaled to the range [-1,1).
+     *
+     * @param input     The input buffer
+     * @param output    The output buffer
+     * @param size      The number of elements to convert
+     *
+     * @return the number of elements successfully converted
+     */
+    static size_t decode_pcm16(const Sint16* input, float* output, size_t size);
+
+    /**
+     * Converts floats to 16-bit PCM samples, storing the result in output
+     *
+     * Values outside of the range [-1,1] are clamped, and all values are
+     * rounded to the nearest sample.
+     *
+     * @param input     The input buffer
+     * @param output    The output buffer
+     * @param size      The number of elements to convert
+     *
+     * @return the number of elements successfully converted
+     */
+    static size_t encode_pcm16(const float* input, Sint16* output, size_t size);
+
+#pragma mark Channel Methods
+    /**
+     * Mixes interleaved input channels into interleaved output channels
+     *
+     * The matrix has a row for each input channel and a column for each
+     * output channel. Hence matrix[ii*outchan+jj] is the gain applied to
+     * input channel ii when it is added to output channel jj. This is the
+     * transpose of the usual redistribution matrix, as it allows the vector
+     * version to process all of the output channels of a frame at once.
+     *
+     * It is safe for output to be the same as input.  If there are more
+     * output channels than input channels, the frames are processed from
+     * back to front to support this.  Neither count may exceed
+     * {@link DSP_MAX_CHANNELS}.
+     *
+     * @param input     The input buffer
+     * @param inchan    The number of input channels
+     * @param matrix    The inchan x outchan gain matrix
+     * @param outchan   The number of output channels
+     * @param output    The output buffer
+     * @param frames    The number of audio frames to mix
+     *
+     * @return the number of frames successfully mixed
+     */
+    static size_t mix_matrix(const float* input, Uint32 inchan, const float* matrix,
+                             Uint32 outchan, float* output, size_t frames);
+
     // TODO: Add convolution
 
 };
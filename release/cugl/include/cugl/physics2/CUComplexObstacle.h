@@ -129,7 +129,10 @@ public:
      * the heap, use one of the static constructors instead (in this case, in
      * one of the subclasses).
      */
-    ComplexObstacle() : Obstacle(), _body(nullptr) { }
+    ComplexObstacle() : Obstacle(), _body(nullptr) {
+        // The parts move independently of the root body
+        setAlwaysUpdated(true);
+    }
     
     /**
      * Deletes this physics object and all of its resources.
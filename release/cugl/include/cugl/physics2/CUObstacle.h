@@ -131,6 +131,21 @@ private:
     bool _remove;
     /** Whether the object has changed shape and needs a new fixture */
     bool _dirty;
+    /** The index of this object in its ObstacleWorld (-1 if not in a world) */
+    size_t _slot;
+    /** Whether to update this object after every step, even if it has not moved */
+    bool _always;
+    /** Whether the body was awake at the last step (managed by ObstacleWorld) */
+    bool _wasAwake;
+    /** Whether the transform below is valid (managed by ObstacleWorld) */
+    bool _synced;
+    /** The position at the last update (managed by ObstacleWorld) */
+    Vec2 _syncPosition;
+    /** The angle at the last update (managed by ObstacleWorld) */
+    float _syncAngle;
+
+    /** The world manages the slot of this object */
+    friend class ObstacleWorld;
     
 
 #pragma mark -
@@ -819,6 +834,32 @@ public:
      * @param value  whether the shape information must be updated.
      */
     void markDirty(bool value) { _dirty = value; }
+
+    /**
+     * Returns true if this obstacle is updated after every physics step.
+     *
+     * By default, {@link ObstacleWorld} only updates an obstacle when its
+     * body has moved since the last update (or its shape is dirty).  Hence
+     * a sleeping or resting obstacle is not updated at all.  Obstacles whose
+     * {@link #update} method does more than follow the body (such as run
+     * timers) should be updated after every step instead.
+     *
+     * @return true if this obstacle is updated after every physics step.
+     */
+    bool isAlwaysUpdated() const { return _always; }
+
+    /**
+     * Sets whether this obstacle is updated after every physics step.
+     *
+     * By default, {@link ObstacleWorld} only updates an obstacle when its
+     * body has moved since the last update (or its shape is dirty).  Hence
+     * a sleeping or resting obstacle is not updated at all.  Obstacles whose
+     * {@link #update} method does more than follow the body (such as run
+     * timers) should be updated after every step instead.
+     *
+     * @param value  whether this obstacle is updated after every physics step.
+     */
+    void setAlwaysUpdated(bool value) { _always = value; }
     
 #pragma mark -
 #pragma mark Physics Methods
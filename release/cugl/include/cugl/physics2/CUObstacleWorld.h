@@ -48,9 +48,13 @@
 #include <vector>
 #include <box2d/b2_world_callbacks.h>
 #include <cugl/math/cu_math.h>
+#include <cugl/util/CUTaskScheduler.h>
 class b2World;
 
 namespace cugl {
+// Forward declaration for the profile log
+class TextWriter;
+
     /**
      * The classes to represent 2-d physics.
      *
@@ -86,6 +90,41 @@ class Obstacle;
  * functions while the program is running.
  */
 class ObstacleWorld : public b2ContactListener, b2DestructionListener, b2ContactFilter {
+public:
+    /**
+     * The measurements of a single physics step.
+     *
+     * Times are in milliseconds.  The broadphase, narrowphase and solve times
+     * come from Box2d, so the narrowphase time includes the begin and end
+     * contact callbacks, and the solve time includes the solve callbacks.
+     */
+    struct Profile {
+        /** The total time of the call to {@link #update} */
+        float step;
+        /** The time finding new contacts */
+        float broadphase;
+        /** The time updating the existing contacts */
+        float narrowphase;
+        /** The time solving the islands (excluding time of impact) */
+        float solve;
+        /** The time solving time of impact events */
+        float solveTOI;
+        /** The time in {@link #onBeginContact} and {@link #onEndContact} */
+        float callbacks;
+        /** The time updating the obstacles after the step */
+        float sync;
+        /** The number of bodies in the world */
+        Uint32 bodies;
+        /** The number of awake bodies in the world */
+        Uint32 awake;
+        /** The number of contacts (pairs with overlapping bounds) */
+        Uint32 contacts;
+        /** The number of contacts that are touching */
+        Uint32 touching;
+        /** The number of obstacles updated after the step */
+        Uint32 updated;
+    };
+
 protected:
     /** Reference to the Box2D world */
     b2World* _world;
@@ -100,8 +139,10 @@ protected:
     /** The current gravitational value of the world */
     Vec2 _gravity;
     
-    /** The list of objects in this world */
+    /** The list of objects in this world (each object knows its index) */
     std::vector<std::shared_ptr<Obstacle>> _objects;
+    /** The objects to remove at the next update (retained until then) */
+    std::vector<std::shared_ptr<Obstacle>> _removals;
     
     /** The boundary of the world */
     Rect _bounds;
@@ -112,6 +153,54 @@ protected:
     bool _filters;
     /** Whether or not to activate the destruction listener */
     bool _destroy;
+
+    /** The scheduler for the parallel parts of the step (may be nullptr) */
+    std::shared_ptr<TaskScheduler> _scheduler;
+    /** The Box2d adapter for the scheduler */
+    std::unique_ptr<b2TaskExecutor> _executor;
+
+    /** Whether to measure each step */
+    bool _profiling;
+    /** The measurements of the last step */
+    Profile _profile;
+    /** The CSV log of every measured step (may be nullptr) */
+    std::shared_ptr<TextWriter> _profileLog;
+
+    /**
+     * Measures the last step, after the Box2d step and obstacle updates
+     *
+     * @param sync  The microseconds updating the obstacles
+     * @param total The microseconds of the entire update
+     */
+    void recordProfile(Uint64 sync, Uint64 total);
+
+    /**
+     * Removes the obstacle in the given slot
+     *
+     * The last obstacle is moved into the slot, so this takes constant time.
+     *
+     * @param slot  The slot of the obstacle to remove
+     */
+    void removeSlot(size_t slot);
+
+    /**
+     * Removes all obstacles queued by {@link #deferRemoval}
+     */
+    void applyRemovals();
+
+    /**
+     * Returns true if the obstacle must be updated after this step
+     *
+     * An obstacle is updated if it is always updated, if its shape is dirty,
+     * or if its body has moved since its last update.  Static bodies never
+     * move, and sleeping bodies only need one update after they fall asleep.
+     * Hence only the moving obstacles pay for the (virtual) update.
+     *
+     * @param obj   The obstacle to check
+     *
+     * @return true if the obstacle must be updated after this step
+     */
+    bool isMoving(Obstacle* obj);
     
     
 #pragma mark -
@@ -264,6 +353,79 @@ public:
      */
     void setStepsize(float step) { _stepssize = step; }
 
+    /**
+     * Returns the scheduler for the parallel parts of the physics step.
+     *
+     * If this is nullptr, the step runs entirely on the calling thread.
+     *
+     * @return the scheduler for the parallel parts of the physics step.
+     */
+    const std::shared_ptr<TaskScheduler>& getScheduler() const { return _scheduler; }
+
+    /**
+     * Sets the scheduler for the parallel parts of the physics step.
+     *
+     * When there is a scheduler, the narrow-phase of the contacts (computing
+     * the contact manifolds) is split across its workers.  The calling thread
+     * helps, and waits until it is done.  The contact callbacks are still
+     * executed on the calling thread, in the same order as a single threaded
+     * step, and the simulation is identical.  Only the workload changes.
+     *
+     * Set this to nullptr to run the step on the calling thread only.
+     *
+     * @param scheduler The scheduler for the parallel parts of the step
+     */
+    void setScheduler(const std::shared_ptr<TaskScheduler>& scheduler);
+
+#pragma mark -
+#pragma mark Profiling
+    /**
+     * Returns true if each physics step is measured.
+     *
+     * @return true if each physics step is measured.
+     */
+    bool isProfiling() const { return _profiling; }
+
+    /**
+     * Sets whether each physics step is measured.
+     *
+     * Profiling is disabled by default.  When enabled, each step is timed and
+     * the bodies and contacts are counted, which costs a pass over both.
+     * Profiling cannot be disabled while a profile log is open.
+     *
+     * @param value Whether each physics step is measured
+     */
+    void setProfiling(bool value);
+
+    /**
+     * Returns the measurements of the last physics step.
+     *
+     * The measurements are all zero if profiling is disabled.
+     *
+     * @return the measurements of the last physics step.
+     */
+    const Profile& getProfile() const { return _profile; }
+
+    /**
+     * Starts logging the measurements of each step to a CSV file.
+     *
+     * This enables profiling.  The file starts with a header row, and has
+     * one row per step until {@link #closeProfileLog} is called.  Relative
+     * paths are written to the application save directory.
+     *
+     * @param file  The path to the CSV file
+     *
+     * @return true if the file was opened successfully
+     */
+    bool openProfileLog(const std::string& file);
+
+    /**
+     * Stops logging the measurements of each step, closing the CSV file.
+     *
+     * Profiling stays enabled.
+     */
+    void closeProfileLog();
+
     /** 
      * Returns number of velocity iterations for the constrain solvers 
      *
@@ -324,6 +486,10 @@ public:
      * physics.  The primary method is the step() method in world.  This implementation
      * works for all applications and should not need to be overwritten.
      *
+     * Only obstacles that have moved since their last update are updated after
+     * the step (see {@link Obstacle#setAlwaysUpdated}).  Static and sleeping
+     * obstacles are skipped.
+     *
      * @param dt Number of seconds since last animation frame
      */
     void update(float dt);
@@ -375,10 +541,12 @@ public:
      * Immediately removes an obstacle from the physics world
      *
      * The obstacle will be released immediately. The physics will be deactivated
-     * and it will be removed from the Box2D world. This method of removing 
-     * objects is very heavy weight, and should only be used for single object 
-     * removal.  If you want to remove multiple objects, then you should mark 
-     * them for removal and call garbageCollect.
+     * and it will be removed from the Box2D world. This takes constant time, as
+     * the last obstacle is moved into the slot of the removed one.  Hence this
+     * changes the order of {@link #getObstacles}.
+     *
+     * This method should not be called during a step of the physics world
+     * (e.g. in a collision callback).  Use {@link #deferRemoval} instead.
      *
      * Removing an obstacle does not automatically delete the obstacle itself.
      * However, this world releases ownership, which may lead to it being
@@ -387,6 +555,20 @@ public:
      * param obj The obstacle to remove
      */
     void removeObstacle(Obstacle* obj);
+
+    /**
+     * Removes an obstacle from the physics world at the next update
+     *
+     * The queued obstacles are removed in one pass, both before and after the
+     * Box2D step of {@link #update}.  Hence an obstacle queued by game logic
+     * is never simulated again, and an obstacle queued in a collision callback
+     * is removed before the obstacles are updated.  The world retains the
+     * obstacle until then.  Queueing an obstacle more than once, or removing
+     * it immediately afterwards, is safe.
+     *
+     * param obj The obstacle to remove
+     */
+    void deferRemoval(Obstacle* obj);
     
     /**
      * Remove all objects marked for removal.
@@ -503,11 +685,7 @@ public:
      *
      * @param  contact  the contact information
      */
-    void BeginContact(b2Contact* contact) override {
-        if (onBeginContact != nullptr) {
-            onBeginContact(contact);
-        }
-    }
+    void BeginContact(b2Contact* contact) override;
     
     /**
      * Called when two fixtures cease to touch
@@ -517,11 +695,7 @@ public:
      *
      * @param  contact  the contact information
      */
-    void EndContact(b2Contact* contact) override {
-        if (onEndContact != nullptr) {
-            onEndContact(contact);
-        }
-    }
+    void EndContact(b2Contact* contact) override;
     
     /**
      * Called after a contact is updated.
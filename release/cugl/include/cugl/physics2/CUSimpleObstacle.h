@@ -181,6 +181,7 @@ public:
     virtual void setPosition(float x, float y) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(x,y),_body->GetAngle());
+            _body->SetAwake(true);  // So the world syncs the move
         } else {
             _bodyinfo.position.Set(x,y);
         }
@@ -203,6 +204,7 @@ public:
     virtual void setX(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(value,_body->GetPosition().y),_body->GetAngle());
+            _body->SetAwake(true);  // So the world syncs the move
         } else {
             _bodyinfo.position.x = value;
         }
@@ -225,6 +227,7 @@ public:
     virtual void setY(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(b2Vec2(_body->GetPosition().y,value),_body->GetAngle());
+            _body->SetAwake(true);  // So the world syncs the move
         } else {
             _bodyinfo.position.y = value;
         }
@@ -249,6 +252,7 @@ public:
     virtual void setAngle(float value) override {
         if (_body != nullptr) {
             _body->SetTransform(_body->GetPosition(),value);
+            _body->SetAwake(true);  // So the world syncs the move
         } else {
             _bodyinfo.angle = value;
         }
@@ -0,0 +1,174 @@
+//
+//  CUMPSCQueue.h
+//  Cornell University Game Library (CUGL)
+//
+//  This header provides a template for a lock-free multiple-producer,
+//  single-consumer queue.  Any number of threads may push to the queue
+//  concurrently without blocking, while a single thread (typically the main
+//  thread) pops from it.  Neither side ever takes a lock, so a worker thread
+//  can never stall the consumer, and vice versa.
+//
+//  The implementation is the intrusive node-based queue of Dmitry Vyukov.  A
+//  push is a single atomic exchange, so it is wait-free.  A pop is wait-free
+//  as well, but may briefly report the queue as empty while a producer is in
+//  the middle of a push.  Such an element is simply picked up on the next pop.
+//
+//  This is not a class. It is a class template. Templates do not have cpp
+//  files. They only have a header file.  When you include the header, it
+//  compiles the specific template used by your program. Hence all of the code
+//  for this templated class is in this header.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_MPSC_QUEUE_H__
+#define __CU_MPSC_QUEUE_H__
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark MPSCQueue Template
+
+/**
+ * Template for a lock-free multiple-producer, single-consumer queue.
+ *
+ * The methods {@link push} may be called from any thread at any time.  The
+ * methods {@link pop} and {@link empty} may only be called from a single
+ * consumer thread.  The queue is unbounded; each push performs one heap
+ * allocation for the node, which is released by the consumer.
+ *
+ * The type T must be default constructible and movable.
+ */
+template <class T>
+class MPSCQueue {
+private:
+    /** A single link in the queue */
+    struct Node {
+        /** The next link (written by producers, read by the consumer) */
+        std::atomic<Node*> next;
+        /** The value stored in this link */
+        T value;
+
+        /** Creates a node with the default value */
+        Node() : next(nullptr) {}
+        /** Creates a node storing the given value */
+        Node(T&& v) : next(nullptr), value(std::move(v)) {}
+    };
+
+    /** The most recently pushed node (shared by producers) */
+    std::atomic<Node*> _head;
+    /** The most recently popped node, whose value is spent (consumer only) */
+    Node* _tail;
+    /** The approximate number of elements in the queue */
+    std::atomic<size_t> _size;
+
+public:
+    /**
+     * Creates an empty queue.
+     */
+    MPSCQueue() : _size(0) {
+        Node* stub = new Node();
+        _head.store(stub, std::memory_order_relaxed);
+        _tail = stub;
+    }
+
+    /**
+     * Deletes this queue, releasing all elements not yet popped.
+     *
+     * No producer may be pushing when the queue is deleted.
+     */
+    ~MPSCQueue() {
+        T value;
+        while (pop(value)) {}
+        delete _tail;
+    }
+
+    /**
+     * Pushes a value on to the back of this queue.
+     *
+     * This method may be called from any thread.  It never blocks.
+     *
+     * @param value The value to push
+     */
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        _size.fetch_add(1, std::memory_order_relaxed);
+        Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Pops the value at the front of this queue, returning true on success.
+     *
+     * This method may only be called from the consumer thread.  It returns
+     * false if the queue is empty, or if the next element is still in the
+     * middle of being pushed.
+     *
+     * @param value The location to store the popped value
+     *
+     * @return true if a value was popped
+     */
+    bool pop(T& value) {
+        Node* tail = _tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        next->value = T();
+        _tail = next;
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        delete tail;
+        return true;
+    }
+
+    /**
+     * Returns true if this queue has no elements ready to pop.
+     *
+     * This method may only be called from the consumer thread.
+     *
+     * @return true if this queue has no elements ready to pop.
+     */
+    bool empty() const {
+        return _tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * Returns the approximate number of elements in this queue.
+     *
+     * This method may be called from any thread, but the value may be stale
+     * by the time it is read.
+     *
+     * @return the approximate number of elements in this queue.
+     */
+    size_t size() const { return _size.load(std::memory_order_relaxed); }
+
+private:
+    /** This queue may not be copied */
+    MPSCQueue(const MPSCQueue&) = delete;
+    /** This queue may not be copied */
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+};
+
+}
+
+#endif /* __CU_MPSC_QUEUE_H__ */
@@ -0,0 +1,295 @@
+//
+//  CUSnapshotPointer.h
+//  Cornell University Game Library (CUGL)
+//
+//  This header provides a template for publishing state from one thread to a
+//  real-time thread that must never block.  It is designed for the audio
+//  graph, where the main thread changes the inputs and parameters of a node
+//  while the audio thread is reading from it.
+//
+//  The approach is read-copy-update (RCU).  The state is kept in an immutable
+//  snapshot.  A writer never modifies the current snapshot.  Instead, it
+//  creates a new one and publishes it with a single atomic exchange.  A reader
+//  pins the snapshot for the duration of a read, which costs two atomic
+//  increments and no locks.  Old snapshots are reclaimed by the writer once
+//  no reader can see them.  This means that readers never block, and never
+//  free memory (which is just as important in the audio thread).
+//
+//  This is not a class. It is a class template. Templates do not have cpp
+//  files. They only have a header file.  When you include the header, it
+//  compiles the specific template used by your program. Hence all of the code
+//  for this templated class is in this header.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_SNAPSHOT_POINTER_H__
+#define __CU_SNAPSHOT_POINTER_H__
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark SnapshotPointer Template
+
+/**
+ * Template for a pointer to state published with read-copy-update.
+ *
+ * A snapshot pointer owns a heap-allocated value of type T.  Readers access
+ * the value through a {@link Reader}, which pins the current snapshot for as
+ * long as the reader is in scope.  Creating a reader never blocks, never
+ * allocates, and never frees memory, so it is safe in the audio thread.
+ *
+ * Writers replace the value with {@link store} or {@link update}.  They never
+ * modify a snapshot that a reader may see.  Writers are serialized by a
+ * mutex, but this mutex is never touched by a reader.  A replaced snapshot is
+ * retired, and it is deleted (on the writer thread) at a later write once no
+ * reader is active.  Call {@link reclaim} to collect retired snapshots
+ * without a write.
+ *
+ * Readers should not hold on to a snapshot across calls.  A reader that is
+ * never released prevents any retired snapshot from being reclaimed.
+ */
+template <class T>
+class SnapshotPointer {
+public:
+    /**
+     * A scoped guard pinning the current snapshot.
+     *
+     * The snapshot (which may be null) is valid until this reader is
+     * destroyed.  Readers may be moved but not copied.
+     */
+    class Reader {
+    private:
+        /** The pointer this reader has pinned (null if moved) */
+        const SnapshotPointer<T>* _owner;
+        /** The pinned snapshot */
+        T* _value;
+
+    public:
+        /**
+         * Creates a reader pinning the current snapshot of owner.
+         *
+         * @param owner The snapshot pointer to read
+         */
+        explicit Reader(const SnapshotPointer<T>* owner) : _owner(owner) {
+            _owner->_readers.fetch_add(1, std::memory_order_seq_cst);
+            _value = _owner->_current.load(std::memory_order_seq_cst);
+        }
+
+        /**
+         * Creates a reader taking over the pin of another.
+         *
+         * @param other The reader to move
+         */
+        Reader(Reader&& other) : _owner(other._owner), _value(other._value) {
+            other._owner = nullptr;
+            other._value = nullptr;
+        }
+
+        /**
+         * Releases the pinned snapshot.
+         */
+        ~Reader() {
+            if (_owner) {
+                _owner->_readers.fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+
+        /**
+         * Returns the pinned snapshot (which may be null).
+         *
+         * @return the pinned snapshot (which may be null).
+         */
+        T* get() const { return _value; }
+
+        /** Returns a reference to the pinned snapshot */
+        T& operator*() const { return *_value; }
+
+        /** Returns the pinned snapshot */
+        T* operator->() const { return _value; }
+
+        /** Returns true if the pinned snapshot is not null */
+        explicit operator bool() const { return _value != nullptr; }
+
+    private:
+        /** Readers may not be copied */
+        Reader(const Reader&) = delete;
+        /** Readers may not be copied */
+        Reader& operator=(const Reader&) = delete;
+        /** Readers may not be reassigned */
+        Reader& operator=(Reader&&) = delete;
+    };
+
+private:
+    /** The current snapshot */
+    std::atomic<T*> _current;
+    /** The number of active readers */
+    mutable std::atomic<unsigned int> _readers;
+    /** The snapshots replaced but not yet deleted (writer only) */
+    std::vector<T*> _retired;
+    /** A mutex serializing the writers (never touched by readers) */
+    std::mutex _writer;
+
+    /**
+     * Publishes the given snapshot, retiring the previous one.
+     *
+     * The writer lock must be held when this method is called.
+     *
+     * @param value The snapshot to publish
+     */
+    void publish(T* value) {
+        T* prev = _current.exchange(value, std::memory_order_seq_cst);
+        if (prev != nullptr) {
+            _retired.push_back(prev);
+        }
+        collect();
+    }
+
+    /**
+     * Deletes the retired snapshots if no reader is active.
+     *
+     * Any reader that starts after the last exchange sees the new snapshot,
+     * so a reader count of zero means that no one can see a retired one. The
+     * writer lock must be held when this method is called.
+     */
+    void collect() {
+        if (!_retired.empty() && _readers.load(std::memory_order_seq_cst) == 0) {
+            for (auto it = _retired.begin(); it != _retired.end(); ++it) {
+                delete *it;
+            }
+            _retired.clear();
+        }
+    }
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a snapshot pointer with no value.
+     */
+    SnapshotPointer() : _current(nullptr), _readers(0) {}
+
+    /**
+     * Creates a snapshot pointer owning the given value.
+     *
+     * @param value The initial snapshot (may be null)
+     */
+    explicit SnapshotPointer(T* value) : _current(value), _readers(0) {}
+
+    /**
+     * Deletes this snapshot pointer and all of its snapshots.
+     *
+     * No reader may be active when this pointer is deleted.
+     */
+    ~SnapshotPointer() {
+        delete _current.load(std::memory_order_relaxed);
+        for (auto it = _retired.begin(); it != _retired.end(); ++it) {
+            delete *it;
+        }
+    }
+
+#pragma mark Readers
+    /**
+     * Returns a reader pinning the current snapshot.
+     *
+     * This method is safe to call from any thread.  It never blocks.
+     *
+     * @return a reader pinning the current snapshot.
+     */
+    Reader read() const { return Reader(this); }
+
+    /**
+     * Returns true if the current snapshot is not null.
+     *
+     * The value may be stale by the time it is read.
+     *
+     * @return true if the current snapshot is not null.
+     */
+    bool hasValue() const {
+        return _current.load(std::memory_order_acquire) != nullptr;
+    }
+
+#pragma mark Writers
+    /**
+     * Publishes the given snapshot, taking ownership of it.
+     *
+     * The previous snapshot is retired.  This method should not be called
+     * from a thread that must not block.
+     *
+     * @param value The snapshot to publish (may be null)
+     */
+    void store(T* value) {
+        std::lock_guard<std::mutex> lock(_writer);
+        publish(value);
+    }
+
+    /**
+     * Publishes a copy of the given value.
+     *
+     * The previous snapshot is retired.  This method should not be called
+     * from a thread that must not block.
+     *
+     * @param value The value to publish
+     */
+    void store(const T& value) {
+        store(new T(value));
+    }
+
+    /**
+     * Publishes a modified copy of the current snapshot.
+     *
+     * The function is applied to a copy of the current snapshot (or to a
+     * default constructed value if there is none), and the result is then
+     * published.  Writers are serialized, so concurrent updates are never
+     * lost.  Only immutable data may be copied this way.
+     *
+     * @param func  The function to modify the copy
+     */
+    template <typename F>
+    void update(F func) {
+        std::lock_guard<std::mutex> lock(_writer);
+        T* prev = _current.load(std::memory_order_relaxed);
+        T* next = prev == nullptr ? new T() : new T(*prev);
+        func(*next);
+        publish(next);
+    }
+
+    /**
+     * Deletes any retired snapshots that are no longer visible.
+     *
+     * Retired snapshots are collected on every write, so this method is
+     * only necessary to release memory promptly.
+     */
+    void reclaim() {
+        std::lock_guard<std::mutex> lock(_writer);
+        collect();
+    }
+
+private:
+    /** This pointer may not be copied */
+    SnapshotPointer(const SnapshotPointer&) = delete;
+    /** This pointer may not be copied */
+    SnapshotPointer& operator=(const SnapshotPointer&) = delete;
+};
+
+}
+
+#endif /* __CU_SNAPSHOT_POINTER_H__ */
@@ -0,0 +1,452 @@
+//
+//  CUTaskScheduler.h
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a work-stealing scheduler of asynchronous tasks.  This is a
+//  sibling of ThreadPool for workloads that need more than a FIFO queue.
+//  Each worker owns a deque of tasks for every priority level, and idle
+//  workers steal from the others.  Tasks may be collected into groups which
+//  can be waited on or cancelled as a unit, and both tasks and groups may
+//  have completion callbacks that are executed on the main thread via
+//  Application::defer.
+//
+//  As with ThreadPool, there are no guarantees about thread safety of the
+//  tasks themselves; that is responsibility of the author of each task.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef __CU_TASK_SCHEDULER_H__
+#define __CU_TASK_SCHEDULER_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CUThreadPool.h>
+#include <SDL/SDL.h>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <thread>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Task Group
+/**
+ * Class representing a collection of related tasks.
+ *
+ * A task group is attached to tasks when they are added to a
+ * {@link TaskScheduler}.  The group tracks how many of its tasks are still
+ * outstanding, so that a caller can wait on all of them at once.  A group
+ * may also be cancelled, in which case any of its tasks that have not yet
+ * started are skipped.  Tasks that are already running are not interrupted,
+ * but they may poll {@link isCancelled} to exit early.
+ *
+ * A group may have any number of continuations.  These are executed on the
+ * main thread once every task in the group has finished (or been skipped).
+ * The continuation is passed false if the group was cancelled.
+ *
+ * A group may be reused once it is done, but a cancelled group stays
+ * cancelled.  Allocate a new group for each batch of work.
+ */
+class TaskGroup {
+private:
+    /** The number of outstanding tasks in this group */
+    std::atomic<int> _pending;
+    /** Whether this group has been cancelled */
+    std::atomic<bool> _cancelled;
+    /** Mutex guarding the continuations and completion signal */
+    std::mutex _mutex;
+    /** Signalled whenever the group finishes its last task */
+    std::condition_variable _finished;
+    /** The continuations to execute on the main thread when done */
+    std::vector<std::function<void(bool)>> _continuations;
+
+    /** Allow the scheduler to update the pending count */
+    friend class TaskScheduler;
+
+    /**
+     * Records that a new task has been added to this group
+     */
+    void enter() { _pending.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * Records that a task in this group has finished (or was skipped)
+     *
+     * If this was the last task, all waiting threads are woken and the
+     * continuations are passed to the main thread.
+     */
+    void leave();
+
+public:
+    /**
+     * Creates a new, empty task group.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a task group
+     * on the heap, use the static constructor instead.
+     */
+    TaskGroup() : _pending(0), _cancelled(false) {}
+
+    /**
+     * Returns a newly allocated, empty task group.
+     *
+     * @return a newly allocated, empty task group.
+     */
+    static std::shared_ptr<TaskGroup> alloc() {
+        return std::make_shared<TaskGroup>();
+    }
+
+    /**
+     * Cancels all tasks in this group that have not yet started.
+     *
+     * Skipped tasks still count as finished, so waiting threads are woken
+     * once any running tasks complete.
+     */
+    void cancel() { _cancelled.store(true, std::memory_order_release); }
+
+    /**
+     * Returns true if this group has been cancelled.
+     *
+     * Long running tasks may poll this method to exit early.
+     *
+     * @return true if this group has been cancelled.
+     */
+    bool isCancelled() const { return _cancelled.load(std::memory_order_acquire); }
+
+    /**
+     * Returns true if every task in this group has finished.
+     *
+     * @return true if every task in this group has finished.
+     */
+    bool isDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * Returns the number of tasks in this group not yet finished.
+     *
+     * @return the number of tasks in this group not yet finished.
+     */
+    int pending() const { return _pending.load(std::memory_order_acquire); }
+
+    /**
+     * Blocks the current thread until every task in this group has finished.
+     *
+     * This method does not help execute tasks.  If called from a worker of
+     * the scheduler running these tasks, use {@link TaskScheduler#wait}
+     * instead to avoid deadlock.
+     */
+    void wait();
+
+    /**
+     * Adds a continuation to execute on the main thread when this group is done.
+     *
+     * The continuation is passed true if the group completed normally, and
+     * false if it was cancelled.  If the group is already done, the
+     * continuation is scheduled immediately.
+     *
+     * @param callback  The continuation to execute
+     */
+    void then(const std::function<void(bool)>& callback);
+
+private:
+    /** This macro disables the copy constructor (not allowed on task groups) */
+    CU_DISALLOW_COPY_AND_ASSIGN(TaskGroup);
+};
+
+#pragma mark -
+#pragma mark Task Scheduler
+/**
+ * Class providing a work-stealing collection of worker threads.
+ *
+ * Unlike {@link ThreadPool}, this scheduler supports priorities, task groups
+ * and main-thread continuations.  Each worker has its own deque for each
+ * priority.  Tasks added from a worker (e.g. a task spawning subtasks) go to
+ * that worker's deque, where they are run most-recent first for locality.
+ * Tasks added from any other thread go to a shared injection queue, where
+ * they are run in FIFO order.  An idle worker always prefers higher priority
+ * work, stealing it from the other workers if necessary, before it considers
+ * lower priority work.
+ *
+ * Priorities are not preemptive.  A long running background task will not be
+ * interrupted by critical work; it simply means that critical work will be
+ * started first by the next free worker.
+ *
+ * As with {@link ThreadPool}, stopping a scheduler does not shut it down
+ * immediately.  Any tasks that have not started when the scheduler stops are
+ * skipped, but their groups are still notified so that no waiter hangs.
+ */
+class TaskScheduler {
+public:
+    /**
+     * The priority of a task.
+     *
+     * Lower values are scheduled first.
+     */
+    enum class Priority : int {
+        /** Work required to make progress right now (e.g. level-critical assets) */
+        CRITICAL = 0,
+        /** The default priority */
+        NORMAL = 1,
+        /** Work that may be deferred indefinitely (e.g. prefetching) */
+        BACKGROUND = 2
+    };
+
+    /** The number of priority levels */
+    static const int PRIORITIES = 3;
+
+private:
+    /** A single unit of work */
+    struct Task {
+        /** The function to execute on the worker */
+        std::function<void()> work;
+        /** The optional continuation to execute on the main thread */
+        std::function<void()> callback;
+        /** The optional group this task belongs to */
+        std::shared_ptr<TaskGroup> group;
+        /** The priority of this task (and its continuation) */
+        Priority priority;
+    };
+
+    /** The state owned by a single worker thread */
+    struct Worker {
+        /** The scheduler owning this worker */
+        TaskScheduler* owner;
+        /** The index of this worker in the scheduler */
+        int index;
+        /** A mutex lock for the task deques */
+        std::mutex mutex;
+        /** The tasks for this worker, one deque per priority */
+        std::deque<Task> queues[PRIORITIES];
+#ifdef CU_SDL_THREADS
+        /** The thread executing this worker */
+        SDL_Thread* thread;
+#else
+        /** The thread executing this worker */
+        std::thread thread;
+#endif
+    };
+
+    /** The individual workers for this scheduler */
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    /** Tasks added from outside the scheduler, one queue per priority */
+    std::deque<Task> _inject[PRIORITIES];
+    /** A mutex lock for the injection queues */
+    std::mutex _injectMutex;
+
+    /** The number of tasks waiting to be started */
+    std::atomic<int> _queued;
+    /** A mutex lock for idle workers */
+    std::mutex _sleepMutex;
+    /** A condition variable to manage workers waiting for a task */
+    std::condition_variable _wakeup;
+
+    /** Whether or not the scheduler has been marked for shutdown */
+    std::atomic<bool> _stop;
+    /** The number of child threads that are completed */
+    std::atomic<int> _complete;
+
+    /**
+     * The body function of a single worker.
+     *
+     * @param index The worker index
+     */
+    void run(int index);
+
+    /**
+     * The body function of a single worker using the SDL thread API.
+     *
+     * This should be used on Android and Windows, which have special thread
+     * requirements.
+     */
+    static int sdlThreadFunc(void* ptr);
+
+    /**
+     * Removes the next task to execute, returning true if one was found.
+     *
+     * Higher priorities are searched first.  Within a priority, the worker's
+     * own deque is checked first, then the injection queue, and finally the
+     * other workers are robbed.
+     *
+     * @param index The worker index (or -1 if not a worker)
+     * @param task  The task to store the result
+     *
+     * @return true if a task was found
+     */
+    bool acquire(int index, Task& task);
+
+    /**
+     * Executes the given task, notifying its group when done.
+     *
+     * @param task  The task to execute
+     */
+    void execute(Task& task);
+
+    /**
+     * Returns the worker index of the current thread, or -1 if not a worker.
+     *
+     * @return the worker index of the current thread, or -1 if not a worker.
+     */
+    int currentIndex() const;
+
+#pragma mark Constructors
+public:
+    /**
+     * Creates a task scheduler with no active threads.
+     *
+     * You must initialize this scheduler before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a scheduler
+     * on the heap, use one of the static constructors instead.
+     */
+    TaskScheduler() : _queued(0), _stop(false), _complete(0) {}
+
+    /**
+     * Deletes this scheduler, destroying all resources.
+     *
+     * This destructor will block until all running tasks complete.
+     */
+    ~TaskScheduler() { dispose(); }
+
+    /**
+     * Disposes this scheduler, releasing all memory.
+     *
+     * Any tasks that have not yet started are skipped. This method will block
+     * until all running tasks complete.
+     */
+    void dispose();
+
+    /**
+     * Initializes a scheduler with the given number of threads.
+     *
+     * If threads is 0, the scheduler uses one less than the number of cores
+     * on this device (leaving a core for the main thread), but at least one.
+     *
+     * @param threads   the number of threads in this scheduler
+     *
+     * @return true if the scheduler is initialized properly, false otherwise.
+     */
+    bool init(int threads = 0);
+
+    /**
+     * Returns a newly allocated scheduler with the given number of threads.
+     *
+     * If threads is 0, the scheduler uses one less than the number of cores
+     * on this device (leaving a core for the main thread), but at least one.
+     *
+     * @param threads   the number of threads in this scheduler
+     *
+     * @return a newly allocated scheduler with the given number of threads.
+     */
+    static std::shared_ptr<TaskScheduler> alloc(int threads = 0) {
+        std::shared_ptr<TaskScheduler> result = std::make_shared<TaskScheduler>();
+        return (result->init(threads) ? result : nullptr);
+    }
+
+#pragma mark Task Management
+    /**
+     * Adds a task to this scheduler.
+     *
+     * If group is not nullptr, the task is counted as part of that group. If
+     * the group is cancelled before the task starts, the task is skipped.
+     *
+     * If callback is not nullptr, it is executed on the main thread (via
+     * {@link Application#defer} at the same priority) after the task
+     * completes.  The callback is not executed if the task was skipped.
+     *
+     * @param task      The task function to execute on a worker
+     * @param priority  The task priority
+     * @param group     The group for this task (may be nullptr)
+     * @param callback  The main-thread continuation (may be nullptr)
+     */
+    void addTask(const std::function<void()>& task,
+                 Priority priority = Priority::NORMAL,
+                 const std::shared_ptr<TaskGroup>& group = nullptr,
+                 const std::function<void()>& callback = nullptr);
+
+    /**
+     * Blocks until every task in the group has finished.
+     *
+     * Unlike {@link TaskGroup#wait}, the calling thread helps execute queued
+     * tasks while it waits.  This makes it safe to call from within a task
+     * on this scheduler, as well as from the main thread.  Note that the
+     * calling thread may run tasks from other groups as well.
+     *
+     * @param group The group to wait on
+     */
+    void wait(const std::shared_ptr<TaskGroup>& group);
+
+    /**
+     * Returns the number of tasks waiting to be started.
+     *
+     * @return the number of tasks waiting to be started.
+     */
+    int pending() const { return _queued.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the number of worker threads in this scheduler.
+     *
+     * @return the number of worker threads in this scheduler.
+     */
+    size_t size() const { return _workers.size(); }
+
+    /**
+     * Stop the scheduler, marking it for shut down.
+     *
+     * This method waits for the running tasks to finish.  Any tasks that
+     * have not yet started are skipped, but their groups are still notified.
+     */
+    void stop();
+
+    /**
+     * Returns whether the scheduler has been stopped.
+     *
+     * @return whether the scheduler has been stopped.
+     */
+    bool isStopped() const { return _stop.load(); }
+
+    /**
+     * Returns whether the scheduler has been shut down.
+     *
+     * A shut down scheduler has no active threads and is safe for deletion.
+     *
+     * @return whether the scheduler has been shut down.
+     */
+    bool isShutdown() const { return _workers.size() == (size_t)_complete.load(); }
+
+private:
+    /** Copying is only allowed via shared pointer. */
+    CU_DISALLOW_COPY_AND_ASSIGN(TaskScheduler);
+};
+
+}
+
+#endif /* __CU_TASK_SCHEDULER_H__ */
@@ -34,7 +34,10 @@
 #include "CUTimestamp.h"
 #include "CUFiletools.h"
 #include "CUFreeList.h"
+#include "CUMPSCQueue.h"
+#include "CUSnapshotPointer.h"
 #include "CUGreedyFreeList.h"
 #include "CUThreadPool.h"
+#include "CUTaskScheduler.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
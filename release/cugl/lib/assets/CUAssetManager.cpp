@@ -78,6 +78,7 @@ bool AssetManager::init() {
 void AssetManager::dispose() {
     detachAll();
     _workers = nullptr;
+    _profiler = nullptr;
 }
 
 #pragma mark -
@@ -232,7 +232,13 @@ bool FontLoader::read(const std::string key, const std::string source, int size,
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Font",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Font> font = preload(source,_charset,size);
         if (font != nullptr) {
             success = true;
@@ -240,12 +246,20 @@ bool FontLoader::read(const std::string key, const std::string source, int size,
         } else {
             _queue.erase(key);
         }
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<Font> font = this->preload(source,_charset,size);
-            Application::get()->schedule([=](void){
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void){
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,font,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -291,7 +305,13 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Font",key,json->getString("file",""));
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Font> font = preload(json);
         if (font != nullptr) {
             success = true;
@@ -299,12 +319,20 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
         } else {
             _queue.erase(key);
         }
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<Font> font = this->preload(json);
-            Application::get()->schedule([=](void){
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void){
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,font,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
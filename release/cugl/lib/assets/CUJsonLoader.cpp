@@ -103,18 +103,32 @@ bool JsonLoader::read(const std::string key, const std::string source, LoaderCal
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Json",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         success = (json != nullptr);
         materialize(key,json,callback);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,json,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -154,18 +168,32 @@ bool JsonLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     std::string source = json->asString(UNKNOWN_SOURCE);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Json",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         success = (json != nullptr);
         materialize(key,json,callback);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,json,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
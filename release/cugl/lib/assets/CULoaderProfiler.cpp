@@ -0,0 +1,406 @@
+//
+//  CULoaderProfiler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a profiler for asset loading.  When attached to an
+//  AssetManager, every loader records the lifetime of each asset it loads.
+//  The results can be exported as a Chrome trace or summarized as a text
+//  table ranked by cost.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/assets/CULoaderProfiler.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/io/CUTextWriter.h>
+#include <cugl/util/CUFiletools.h>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+using namespace cugl;
+
+#pragma mark Support Functions
+/**
+ * Returns the string with JSON special characters escaped
+ *
+ * @param s The string to escape
+ *
+ * @return the string with JSON special characters escaped
+ */
+static std::string escape(const std::string& s) {
+    std::string result;
+    result.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result.push_back('\\');
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+/**
+ * Returns the size in bytes of the given asset source file
+ *
+ * Relative paths are resolved against the asset directory. This uses the
+ * SDL file API so that it also works for assets packaged in an Android APK.
+ *
+ * @param source    The asset source file
+ *
+ * @return the size in bytes of the given asset source file
+ */
+static size_t sourceSize(const std::string& source) {
+    if (source.empty()) {
+        return 0;
+    }
+    std::string path = source;
+    if (!filetool::is_absolute(source)) {
+        path = Application::get()->getAssetDirectory()+source;
+    }
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "rb");
+    if (stream == nullptr) {
+        return 0;
+    }
+    Sint64 size = SDL_RWsize(stream);
+    SDL_RWclose(stream);
+    return size < 0 ? 0 : (size_t)size;
+}
+
+/**
+ * Appends a complete ("X") trace event to the output stream
+ *
+ * @param out   The output stream
+ * @param name  The event name
+ * @param cat   The event category
+ * @param tid   The thread index
+ * @param start The event start in microseconds
+ * @param end   The event end in microseconds
+ */
+static void traceComplete(std::ostringstream& out, const std::string& name, const std::string& cat,
+                          int tid, Sint64 start, Sint64 end) {
+    out << ",\n{\"name\":\"" << escape(name) << "\",\"cat\":\"" << escape(cat);
+    out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid;
+    out << ",\"ts\":" << start << ",\"dur\":" << (end-start) << "}";
+}
+
+/**
+ * Appends an async ("b"/"e") trace event pair to the output stream
+ *
+ * @param out   The output stream
+ * @param name  The event name
+ * @param cat   The event category
+ * @param id    The async event id
+ * @param start The event start in microseconds
+ * @param end   The event end in microseconds
+ */
+static void traceAsync(std::ostringstream& out, const std::string& name, const std::string& cat,
+                       size_t id, Sint64 start, Sint64 end) {
+    out << ",\n{\"name\":\"" << escape(name) << "\",\"cat\":\"" << cat;
+    out << "\",\"ph\":\"b\",\"pid\":1,\"id\":" << id << ",\"ts\":" << start << "}";
+    out << ",\n{\"name\":\"" << escape(name) << "\",\"cat\":\"" << cat;
+    out << "\",\"ph\":\"e\",\"pid\":1,\"id\":" << id << ",\"ts\":" << end << "}";
+}
+
+/**
+ * Returns the given microseconds formatted as milliseconds
+ *
+ * @param micros    The time in microseconds
+ *
+ * @return the given microseconds formatted as milliseconds
+ */
+static std::string millis(Sint64 micros) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << (micros/1000.0);
+    return out.str();
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this profiler.
+ */
+void LoaderProfiler::dispose() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _records.clear();
+    _threads.clear();
+}
+
+/**
+ * Initializes a profiler, marking the current thread as the main thread.
+ *
+ * @return true if the profiler was initialized successfully
+ */
+bool LoaderProfiler::init() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _origin.mark();
+    _threads.clear();
+    _threads[std::this_thread::get_id()] = 0;
+    return true;
+}
+
+/**
+ * Returns the current time in microseconds relative to the origin
+ */
+Sint64 LoaderProfiler::now() const {
+    Timestamp stamp;
+    return (Sint64)Timestamp::ellapsedMicros(_origin,stamp);
+}
+
+/**
+ * Returns the profiler index for the current thread
+ *
+ * This method assumes the mutex is held.
+ */
+int LoaderProfiler::threadIndex() {
+    std::thread::id id = std::this_thread::get_id();
+    auto it = _threads.find(id);
+    if (it != _threads.end()) {
+        return it->second;
+    }
+    int index = (int)_threads.size();
+    _threads[id] = index;
+    return index;
+}
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Records a request to load an asset, returning a ticket for it.
+ *
+ * @param category  The asset category (e.g. "Texture")
+ * @param key       The asset key
+ * @param source    The source file for the asset (may be empty)
+ *
+ * @return the ticket for the subsequent phases of this load
+ */
+size_t LoaderProfiler::enqueue(const std::string& category, const std::string& key, const std::string& source) {
+    Record record;
+    record.category = category;
+    record.key = key;
+    record.source = source;
+    record.bytes = 0;
+    record.enqueued = now();
+    record.decodeStart = -1;
+    record.decodeEnd = -1;
+    record.materializeStart = -1;
+    record.materializeEnd = -1;
+    record.decodeThread = -1;
+    record.success = false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _records.push_back(std::move(record));
+    return _records.size()-1;
+}
+
+/**
+ * Marks the start of decoding for the given ticket.
+ *
+ * @param ticket    The ticket returned by {@link enqueue}
+ */
+void LoaderProfiler::beginDecode(size_t ticket) {
+    Sint64 time = now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (ticket < _records.size()) {
+        _records[ticket].decodeStart = time;
+        _records[ticket].decodeThread = threadIndex();
+    }
+}
+
+/**
+ * Marks the end of decoding for the given ticket.
+ *
+ * @param ticket    The ticket returned by {@link enqueue}
+ */
+void LoaderProfiler::endDecode(size_t ticket) {
+    Sint64 time = now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (ticket < _records.size()) {
+        _records[ticket].decodeEnd = time;
+    }
+}
+
+/**
+ * Marks the start of materialization for the given ticket.
+ *
+ * @param ticket    The ticket returned by {@link enqueue}
+ */
+void LoaderProfiler::beginMaterialize(size_t ticket) {
+    Sint64 time = now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (ticket < _records.size()) {
+        _records[ticket].materializeStart = time;
+    }
+}
+
+/**
+ * Marks the end of materialization for the given ticket.
+ *
+ * @param ticket    The ticket returned by {@link enqueue}
+ * @param success   Whether the asset loaded successfully
+ */
+void LoaderProfiler::endMaterialize(size_t ticket, bool success) {
+    Sint64 time = now();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (ticket < _records.size()) {
+        _records[ticket].materializeEnd = time;
+        _records[ticket].success = success;
+    }
+}
+
+/**
+ * Clears all recorded loads, resetting the origin to now.
+ */
+void LoaderProfiler::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _records.clear();
+    _origin.mark();
+}
+
+#pragma mark -
+#pragma mark Reporting
+/**
+ * Returns a copy of all recorded loads.
+ *
+ * @return a copy of all recorded loads.
+ */
+std::vector<LoaderProfiler::Record> LoaderProfiler::getRecords() const {
+    std::vector<Record> result;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        result = _records;
+    }
+    for (auto it = result.begin(); it != result.end(); ++it) {
+        it->bytes = sourceSize(it->source);
+    }
+    return result;
+}
+
+/**
+ * Returns the recorded loads as a Chrome trace JSON string.
+ *
+ * @return the recorded loads as a Chrome trace JSON string.
+ */
+std::string LoaderProfiler::toTrace() const {
+    std::vector<Record> records = getRecords();
+    int threads = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        threads = (int)_threads.size();
+    }
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main\"}}";
+    for (int ii = 1; ii < threads; ii++) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ii;
+        out << ",\"args\":{\"name\":\"Loader " << ii << "\"}}";
+    }
+
+    for (size_t ii = 0; ii < records.size(); ii++) {
+        const Record& record = records[ii];
+        if (record.decodeStart >= 0) {
+            if (record.decodeStart > record.enqueued) {
+                traceAsync(out, record.key, "queue", ii, record.enqueued, record.decodeStart);
+            }
+            if (record.decodeEnd >= 0) {
+                traceComplete(out, record.key, record.category+".decode", record.decodeThread,
+                              record.decodeStart, record.decodeEnd);
+            }
+        }
+        if (record.materializeStart >= 0) {
+            if (record.decodeEnd >= 0 && record.materializeStart > record.decodeEnd) {
+                traceAsync(out, record.key, "wait", ii, record.decodeEnd, record.materializeStart);
+            }
+            if (record.materializeEnd >= 0) {
+                traceComplete(out, record.key, record.category+".materialize", 0,
+                              record.materializeStart, record.materializeEnd);
+            }
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+/**
+ * Writes the recorded loads as a Chrome trace to the given file.
+ *
+ * Relative paths are written to the application save directory.
+ *
+ * @param file  The path to write the trace to
+ *
+ * @return true if the file was written successfully
+ */
+bool LoaderProfiler::exportTrace(const std::string& file) const {
+    std::string path = file;
+    if (!filetool::is_absolute(file)) {
+        path = Application::get()->getSaveDirectory()+file;
+    }
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(path);
+    if (writer == nullptr) {
+        return false;
+    }
+    writer->write(toTrace());
+    writer->close();
+    return true;
+}
+
+/**
+ * Returns a text table of the recorded loads ranked by cost.
+ *
+ * @param limit The maximum number of rows (0 for all)
+ *
+ * @return a text table of the recorded loads ranked by cost.
+ */
+std::string LoaderProfiler::toSummary(size_t limit) const {
+    std::vector<Record> records = getRecords();
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.cost() > b.cost();
+    });
+
+    Sint64 total = 0;
+    Sint64 last  = 0;
+    for (auto it = records.begin(); it != records.end(); ++it) {
+        total += it->cost();
+        last = std::max(last, std::max(it->materializeEnd, it->decodeEnd));
+    }
+
+    std::ostringstream out;
+    out << "Loaded " << records.size() << " assets in " << millis(last) << " ms (";
+    out << millis(total) << " ms of decode + materialize)\n";
+    out << std::left << std::setw(32) << "key" << std::setw(12) << "category";
+    out << std::right << std::setw(10) << "queue" << std::setw(10) << "decode";
+    out << std::setw(10) << "wait" << std::setw(10) << "upload";
+    out << std::setw(10) << "cost" << std::setw(12) << "bytes" << "\n";
+
+    size_t rows = (limit == 0 || limit > records.size()) ? records.size() : limit;
+    for (size_t ii = 0; ii < rows; ii++) {
+        const Record& record = records[ii];
+        out << std::left << std::setw(32) << record.key.substr(0,31);
+        out << std::setw(12) << record.category.substr(0,11);
+        out << std::right << std::setw(10) << millis(record.queueTime());
+        out << std::setw(10) << millis(record.decodeTime());
+        out << std::setw(10) << millis(record.waitTime());
+        out << std::setw(10) << millis(record.materializeTime());
+        out << std::setw(10) << millis(record.cost());
+        out << std::setw(12) << record.bytes;
+        out << (record.success ? "" : "  FAILED") << "\n";
+    }
+    return out.str();
+}
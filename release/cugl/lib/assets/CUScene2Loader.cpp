@@ -405,7 +405,13 @@ bool Scene2Loader::read(const std::string key, const std::string source,
     _queue.emplace(key);
 
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Scene2",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
@@ -416,15 +422,23 @@ bool Scene2Loader::read(const std::string key, const std::string source,
         } else {
             _queue.erase(key);
         }
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(node,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -473,7 +487,13 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Scene2",key,"");
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
         node->doLayout();
         if (node != nullptr) {
@@ -482,13 +502,21 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
         } else {
             _queue.erase(key);
         }
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(node,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -142,29 +142,40 @@ bool SoundLoader::read(const std::string key, const std::string source, LoaderCa
     path.append(source);
     
     
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = profiler ? profiler->enqueue("Sound",key,source) : LoaderProfiler::INVALID_TICKET;
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Sound> sound = nullptr;
         if (AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
             sound = AudioSample::alloc(path);
         }
         success = (sound != nullptr);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+        }
         if (success) {
             sound->setVolume(_volume);
             materialize(key,sound,callback);
         }
+        if (profiler) { profiler->endMaterialize(ticket,success); }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<Sound> sound = nullptr;
             if (AudioSample::guessType(path) != AudioSample::Type::UNKNOWN) {
                 sound = AudioSample::alloc(path);
             }
+            if (profiler) { profiler->endDecode(ticket); }
             if (sound != nullptr) {
                 sound->setVolume(_volume);
-                Application::get()->schedule([=](void){
-                    this->materialize(key,sound,callback);
-                    return false;
-                });
             }
+            Application::get()->defer([=](void){
+                if (profiler) { profiler->beginMaterialize(ticket); }
+                this->materialize(key,sound,callback);
+                if (profiler) { profiler->endMaterialize(ticket,sound != nullptr); }
+            });
         });
     }
     
@@ -205,7 +216,13 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     }
     _queue.emplace(key);
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Sound",key,json->getString("file",""));
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Sound> sound = nullptr;
         if (type == "sample") {
             sound = AudioSample::allocWithData(json);
@@ -213,25 +230,33 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
             sound = AudioWaveform::allocWithData(json);
         }
         success = (sound != nullptr);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+        }
         if (success) {
             sound->setVolume(volume);
             materialize(key,sound,callback);
         }
+        if (profiler) { profiler->endMaterialize(ticket,success); }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<Sound> sound = nullptr;
             if (type == "sample") {
                 sound = AudioSample::allocWithData(json);
             } else if (type == "waveform") {
                 sound = AudioWaveform::allocWithData(json);
             }
+            if (profiler) { profiler->endDecode(ticket); }
             if (sound != nullptr) {
                 sound->setVolume(volume);
-                Application::get()->schedule([=](void) {
-                    this->materialize(key,sound,callback);
-                    return false;
-                });
             }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
+                this->materialize(key,sound,callback);
+                if (profiler) { profiler->endMaterialize(ticket,sound != nullptr); }
+            });
         });
     }
     
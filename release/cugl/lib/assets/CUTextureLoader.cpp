@@ -307,19 +307,30 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = profiler ? profiler->enqueue("Texture",key,source) : LoaderProfiler::INVALID_TICKET;
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
         success = (texture != nullptr);
         if (success) { 
 			_assets[key] = texture;
 		}
         _queue.erase(key);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,success);
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             SDL_Surface* surface = this->preload(source);
-            Application::get()->schedule([=](void){
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void){
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,surface,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -376,19 +387,30 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
     
     std::string source = json->getString("file",UNKNOWN_SOURCE);
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = profiler ? profiler->enqueue("Texture",key,source) : LoaderProfiler::INVALID_TICKET;
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
         success = (texture != nullptr);
         if (success) { 
 			_assets[key] = texture;
 		}
         _queue.erase(key);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,success);
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             SDL_Surface* surface = this->preload(source);
-            Application::get()->schedule([=](void){
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void){
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(json,surface,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
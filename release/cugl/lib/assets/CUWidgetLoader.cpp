@@ -110,20 +110,34 @@ bool WidgetLoader::read(const std::string key, const std::string source, LoaderC
     _queue.emplace(key);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Widget",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,widget,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -160,20 +174,34 @@ bool WidgetLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     std::string source = json->asString(UNKNOWN_SOURCE);
     
     bool success = false;
+    std::shared_ptr<LoaderProfiler> profiler = _profiler;
+    size_t ticket = LoaderProfiler::INVALID_TICKET;
+    if (profiler) {
+        ticket = profiler->enqueue("Widget",key,source);
+    }
     if (_loader == nullptr || !async) {
+        if (profiler) { profiler->beginDecode(ticket); }
         std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
+        if (profiler) {
+            profiler->endDecode(ticket);
+            profiler->beginMaterialize(ticket);
+            profiler->endMaterialize(ticket,this->verify(key));
+        }
     } else {
         _loader->addTask([=](void) {
+            if (profiler) { profiler->beginDecode(ticket); }
             std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
-            Application::get()->schedule([=](void) {
+            if (profiler) { profiler->endDecode(ticket); }
+            Application::get()->defer([=](void) {
+                if (profiler) { profiler->beginMaterialize(ticket); }
                 this->materialize(key,widget,callback);
-                return false;
+                if (profiler) { profiler->endMaterialize(ticket,this->verify(key)); }
             });
         });
     }
@@ -36,6 +36,7 @@
 #include <cugl/audio/CUAudioDevices.h>
 #include <cugl/audio/graph/CUAudioOutput.h>
 #include <cugl/audio/graph/CUAudioInput.h>
+#include <cugl/audio/CUAudioStreamer.h>
 #include <cugl/util/CUDebug.h>
 
 using namespace cugl;
@@ -117,6 +118,7 @@ bool AudioDevices::init(Uint32 output, Uint32 input) {
 #endif
         _output = output;
         _input  = input;
+        _streamer = audio::AudioStreamer::alloc();
         return true;
     }
     return false;
@@ -134,6 +136,7 @@ void AudioDevices::dispose() {
         deactivate();
         _outputs.clear();
         _inputs.clear();
+        _streamer = nullptr;
 
 #if CU_PLATFORM == CU_PLATFORM_MACOS
         AudioObjectRemovePropertyListener(kAudioObjectSystemObject, &test_address, device_unplugged, this);
@@ -598,6 +601,30 @@ bool AudioDevices::closeOutput(const std::shared_ptr<audio::AudioOutput>& output
     return success;
 }
 
+/**
+ * Returns an offline output with the given channels and sample rate.
+ *
+ * An offline output is not attached to any device, so it may be used on
+ * machines without sound hardware.  The audio graph is only read when
+ * the programmer calls {@link audio::AudioOutput#render}.  Offline outputs
+ * are not affected by {@link activate} or {@link deactivate}, and do not
+ * need to be closed.
+ *
+ * The output reads {@link getReadSize()} frames at each simulated poll.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in Hz
+ *
+ * @return an offline output with the given channels and sample rate.
+ */
+std::shared_ptr<audio::AudioOutput> AudioDevices::openOfflineOutput(Uint8 channels, Uint32 rate) {
+    std::shared_ptr<audio::AudioOutput> result = std::make_shared<audio::AudioOutput>();
+    if (result && result->initOffline(channels,rate,_output)) {
+        return result;
+    }
+    return nullptr;
+}
+
 #pragma mark -
 #pragma mark Input Devices
 /**
@@ -39,6 +39,9 @@
 //
 #include <cugl/cugl.h>
 #include <algorithm>
+#include <limits>
+#include <cstdio>
+#include <thread>
 
 using namespace cugl;
 using namespace cugl::audio;
@@ -46,6 +49,21 @@ using namespace cugl::audio;
 /** Reference to the sound engine singleton */
 AudioEngine* AudioEngine::_gEngine = nullptr;
 
+/**
+ * Returns the generation following the given one for a voice handle.
+ *
+ * Generations wrap around in the bits not used by the slot, skipping 0 so
+ * that no handle is ever equal to {@link AudioEngine#NO_VOICE}.
+ *
+ * @param generation    The current generation
+ *
+ * @return the generation following the given one for a voice handle.
+ */
+static Uint32 next_generation(Uint32 generation) {
+    generation = (generation+1) & ((1 << (32-VOICE_SLOT_BITS))-1);
+    return generation == 0 ? 1 : generation;
+}
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -55,7 +73,9 @@ AudioEngine* AudioEngine::_gEngine = nullptr;
  */
 AudioEngine::AudioEngine() :
 _capacity(0),
-_primary(false) {
+_primary(false),
+_voiceCount(0),
+_voiceClock(0) {
     _output = nullptr;
     _mixer  = nullptr;
 }
@@ -115,6 +135,25 @@ bool AudioEngine::init(const std::shared_ptr<AudioOutput>& device, Uint32 slots)
         _panPool.push_back(AudioPanner::alloc(_mixer->getChannels(),2,_mixer->getRate()));
     }
     
+    // Prebuild the voice chains, two per slot
+    _voices.resize(_capacity);
+    for(int ii = 0; ii < _capacity; ii++) {
+        VoiceState* state = &(_voices[ii]);
+        for(int jj = 0; jj < 2; jj++) {
+            VoiceChain* chain = &(state->chains[jj]);
+            chain->fader  = AudioFader::alloc(_mixer->getChannels(),_mixer->getRate());
+            chain->panner = AudioPanner::alloc(_mixer->getChannels(),2,_mixer->getRate());
+            chain->fader->attach(chain->panner);
+            chain->fader->setTag(ii);
+            chain->busy = false;
+        }
+        state->current = 0;
+        state->generation = 1;
+        state->priority = 0;
+        state->stamp  = 0;
+        state->active = false;
+    }
+    
     _output->attach(_mixer);
     return true;
 }
@@ -139,6 +178,10 @@ void AudioEngine::dispose() {
         
         _fadePool.clear();
         _panPool.clear();
+        _voices.clear();
+        _scratch.clear();
+        _voiceCount = 0;
+        _voiceClock = 0;
         _capacity = 0;
         
 		_output = nullptr;
@@ -304,6 +347,9 @@ std::shared_ptr<audio::AudioNode> AudioEngine::disposeWrapper(const std::shared_
  * @param status    True if the music terminated normally, false otherwise.
  */
 void AudioEngine::gcollect(const std::shared_ptr<audio::AudioNode>& sound, bool status) {
+    if (recycleVoice(sound)) {
+        return;
+    }
     std::string key = sound->getName();
     disposeWrapper(sound);
     removeKey(key);
@@ -312,6 +358,159 @@ void AudioEngine::gcollect(const std::shared_ptr<audio::AudioNode>& sound, bool
     }
 }
 
+/**
+ * Returns the voice state for the given handle, or nullptr if it is stale.
+ *
+ * @param voice The voice handle
+ *
+ * @return the voice state for the given handle, or nullptr if it is stale.
+ */
+AudioEngine::VoiceState* AudioEngine::accessVoice(Voice voice) {
+    Uint32 slot = voice & ((1 << VOICE_SLOT_BITS)-1);
+    if (voice == NO_VOICE || slot >= _voices.size()) {
+        return nullptr;
+    }
+    VoiceState* state = &(_voices[slot]);
+    if (state->active && state->generation == (voice >> VOICE_SLOT_BITS)) {
+        return state;
+    }
+    return nullptr;
+}
+
+/**
+ * Returns the voice state for the given handle, or nullptr if it is stale.
+ *
+ * @param voice The voice handle
+ *
+ * @return the voice state for the given handle, or nullptr if it is stale.
+ */
+const AudioEngine::VoiceState* AudioEngine::accessVoice(Voice voice) const {
+    Uint32 slot = voice & ((1 << VOICE_SLOT_BITS)-1);
+    if (voice == NO_VOICE || slot >= _voices.size()) {
+        return nullptr;
+    }
+    const VoiceState* state = &(_voices[slot]);
+    if (state->active && state->generation == (voice >> VOICE_SLOT_BITS)) {
+        return state;
+    }
+    return nullptr;
+}
+
+/**
+ * Returns true if the node is a voice chain, marking it as idle.
+ *
+ * This method is the voice equivalent of {@link gcollect}.  It is called
+ * when a chain leaves its slot, either because it completed or because
+ * it was interrupted by a steal.
+ *
+ * @param node  The node removed from a slot
+ *
+ * @return true if the node is a voice chain
+ */
+bool AudioEngine::recycleVoice(const std::shared_ptr<audio::AudioNode>& node) {
+    Uint32 slot = node->getTag();
+    if (slot >= _voices.size()) {
+        return false;
+    }
+    
+    VoiceState* state = &(_voices[slot]);
+    for(Uint32 ii = 0; ii < 2; ii++) {
+        if (state->chains[ii].fader.get() == node.get()) {
+            state->chains[ii].busy = false;
+            if (state->active && state->current == ii) {
+                state->active = false;
+                state->generation = next_generation(state->generation);
+                _voiceCount--;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Rebinds the given voice chain to a new sound.
+ *
+ * In-memory samples reuse the player of the chain, so this allocates
+ * nothing in the common case.  Any other sound creates a new node.
+ *
+ * @param chain     The (idle) voice chain
+ * @param sound     The sound to play
+ *
+ * @return true if the chain was successfully rebound
+ */
+bool AudioEngine::bindVoice(VoiceChain& chain, const std::shared_ptr<Sound>& sound) {
+    std::shared_ptr<AudioNode> source = nullptr;
+    std::shared_ptr<AudioSample> sample = std::dynamic_pointer_cast<AudioSample>(sound);
+    if (sample && !sample->isStreamed()) {
+        if (chain.player == nullptr) {
+            chain.player = AudioPlayer::alloc(sample);
+        } else if (chain.player->getSource() != sample) {
+            chain.player->dispose();
+            chain.player->init(sample);
+        } else {
+            chain.player->setPosition(0);
+        }
+        // Match AudioSample#createNode (init and dispose reset the gain)
+        chain.player->setGain(sample->getVolume());
+        source = chain.player;
+    } else {
+        source = sound->createNode();
+    }
+    if (source == nullptr) {
+        return false;
+    }
+    
+    // The panner field may only change when detached
+    chain.panner->detach();
+    if (chain.panner->getField() != source->getChannels()) {
+        chain.panner->setField(source->getChannels());
+    }
+    
+    if (source->getRate() == chain.panner->getRate()) {
+        chain.panner->attach(source);
+    } else {
+        if (chain.sampler == nullptr || chain.sampler->getChannels() != source->getChannels()) {
+            chain.sampler = AudioResampler::alloc(source->getChannels(),chain.panner->getRate());
+            chain.sampler->setName("__engine_resampler__");
+        } else {
+            // Do not let the tail of the previous sound bleed into this one
+            chain.sampler->flush();
+        }
+        chain.sampler->attach(source);
+        chain.panner->attach(chain.sampler);
+    }
+    
+    chain.fader->fadeOut(-1);
+    chain.fader->reset();
+    return true;
+}
+
+/**
+ * Sets the pan of the given panner as a factor in [-1,1].
+ *
+ * @param panner    The panner to adjust
+ * @param pan       The pan factor
+ */
+void AudioEngine::applyPan(audio::AudioPanner* panner, float pan) {
+    if (panner->getField() == 1) {
+        panner->setPan(0,0,0.5-pan/2.0);
+        panner->setPan(0,1,0.5+pan/2.0);
+    } else {
+        if (pan <= 0) {
+            panner->setPan(0,0,1);
+            panner->setPan(0,1,0);
+            panner->setPan(1,0,-pan);
+            panner->setPan(1,1,1+pan);
+        } else {
+            panner->setPan(1,1,1);
+            panner->setPan(1,0,0);
+            panner->setPan(0,0,1-pan);
+            panner->setPan(0,1,pan);
+        }
+    }
+}
+
 #pragma mark -
 #pragma mark Static Accessors
 /**
@@ -401,6 +600,46 @@ bool AudioEngine::start(const std::shared_ptr<audio::AudioOutput>& device, Uint3
     return true;
 }
 
+/**
+ * Starts the singleton audio engine on an offline output.
+ *
+ * This is the same as {@link #start(Uint32)}, except that the engine is
+ * not attached to any sound hardware.  Instead, the audio is produced
+ * on demand with {@link #render}. This is useful for benchmarking and
+ * for testing on machines without audio devices.
+ *
+ * Like {@link #start(Uint32)}, this method will start up the
+ * {@link AudioDevices} manager and shut it down when done. Hence it will
+ * fail if the audio device manager is already active.
+ *
+ * @param slots  The maximum number of sound slots to support
+ *
+ * @return true if the engine was successfully initialized
+ */
+bool AudioEngine::startOffline(Uint32 slots) {
+    if (_gEngine != nullptr) {
+        return false;
+    } else if (AudioDevices::get()) {
+        CUAssertLog(false,"Audio devices are currently in use");
+        return false;
+    }
+    
+    AudioDevices::start();
+    std::shared_ptr<AudioOutput> device;
+    device = AudioDevices::get()->openOfflineOutput(AudioNode::DEFAULT_CHANNELS,
+                                                    AudioNode::DEFAULT_SAMPLING);
+    _gEngine = new AudioEngine();
+    if (!_gEngine->init(device,slots)) {
+        delete _gEngine;
+        _gEngine = nullptr;
+        AudioDevices::stop();
+        CUAssertLog(false,"Audio engine failed to initialize");
+        return false;
+    }
+    _gEngine->_primary = true;
+    return true;
+}
+
 /**
  * Shutsdown the singleton audio engine, releasing all resources.
  *
@@ -581,11 +820,11 @@ bool AudioEngine::play(const std::string key, const std::shared_ptr<Sound>& soun
         }
     }
     
-    // Find an empty scheduler
+    // Find an empty scheduler (the music slots follow the effect slots)
     int audioID = -1;
-    for(auto it = _slots.begin()+1; audioID == -1 && it != _slots.end(); ++it) {
-        if (!(*it)->isPlaying()) {
-            audioID = (*it)->getTag();
+    for(Uint32 ii = 0; audioID == -1 && ii < _capacity; ii++) {
+        if (!_voices[ii].active && !_slots[ii]->isPlaying()) {
+            audioID = ii;
         }
     }
     
@@ -671,11 +910,11 @@ bool AudioEngine::play(const std::string key, const std::shared_ptr<audio::Audio
         }
     }
     
-    // Find an empty scheduler
+    // Find an empty scheduler (the music slots follow the effect slots)
     int audioID = -1;
-    for(auto it = _slots.begin()+1; audioID == -1 && it != _slots.end(); ++it) {
-        if (!(*it)->isPlaying()) {
-            audioID = (*it)->getTag();
+    for(Uint32 ii = 0; audioID == -1 && ii < _capacity; ii++) {
+        if (!_voices[ii].active && !_slots[ii]->isPlaying()) {
+            audioID = ii;
         }
     }
     
@@ -913,22 +1152,7 @@ void AudioEngine::setPanFactor(const std::string key, float pan) {
     if (_actives.find(key) != _actives.end()) {
         std::shared_ptr<AudioFader> fader = _actives.at(key);
         std::shared_ptr<AudioPanner> panner = std::dynamic_pointer_cast<AudioPanner>(fader->getInput());
-        if (panner->getField() == 1) {
-            panner->setPan(0,0,0.5-pan/2.0);
-            panner->setPan(0,1,0.5+pan/2.0);
-        } else {
-            if (pan <= 0) {
-                panner->setPan(0,0,1);
-                panner->setPan(0,1,0);
-                panner->setPan(1,0,-pan);
-                panner->setPan(1,1,1+pan);
-            } else {
-                panner->setPan(1,1,1);
-                panner->setPan(1,0,0);
-                panner->setPan(0,0,1-pan);
-                panner->setPan(0,1,pan);
-            }
-        }
+        applyPan(panner.get(),pan);
     }
 }
 
@@ -1129,6 +1353,171 @@ void AudioEngine::resume(std::string key) {
 }
 
 
+#pragma mark -
+#pragma mark Voice Management
+/**
+ * Plays the given sound as a voice, returning its handle.
+ *
+ * Voices are the allocation-free alternative to keyed sound effects.
+ * Each sound effect slot has prebuilt playback nodes that are reused by
+ * every voice in that slot, so there are no keys to hash and (for
+ * in-memory samples) no audio nodes to allocate.  Use the returned
+ * handle to adjust or stop the voice later.
+ *
+ * If there is no free slot, this method steals the slot of an active
+ * voice whose priority does not exceed the given one.  Of these, it
+ * chooses the lowest priority, and then the oldest voice.  Keyed effects
+ * are never stolen. If no slot can be found, this method returns
+ * {@link NO_VOICE}.
+ *
+ * @param sound     The sound effect to play
+ * @param priority  The voice priority (higher voices are kept longer)
+ * @param volume    The voice volume (relative to the default asset volume)
+ * @param pan       The pan factor in [-1,1]
+ * @param loop      Whether to loop the sound effect continuously
+ *
+ * @return the handle for the new voice, or NO_VOICE on failure
+ */
+AudioEngine::Voice AudioEngine::playVoice(const std::shared_ptr<Sound>& sound, Sint32 priority,
+                                          float volume, float pan, bool loop) {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    CUAssertLog(pan >= -1 && pan <= 1, "Pan value %f is out of range",pan);
+    
+    // Prefer an empty slot, then the weakest voice we can steal
+    int slot  = -1;
+    int chain = -1;
+    int steal = -1;
+    int spare = -1;
+    for(Uint32 ii = 0; slot == -1 && ii < _capacity; ii++) {
+        VoiceState* state = &(_voices[ii]);
+        int current = (int)state->current;
+        int idle = !state->chains[current].busy ? current :
+                   (!state->chains[1-current].busy ? 1-current : -1);
+        if (idle == -1) {
+            continue;
+        } else if (!state->active) {
+            if (!_slots[ii]->isPlaying()) {
+                slot  = ii;
+                chain = idle;
+            }
+        } else if (idle != current && state->priority <= priority) {
+            if (steal == -1 || state->priority < _voices[steal].priority ||
+                (state->priority == _voices[steal].priority && state->stamp < _voices[steal].stamp)) {
+                steal = ii;
+                spare = idle;
+            }
+        }
+    }
+    
+    if (slot == -1) {
+        if (steal == -1) {
+            return NO_VOICE;
+        }
+        slot  = steal;
+        chain = spare;
+        _voices[slot].active = false;
+        _voiceCount--;
+    }
+    
+    VoiceState* state = &(_voices[slot]);
+    VoiceChain* entry = &(state->chains[chain]);
+    if (!bindVoice(*entry,sound)) {
+        return NO_VOICE;
+    }
+    applyPan(entry->panner.get(),pan);
+    entry->fader->setGain(volume);
+    entry->busy = true;
+    
+    state->generation = next_generation(state->generation);
+    state->current  = chain;
+    state->priority = priority;
+    state->stamp  = _voiceClock++;
+    state->active = true;
+    _voiceCount++;
+    
+    // Playing interrupts any stolen voice at the next render frame
+    _slots[slot]->play(entry->fader, loop ? -1 : 0);
+    return (state->generation << VOICE_SLOT_BITS) | slot;
+}
+
+/**
+ * Returns the current volume of the given voice.
+ *
+ * If the voice is not active, this method returns 0.
+ *
+ * @param voice The voice handle
+ *
+ * @return the current volume of the given voice.
+ */
+float AudioEngine::getVoiceVolume(Voice voice) const {
+    const VoiceState* state = accessVoice(voice);
+    if (state) {
+        return state->chains[state->current].fader->getGain();
+    }
+    return 0;
+}
+
+/**
+ * Sets the current volume of the given voice.
+ *
+ * This method has no effect if the voice is not active.
+ *
+ * @param voice     The voice handle
+ * @param volume    The voice volume
+ */
+void AudioEngine::setVoiceVolume(Voice voice, float volume) {
+    VoiceState* state = accessVoice(voice);
+    if (state) {
+        state->chains[state->current].fader->setGain(volume);
+    }
+}
+
+/**
+ * Sets the pan factor of the given voice.
+ *
+ * The pan factor is in the range [-1,1], as in {@link #setPanFactor}.
+ * This method has no effect if the voice is not active.
+ *
+ * @param voice The voice handle
+ * @param pan   The pan factor
+ */
+void AudioEngine::setVoicePan(Voice voice, float pan) {
+    CUAssertLog(pan >= -1 && pan <= 1, "Pan value %f is out of range",pan);
+    VoiceState* state = accessVoice(voice);
+    if (state) {
+        applyPan(state->chains[state->current].panner.get(),pan);
+    }
+}
+
+/**
+ * Stops the given voice, fading it out over the given number of seconds.
+ *
+ * If fade is 0, the voice is stopped immediately. The handle is invalid
+ * once this method is called, and the slot may be stolen by any voice
+ * while it fades.
+ *
+ * @param voice The voice handle
+ * @param fade  The number of seconds to fade out
+ */
+void AudioEngine::stopVoice(Voice voice, float fade) {
+    VoiceState* state = accessVoice(voice);
+    if (state == nullptr) {
+        return;
+    }
+    
+    Uint32 slot = voice & ((1 << VOICE_SLOT_BITS)-1);
+    _slots[slot]->setLoops(0);
+    if (fade > 0) {
+        state->chains[state->current].fader->fadeOut(fade);
+    } else {
+        _slots[slot]->clear();
+    }
+    
+    // Invalidate the handle, but keep the slot until the chain is recycled
+    state->generation = next_generation(state->generation);
+    state->priority = std::numeric_limits<Sint32>::min();
+}
+
 #pragma mark -
 #pragma mark Global Management
 /**
@@ -1150,6 +1539,11 @@ void AudioEngine::clearEffects(float fade) {
     for(auto it = _actives.begin(); it != _actives.end(); ++it) {
         it->second->fadeOut(fade);
     }
+    for(Uint32 ii = 0; ii < _voices.size(); ii++) {
+        if (_voices[ii].active) {
+            stopVoice((_voices[ii].generation << VOICE_SLOT_BITS) | ii, fade);
+        }
+    }
     _actives.clear();
     _evicts.clear();
 }
@@ -1248,3 +1642,159 @@ void AudioEngine::resume()  {
     }
 }
 
+#pragma mark -
+#pragma mark Output Device
+/**
+ * Renders the given number of seconds from an offline engine.
+ *
+ * This method reads the audio graph on the calling thread, which should
+ * be the main thread. The audio is discarded. Sounds and music played
+ * before this call are processed as if they were playing on a device.
+ * To simulate a game, alternate calls to this method with calls to
+ * play sounds.
+ *
+ * If speed is 0, the graph is pulled as fast as possible.  Otherwise,
+ * the render is paced to the given multiple of real time (so 1 is real
+ * time).  This method fails if the engine was not started offline.
+ *
+ * @param seconds   The number of seconds of audio to render
+ * @param speed     The multiple of real time (0 for unpaced)
+ *
+ * @return the number of frames rendered
+ */
+Uint64 AudioEngine::render(double seconds, double speed) {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    if (!_output->isOffline()) {
+        CUAssertLog(false, "Attempt to render from a device output");
+        return 0;
+    }
+    
+    Uint64 frames = (Uint64)(seconds*_output->getRate());
+    Uint32 pagesize = AudioDevices::get()->getReadSize();
+    if (_scratch.size() < pagesize*_output->getChannels()) {
+        _scratch.resize(pagesize*_output->getChannels());
+    }
+    
+    timestamp_t start = cuclock_t::now();
+    Uint64 take = 0;
+    while (take < frames) {
+        Uint32 amount = frames-take < pagesize ? (Uint32)(frames-take) : pagesize;
+        take += _output->render(_scratch.data(), amount);
+        if (speed > 0) {
+            std::chrono::duration<double> ahead(take/(speed*_output->getRate()));
+            std::this_thread::sleep_until(start+std::chrono::duration_cast<cuclock_t::duration>(ahead));
+        }
+    }
+    return take;
+}
+
+#pragma mark -
+#pragma mark Profiling
+/**
+ * Returns true if the audio graph is recording timing statistics.
+ *
+ * Profiling is disabled by default. It applies to every audio node, and
+ * not just those managed by this engine.
+ *
+ * @return true if the audio graph is recording timing statistics.
+ */
+bool AudioEngine::isProfiling() const {
+    return AudioNode::isProfiling();
+}
+
+/**
+ * Sets whether the audio graph is recording timing statistics.
+ *
+ * Profiling is disabled by default. It applies to every audio node, and
+ * not just those managed by this engine.
+ *
+ * @param value Whether the audio graph is recording timing statistics
+ */
+void AudioEngine::setProfiling(bool value) {
+    AudioNode::setProfiling(value);
+}
+
+/**
+ * Returns the timing statistics of each audio node class.
+ *
+ * The statistics are accumulated over every node of each class since
+ * the last call to {@link #resetProfile}.  Only classes that have been
+ * read while profiling are included.  The self time of a class is the
+ * most useful measure, as it excludes the time spent in input nodes.
+ *
+ * @return the timing statistics of each audio node class.
+ */
+std::vector<AudioNode::Profile> AudioEngine::getProfile() const {
+    return AudioNode::getClassProfiles();
+}
+
+/**
+ * Returns the health statistics of the output device callback.
+ *
+ * These statistics include the number of underruns and late callbacks,
+ * and the headroom of the audio graph.  They are recorded even when
+ * profiling is disabled.
+ *
+ * @return the health statistics of the output device callback.
+ */
+AudioOutput::Telemetry AudioEngine::getTelemetry() const {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    return _output->getTelemetry();
+}
+
+/**
+ * Resets the timing and health statistics of the audio graph.
+ */
+void AudioEngine::resetProfile() {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    AudioNode::resetClassProfiles();
+    _output->resetTelemetry();
+}
+
+/**
+ * Returns a text report of the timing and health statistics.
+ *
+ * The report has a summary line for the output device, followed by one
+ * line per node class, sorted by self time.  It is intended for logs
+ * and for offline comparison before and after an optimization.
+ *
+ * @return a text report of the timing and health statistics.
+ */
+std::string AudioEngine::dumpProfile() const {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    AudioOutput::Telemetry telemetry = _output->getTelemetry();
+    std::vector<AudioNode::Profile> profile = AudioNode::getClassProfiles();
+    std::sort(profile.begin(), profile.end(),
+              [](const AudioNode::Profile& a, const AudioNode::Profile& b) {
+                  return a.self > b.self;
+              });
+
+    Uint64 total = 0;
+    for(auto it = profile.begin(); it != profile.end(); ++it) {
+        total += it->self;
+    }
+
+    std::string result;
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "callbacks=%llu underruns=%llu late=%llu headroom=%.3f min=%.3f\n",
+                  (unsigned long long)telemetry.callbacks,
+                  (unsigned long long)telemetry.underruns,
+                  (unsigned long long)telemetry.late,
+                  telemetry.headroom, telemetry.minimum);
+    result += line;
+    std::snprintf(line, sizeof(line), "%-20s %10s %12s %10s %10s %10s %6s\n",
+                  "class", "calls", "frames", "self(ms)", "avg(us)", "peak(us)", "self%");
+    result += line;
+    for(auto it = profile.begin(); it != profile.end(); ++it) {
+        double average = it->calls ? it->total/(1000.0*it->calls) : 0.0;
+        double percent = total ? (100.0*it->self)/total : 0.0;
+        std::snprintf(line, sizeof(line), "%-20s %10llu %12llu %10.3f %10.2f %10.2f %6.1f\n",
+                      it->name.c_str(),
+                      (unsigned long long)it->calls,
+                      (unsigned long long)it->frames,
+                      it->self/1.0e6, average, it->peak/1000.0, percent);
+        result += line;
+    }
+    return result;
+}
@@ -39,7 +39,9 @@
 #include <cugl/audio/graph/CUAudioPlayer.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUStrings.h>
 #include <cugl/audio/codecs/cu_codecs.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 
 using namespace cugl;
 
@@ -54,7 +56,9 @@ using namespace cugl;
 AudioSample::AudioSample() : Sound(),
 _frames(0),
 _stream(false),
-_buffer(nullptr) {
+_encoding(Encoding::FLOAT),
+_buffer(nullptr),
+_pcm16(nullptr) {
     _type = Type::UNKNOWN;
 }
 
@@ -63,14 +67,16 @@ _buffer(nullptr) {
  *
  * The choice of buffered or streaming is independent of the file type.
  * If the file is streamed, it will not be loaded into memory.  Otherwise,
- * this initializer will allocate memory to read the asset into memory.
+ * this initializer will allocate memory to read the asset into memory,
+ * using the given encoding.
  *
  * @param file      The source file for the audio sample
  * @param stream    Wether to stream the audio from the file.
+ * @param encoding  The in-memory storage format (if not streamed)
  *
  * @return true if the sound source was initialized successfully
  */
-bool AudioSample::init(const std::string file, bool stream) {
+bool AudioSample::init(const std::string file, bool stream, Encoding encoding) {
     std::string path = filetool::normalize_path(file);
     if (!filetool::file_exists(path)) {
         CULogError("Cannot find file %s",path.c_str());
@@ -80,6 +86,7 @@ bool AudioSample::init(const std::string file, bool stream) {
     _file = file;
     _type = guessType(file);
     _stream = stream;
+    _encoding = encoding;
     std::shared_ptr<audio::AudioDecoder> decoder = getDecoder();
     if (decoder == nullptr) {
         CULogError("Could not open '%s': %s\n", path.c_str(), SDL_GetError());
@@ -90,12 +97,33 @@ bool AudioSample::init(const std::string file, bool stream) {
     _frames = decoder->getLength();
     _rate   = decoder->getSampleRate();
     
-    if (!_stream) {
-        _buffer = (float*)SDL_malloc((size_t)(_frames*_channels*sizeof(float)));
-        Sint64 size = decoder->decode(_buffer);
-        return size >= 0;
+    if (_stream) {
+        return true;
+    } else if (_encoding == Encoding::PCM16) {
+        // Convert a page at a time so we never hold the float version
+        _pcm16 = (Sint16*)SDL_malloc((size_t)(_frames*_channels*sizeof(Sint16)));
+        Uint32 pagesize = decoder->getPageSize();
+        float* page = (float*)SDL_malloc((size_t)(pagesize*_channels*sizeof(float)));
+        Uint64 total = 0;
+        Sint32 amt = 0;
+        do {
+            amt = decoder->pagein(page);
+            if (amt > 0) {
+                Uint64 take = std::min((Uint64)amt,_frames-total);
+                dsp::DSPMath::encode_pcm16(page,_pcm16+total*_channels,(size_t)(take*_channels));
+                total += take;
+            }
+        } while (amt > 0 && total < _frames);
+        SDL_free(page);
+        if (total < _frames) {
+            std::memset(_pcm16+total*_channels,0,(size_t)((_frames-total)*_channels*sizeof(Sint16)));
+        }
+        return amt >= 0;
     }
-    return true;
+
+    _buffer = (float*)SDL_malloc((size_t)(_frames*_channels*sizeof(float)));
+    Sint64 size = decoder->decode(_buffer);
+    return size >= 0;
 }
 
 /**
@@ -117,6 +145,7 @@ bool AudioSample::init(Uint8 channels, Uint32 rate, Uint32 frames) {
     _rate = rate;
     _buffer = (float*)SDL_malloc((size_t)(_channels*_frames*sizeof(float)));
     _stream = false;
+    _encoding = Encoding::FLOAT;
     _type  = Type::IN_MEMORY;
     return true;
 }
@@ -130,6 +159,7 @@ bool AudioSample::init(Uint8 channels, Uint32 rate, Uint32 frames) {
  *
  *      "file":     The path to the source, relative to the asset directory
  *      "stream":   A boolean, indicating whether to stream the sample
+ *      "encoding": One of "float" or "pcm16" (for samples that are not streamed)
  *      "volume":   A float, representing the volume
  *
  * All attributes are optional.  There are no required attributes. By default,
@@ -143,7 +173,14 @@ bool AudioSample::init(Uint8 channels, Uint32 rate, Uint32 frames) {
 bool AudioSample::initWithData(const std::shared_ptr<JsonValue>& data) {
     std::string source = data->has("file") ? filetool::normalize_path(data->getString("file","")) : "";
     bool stream = data->getBool("stream",false);
-    if (init(source,stream)) {
+    std::string format = strtool::tolower(data->getString("encoding","float"));
+    Encoding encoding = Encoding::FLOAT;
+    if (format == "pcm16") {
+        encoding = Encoding::PCM16;
+    } else if (format != "float") {
+        CULogError("Unknown sample encoding '%s'; using float",format.c_str());
+    }
+    if (init(source,stream,encoding)) {
         _volume = data->getFloat("volume",1.0f);
         return true;
     }
@@ -161,10 +198,15 @@ void AudioSample::dispose() {
     _frames = 0;
     _channels = 0;
     _stream = false;
+    _encoding = Encoding::FLOAT;
     if (_buffer != nullptr) {
         SDL_free(_buffer);
         _buffer = nullptr;
     }
+    if (_pcm16 != nullptr) {
+        SDL_free(_pcm16);
+        _pcm16 = nullptr;
+    }
     _type = Type::UNKNOWN;
 }
 
@@ -220,6 +262,22 @@ AudioSample::Type AudioSample::guessType(const char* file) {
     return type;
 }
 
+/**
+ * Returns the number of bytes of decoded audio held in memory.
+ *
+ * This value is 0 for a streamed sample.
+ *
+ * @return the number of bytes of decoded audio held in memory.
+ */
+size_t AudioSample::getMemoryUsage() const {
+    if (_buffer != nullptr) {
+        return (size_t)(_frames*_channels*sizeof(float));
+    } else if (_pcm16 != nullptr) {
+        return (size_t)(_frames*_channels*sizeof(Sint16));
+    }
+    return 0;
+}
+
 /**
  * Returns a new decoder for this audio sample
  *
@@ -0,0 +1,452 @@
+//
+//  CUAudioStreamer.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a background decoding service for streamed audio
+//  samples.  Each streaming player owns an AudioStream, which is a lock-free
+//  single-producer/single-consumer ring of decoded frames.  The AudioStreamer
+//  thread is the only producer, and the audio thread is the only consumer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/audio/CUAudioStreamer.h>
+#include <cugl/audio/codecs/CUAudioDecoder.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace cugl::audio;
+
+#pragma mark -
+#pragma mark Audio Stream
+/**
+ * Creates an uninitialized stream.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a stream on
+ * the heap, use one of the static constructors instead.
+ */
+AudioStream::AudioStream() :
+_decoder(nullptr),
+_channels(0),
+_length(0),
+_pagesize(0),
+_ring(nullptr),
+_capacity(0),
+_head(0),
+_tail(0),
+_mhead(0),
+_mtail(0),
+_cursor(0),
+_requested(NO_POSITION),
+_request(NO_POSITION),
+_loopStart(0),
+_closed(false),
+_chunk(nullptr),
+_chunkLimit(0),
+_chunkLast(0),
+_decodePos(0) {
+}
+
+/**
+ * Disposes this stream, releasing all resources.
+ */
+void AudioStream::dispose() {
+    if (_ring != nullptr) {
+        free(_ring);
+        _ring = nullptr;
+    }
+    if (_chunk != nullptr) {
+        free(_chunk);
+        _chunk = nullptr;
+    }
+    _decoder = nullptr;
+    _capacity = 0;
+    _head.store(0);
+    _tail.store(0);
+    _mhead.store(0);
+    _mtail.store(0);
+}
+
+/**
+ * Initializes a stream for the given decoder.
+ *
+ * The decoder becomes owned by the producer.  No other thread should
+ * access it once the stream has been attached to an {@link AudioStreamer}.
+ *
+ * @param decoder   The decoder for the streamed asset
+ *
+ * @return true if initialization was successful
+ */
+bool AudioStream::init(const std::shared_ptr<AudioDecoder>& decoder) {
+    if (decoder == nullptr || _ring != nullptr) {
+        return false;
+    }
+    _decoder  = decoder;
+    _channels = decoder->getChannels();
+    _length   = decoder->getLength();
+    _pagesize = decoder->getPageSize();
+    _capacity = std::max((Uint64)STREAM_MIN_CAPACITY,(Uint64)_pagesize*STREAM_MIN_PAGES);
+
+    _ring  = (float*)malloc((size_t)(_capacity*_channels*sizeof(float)));
+    _chunk = (float*)malloc(_pagesize*_channels*sizeof(float));
+    if (_ring == nullptr || _chunk == nullptr) {
+        dispose();
+        return false;
+    }
+    _decoder->rewind();
+    return true;
+}
+
+/**
+ * Moves the decoder to the given position, recording a marker.
+ *
+ * PRODUCER ONLY.
+ *
+ * @param frame The stream position to decode from
+ *
+ * @return false if there is no room for another marker
+ */
+bool AudioStream::seek(Uint64 frame) {
+    Uint32 mhead = _mhead.load(std::memory_order_relaxed);
+    if (mhead-_mtail.load(std::memory_order_acquire) >= STREAM_MARKERS) {
+        return false;
+    }
+    frame = std::min(frame,_length);
+    Marker& marker = _markers[mhead % STREAM_MARKERS];
+    marker.index = _head.load(std::memory_order_relaxed);
+    marker.frame = frame;
+    _mhead.store(mhead+1,std::memory_order_release);
+
+    _decoder->setPage(frame/_pagesize);
+    Sint32 amt = frame < _length ? _decoder->pagein(_chunk) : 0;
+    _chunkLimit = amt > 0 ? (Uint32)amt : 0;
+    _chunkLast  = std::min((Uint32)(frame % _pagesize),_chunkLimit);
+    _decodePos  = frame;
+    return true;
+}
+
+/**
+ * Reads up to the given number of frames starting at position.
+ *
+ * AUDIO THREAD ONLY: This method is for the owning player.
+ *
+ * If the ring is not aligned with the given position, this method will
+ * discard frames up to the next marker.  If that does not help, it asks
+ * the producer to seek.  The method never blocks, so it may return fewer
+ * frames than requested (including 0).
+ *
+ * @param buffer    The buffer to store the frames
+ * @param position  The stream position of the first frame to read
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the number of frames read
+ */
+Uint32 AudioStream::read(float* buffer, Uint64 position, Uint32 frames) {
+    Uint64 tail = _tail.load(std::memory_order_relaxed);
+    Uint64 head = _head.load(std::memory_order_acquire);
+
+    Uint32 total = 0;
+    while (total < frames) {
+        Uint64 want  = position+total;
+        Uint64 limit = head;
+        bool aligned = false;
+        while (!aligned) {
+            Uint32 mtail = _mtail.load(std::memory_order_relaxed);
+            bool marked  = mtail != _mhead.load(std::memory_order_acquire);
+            const Marker* marker = marked ? &_markers[mtail % STREAM_MARKERS] : nullptr;
+            if (marker && marker->index <= tail) {
+                _cursor = marker->frame;
+                _mtail.store(mtail+1,std::memory_order_release);
+                continue;
+            }
+
+            limit = marker ? std::min(marker->index,head) : head;
+            if (_cursor == want) {
+                aligned = true;
+            } else if (_cursor != NO_POSITION && want > _cursor && want-_cursor < limit-tail) {
+                // A short skip forward within the segment
+                tail += want-_cursor;
+                _cursor = want;
+                aligned = true;
+            } else if (limit == tail) {
+                break;
+            } else {
+                // Discard the rest of the segment
+                tail = limit;
+                _cursor = NO_POSITION;
+            }
+        }
+
+        if (!aligned) {
+            if (_requested != want) {
+                _requested = want;
+                _request.store(want,std::memory_order_release);
+            }
+            break;
+        }
+        _requested = NO_POSITION;
+
+        Uint32 avail = (Uint32)std::min((Uint64)(frames-total),limit-tail);
+        if (avail == 0) {
+            break;
+        }
+
+        // Copy out, wrapping around the ring if necessary
+        Uint64 start = tail % _capacity;
+        Uint32 first = (Uint32)std::min((Uint64)avail,_capacity-start);
+        std::memcpy(buffer+total*_channels,_ring+start*_channels,first*_channels*sizeof(float));
+        if (first < avail) {
+            std::memcpy(buffer+(total+first)*_channels,_ring,(avail-first)*_channels*sizeof(float));
+        }
+        tail    += avail;
+        _cursor += avail;
+        total   += avail;
+    }
+
+    _tail.store(tail,std::memory_order_release);
+    return total;
+}
+
+/**
+ * Decodes frames into the ring until it is full or the limit is reached.
+ *
+ * PRODUCER ONLY: This method is for the {@link AudioStreamer} (or for
+ * priming a stream before it is attached).
+ *
+ * @param limit The maximum number of frames to decode
+ *
+ * @return true if any work was performed
+ */
+bool AudioStream::fill(Uint64 limit) {
+    bool worked = false;
+    Uint64 request = _request.exchange(NO_POSITION,std::memory_order_acq_rel);
+    if (request != NO_POSITION) {
+        if (!seek(request)) {
+            // Try again once the consumer catches up on markers
+            _request.store(request,std::memory_order_release);
+            return false;
+        }
+        worked = true;
+    }
+
+    Uint64 head = _head.load(std::memory_order_relaxed);
+    Uint64 written = 0;
+    bool wrapped = false;
+    while (written < limit && _request.load(std::memory_order_relaxed) == NO_POSITION) {
+        Uint64 space = _capacity-(head-_tail.load(std::memory_order_acquire));
+        if (space == 0) {
+            break;
+        } else if (_chunkLast < _chunkLimit) {
+            Uint32 amt = (Uint32)std::min(std::min(space,limit-written),(Uint64)(_chunkLimit-_chunkLast));
+            Uint64 start = head % _capacity;
+            Uint32 first = (Uint32)std::min((Uint64)amt,_capacity-start);
+            std::memcpy(_ring+start*_channels,_chunk+_chunkLast*_channels,first*_channels*sizeof(float));
+            if (first < amt) {
+                std::memcpy(_ring,_chunk+(_chunkLast+first)*_channels,(amt-first)*_channels*sizeof(float));
+            }
+            head += amt;
+            written += amt;
+            _chunkLast += amt;
+            _decodePos += amt;
+            _head.store(head,std::memory_order_release);
+            wrapped = false;
+            worked  = true;
+        } else if (_decodePos >= _length) {
+            // Decode the start of the next loop ahead of time
+            Uint64 loop = _loopStart.load(std::memory_order_relaxed);
+            if (wrapped || loop >= _length || !seek(loop)) {
+                break;
+            }
+            wrapped = true;
+        } else {
+            Sint32 amt = _decoder->pagein(_chunk);
+            _chunkLast  = 0;
+            _chunkLimit = amt > 0 ? (Uint32)amt : 0;
+            if (amt <= 0) {
+                _decodePos = _length;
+            }
+        }
+    }
+    return worked;
+}
+
+
+#pragma mark -
+#pragma mark Audio Streamer
+/**
+ * Creates an inactive streamer.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a streamer on
+ * the heap, use one of the static constructors instead.
+ */
+AudioStreamer::AudioStreamer() :
+_stop(false),
+#ifdef CU_SDL_THREADS
+_thread(nullptr),
+#endif
+_running(false) {
+}
+
+/**
+ * Disposes this streamer, stopping the decoding thread.
+ *
+ * Any attached streams stop receiving data.
+ */
+void AudioStreamer::dispose() {
+    if (!_running) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        _stop.store(true);
+        _wakeup.notify_all();
+    }
+#ifdef CU_SDL_THREADS
+    int status;
+    SDL_WaitThread(_thread,&status);
+    _thread = nullptr;
+#else
+    _thread.join();
+#endif
+    _running = false;
+    _streams.clear();
+}
+
+/**
+ * Initializes this streamer, starting the decoding thread.
+ *
+ * @return true if initialization was successful
+ */
+bool AudioStreamer::init() {
+    if (_running) {
+        return false;
+    }
+    _stop.store(false);
+#ifdef CU_SDL_THREADS
+    _thread = SDL_CreateThread(AudioStreamer::sdlThreadFunc,"Audio Streamer",(void*)this);
+    _running = _thread != nullptr;
+#else
+    _thread = std::thread(std::bind(&AudioStreamer::run, this));
+    _running = true;
+#endif
+    return _running;
+}
+
+/**
+ * The body function of the decoding thread.
+ */
+void AudioStreamer::run() {
+    while (!_stop.load()) {
+        if (!pass()) {
+            std::unique_lock<std::mutex> lk(_mutex);
+            if (!_stop.load()) {
+                _wakeup.wait_for(lk,std::chrono::milliseconds(STREAM_POLL_PERIOD));
+            }
+        }
+    }
+}
+
+/**
+ * Performs a single decoding pass over the attached streams.
+ *
+ * Closed streams are dropped first. The pass holds the fill lock, so
+ * that each stream only ever has one producer at a time.
+ *
+ * @return true if any stream received data
+ */
+bool AudioStreamer::pass() {
+    std::vector<std::shared_ptr<AudioStream>> active;
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        _streams.erase(std::remove_if(_streams.begin(), _streams.end(),
+                                      [](const std::shared_ptr<AudioStream>& stream) {
+                                          return stream->isClosed();
+                                      }), _streams.end());
+        active = _streams;
+    }
+
+    std::unique_lock<std::mutex> lk(_filling);
+    bool worked = false;
+    for(auto it = active.begin(); it != active.end() && !_stop.load(); ++it) {
+        worked = (*it)->fill() || worked;
+    }
+    return worked;
+}
+
+/**
+ * The body function of the decoding thread using the SDL thread API.
+ *
+ * This should be used on Android and Windows, which have special thread
+ * requirements.
+ */
+int AudioStreamer::sdlThreadFunc(void* ptr) {
+    AudioStreamer* self = (AudioStreamer*)ptr;
+    self->run();
+    return 0;
+}
+
+/**
+ * Returns a new stream for the decoder, attached to this streamer.
+ *
+ * The first page of the stream is decoded on the calling thread, so that
+ * playback can begin immediately. The decoder is owned by the streamer
+ * thread from then on.
+ *
+ * @param decoder   The decoder for the streamed asset
+ *
+ * @return a new stream for the decoder, attached to this streamer.
+ */
+std::shared_ptr<AudioStream> AudioStreamer::attach(const std::shared_ptr<AudioDecoder>& decoder) {
+    std::shared_ptr<AudioStream> stream = AudioStream::alloc(decoder);
+    if (stream == nullptr) {
+        return nullptr;
+    }
+    stream->fill(decoder->getPageSize());
+
+    std::unique_lock<std::mutex> lk(_mutex);
+    _streams.push_back(stream);
+    _wakeup.notify_one();
+    return stream;
+}
+
+/**
+ * Fills every attached stream on the calling thread.
+ *
+ * This is for offline rendering, where the graph is pulled faster than
+ * real time and the decoding thread may fall behind.  The decoding
+ * thread is locked out while this method runs, so it is safe to call
+ * at any time.  It should not be called from the audio thread.
+ *
+ * @return true if any stream received data
+ */
+bool AudioStreamer::pump() {
+    return pass();
+}
+
+/**
+ * Returns the number of attached streams.
+ *
+ * @return the number of attached streams.
+ */
+size_t AudioStreamer::size() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    return _streams.size();
+}
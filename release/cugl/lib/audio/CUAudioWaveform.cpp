@@ -448,6 +448,7 @@ void AudioWaveNode::dispose() {
  * @return the actual number of frames read
  */
 Uint32 AudioWaveNode::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     if (_paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*sizeof(float)*_channels);
         return frames;
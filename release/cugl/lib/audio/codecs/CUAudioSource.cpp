@@ -0,0 +1,306 @@
+//
+//  CUAudioSource.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides the encoded bytes of an audio file for the decoders.
+//  The file is memory mapped when the platform allows it, and read into memory
+//  once otherwise (such as for assets inside an Android APK).  Either way, the
+//  decoders read through an in-memory SDL_RWops, so a decoder never makes a
+//  system call after it is opened.
+//
+//  Sources are shared.  Every decoder for the same file uses the same bytes,
+//  and the same seek index.  The seek index maps frames to byte offsets so
+//  that a decoder can reposition without scanning the file. It is built once
+//  per file by the first decoder that needs it.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/audio/codecs/CUAudioSource.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <map>
+
+#if defined (__WINDOWS__)
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace cugl::audio;
+
+#pragma mark Constructors
+/**
+ * Creates an empty audio source
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. Use {@link #acquire} instead.
+ */
+AudioSource::AudioSource() :
+_data(nullptr),
+_size(0),
+_mapped(false),
+#if defined (__WINDOWS__)
+_mapping(nullptr),
+#endif
+_indexed(false) {
+}
+
+/**
+ * Initializes this source for the given file.
+ *
+ * The file is memory mapped if possible, and read into memory otherwise.
+ *
+ * @param file  The source file
+ *
+ * @return true if the source was initialized successfully
+ */
+bool AudioSource::init(const std::string& file) {
+    if (_data != nullptr) {
+        return false;
+    }
+    _file = file;
+    return map(file) || load(file);
+}
+
+/**
+ * Releases the bytes of this source.
+ *
+ * Any SDL_RWops returned by {@link #open} is invalid after this call.
+ */
+void AudioSource::dispose() {
+    if (_data == nullptr) {
+        return;
+    }
+    if (_mapped) {
+#if defined (__WINDOWS__)
+        UnmapViewOfFile(_data);
+        CloseHandle((HANDLE)_mapping);
+        _mapping = nullptr;
+#else
+        munmap((void*)_data,_size);
+#endif
+    } else {
+        free((void*)_data);
+    }
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+    _index.clear();
+    _indexed = false;
+}
+
+/**
+ * Attempts to memory map the given file
+ *
+ * @param file  The file to map
+ *
+ * @return true if the file was mapped
+ */
+bool AudioSource::map(const std::string& file) {
+#if defined (__WINDOWS__)
+    HANDLE handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if (mapping == NULL) {
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+    _mapping = (void*)mapping;
+    _data = (const Uint8*)data;
+    _size = (size_t)size.QuadPart;
+#else
+    // Files inside an Android APK cannot be opened (and fall back to SDL)
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    _data = (const Uint8*)data;
+    _size = (size_t)info.st_size;
+#endif
+    _mapped = true;
+    return true;
+}
+
+/**
+ * Reads the given file into memory with SDL
+ *
+ * @param file  The file to read
+ *
+ * @return true if the file was read
+ */
+bool AudioSource::load(const std::string& file) {
+    SDL_RWops* source = SDL_RWFromFile(file.c_str(), "rb");
+    if (source == nullptr) {
+        SDL_SetError("Could not open '%s'",file.c_str());
+        return false;
+    }
+    Sint64 size = SDL_RWsize(source);
+    if (size <= 0) {
+        SDL_SetError("File '%s' is empty",file.c_str());
+        SDL_RWclose(source);
+        return false;
+    }
+
+    Uint8* data = (Uint8*)malloc((size_t)size);
+    size_t amt = SDL_RWread(source, data, 1, (size_t)size);
+    SDL_RWclose(source);
+    if (amt != (size_t)size) {
+        SDL_SetError("Could not read '%s'",file.c_str());
+        free(data);
+        return false;
+    }
+    _data = data;
+    _size = (size_t)size;
+    _mapped = false;
+    return true;
+}
+
+/**
+ * Returns the shared source for the given file
+ *
+ * If there is already a source for this file in use, this method returns
+ * it.  Otherwise it creates a new one.  It returns nullptr if the file
+ * cannot be read.
+ *
+ * @param file  The source file
+ *
+ * @return the shared source for the given file
+ */
+std::shared_ptr<AudioSource> AudioSource::acquire(const std::string& file) {
+    static std::mutex lock;
+    static std::map<std::string,std::weak_ptr<AudioSource>> cache;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::shared_ptr<AudioSource> result = cache[file].lock();
+    if (result == nullptr) {
+        result = std::make_shared<AudioSource>();
+        if (!result->init(file)) {
+            cache.erase(file);
+            return nullptr;
+        }
+        cache[file] = result;
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access
+/**
+ * Returns a new read-only SDL_RWops for the bytes of this source.
+ *
+ * The caller must close the SDL_RWops, and must keep a reference to this
+ * source for as long as the SDL_RWops is open.
+ *
+ * @return a new read-only SDL_RWops for the bytes of this source.
+ */
+SDL_RWops* AudioSource::open() const {
+    if (_data == nullptr) {
+        return nullptr;
+    }
+    return SDL_RWFromConstMem(_data, (int)_size);
+}
+
+#pragma mark -
+#pragma mark Seek Index
+/**
+ * Returns the seek point at or before the given frame.
+ *
+ * If the seek index has not been built, it is built with the given
+ * function first.  The builder is called at most once per source, no
+ * matter how many decoders share it.  This method returns false if the
+ * index is empty or no seek point precedes the frame.
+ *
+ * @param frame     The frame to seek to
+ * @param builder   The function to build the seek index
+ * @param point     The seek point to store the result
+ *
+ * @return true if a seek point was found
+ */
+bool AudioSource::lookup(Uint64 frame,
+                         const std::function<void(const AudioSource*, std::vector<SeekPoint>&)>& builder,
+                         SeekPoint& point) {
+    std::lock_guard<std::mutex> guard(_indexlock);
+    if (!_indexed) {
+        builder(this,_index);
+        _indexed = true;
+    }
+
+    auto it = std::upper_bound(_index.begin(), _index.end(), frame,
+                               [](Uint64 value, const SeekPoint& entry) {
+                                   return value < entry.frame;
+                               });
+    if (it == _index.begin()) {
+        return false;
+    }
+    point = *(--it);
+    return true;
+}
+
+/**
+ * Returns the seek point before the given one
+ *
+ * This is used when decoding from a seek point overshoots its frame.
+ * This method returns false if there is no earlier seek point.
+ *
+ * @param point     The seek point to replace with its predecessor
+ *
+ * @return true if there was an earlier seek point
+ */
+bool AudioSource::previous(SeekPoint& point) {
+    std::lock_guard<std::mutex> guard(_indexlock);
+    auto it = std::lower_bound(_index.begin(), _index.end(), point.offset,
+                               [](const SeekPoint& entry, Uint64 value) {
+                                   return entry.offset < value;
+                               });
+    if (it == _index.begin()) {
+        return false;
+    }
+    point = *(--it);
+    return true;
+}
@@ -216,6 +216,8 @@ void flac_error(const FLAC__StreamDecoder *decoder,
  * the heap, use one of the static constructors instead.
  */
 FLACDecoder::FLACDecoder() : AudioDecoder(),
+_input(nullptr),
+_source(nullptr),
 _decoder(nullptr),
 _buffer(nullptr),
 _sampsize(0),
@@ -231,8 +233,10 @@ FLACDecoder::~FLACDecoder() {
         free(_buffer);
         FLAC__stream_decoder_delete(_decoder);
         SDL_RWclose(_source);
+        _source = nullptr;
         _buffer = nullptr;
     }
+    _input = nullptr;
 }
 
 /**
@@ -248,9 +252,11 @@ FLACDecoder::~FLACDecoder() {
 bool FLACDecoder::init(const std::string& file) {
     _file = file;
     
-    _source = SDL_RWFromFile(file.c_str(), "r");
+    _input  = AudioSource::acquire(file);
+    _source = _input == nullptr ? nullptr : _input->open();
     if (_source == nullptr) {
         SDL_SetError("Could not open '%s'",file.c_str());
+        _input = nullptr;
         return false;
     }
 
@@ -295,8 +301,10 @@ void FLACDecoder::dispose() {
         free(_buffer);
         FLAC__stream_decoder_delete(_decoder);
         SDL_RWclose(_source);
+        _source = nullptr;
         _buffer = nullptr;
     }
+    _input = nullptr;
 }
 
 /**
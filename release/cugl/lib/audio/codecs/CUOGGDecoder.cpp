@@ -37,8 +37,10 @@
 //  Version: 6/29/17
 //
 #include <cugl/audio/codecs/CUOGGDecoder.h>
+#include <algorithm>
 #include <cassert>
 #include <climits>
+#include <cstring>
 
 using namespace cugl::audio;
 
@@ -140,6 +142,64 @@ static long   ogg_tell(void *datasource) {
     return (long)SDL_RWtell((SDL_RWops*)datasource);
 }
 
+/**
+ * Builds the seek index for an OGG file
+ *
+ * Each Ogg page records the granule position (the frame count) at the end
+ * of its last complete packet.  Decoding from the page after it resumes at
+ * that frame.  Hence the index has one entry for each page with a granule
+ * position, mapping the frame to the offset of the next page. The pages
+ * are walked with their headers, so no audio data is decoded.  Only the
+ * first logical bitstream is indexed.
+ *
+ * @param source    The encoded file
+ * @param index     The seek index to fill
+ */
+static void ogg_index(const AudioSource* source, std::vector<AudioSource::SeekPoint>& index) {
+    const Uint8* data = source->getData();
+    size_t size = source->getSize();
+    size_t pos = 0;
+    Uint32 serial = 0;
+    bool first = true;
+    while (pos+27 <= size) {
+        if (std::memcmp(data+pos, "OggS", 4) != 0 || data[pos+4] != 0) {
+            pos++;  // Resync on a damaged page
+            continue;
+        }
+        Uint8 segments = data[pos+26];
+        if (pos+27+segments > size) {
+            break;
+        }
+        size_t next = pos+27+segments;
+        for(Uint8 ii = 0; ii < segments; ii++) {
+            next += data[pos+27+ii];
+        }
+        if (next > size) {
+            break;
+        }
+
+        Sint64 granule = 0;
+        for(int ii = 7; ii >= 0; ii--) {
+            granule = (granule << 8) | data[pos+6+ii];
+        }
+        Uint32 serialno = SDL_SwapLE32(*(const Uint32*)(data+pos+14));
+        if (first) {
+            serial = serialno;
+            first = false;
+        } else if (serialno != serial) {
+            break;
+        }
+
+        if (granule >= 0 && next < size) {
+            AudioSource::SeekPoint point;
+            point.frame  = (Uint64)granule;
+            point.offset = next;
+            index.push_back(point);
+        }
+        pos = next;
+    }
+}
+
 
 #pragma mark -
 #pragma mark OGG Decoder
@@ -150,6 +210,7 @@ static long   ogg_tell(void *datasource) {
  * the heap, use one of the static constructors instead.
  */
 OGGDecoder::OGGDecoder() : AudioDecoder(),
+_input(nullptr),
 _source(nullptr),
 _bitstream(0)
 {}
@@ -163,6 +224,7 @@ OGGDecoder::~OGGDecoder() {
         SDL_RWclose(_source);
         _source = nullptr;
     }
+    _input = nullptr;
 }
 
 /**
@@ -177,9 +239,11 @@ OGGDecoder::~OGGDecoder() {
 bool OGGDecoder::init(const std::string& file) {
     _file = file;
     
-    _source = SDL_RWFromFile(file.c_str(), "rb");
+    _input = AudioSource::acquire(file);
+    _source = _input == nullptr ? nullptr : _input->open();
     if (_source == nullptr) {
         SDL_SetError("Could not open '%s'",file.c_str());
+        _input = nullptr;
         return false;
     }
     
@@ -197,6 +261,7 @@ bool OGGDecoder::init(const std::string& file) {
         SDL_SetError("File '%s' is not an OFF file", file.c_str());
         SDL_RWclose(_source);
         _source = nullptr;
+        _input = nullptr;
         return false;
     }
     
@@ -220,6 +285,7 @@ void OGGDecoder::dispose() {
         SDL_RWclose(_source);
         _source = nullptr;
     }
+    _input = nullptr;
 }
 
 
@@ -310,10 +376,54 @@ Sint32 OGGDecoder::pagein(float* buffer) {
  * @param page  The new page of this decoder
  */
 void OGGDecoder::setPage(Uint64 page) {
-    Uint32 frame = (Uint32)(page*_pagesize);
+    Uint64 frame = page*_pagesize;
     if (frame > _frames) {
-        frame = (Uint32)_frames;
+        frame = _frames;
+    }
+    if (!seek(frame)) {
+        ov_pcm_seek(&_oggfile,frame);
     }
-    ov_pcm_seek(&_oggfile,frame);
     _currpage = frame/_pagesize;
 }
+
+/**
+ * Moves the decoder to the given frame using the page index
+ *
+ * This method returns false if the index cannot be used, in which case
+ * the decoder position is unspecified.
+ *
+ * @param frame The frame to seek to
+ *
+ * @return true if the decoder is at the given frame
+ */
+bool OGGDecoder::seek(Uint64 frame) {
+    AudioSource::SeekPoint point;
+    if (_input == nullptr || frame >= _frames || !_input->lookup(frame, ogg_index, point)) {
+        return false;
+    }
+
+    // Decoding may begin slightly after the page granule; back up if so
+    ogg_int64_t actual = -1;
+    do {
+        if (ov_raw_seek(&_oggfile, (ogg_int64_t)point.offset) != 0) {
+            return false;
+        }
+        actual = ov_pcm_tell(&_oggfile);
+    } while ((actual < 0 || (Uint64)actual > frame) && _input->previous(point));
+    if (actual < 0 || (Uint64)actual > frame) {
+        return false;
+    }
+
+    // Decode forward to the exact frame
+    float** pcmb;
+    Uint64 skip = frame-(Uint64)actual;
+    while (skip > 0) {
+        int amt = (int)std::min(skip,(Uint64)_pagesize);
+        amt = (int)ov_read_float(&_oggfile, &pcmb, amt, &_bitstream);
+        if (amt <= 0) {
+            return false;
+        }
+        skip -= amt;
+    }
+    return true;
+}
@@ -716,6 +716,7 @@ Sint32 IMADecoder::read(SDL_RWops* _source, Uint8* buffer) {
  * the heap, use one of the static constructors instead.
  */
 WAVDecoder::WAVDecoder() : AudioDecoder(),
+_input(nullptr),
 _source(nullptr),
 _chunker(nullptr),
 _adpcm(nullptr)
@@ -729,6 +730,7 @@ WAVDecoder::~WAVDecoder() {
         SDL_RWclose(_source);
         _source = nullptr;
     }
+    _input = nullptr;
     
     if (_chunker != nullptr) {
         SDL_free(_chunker);
@@ -768,6 +770,7 @@ void WAVDecoder::dispose() {
         SDL_RWclose(_source);
         _source = nullptr;
     }
+    _input = nullptr;
     
     if (_chunker != nullptr) {
         SDL_free(_chunker);
@@ -937,7 +940,8 @@ bool WAVDecoder::bootstrap(const std::string& file) {
     
     SDL_zero(chunk);
     
-    _source = SDL_RWFromFile(file.c_str(),"r");
+    _input  = AudioSource::acquire(file);
+    _source = _input == nullptr ? nullptr : _input->open();
      was_error = 0;
     if (_source == NULL) {
         SDL_SetError("'%s' not found",file.c_str());
@@ -1105,6 +1109,7 @@ done:
     if (was_error && _source != nullptr) {
         SDL_RWclose(_source);
         _source = nullptr;
+        _input = nullptr;
         return false;
     }
     return !was_error;
@@ -535,6 +535,7 @@ bool AudioInput::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioInput::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     Sint64 timeout = _timeout.load(std::memory_order_relaxed);
     if (_paused.load(std::memory_order_relaxed) || timeout == 0) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
@@ -58,11 +58,13 @@ const float AudioMixer::DEFAULT_KNEE  = 0.9;
  */
 AudioMixer::AudioMixer() :
 _width(0),
-_knee(-1),
+_buffer(nullptr),
 _capacity(0),
-_inputs(nullptr),
-_buffer(nullptr) {
-    _classname = "AudioScheduler";
+_knee(-1),
+_offset(0),
+_marked(0),
+_moved(-1) {
+    _classname = "AudioMixer";
 #if CU_PLATFORM == CU_PLATFORM_ANDROID
 	// Android handles clipping very badly.
 	_knee = AudioMixer::DEFAULT_KNEE;
@@ -145,10 +147,7 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
         _width = width;
         _knee  = -1;
         _capacity = AudioDevices::get()->getReadSize();
-        _inputs = new std::shared_ptr<AudioNode>[_width];
-        for (int ii = 0; ii < _width; ii++) {
-            _inputs[ii] = nullptr;
-        }
+        _inputs.store(new Slots(width));
         _buffer = (float*)malloc(_capacity*_channels*sizeof(float));
         return true;
     }
@@ -164,13 +163,13 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
 void AudioMixer::dispose() {
     if (_booted) {
         AudioNode::dispose();
-        delete[] _inputs;
+        _inputs.store(nullptr);
         free(_buffer);
-        _inputs = nullptr;
         _buffer = nullptr;
         _width = 0;
         _knee  = -1;
         _capacity = 0;
+        _moved = -1;
     }
 }
 
@@ -189,7 +188,7 @@ void AudioMixer::dispose() {
  * @return the input node previously at the given slot
  */
 std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<AudioNode>& input) {
-    CUAssertLog(slot < _width, "Slot %d is out of range",slot);
+    CUAssertLog(slot < getWidth(), "Slot %d is out of range",slot);
     if (input == nullptr) {
         return detach(slot);
     } else if (input->getChannels() != _channels) {
@@ -202,8 +201,15 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
         return nullptr;
     }
     _marked.store(0,std::memory_order_relaxed);
-    _offset.store(0,std::memory_order_relaxed);
-    return std::atomic_exchange_explicit(_inputs+slot,input,std::memory_order_relaxed);
+    move(0);
+    std::shared_ptr<AudioNode> result;
+    _inputs.update([&](Slots& slots) {
+        if (slot < slots.size()) {
+            result = slots[slot];
+            slots[slot] = input;
+        }
+    });
+    return result;
 }
 
 /**
@@ -216,8 +222,15 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
  * @return the input node detached from the slot
  */
 std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
-    CUAssertLog(slot < _width, "Slot %d is out of range",slot);
-    return std::atomic_exchange_explicit(_inputs+slot,{},std::memory_order_relaxed);
+    CUAssertLog(slot < getWidth(), "Slot %d is out of range",slot);
+    std::shared_ptr<AudioNode> result;
+    _inputs.update([&](Slots& slots) {
+        if (slot < slots.size()) {
+            result = slots[slot];
+            slots[slot] = nullptr;
+        }
+    });
+    return result;
 }
 
 /**
@@ -233,13 +246,13 @@ std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
  * @return true if this audio node has no more data.
  */
 bool AudioMixer::completed() {
-    std::lock_guard<std::mutex> lock(_mutex);
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            success = temp->completed() && success;
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                success = (*it)->completed() && success;
+            }
         }
     }
     return success;
@@ -264,21 +277,27 @@ bool AudioMixer::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
+    Sint64 moved = _moved.exchange(-1,std::memory_order_acquire);
+    if (moved >= 0) {
+        _offset.store((Uint64)moved,std::memory_order_relaxed);
+    }
+
     std::memset(buffer,0,frames*_channels*sizeof(float));
     frames = std::min(frames,_capacity);
     Uint32 actual = 0;
     if (!_paused.load(std::memory_order_relaxed)) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        std::shared_ptr<AudioNode> temp;
-        for(int ii = 0; ii < _width; ii++) {
-            temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-            if (temp) {
-                Uint32 amt = temp->read(_buffer,frames);
-                actual = std::max(amt,actual);
-                if (amt < frames) {
-                    std::memset(_buffer+amt,0,(frames-amt)*_channels*sizeof(float));
+        SnapshotPointer<Slots>::Reader slots = _inputs.read();
+        if (slots) {
+            for(auto it = slots->begin(); it != slots->end(); ++it) {
+                if (*it) {
+                    Uint32 amt = (*it)->read(_buffer,frames);
+                    actual = std::max(amt,actual);
+                    if (amt < frames) {
+                        std::memset(_buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
+                    }
+                    dsp::DSPMath::add(_buffer,buffer,buffer,frames*_channels);
                 }
-                dsp::DSPMath::add(_buffer,buffer,buffer,frames*_channels);
             }
         }
         dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,frames*_channels);
@@ -293,16 +312,30 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
         actual = frames;
     }
     
-    Uint64 pos = _offset.load(std::memory_order_relaxed);
-    _offset.store(pos+actual,std::memory_order_relaxed);
+    _offset.fetch_add(actual,std::memory_order_relaxed);
     return actual;
 }
 
+/**
+ * Moves the read position from the main thread.
+ *
+ * The position is stored immediately, but it is also applied by the
+ * audio thread at the start of its next read.  This keeps a read in
+ * progress from overwriting the new position when it finishes.
+ *
+ * @param position  The new read position
+ */
+void AudioMixer::move(Uint64 position) {
+    _offset.store(position,std::memory_order_relaxed);
+    _moved.store((Sint64)position,std::memory_order_release);
+}
+
 /**
  * Sets the width of this mixer.
  *
- * The width is the number of supported input slots. This method will only
- * succeed if the mixer is paused.  Otherwise, it will fail.
+ * The width is the number of supported input slots. This method may be
+ * called at any time; the audio thread picks up the new slots on its
+ * next read.
  *
  * Once the width is adjusted, the children will be reassigned in order.
  * If the new width is less than the old width, children at the end of
@@ -311,17 +344,14 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
  * @return true if the mixer width was reset
  */
 bool AudioMixer::setWidth(Uint8 width) {
-    if (_paused.load(std::memory_order_relaxed)) {
-        std::shared_ptr<AudioNode>* replace = new std::shared_ptr<AudioNode>[width];
-        Uint32 min = width < _width ? width : _width;
-        for(int ii = 0; ii < width; ii++) {
-            replace[ii] = ii < min ? _inputs[ii] : nullptr;
-        }
-        delete[] _inputs;
-        _inputs = replace;
-        return true;
+    if (!_booted || width == 0) {
+        return false;
     }
-    return false;
+    _inputs.update([&](Slots& slots) {
+        slots.resize(width);
+    });
+    _width.store(width,std::memory_order_relaxed);
+    return true;
 }
 
 #pragma mark -
@@ -381,13 +411,13 @@ void AudioMixer::setKnee(float knee) {
  * @return true if the read position was marked across all inputs.
  */
 bool AudioMixer::mark() {
-    std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            success = temp->mark() && success;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                success = (*it)->mark() && success;
+            }
         }
     }
     _marked.store(_offset.load(std::memory_order_relaxed),std::memory_order_relaxed);
@@ -414,13 +444,13 @@ bool AudioMixer::mark() {
  * @return true if the read position was marked.
  */
 bool AudioMixer::unmark() {
-    std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            success = temp->unmark() && success;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                success = (*it)->unmark() && success;
+            }
         }
     }
     _marked.store(0,std::memory_order_relaxed);
@@ -442,16 +472,16 @@ bool AudioMixer::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioMixer::reset() {
-    std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            success = temp->reset() && success;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                success = (*it)->reset() && success;
+            }
         }
     }
-    _offset.store(_marked.load(std::memory_order_relaxed),std::memory_order_relaxed);
+    move(_marked.load(std::memory_order_relaxed));
     return success;
 }
 
@@ -472,21 +502,20 @@ bool AudioMixer::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioMixer::advance(Uint32 frames) {
-    std::lock_guard<std::mutex> lock(_mutex);
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            Sint64 amt = temp->advance(frames);
-            actual = std::max(actual,amt);
-            fail = fail || amt == -1;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                Sint64 amt = (*it)->advance(frames);
+                actual = std::max(actual,amt);
+                fail = fail || amt == -1;
+            }
         }
     }
     
-    Uint64 pos = _offset.load(std::memory_order_relaxed);
-    _offset.store(pos+actual,std::memory_order_relaxed);
+    move(_offset.load(std::memory_order_relaxed)+actual);
     return fail ? -1 : actual;
 }
 
@@ -526,20 +555,20 @@ Sint64 AudioMixer::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioMixer::setPosition(Uint32 position) {
-    std::lock_guard<std::mutex> lock(_mutex);
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            Sint64 amt = temp->setPosition(position);
-            actual = std::max(actual,amt);
-            fail = fail || amt == -1;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                Sint64 amt = (*it)->setPosition(position);
+                actual = std::max(actual,amt);
+                fail = fail || amt == -1;
+            }
         }
     }
     
-    _offset.store(actual,std::memory_order_relaxed);
+    move(actual);
     return fail ? -1 : actual;
 }
 
@@ -603,13 +632,14 @@ double AudioMixer::getRemaining() const {
     // An unavoidable race condition has minor effects on accuracy
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            double amt = temp->getRemaining();
-            actual = std::max(actual,amt);
-            fail = fail || amt == -1;
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (slots) {
+        for(auto it = slots->begin(); it != slots->end(); ++it) {
+            if (*it) {
+                double amt = (*it)->getRemaining();
+                actual = std::max(actual,amt);
+                fail = fail || amt == -1;
+            }
         }
     }
     
@@ -638,16 +668,17 @@ double AudioMixer::getRemaining() const {
  * @return the new remaining time in seconds.
  */
 double AudioMixer::setRemaining(double time) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    
+    SnapshotPointer<Slots>::Reader slots = _inputs.read();
+    if (!slots) {
+        return -1;
+    }
+
     // Get longest time remaining
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            double amt = temp->getRemaining();
+    for(auto it = slots->begin(); it != slots->end(); ++it) {
+        if (*it) {
+            double amt = (*it)->getRemaining();
             actual = std::max(actual,amt);
             fail = fail || amt == -1;
         }
@@ -656,19 +687,18 @@ double AudioMixer::setRemaining(double time) {
     Uint64 pos = _offset.load(std::memory_order_relaxed)+actual*getRate();
     
     // Now push forward
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
-        if (temp) {
-            Uint64 off = temp->setPosition((Uint32)pos);
+    for(auto it = slots->begin(); it != slots->end(); ++it) {
+        if (*it) {
+            Sint64 off = (*it)->setPosition((Uint32)pos);
             if (off < 0) {
-                double back = temp->setRemaining(time+temp->getRemaining()-actual);
+                double back = (*it)->setRemaining(time+(*it)->getRemaining()-actual);
                 if (back < 0) {
-                    fail = false;
+                    fail = true;
                 }
             }
         }
     }
     
-    _offset.store(pos,std::memory_order_relaxed);
+    move(pos);
     return fail ? -1 : actual;
 }
@@ -46,6 +46,7 @@
 #include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
 #include <sstream>
+#include <mutex>
 
 using namespace cugl::audio;
 
@@ -57,6 +58,139 @@ const Uint32 AudioNode::DEFAULT_CHANNELS = 2;
 /** The default sampling frequency for an audio graph node */
 const Uint32 AudioNode::DEFAULT_SAMPLING = 48000;
 
+#pragma mark -
+#pragma mark Static State
+/** Whether audio nodes are recording timing statistics */
+static std::atomic<bool> g_profiling(false);
+/** The class names for the class statistics */
+static std::string g_classnames[AUDIO_PROFILE_CLASSES];
+/** The number of registered node classes */
+static std::atomic<Uint32> g_classcount(0);
+/** A mutex for registering node classes */
+static std::mutex g_classlock;
+
+/** Whether callbacks raised on this thread are held for offline rendering */
+static thread_local bool t_holding = false;
+/** The callbacks held for offline rendering */
+static std::vector<std::function<void()>> g_held;
+/** A mutex for the held callbacks */
+static std::mutex g_heldlock;
+
+/** The statistics for each registered node class */
+AudioNode::ProfileCounters AudioNode::_classProfiles[AUDIO_PROFILE_CLASSES];
+
+/** The innermost active timer on this thread */
+thread_local AudioNode::ProfileScope* AudioNode::ProfileScope::_current = nullptr;
+
+/**
+ * Returns the index of the class statistics for the given class name.
+ *
+ * Classes are registered on first use.  If there are too many classes, this
+ * function returns AUDIO_PROFILE_CLASSES, and the class is not profiled.
+ *
+ * @param name  The class name
+ *
+ * @return the index of the class statistics for the given class name.
+ */
+static Uint32 register_class(const std::string& name) {
+    std::lock_guard<std::mutex> lock(g_classlock);
+    Uint32 count = g_classcount.load(std::memory_order_relaxed);
+    for(Uint32 ii = 0; ii < count; ii++) {
+        if (g_classnames[ii] == name) {
+            return ii;
+        }
+    }
+    if (count == AUDIO_PROFILE_CLASSES) {
+        return AUDIO_PROFILE_CLASSES;
+    }
+    g_classnames[count] = name;
+    g_classcount.store(count+1,std::memory_order_release);
+    return count;
+}
+
+/**
+ * Records a single call to read.
+ *
+ * @param amount    The number of frames requested
+ * @param elapsed   The time of the call, including the input nodes
+ * @param exclusive The time of the call, excluding the input nodes
+ */
+void AudioNode::ProfileCounters::record(Uint32 amount, Uint64 elapsed, Uint64 exclusive) {
+    calls.fetch_add(1,std::memory_order_relaxed);
+    frames.fetch_add(amount,std::memory_order_relaxed);
+    total.fetch_add(elapsed,std::memory_order_relaxed);
+    self.fetch_add(exclusive,std::memory_order_relaxed);
+    Uint64 prev = peak.load(std::memory_order_relaxed);
+    while (elapsed > prev && !peak.compare_exchange_weak(prev,elapsed,std::memory_order_relaxed)) {}
+}
+
+/**
+ * Returns a copy of these counters with the given name.
+ *
+ * @param name  The name for the statistics
+ *
+ * @return a copy of these counters with the given name.
+ */
+AudioNode::Profile AudioNode::ProfileCounters::snapshot(const std::string& name) const {
+    Profile result;
+    result.name   = name;
+    result.calls  = calls.load(std::memory_order_relaxed);
+    result.frames = frames.load(std::memory_order_relaxed);
+    result.total  = total.load(std::memory_order_relaxed);
+    result.self   = self.load(std::memory_order_relaxed);
+    result.peak   = peak.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * Resets all counters to zero.
+ */
+void AudioNode::ProfileCounters::reset() {
+    calls.store(0,std::memory_order_relaxed);
+    frames.store(0,std::memory_order_relaxed);
+    total.store(0,std::memory_order_relaxed);
+    self.store(0,std::memory_order_relaxed);
+    peak.store(0,std::memory_order_relaxed);
+}
+
+/**
+ * Starts timing a call to read for the given node.
+ *
+ * @param node      The node being read
+ * @param frames    The number of frames requested
+ */
+AudioNode::ProfileScope::ProfileScope(AudioNode* node, Uint32 frames) :
+_node(nullptr),
+_parent(nullptr),
+_inputs(0),
+_frames(frames) {
+    if (g_profiling.load(std::memory_order_relaxed)) {
+        _node   = node;
+        _parent = _current;
+        _current = this;
+        _start  = cuclock_t::now();
+    }
+}
+
+/**
+ * Records the time of the call to read.
+ */
+AudioNode::ProfileScope::~ProfileScope() {
+    if (_node == nullptr) {
+        return;
+    }
+    Uint64 elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(cuclock_t::now()-_start).count();
+    Uint64 exclusive = elapsed > _inputs ? elapsed-_inputs : 0;
+    _node->_profile.record(_frames,elapsed,exclusive);
+    if (_node->_profclass < AUDIO_PROFILE_CLASSES) {
+        _classProfiles[_node->_profclass].record(_frames,elapsed,exclusive);
+    }
+    if (_parent != nullptr) {
+        _parent->_inputs += elapsed;
+    }
+    _current = _parent;
+}
+
 #pragma mark -
 #pragma mark Constructors
 
@@ -77,6 +211,7 @@ AudioNode::AudioNode() : _channels(0), _sampling(0) {
     _polling = false;
     _booted = false;
     _tag = -1;
+    _profclass = AUDIO_PROFILE_CLASSES;
 }
 
 /**
@@ -123,6 +258,8 @@ bool AudioNode::init(Uint8 channels, Uint32 rate) {
     _channels = channels;
     _sampling = rate;
     _booted = true;
+    _profclass = register_class(_classname);
+    _profile.reset();
     return true;
 }
 
@@ -254,7 +391,17 @@ void AudioNode::setCallback(Callback callback) {
  * unexpected side effects.
  */
 void AudioNode::notify(const std::shared_ptr<AudioNode>& node, AudioNode::Action action) {
-    Application::get()->schedule([=] {
+    Application* app = Application::get();
+    if (t_holding || app == nullptr) {
+        std::lock_guard<std::mutex> lock(g_heldlock);
+        g_held.push_back([=] {
+            if (_callback) {
+                _callback(node,action);
+            }
+        });
+        return;
+    }
+    app->schedule([=] {
         if (_callback) {
             _callback(node,action);
         }
@@ -262,6 +409,43 @@ void AudioNode::notify(const std::shared_ptr<AudioNode>& node, AudioNode::Action
     });
 }
 
+/**
+ * Sets whether callbacks raised on this thread are held for later.
+ *
+ * AUDIO THREAD ONLY: This method is for offline rendering, where the
+ * audio graph is read on the main thread.  Held callbacks are executed
+ * by {@link #flushCallbacks}, instead of being scheduled with the
+ * {@link Application}.  That way they run between two reads, and not
+ * in the middle of one.
+ *
+ * @param value Whether callbacks raised on this thread are held
+ */
+void AudioNode::holdCallbacks(bool value) {
+    t_holding = value;
+}
+
+/**
+ * Executes any callbacks held for offline rendering.
+ *
+ * These are the callbacks raised during {@link #holdCallbacks}, or at
+ * any time when there is no running {@link Application}. This method
+ * should only be called on the main thread, and never while the audio
+ * graph is being read on the same thread.
+ *
+ * @return the number of callbacks executed
+ */
+size_t AudioNode::flushCallbacks() {
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(g_heldlock);
+        pending.swap(g_held);
+    }
+    for(auto it = pending.begin(); it != pending.end(); ++it) {
+        (*it)();
+    }
+    return pending.size();
+}
+
 /**
  * Returns true if this node is currently paused
  *
@@ -317,3 +501,71 @@ Uint32 AudioNode::read(float* buffer, Uint32 frames) {
     std::memset(buffer, 0, sizeof(float)*frames*_channels);
     return frames;
 }
+
+#pragma mark -
+#pragma mark Profiling
+/**
+ * Returns true if audio nodes are recording timing statistics.
+ *
+ * Profiling is disabled by default. When it is disabled, the only cost
+ * is a single atomic load per call to {@link #read}.
+ *
+ * @return true if audio nodes are recording timing statistics.
+ */
+bool AudioNode::isProfiling() {
+    return g_profiling.load(std::memory_order_relaxed);
+}
+
+/**
+ * Sets whether audio nodes are recording timing statistics.
+ *
+ * Profiling is disabled by default. When it is disabled, the only cost
+ * is a single atomic load per call to {@link #read}.
+ *
+ * @param value Whether audio nodes are recording timing statistics
+ */
+void AudioNode::setProfiling(bool value) {
+    g_profiling.store(value,std::memory_order_relaxed);
+}
+
+/**
+ * Returns the timing statistics for this node.
+ *
+ * The statistics are named after this node, or after its class if it
+ * does not have a name.
+ *
+ * @return the timing statistics for this node.
+ */
+AudioNode::Profile AudioNode::getProfile() const {
+    return _profile.snapshot(_localname.empty() ? _classname : _localname);
+}
+
+/**
+ * Returns the timing statistics of every node class that has been read.
+ *
+ * These statistics are accumulated over every node of the class, so
+ * they include nodes that have since been deleted.  They are named after
+ * the class.
+ *
+ * @return the timing statistics of every node class that has been read.
+ */
+std::vector<AudioNode::Profile> AudioNode::getClassProfiles() {
+    std::vector<Profile> result;
+    std::lock_guard<std::mutex> lock(g_classlock);
+    Uint32 count = g_classcount.load(std::memory_order_acquire);
+    for(Uint32 ii = 0; ii < count; ii++) {
+        if (_classProfiles[ii].calls.load(std::memory_order_relaxed) > 0) {
+            result.push_back(_classProfiles[ii].snapshot(g_classnames[ii]));
+        }
+    }
+    return result;
+}
+
+/**
+ * Resets the timing statistics of every node class.
+ */
+void AudioNode::resetClassProfiles() {
+    for(Uint32 ii = 0; ii < AUDIO_PROFILE_CLASSES; ii++) {
+        _classProfiles[ii].reset();
+    }
+}
@@ -48,10 +48,14 @@
 #include <cugl/audio/graph/CUAudioResampler.h>
 #include <cugl/audio/graph/CUAudioRedistributor.h>
 #include <cugl/audio/CUAudioDevices.h>
+#include <cugl/audio/CUAudioStreamer.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUTimestamp.h>
 #include <atomic>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace cugl::audio;
 
@@ -138,6 +142,7 @@ static void float_to_u8(const float *input, Uint8* output, size_t size, bool swa
  *
  * The conversion is the usual one. It assumes that the floats are in the range
  * [-1,1] where -1 is converts to the minimum short and 1 converts to the maximum.
+ * Samples are rounded to the nearest short, as in {@link dsp::DSPMath#encode_pcm16}.
  *
  * If swap is true, then the endianness of the data will be reversed before it
  * it is stored in the output buffer.
@@ -148,19 +153,12 @@ static void float_to_u8(const float *input, Uint8* output, size_t size, bool swa
  * @param swap      Whether to swap the endianness of the data
  */
 static void float_to_s16(const float *input, Uint8* output, size_t size, bool swap) {
-    const float *src = input;
     Sint16 *dst = (Sint16 *)output;
 
-    for (size_t ii = 0; ii < size; ++ii, ++src, ++dst) {
-        const float sample = *src;
-        if (sample >= 1.0f) {
-            *dst = 32767;
-        } else if (sample <= -1.0f) {
-            *dst = -32768;
-        } else {
-            *dst = (Sint16)(sample * 32767.0f);
-        }
-        if (swap) {
+    // This is the most common device format, so it uses the vector kernel
+    cugl::dsp::DSPMath::encode_pcm16(input, dst, size);
+    if (swap) {
+        for (size_t ii = 0; ii < size; ++ii, ++dst) {
             *dst = (Sint16)SDL_Swap16(*dst);
         }
     }
@@ -274,7 +272,13 @@ static void float_to_float(const float *input, Uint8* output, size_t size, bool
 AudioOutput::AudioOutput() : AudioNode(),
 _dvname(""),
 _overhd(0),
-_input(nullptr),
+_callbacks(0),
+_underruns(0),
+_latecalls(0),
+_headroom(1.0f),
+_minroom(1.0f),
+_resync(true),
+_offline(false),
 _pagesize(0),
 _resampler(nullptr),
 _bitbuffer(nullptr) {
@@ -521,6 +525,44 @@ bool AudioOutput::init(const std::string& device, Uint8 channels, Uint32 rate, U
     return true;
 }
 
+/**
+ * Initializes an offline output with the given channels and sample rate.
+ *
+ * An offline output is not attached to any SDL device, and is never read
+ * by the audio thread. Instead, the audio graph is pulled on demand with
+ * {@link #render}.  This allows the audio graph to be processed (and
+ * benchmarked) on machines without any sound hardware.
+ *
+ * The buffer value is the number of frames read at each simulated poll.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in Hz
+ * @param buffer    The size of the buffer to play audio
+ *
+ * @return true if initialization was successful
+ */
+bool AudioOutput::initOffline(Uint8 channels, Uint32 rate, Uint32 buffer) {
+    if (!AudioNode::init(channels,rate)) {
+        return false;
+    }
+    _dvname = "";
+    _device = 0;
+    _offline = true;
+    
+    SDL_zero(_audiospec);
+    _audiospec.freq = rate;
+    _audiospec.channels = channels;
+    _audiospec.samples  = buffer;
+    _audiospec.format   = AUDIO_F32SYS;
+    _bitrate = sizeof(float);
+    _converter = nullptr;
+    _swapbits  = false;
+    
+    _active = false;
+    _paused = false;
+    return true;
+}
+
 /**
  * Disposes any resources allocated for this output device node.
  *
@@ -529,14 +571,19 @@ bool AudioOutput::init(const std::string& device, Uint8 channels, Uint32 rate, U
  */
 void AudioOutput::dispose() {
     if (_booted) {
-        SDL_PauseAudioDevice(_device, 1);
-        SDL_CloseAudioDevice(_device);
+        if (!_offline) {
+            SDL_PauseAudioDevice(_device, 1);
+            SDL_CloseAudioDevice(_device);
+        }
+        _offline = false;
         detach();
         AudioNode::dispose();
         _active = false;
         _overhd = 0;
+        _resync = true;
+        resetTelemetry();
 
-        _input = nullptr;
+        _input.store(nullptr);
         _resampler = nullptr;
         _distributor = nullptr;
         if (_bitbuffer != nullptr) {
@@ -558,7 +605,8 @@ void AudioOutput::dispose() {
  */
 void AudioOutput::setActive(bool active) {
     _active.store(active,std::memory_order_relaxed);
-    if (!_paused.load(std::memory_order_relaxed)) {
+    _resync.store(true,std::memory_order_relaxed);
+    if (!_offline && !_paused.load(std::memory_order_relaxed)) {
         SDL_PauseAudioDevice(_device, !active);
     }
 }
@@ -604,11 +652,11 @@ bool AudioOutput::attach(const std::shared_ptr<AudioNode>& node) {
         return false;
     }
     
-    std::atomic_exchange_explicit(&_input,node,std::memory_order_relaxed);
+    _input.store(node);
     if (_resampler != nullptr) {
-        _resampler->attach(_input);
+        _resampler->attach(node);
     } else if (_distributor != nullptr) {
-        _distributor->attach(_input);
+        _distributor->attach(node);
     }
     return true;
 }
@@ -633,7 +681,8 @@ std::shared_ptr<AudioNode> AudioOutput::detach() {
     } else if (_distributor != nullptr) {
         _distributor->detach();
     }
-    std::shared_ptr<AudioNode> result = std::atomic_exchange_explicit(&_input,{},std::memory_order_relaxed);
+    std::shared_ptr<AudioNode> result = getInput();
+    _input.store(nullptr);
     return result;
 }
 
@@ -650,7 +699,7 @@ std::shared_ptr<AudioNode> AudioOutput::detach() {
  */
 bool AudioOutput::pause() {
     bool success = !_paused.exchange(true);
-    if (success && _active.load(std::memory_order_relaxed)) {
+    if (success && !_offline && _active.load(std::memory_order_relaxed)) {
         SDL_PauseAudioDevice(_device, 1);
     }
     return success;
@@ -667,7 +716,8 @@ bool AudioOutput::pause() {
  */
 bool AudioOutput::resume() {
     bool success = _paused.exchange(false);
-    if (success && _active.load(std::memory_order_relaxed)) {
+    _resync.store(true,std::memory_order_relaxed);
+    if (success && !_offline && _active.load(std::memory_order_relaxed)) {
         SDL_PauseAudioDevice(_device, 0);
     }
     return success;
@@ -685,7 +735,8 @@ bool AudioOutput::resume() {
  * @return true if this audio node has no more data.
  */
 bool AudioOutput::completed() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     return (input == nullptr || input->completed());
 }
 
@@ -707,9 +758,11 @@ bool AudioOutput::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioOutput::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     Timestamp start;
     
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     Uint32 take = 0;
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_audiospec.channels*_bitrate);
@@ -724,7 +777,7 @@ Uint32 AudioOutput::read(float* buffer, Uint32 frames) {
     
     // Buck stops here.  Fill remainder with 0s.
     if (take < frames) {
-        std::memset(buffer+take*_audiospec.channels,0,(frames-take)*_audiospec.channels);
+        std::memset(buffer+take*_audiospec.channels,0,(frames-take)*_audiospec.channels*sizeof(float));
     }
 
     Timestamp end;
@@ -734,9 +787,18 @@ Uint32 AudioOutput::read(float* buffer, Uint32 frames) {
 }
 
 Uint32 AudioOutput::poll(Uint8* stream, int len) {
+    timestamp_t start = cuclock_t::now();
     Uint32 wordsize = SDL_AUDIO_BITSIZE(_audiospec.format)/8;
     Uint32 take = 0;
     Uint32 frames = len/(_audiospec.channels*wordsize);
+    double period = ((double)frames)/_audiospec.freq;
+    if (!_resync.exchange(false,std::memory_order_relaxed)) {
+        double interval = std::chrono::duration<double>(start-_lastpoll).count();
+        if (interval > 2*period) {
+            _latecalls.fetch_add(1,std::memory_order_relaxed);
+        }
+    }
+    _lastpoll = start;
     if (_converter != nullptr) {
         //std::memset(stream,0,len);
         while (take < frames) {
@@ -748,6 +810,17 @@ Uint32 AudioOutput::poll(Uint8* stream, int len) {
     } else {
         take = read((float*)stream,frames);
     }
+
+    double elapsed = std::chrono::duration<double>(cuclock_t::now()-start).count();
+    float headroom = period > 0 ? (float)(1.0-elapsed/period) : 0.0f;
+    _callbacks.fetch_add(1,std::memory_order_relaxed);
+    if (headroom < 0) {
+        _underruns.fetch_add(1,std::memory_order_relaxed);
+    }
+    _headroom.store(headroom,std::memory_order_relaxed);
+    if (headroom < _minroom.load(std::memory_order_relaxed)) {
+        _minroom.store(headroom,std::memory_order_relaxed);
+    }
     return take;
 }
 
@@ -764,6 +837,9 @@ Uint32 AudioOutput::poll(Uint8* stream, int len) {
  * between devices.
  */
 void AudioOutput::reboot() {
+    if (_offline) {
+        return;
+    }
     bool active = _active.exchange(false);
     if (active && !_paused.load(std::memory_order_relaxed)) {
         SDL_PauseAudioDevice(_device, 1);
@@ -781,6 +857,136 @@ void AudioOutput::reboot() {
         SDL_PauseAudioDevice(_device, 0);
     }
     _active.store(active,std::memory_order_relaxed);
+    _resync.store(true,std::memory_order_relaxed);
+}
+
+#pragma mark -
+#pragma mark Offline Rendering
+/**
+ * Renders the given number of frames from an offline output.
+ *
+ * The audio graph is read on the calling thread one buffer at a time,
+ * exactly as the SDL callback would read it. Node callbacks raised
+ * while reading are executed between buffers, so the {@link AudioEngine}
+ * and {@link AudioQueue} work as usual.  Hence this method should only
+ * be called from the main thread.
+ *
+ * If speed is 0, the graph is pulled as fast as possible.  Otherwise,
+ * the render is paced to the given multiple of real time (so 1 is real
+ * time).  Streamed assets are decoded on the calling thread before each
+ * buffer, so they never starve.  This method fails if the output is not
+ * offline.
+ *
+ * @param buffer    The buffer to store the interleaved frames
+ * @param frames    The number of frames to render
+ * @param speed     The multiple of real time (0 for unpaced)
+ *
+ * @return the number of frames rendered
+ */
+Uint64 AudioOutput::render(float* buffer, Uint64 frames, double speed) {
+    if (!_offline) {
+        CUAssertLog(false, "Attempt to render from a device output");
+        return 0;
+    }
+    
+    Uint32 pagesize = _audiospec.samples;
+    std::shared_ptr<AudioStreamer> streamer;
+    if (AudioDevices::get()) {
+        streamer = AudioDevices::get()->getStreamer();
+    }
+    timestamp_t start = cuclock_t::now();
+    _resync.store(true,std::memory_order_relaxed);
+    
+    Uint64 take = 0;
+    while (take < frames) {
+        Uint32 amount = frames-take < pagesize ? (Uint32)(frames-take) : pagesize;
+        if (streamer) {
+            // Unpaced renders can outrun the decoding thread
+            streamer->pump();
+        }
+        holdCallbacks(true);
+        poll((Uint8*)(buffer+take*_channels),amount*_channels*sizeof(float));
+        holdCallbacks(false);
+        flushCallbacks();
+        take += amount;
+        
+        if (speed > 0) {
+            std::chrono::duration<double> ahead(take/(speed*_sampling));
+            std::this_thread::sleep_until(start+std::chrono::duration_cast<cuclock_t::duration>(ahead));
+        }
+    }
+    return take;
+}
+
+/**
+ * Renders the given number of frames from an offline output to a file.
+ *
+ * The file is a 16-bit PCM WAV file. Otherwise, this method is the same
+ * as {@link #render}.
+ *
+ * @param file      The path of the WAV file
+ * @param frames    The number of frames to render
+ * @param speed     The multiple of real time (0 for unpaced)
+ *
+ * @return true if the file was successfully written
+ */
+bool AudioOutput::renderToFile(const std::string& file, Uint64 frames, double speed) {
+    if (!_offline) {
+        CUAssertLog(false, "Attempt to render from a device output");
+        return false;
+    }
+    
+    SDL_RWops* stream = SDL_RWFromFile(file.c_str(), "wb");
+    if (stream == nullptr) {
+        CULogError("[AUDIO] %s", SDL_GetError());
+        return false;
+    }
+    
+    // The canonical 44 byte header
+    Uint32 datasize = (Uint32)(frames*_channels*sizeof(Sint16));
+    SDL_WriteLE32(stream, 0x46464952);      // "RIFF"
+    SDL_WriteLE32(stream, 36+datasize);
+    SDL_WriteLE32(stream, 0x45564157);      // "WAVE"
+    SDL_WriteLE32(stream, 0x20746D66);      // "fmt "
+    SDL_WriteLE32(stream, 16);
+    SDL_WriteLE16(stream, 1);               // PCM
+    SDL_WriteLE16(stream, _channels);
+    SDL_WriteLE32(stream, _sampling);
+    SDL_WriteLE32(stream, _sampling*_channels*sizeof(Sint16));
+    SDL_WriteLE16(stream, _channels*sizeof(Sint16));
+    SDL_WriteLE16(stream, 16);
+    SDL_WriteLE32(stream, 0x61746164);      // "data"
+    SDL_WriteLE32(stream, datasize);
+    
+    Uint32 pagesize = _audiospec.samples;
+    std::vector<float>  page(pagesize*_channels);
+    std::vector<Sint16> pcm(pagesize*_channels);
+    
+    timestamp_t start = cuclock_t::now();
+    Uint64 take = 0;
+    bool success = true;
+    while (success && take < frames) {
+        Uint32 amount = frames-take < pagesize ? (Uint32)(frames-take) : pagesize;
+        render(page.data(), amount);
+        dsp::DSPMath::encode_pcm16(page.data(), pcm.data(), amount*_channels);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+        for(size_t ii = 0; ii < amount*_channels; ii++) {
+            pcm[ii] = SDL_SwapLE16(pcm[ii]);
+        }
+#endif
+        success = SDL_RWwrite(stream, pcm.data(), sizeof(Sint16), amount*_channels) == amount*_channels;
+        take += amount;
+
+        if (speed > 0) {
+            std::chrono::duration<double> ahead(take/(speed*_sampling));
+            std::this_thread::sleep_until(start+std::chrono::duration_cast<cuclock_t::duration>(ahead));
+        }
+    }
+    SDL_RWclose(stream);
+    if (!success) {
+        CULogError("[AUDIO] Could not write to '%s'", file.c_str());
+    }
+    return success;
 }
 
 /**
@@ -794,6 +1000,36 @@ Uint64 AudioOutput::getOverhead() const {
     return _overhd.load(std::memory_order_relaxed);
 }
 
+/**
+ * Returns the health statistics of the device callback.
+ *
+ * These statistics are always recorded, as they only cost two clock
+ * reads per callback. The lateness of a callback is not checked after
+ * the device is paused, deactivated or rebooted.
+ *
+ * @return the health statistics of the device callback.
+ */
+AudioOutput::Telemetry AudioOutput::getTelemetry() const {
+    Telemetry result;
+    result.callbacks = _callbacks.load(std::memory_order_relaxed);
+    result.underruns = _underruns.load(std::memory_order_relaxed);
+    result.late      = _latecalls.load(std::memory_order_relaxed);
+    result.headroom  = _headroom.load(std::memory_order_relaxed);
+    result.minimum   = _minroom.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * Resets the health statistics of the device callback.
+ */
+void AudioOutput::resetTelemetry() {
+    _callbacks.store(0,std::memory_order_relaxed);
+    _underruns.store(0,std::memory_order_relaxed);
+    _latecalls.store(0,std::memory_order_relaxed);
+    _headroom.store(1.0f,std::memory_order_relaxed);
+    _minroom.store(1.0f,std::memory_order_relaxed);
+}
+
 
 #pragma mark -
 #pragma mark Optional Methods
@@ -814,7 +1050,8 @@ Uint64 AudioOutput::getOverhead() const {
  * @return true if the read position was marked.
  */
 bool AudioOutput::mark() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->mark();
     }
@@ -835,7 +1072,8 @@ bool AudioOutput::mark() {
  * @return true if the read position was marked.
  */
 bool AudioOutput::unmark() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->unmark();
     }
@@ -857,7 +1095,8 @@ bool AudioOutput::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioOutput::reset() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->reset();
     }
@@ -879,7 +1118,8 @@ bool AudioOutput::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioOutput::advance(Uint32 frames) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->advance(frames);
     }
@@ -900,7 +1140,8 @@ Sint64 AudioOutput::advance(Uint32 frames) {
  * @return the current frame position of this audio node.
  */
 Sint64 AudioOutput::getPosition() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->getPosition();
     }
@@ -923,7 +1164,8 @@ Sint64 AudioOutput::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioOutput::setPosition(Uint32 position) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->setPosition(position);
     }
@@ -944,7 +1186,8 @@ Sint64 AudioOutput::setPosition(Uint32 position) {
  * @return the elapsed time in seconds.
  */
 double AudioOutput::getElapsed() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->getElapsed();
     }
@@ -967,7 +1210,8 @@ double AudioOutput::getElapsed() const {
  * @return the new elapsed time in seconds.
  */
 double AudioOutput::setElapsed(double time) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->setElapsed(time);
     }
@@ -991,7 +1235,8 @@ double AudioOutput::setElapsed(double time) {
  * @return the remaining time in seconds.
  */
 double AudioOutput::getRemaining() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->getRemaining();
     }
@@ -1016,7 +1261,8 @@ double AudioOutput::getRemaining() const {
  * @return the new remaining time in seconds.
  */
 double AudioOutput::setRemaining(double time) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->setRemaining(time);
     }
@@ -33,6 +33,7 @@
 //
 #include <cugl/audio/graph/CUAudioPanner.h>
 #include <cugl/audio/CUAudioDevices.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
 #include <cmath>
 
@@ -49,7 +50,10 @@ using namespace cugl::audio;
  */
 AudioPanner::AudioPanner() : AudioNode(),
 _field(0),
-_mapper(nullptr) {
+_buffer(nullptr),
+_capacity(0),
+_mapper(nullptr),
+_gains(nullptr) {
     _input = nullptr;
     _classname = "AudioPanner";
 }
@@ -120,6 +124,9 @@ void AudioPanner::dispose() {
     if (_booted) {
         AudioNode::dispose();
         delete[] _mapper;
+        _mapper = nullptr;
+        free(_gains);
+        _gains = nullptr;
         free(_buffer);
         _buffer = nullptr;
         _capacity = 0;
@@ -196,8 +203,16 @@ bool AudioPanner::setField(Uint8 field) {
         return false;
     }
     
+    if (_buffer != nullptr && field > _field) {
+        free(_buffer);
+        _buffer = (float*)malloc(_capacity*field*sizeof(float));
+    }
+    
+    delete[] _mapper;
+    free(_gains);
     _field  = field;
     _mapper = new std::atomic<float>[field*_channels];
+    _gains  = (float*)malloc(field*_channels*sizeof(float));
     for(int ii = 0; ii < field; ii++) {
         for(int jj = 0; jj < _channels; jj++) {
             if (ii == jj) {
@@ -278,27 +293,23 @@ bool AudioPanner::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioPanner::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
     } else {
         frames = std::min(frames,_capacity);
-        std::memset(buffer,0,frames*_channels*sizeof(float));
         Uint32 amt = input->read(_buffer, frames);
-        for(int ii = 0; ii < _field; ii++) {
-            for(int jj = 0; jj < _channels; jj++) {
-                float percent =  _mapper[ii*_channels+jj].load(std::memory_order_relaxed);
-                if (percent > 0) {
-                    float* output = buffer+jj;
-                    float* input  = _buffer+ii;
-                    Uint32 tmp = amt;
-                    while (tmp--) {
-                        *output += *input*percent;
-                        output += _channels;
-                        input += _field;
-                    }
-                }
-            }
+        
+        // Negative pan values are ignored
+        Uint32 size = _field*_channels;
+        for(Uint32 ii = 0; ii < size; ii++) {
+            float percent = _mapper[ii].load(std::memory_order_relaxed);
+            _gains[ii] = percent > 0 ? percent : 0.0f;
+        }
+        dsp::DSPMath::mix_matrix(_buffer,_field,_gains,_channels,buffer,amt);
+        if (amt < frames) {
+            std::memset(buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
         }
         return amt;
     }
@@ -56,16 +56,19 @@ using namespace cugl;
  * The player must be initialized to be used.
  */
 AudioPlayer::AudioPlayer() : AudioNode(),
+_source(nullptr),
+_decoder(nullptr),
 _offset(0),
 _marked(0),
 _buffer(nullptr),
-_decoder(nullptr),
-_source(nullptr),
+_pcm16(nullptr),
 _chunker(nullptr),
+_chksize(0),
 _chklimt(0),
 _chklast(0),
-_chksize(0),
-_dirty(false) {
+_dirty(false),
+_stream(nullptr),
+_underruns(0) {
     _classname = "AudioPlayer";
 }
 
@@ -83,11 +86,22 @@ bool AudioPlayer::init(const std::shared_ptr<AudioSample>& source) {
     if (AudioNode::init(source->getChannels(),source->getRate())) {
         _source = source;
         _buffer = source->getBuffer();
+        _pcm16  = source->getPCM16Buffer();
         _dirty  = false;
         
+        _underruns.store(0);
+        
         // TODO: Require manager active and access buffer from it.
-        _decoder = source->getDecoder();
-        if (source->isStreamed() && _decoder != nullptr) {
+        // In-memory samples never touch the decoder, so do not open the file
+        _decoder = source->isStreamed() ? source->getDecoder() : nullptr;
+        AudioDevices* devices = AudioDevices::get();
+        std::shared_ptr<AudioStreamer> streamer = devices ? devices->getStreamer() : nullptr;
+        if (source->isStreamed() && _decoder != nullptr && streamer != nullptr) {
+            // The streamer thread owns the decoder from now on
+            _stream  = streamer->attach(_decoder);
+            _decoder = nullptr;
+            return _stream != nullptr;
+        } else if (source->isStreamed() && _decoder != nullptr) {
             Uint32 channels = _decoder->getChannels();
             _chksize  = _decoder->getPageSize();
             _chklimt  = _chksize;
@@ -111,9 +125,14 @@ void AudioPlayer::dispose() {
         AudioNode::dispose();
         _source = nullptr;
         _decoder = nullptr;
+        if (_stream) {
+            _stream->close();
+            _stream = nullptr;
+        }
         _offset.store(0);
         _marked.store(0);
         _buffer  = nullptr;
+        _pcm16   = nullptr;
         _calling.store(false);
         _callback = nullptr;
         _chksize = 0;
@@ -147,6 +166,7 @@ void AudioPlayer::dispose() {
  * @return the actual number of frames read
  */
 Uint32 AudioPlayer::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     if (_paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*sizeof(float)*_channels);
         return frames;
@@ -165,6 +185,25 @@ Uint32 AudioPlayer::read(float* buffer, Uint32 frames) {
     
         amt = (Uint32)(off+amt > _source->getLength() ? _source->getLength()-off : amt);
         std::memcpy(buffer,input,sizeof(float)*amt*_source->getChannels());
+    } else if (_pcm16) {
+        Sint16* input = _pcm16;
+        input += off*_source->getChannels();
+        
+        amt = (Uint32)(off+amt > _source->getLength() ? _source->getLength()-off : amt);
+        dsp::DSPMath::decode_pcm16(input,buffer,amt*_source->getChannels());
+    } else if (_stream) {
+        // Only copy here; the streamer thread does all of the decoding
+        amt = (Uint32)(off+amt > _source->getLength() ? _source->getLength()-off : amt);
+        Uint32 got = _stream->read(buffer,off,amt);
+        if (got < amt) {
+            // Stall rather than skip, so the stream resumes where it left off
+            std::memset(buffer+got*_channels,0,(amt-got)*_channels*sizeof(float));
+            _underruns.fetch_add(1,std::memory_order_relaxed);
+            dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,got*_channels);
+            _offset.store(off+got,std::memory_order_release);
+            _polling.store(false);
+            return amt;
+        }
     } else {
         if (_dirty.load(std::memory_order_acquire)) {
             scan(off);
@@ -220,6 +259,9 @@ bool AudioPlayer::completed() {
  */
 bool AudioPlayer::mark() {
     _marked.store(_offset.load(std::memory_order_relaxed),std::memory_order_relaxed);
+    if (_stream) {
+        _stream->setLoopStart(_marked.load(std::memory_order_relaxed));
+    }
     return true;
 }
 
@@ -234,6 +276,9 @@ bool AudioPlayer::mark() {
  */
 bool AudioPlayer::unmark() {
     _marked.store(0,std::memory_order_relaxed);
+    if (_stream) {
+        _stream->setLoopStart(0);
+    }
     return true;
 }
 
@@ -38,6 +38,7 @@
 //
 #include <cugl/audio/graph/CUAudioRedistributor.h>
 #include <cugl/audio/CUAudioDevices.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
 #include <cmath>
 
@@ -277,7 +278,7 @@ static void convert_mono_to_stereo(const float* input, float* output, size_t siz
  */
 static void convert_stereo_to_tri(const float* input, float* output, size_t size) {
     const float *src = (input + size*2);
-    float *dst = (output + size*4);
+    float *dst = (output + size*3);
     float lf, rf;
 
     for (size_t ii = 0; ii < size; ii++) {
@@ -672,12 +673,12 @@ static std::function<void(const float*, float*, size_t)> select_algorithm(Uint8
  */
 AudioRedistributor::AudioRedistributor() :
 _matrix(nullptr),
+_mixtable(nullptr),
 _buffer(nullptr),
 _conduits(0),
 _pagesize(0),
 _matsize(0) {
     _input = nullptr;
-    _director = nullptr;
     _classname = "AudioRedistributor";
 
 }
@@ -771,12 +772,15 @@ void AudioRedistributor::dispose() {
     if (_booted) {
         AudioNode::dispose();
         _input = nullptr;
-        _director = nullptr;
         _pagesize = 0;
         if (_matrix != nullptr) {
             free(_matrix);
             _matrix = nullptr;
         }
+        if (_mixtable != nullptr) {
+            free(_mixtable);
+            _mixtable = nullptr;
+        }
         if (_buffer != nullptr) {
             free(_buffer);
             _buffer = nullptr;
@@ -898,8 +902,8 @@ void AudioRedistributor::setConduits(Uint8 number) {
             _buffer = (float*)malloc(_pagesize*sizeof(float));
         }
         
-        _director = select_algorithm(number, _channels);
         _conduits = number;
+        buildTable();
     }
 }
 
@@ -946,21 +950,13 @@ void AudioRedistributor::setConduits(Uint8 number, const float* matrix) {
             _buffer = (float*)malloc(_pagesize*sizeof(float));
         }
         
-        Uint32 size = (number+1)*_channels;
+        Uint32 size = number*_channels;
         _matrix = (float*)malloc(size*sizeof(float));
         std::memcpy(_matrix,matrix,size*sizeof(float));
 
-        if (number > _channels) {
-            _director = [this](const float* input, float* output, size_t size) {
-                            scaleDown(input,output,size);
-                        };
-        } else {
-            _director = [this](const float* input, float* output, size_t size) {
-                            scaleUp(input,output,size);
-                        };
-        }
         _matsize = size;
         _conduits = number;
+        buildTable();
     }
 }
 
@@ -998,7 +994,7 @@ const float* const AudioRedistributor::getMatrix() {
 void AudioRedistributor::setMatrix(const float* matrix) {
     std::unique_lock<std::mutex> lk(_buffmtex);
     Uint32 size = _conduits;
-    size = (size+1)*_channels;
+    size = size*_channels;
     _matsize = 0;
     if (_matrix != nullptr) {
         free(_matrix);
@@ -1006,8 +1002,8 @@ void AudioRedistributor::setMatrix(const float* matrix) {
     }
     _matrix = (float*)malloc(size*sizeof(float));
     std::memcpy(_matrix,matrix,size*sizeof(float));
-    _director = nullptr;
     _matsize = size;
+    buildTable();
 }
 
 #pragma mark -
@@ -1031,6 +1027,7 @@ void AudioRedistributor::setMatrix(const float* matrix) {
  * @return the actual number of frames read
  */
 Uint32 AudioRedistributor::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     Uint32 take = 0;
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
@@ -1039,7 +1036,7 @@ Uint32 AudioRedistributor::read(float* buffer, Uint32 frames) {
     } else {
         std::unique_lock<std::mutex> lk(_buffmtex);
         // Prevent a subtle race
-        if (_conduits != input->getChannels() || _director == nullptr) {
+        if (_conduits != input->getChannels() || _mixtable == nullptr) {
             std::memset(buffer,0,frames*_channels*sizeof(float));
             take = frames;
         } else {
@@ -1049,11 +1046,11 @@ Uint32 AudioRedistributor::read(float* buffer, Uint32 frames) {
                 if (_buffer != nullptr) {
                     amt = _pagesize < frames-take ? _pagesize : frames-take;
                     amt = input->read(_buffer,amt);
-                    _director(_buffer,_buffer,amt);
+                    remix(_buffer,_buffer,amt);
                     std::memcpy(buffer+take*_channels, _buffer, amt*_channels*sizeof(float));
                 } else {
                     amt = input->read(buffer+take*_channels,amt);
-                    _director(buffer+take*_channels,buffer+take*_channels,amt);
+                    remix(buffer+take*_channels,buffer+take*_channels,amt);
                 }
                 take += amt;
                 abort = (amt == 0);
@@ -1282,44 +1279,55 @@ double AudioRedistributor::setRemaining(double time) {
 #pragma mark Matrix Redistribution
 
 /**
- * Redistribute from buffer input to buffer output
- *
- * The buffer input should have {@link #getConduits()} channels
- * worth of data, while output should support {@link #getChannels()}
- * channels. However, this method is safe to call in-place,
- * provided that the buffer is large enough to support the
- * new output data.
+ * Rebuilds the mixing table for the current channel configuration.
  *
- * This version of the method assumes that output has more channels
- * than input. This distinction is necessary to support in-place
- * redistribution. The value size is specified in terms of frames,
- * not samples, so that it does not include any channel information.
- *
- * @param input     The input buffer
- * @param output    The output buffer
- * @param size      The number of audio frames to process
+ * If there is a redistribution matrix, the table is its transpose.
+ * Otherwise the table is derived from the default conversion for the
+ * two channel counts.  The buffer mutex must be held when this method
+ * is called.
  */
-void AudioRedistributor::scaleUp(const float* input, float* output, size_t size) {
+void AudioRedistributor::buildTable() {
+    if (_mixtable != nullptr) {
+        free(_mixtable);
+        _mixtable = nullptr;
+    }
+    
     Uint32 rows = _channels;
     Uint32 cols = _conduits;
-    Uint32 work = rows*cols;
-    
-    const float* src = input + size*cols;
-    float* dst = output + size*rows;
+    if (rows == 0 || cols == 0) {
+        return;
+    }
     
-    for(size_t ii = 0; ii < size; ii++) {
-        dst -= rows;
-        src -= cols;
-        
+    float* table = (float*)malloc(rows*cols*sizeof(float));
+    if (_matrix != nullptr) {
         for(Uint32 ii = 0; ii < rows; ii++) {
-            float total = 0;
             for (Uint32 jj = 0; jj < cols; jj++) {
-                total += _matrix[ii*cols+jj]*src[jj];
+                table[jj*rows+ii] = _matrix[ii*cols+jj];
             }
-            _matrix[work+ii] = total;
         }
-        std::memcpy(dst, _matrix+work, rows*sizeof(float));
+    } else if (rows == cols) {
+        for(Uint32 ii = 0; ii < rows*cols; ii++) {
+            table[ii] = (ii % (cols+1) == 0) ? 1.0f : 0.0f;
+        }
+    } else {
+        // The conversions are linear, so run them on each basis frame
+        std::function<void(const float*, float*, size_t)> algorithm;
+        algorithm = select_algorithm(cols, rows);
+        if (algorithm == nullptr) {
+            free(table);
+            return;
+        }
+        float input[8];
+        float output[8];
+        for (Uint32 jj = 0; jj < cols; jj++) {
+            std::memset(input, 0,sizeof(input));
+            std::memset(output,0,sizeof(output));
+            input[jj] = 1.0f;
+            algorithm(input,output,1);
+            std::memcpy(table+jj*rows,output,rows*sizeof(float));
+        }
     }
+    _mixtable = table;
 }
 
 /**
@@ -1329,33 +1337,13 @@ void AudioRedistributor::scaleUp(const float* input, float* output, size_t size)
  * worth of data, while output should support {@link #getChannels()}
  * channels. However, this method is safe to call in-place,
  * provided that the buffer is large enough to support the
- * new output data.
- *
- * This version of the method assumes that input has more channels
- * than output. This distinction is necessary to support in-place
- * redistribution. The value size is specified in terms of frames,
+ * new output data. The value size is specified in terms of frames,
  * not samples, so that it does not include any channel information.
  *
  * @param input     The input buffer
  * @param output    The output buffer
  * @param size      The number of audio frames to process
  */
-void AudioRedistributor::scaleDown(const float* input, float* output, size_t size) {
-    Uint32 rows = _channels;
-    Uint32 cols = _conduits;
-    Uint32 work = rows*cols;
-    
-    const float* src = input;
-    float* dst = output;
-    
-    for(size_t ii = 0; ii < size; ii++, dst += rows, src += cols) {
-        for(Uint32 ii = 0; ii < rows; ii++) {
-            float total = 0;
-            for (Uint32 jj = 0; jj < cols; jj++) {
-                total += _matrix[ii*cols+jj]*src[jj];
-            }
-            _matrix[work+ii] = total;
-        }
-        std::memcpy(dst, _matrix+work, rows*sizeof(float));
-    }
+void AudioRedistributor::remix(const float* input, float* output, size_t size) {
+    dsp::DSPMath::mix_matrix(input,_conduits,_mixtable,_channels,output,size);
 }
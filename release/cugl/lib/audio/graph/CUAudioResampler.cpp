@@ -41,7 +41,11 @@
 #include <cugl/audio/CUAudioDevices.h>
 #include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 using namespace cugl::audio;
 
@@ -95,6 +99,48 @@ static double bessel(double x, double err=1.0e-21) {
     return i0;
 }
 
+/**
+ * Returns the greatest common divisor of a and b
+ *
+ * @param a     The first value
+ * @param b     The second value
+ *
+ * @return the greatest common divisor of a and b
+ */
+static Uint32 gcd(Uint32 a, Uint32 b) {
+    while (b != 0) {
+        Uint32 r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+/**
+ * Returns the Catmull-Rom interpolation of four adjacent samples
+ *
+ * The result is between y1 and y2.
+ *
+ * @param y0    The sample before y1
+ * @param y1    The sample at time 0
+ * @param y2    The sample at time 1
+ * @param y3    The sample after y2
+ * @param t     The interpolation time in [0,1)
+ *
+ * @return the Catmull-Rom interpolation of four adjacent samples
+ */
+static inline float cubic(float y0, float y1, float y2, float y3, float t) {
+    float a = 0.5f*(y3-y0)+1.5f*(y1-y2);
+    float b = y0-2.5f*y1+2.0f*y2-0.5f*y3;
+    float c = 0.5f*(y2-y0);
+    return ((a*t+b)*t+c)*t+y1;
+}
+
+#pragma mark -
+#pragma mark Static Attributes
+/** The quality assigned to newly initialized resamplers */
+AudioResampler::Quality AudioResampler::DEFAULT_QUALITY = AudioResampler::Quality::SINC;
+
 #pragma mark -
 #pragma mark Constructors
 /** The default number of zero crossings */
@@ -118,16 +164,9 @@ _inputrate(0),
 _stopband(STOPBAND_ATTEN),
 _zero_cross(ZERO_CROSSINGS),
 _bit_precision(BITS_PER_SAMPLE),
-_per_crossing(0),
-_filter_size(0),
-_filter_table(nullptr),
-_filter_diffs(nullptr),
-_capacity(0),
 _pagesize(0),
-_cvtavail(0),
-_cvtoffset(0.0),
-_cvtbuffer(nullptr) {
-    _input = nullptr;
+_quality(DEFAULT_QUALITY),
+_flush(false) {
     _classname = "AudioResampler";
 }
 
@@ -158,9 +197,11 @@ bool AudioResampler::init() {
  */
 bool AudioResampler::init(Uint8 channels, Uint32 rate) {
     if (AudioNode::init(channels,rate)) {
-        setup();
         _pagesize  = AudioDevices::get()->getReadSize();
         _inputrate = rate;
+        _quality   = DEFAULT_QUALITY;
+        setup();
+        rebuild();
         return true;
     }
     return false;
@@ -180,7 +221,7 @@ bool AudioResampler::init(Uint8 channels, Uint32 rate) {
  */
 bool AudioResampler::init(const std::shared_ptr<AudioNode>& input, Uint32 rate) {
     if (init(input->getChannels(),rate)) {
-        _input = input;
+        attach(input);
         return true;
     }
     return false;
@@ -194,35 +235,16 @@ bool AudioResampler::init(const std::shared_ptr<AudioNode>& input, Uint32 rate)
  */
 void AudioResampler::dispose() {
     if (_booted) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
         AudioNode::dispose();
-        if (_filter_table  != nullptr) {
-            free(_filter_table);
-            _filter_table = nullptr;
-        }
-        if (_filter_diffs  != nullptr) {
-            free(_filter_diffs);
-            _filter_diffs = nullptr;
-        }
-        if (_filter_table  != nullptr) {
-            free(_filter_table);
-            _filter_table = nullptr;
-        }
-        if (_cvtbuffer  != nullptr) {
-            free(_cvtbuffer);
-            _cvtbuffer = nullptr;
-        }
-        _input = nullptr;
-        _capacity  = 0;
+        _input.store(nullptr);
+        _filter.store(nullptr);
+        _kernel = nullptr;
         _pagesize  = 0;
-        _cvtavail  = 0;
-        _cvtoffset = 0;
         _inputrate = 0;
         _stopband  = STOPBAND_ATTEN;
         _zero_cross    = ZERO_CROSSINGS;
         _bit_precision = BITS_PER_SAMPLE;
-        _per_crossing  = 0;
-        _filter_size   = 0;
+        _quality = DEFAULT_QUALITY;
     }
 }
 
@@ -252,18 +274,11 @@ bool AudioResampler::attach(const std::shared_ptr<AudioNode>& node) {
         return false;
     }
     
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
-    Uint32 inrate = _inputrate.load(std::memory_order_relaxed);
-    
-    if (input) {
-        detach();
-    }
-
-    if (node->getRate() != inrate) {
+    // Publish the filter first; the audio thread checks for a mismatch
+    if (node->getRate() != getInputRate()) {
         setInputRate(node->getRate());
     }
-        
-    std::atomic_store_explicit(&_input,node,std::memory_order_relaxed);
+    _input.store(node);
     return true;
 }
 
@@ -281,7 +296,8 @@ std::shared_ptr<AudioNode> AudioResampler::detach() {
         return nullptr;
     }
     
-    std::shared_ptr<AudioNode> result = std::atomic_exchange_explicit(&_input,{},std::memory_order_relaxed);
+    std::shared_ptr<AudioNode> result = getInput();
+    _input.store(nullptr);
     return result;
 }
 
@@ -305,14 +321,8 @@ std::shared_ptr<AudioNode> AudioResampler::detach() {
  * @param value The input sample rate of this filter.
  */
 void AudioResampler::setInputRate(Uint32 value) {
-    std::unique_lock<std::mutex> lk(_buffmtex);
-    _inputrate = value;
-    double cvtratio  = ((double)value)/getRate();
-    size_t buffsize  = _pagesize;
-    _capacity  = std::ceil(buffsize*cvtratio)+2*_zero_cross;
-    _cvtbuffer = (float*)malloc(sizeof(float)*_capacity*getChannels());
-    std::memset(_cvtbuffer, 0, sizeof(float)*_capacity*getChannels());
-    _cvtoffset = _capacity;
+    _inputrate.store(value,std::memory_order_relaxed);
+    rebuild();
 }
 
 /**
@@ -327,11 +337,10 @@ void AudioResampler::setInputRate(Uint32 value) {
  * @param value The ripple factor for this filter in dB
  */
 void AudioResampler::setStopband(float value) {
-    float oldval = getStopband();
-    if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _stopband = value;
+    if (value != getStopband()) {
+        _stopband.store(value,std::memory_order_relaxed);
         setup();
+        rebuild();
     }
 }
 
@@ -352,11 +361,10 @@ void AudioResampler::setStopband(float value) {
  * @param value The bit precision for audio sent to this filter.
  */
 void AudioResampler::setBitPrecision(Uint32 value) {
-    float oldval = getBitPrecision();
-    if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _bit_precision = value;
+    if (value != getBitPrecision()) {
+        _bit_precision.store(value,std::memory_order_relaxed);
         setup();
+        rebuild();
     }
 }
 
@@ -379,14 +387,41 @@ void AudioResampler::setBitPrecision(Uint32 value) {
  * @param value The number of zero-crossings of this filter.
  */
 void AudioResampler::setZeroCrossings(Uint32 value) {
-    float oldval = getZeroCrossings();
-    if (value != oldval) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        _zero_cross = value;
+    if (value != getZeroCrossings()) {
+        _zero_cross.store(value,std::memory_order_relaxed);
         setup();
+        rebuild();
     }
 }
 
+/**
+ * Sets the interpolation quality of this resampler.
+ *
+ * Lower qualities are cheaper, but introduce audible aliasing. Changing
+ * the quality publishes a new filter, which may cause a brief
+ * discontinuity.
+ *
+ * @param value The interpolation quality
+ */
+void AudioResampler::setQuality(Quality value) {
+    if (value != getQuality()) {
+        _quality.store(value,std::memory_order_relaxed);
+        rebuild();
+    }
+}
+
+/**
+ * Clears the filter history of this resampler.
+ *
+ * The resampler keeps the most recent input frames to interpolate across
+ * reads.  This method discards them, so that a new (unrelated) input does
+ * not start with the tail of the previous one.  The history is cleared by
+ * the audio thread at the start of its next read.
+ */
+void AudioResampler::flush() {
+    _flush.store(true,std::memory_order_release);
+}
+
 #pragma mark -
 #pragma mark Playback Control
 /**
@@ -401,8 +436,8 @@ void AudioResampler::setZeroCrossings(Uint32 value) {
  * @return true if this audio node has no more data.
  */
 bool AudioResampler::completed() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
-    return (input == nullptr || input->completed());
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader input = _input.read();
+    return (!input || *input == nullptr || (*input)->completed());
 }
 
 /**
@@ -423,45 +458,54 @@ bool AudioResampler::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_seq_cst);
-    Uint32 inrate = _inputrate.load(std::memory_order_seq_cst);
+    ProfileScope profile(this,frames);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
 
     Uint32 take = 0;
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         take = frames;
-    } if (inrate == getRate()) {
+    } else if (input->getRate() == getRate()) {
         take = input->read(buffer,frames);
     } else {
-        std::unique_lock<std::mutex> lk(_buffmtex);
+        SnapshotPointer<Filter>::Reader state = _filter.read();
+        if (state && _flush.exchange(false,std::memory_order_acquire)) {
+            clearHistory(state.get());
+        }
         // Prevent a subtle race
-        if (inrate != input->getRate()) {
+        if (!state || state->inrate != input->getRate()) {
             std::memset(buffer,0,frames*_channels*sizeof(float));
             take = frames;
+        } else if (state->bank != nullptr || state->quality != Quality::SINC) {
+            take = interpolate(state.get(), input, buffer, frames);
         } else {
+            Filter* filt = state.get();
+            Uint32 zero_cross = filt->kernel->zero_cross;
+            float* cvtbuffer  = filt->buffer.data();
             bool abort = false;
             while (take < frames && !abort) {
                 // Rotate the buffer
-                Uint32 ending = (Uint32)_cvtoffset;
-                Uint32 remain = _capacity-ending-_zero_cross;
-                for(size_t ii = 0; ii < (remain+_zero_cross)*_channels; ii++) {
-                    _cvtbuffer[ii] = _cvtbuffer[ii+ending*_channels];
+                Uint32 ending = (Uint32)filt->offset;
+                Uint32 remain = filt->capacity-ending-zero_cross;
+                for(size_t ii = 0; ii < (remain+zero_cross)*_channels; ii++) {
+                    cvtbuffer[ii] = cvtbuffer[ii+ending*_channels];
                 }
-                _cvtoffset -= ending;
+                filt->offset -= ending;
 
                 // Fill the remaider of the buffer
-                Uint32 amount = input->read(_cvtbuffer+(remain+_zero_cross)*_channels,
-                                            _capacity-remain-_zero_cross);
-                _cvtavail = amount+remain;
+                Uint32 amount = input->read(cvtbuffer+(remain+zero_cross)*_channels,
+                                            filt->capacity-remain-zero_cross);
+                filt->avail = amount+remain;
             
                 // Consume the buffer
-                Uint32 limit = _cvtavail < frames-take ? _cvtavail : frames-take;
+                Uint32 limit = filt->avail < frames-take ? filt->avail : frames-take;
                 if (limit == 0) {
                     abort = true;
                 } else {
                     // Let's do this appropriately
                     for(size_t index = 0; index < limit; index++) {
-                        filter(buffer+(take+index)*_channels, inrate, limit);
+                        filter(filt, buffer+(take+index)*_channels, limit);
                     }
                     take += limit;
                 }
@@ -492,7 +536,8 @@ Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
  * @return true if the read position was marked.
  */
 bool AudioResampler::mark() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->mark();
     }
@@ -513,7 +558,8 @@ bool AudioResampler::mark() {
  * @return true if the read position was marked.
  */
 bool AudioResampler::unmark() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->unmark();
     }
@@ -535,7 +581,8 @@ bool AudioResampler::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioResampler::reset() {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->reset();
     }
@@ -557,7 +604,8 @@ bool AudioResampler::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioResampler::advance(Uint32 frames) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         double ratio =  (double)(_inputrate.load(std::memory_order_relaxed))/getRate();
         return input->advance(std::ceil(frames*ratio));
@@ -579,7 +627,8 @@ Sint64 AudioResampler::advance(Uint32 frames) {
  * @return the current frame position of this audio node.
  */
 Sint64 AudioResampler::getPosition() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         double ratio =  (double)(_inputrate.load(std::memory_order_relaxed))/getRate();
         return std::ceil(input->getPosition()*ratio);
@@ -603,7 +652,8 @@ Sint64 AudioResampler::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioResampler::setPosition(Uint32 position) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         double ratio =  (double)(_inputrate.load(std::memory_order_relaxed))/getRate();
         return input->setPosition(std::ceil(position*ratio));
@@ -625,7 +675,8 @@ Sint64 AudioResampler::setPosition(Uint32 position) {
  * @return the elapsed time in seconds.
  */
 double AudioResampler::getElapsed() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->getElapsed();
     }
@@ -648,7 +699,8 @@ double AudioResampler::getElapsed() const {
  * @return the new elapsed time in seconds.
  */
 double AudioResampler::setElapsed(double time) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->setElapsed(time);
     }
@@ -672,7 +724,8 @@ double AudioResampler::setElapsed(double time) {
  * @return the remaining time in seconds.
  */
 double AudioResampler::getRemaining() const {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->getRemaining();
     }
@@ -697,7 +750,8 @@ double AudioResampler::getRemaining() const {
  * @return the new remaining time in seconds.
  */
 double AudioResampler::setRemaining(double time) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    SnapshotPointer<std::shared_ptr<AudioNode>>::Reader slot = _input.read();
+    AudioNode* input = slot ? slot->get() : nullptr;
     if (input) {
         return input->setRemaining(time);
     }
@@ -715,42 +769,99 @@ double AudioResampler::setRemaining(double time) {
  * does **not** need to be recomputed when the input rate changes.
  */
 void AudioResampler::setup() {
-    // Clean up if we are calling this a second time
-    if (_filter_table != nullptr) {
-        free(_filter_table);
-        _filter_table = nullptr;
-    }
-    if (_filter_diffs != nullptr) {
-        free(_filter_diffs);
-        _filter_diffs = nullptr;
-    }
+    std::shared_ptr<Kernel> kernel = std::make_shared<Kernel>();
 
     // Initialize the new filter
-    _per_crossing = (1 << ((_bit_precision / 2) + 1));
-    _filter_size = ((_per_crossing * _zero_cross) + 1);
+    Uint32 precision  = _bit_precision.load(std::memory_order_relaxed);
+    kernel->zero_cross   = _zero_cross.load(std::memory_order_relaxed);
+    kernel->per_crossing = (1 << ((precision / 2) + 1));
+    kernel->size = ((kernel->per_crossing * kernel->zero_cross) + 1);
 
-    _filter_table = (float*)malloc(sizeof(float)*_filter_size);
-    _filter_diffs = (float*)malloc(sizeof(float)*_filter_size);
-    std::memset(_filter_table, 0, sizeof(float)*_filter_size);
-    std::memset(_filter_diffs, 0, sizeof(float)*_filter_size);
+    size_t filter_size = kernel->size;
+    kernel->table.resize(filter_size,0.0f);
+    kernel->diffs.resize(filter_size,0.0f);
+    float* filter_table = kernel->table.data();
+    float* filter_diffs = kernel->diffs.data();
 
-    size_t lenm1 = _filter_size - 1;
+    size_t lenm1 = filter_size - 1;
     double lenm1div2 = lenm1 / 2.0;
-    double beta = filter_beta(_stopband);
+    double beta = filter_beta(_stopband.load(std::memory_order_relaxed));
     
-    _filter_table[0] = 1.0;
-    for(size_t ii = 1; ii < _filter_size; ii++) {
+    filter_table[0] = 1.0;
+    for(size_t ii = 1; ii < filter_size; ii++) {
         double factor = -((lenm1 - ii) / 2.0) / lenm1div2;
         double kaiser = bessel(beta * sqrt(1.0 - factor*factor)) / bessel(beta);
-        _filter_table[_filter_size - ii] = kaiser;
+        filter_table[filter_size - ii] = kaiser;
     }
     
-    for (size_t ii = 1; ii < _filter_size; ii++) {
-        double x = (M_PI*ii)/_per_crossing;
-        _filter_table[ii] *= sin(x) / x;
-        _filter_diffs[ii-1] = _filter_table[ii] - _filter_table[ii - 1];
+    for (size_t ii = 1; ii < filter_size; ii++) {
+        double x = (M_PI*ii)/kernel->per_crossing;
+        filter_table[ii] *= sin(x) / x;
+        filter_diffs[ii-1] = filter_table[ii] - filter_table[ii - 1];
     }
-    _filter_diffs[lenm1] = 0.0;
+    filter_diffs[lenm1] = 0.0;
+    _kernel = kernel;
+}
+
+/**
+ * Publishes a new filter for the current kernel and input rate.
+ *
+ * The new filter has a fresh intermediate buffer.  The old filter is
+ * released on this thread once the audio thread is done with it.
+ */
+void AudioResampler::rebuild() {
+    Filter* state = new Filter();
+    state->kernel = _kernel;
+    state->inrate = _inputrate.load(std::memory_order_relaxed);
+    state->quality = _quality.load(std::memory_order_relaxed);
+
+    // Reduce the conversion ratio to a fixed number of phases
+    Uint32 divisor = gcd(state->inrate,getRate());
+    state->outstep = divisor ? getRate()/divisor : 1;
+    state->instep  = divisor ? state->inrate/divisor : 1;
+    Uint32 stride = 0;
+    switch (state->quality) {
+        case Quality::LINEAR:
+            state->taps = 2;
+            break;
+        case Quality::CUBIC:
+            state->taps = 4;
+            break;
+        case Quality::SINC:
+            state->bank = acquireBank(state->outstep, state->instep,
+                                      _kernel->zero_cross,
+                                      _stopband.load(std::memory_order_relaxed));
+            state->taps = state->bank ? state->bank->taps : 0;
+            stride = state->bank ? state->bank->stride : 0;
+            break;
+    }
+    
+    if (state->taps > 0) {
+        // The input frames needed for one page (plus the filter window)
+        double cvtratio = ((double)state->instep)/state->outstep;
+        state->rowsize  = (Uint32)std::ceil(_pagesize*cvtratio)+state->taps+1;
+        state->capacity = state->rowsize;
+        state->buffer.resize(state->capacity*getChannels(),0.0f);
+        
+        // Pad each row so a vectorized dot product never leaves the row
+        Uint32 padding = stride > state->taps ? stride-state->taps : 0;
+        state->planar.resize((state->rowsize+padding)*getChannels(),0.0f);
+        state->head  = state->taps/2-1;    // Leading silence centers the window
+        state->base  = 0;
+        state->phase = 0;
+        state->avail = 0;
+        state->offset = 0;
+        _filter.store(state);
+        return;
+    }
+
+    double cvtratio = ((double)state->inrate)/getRate();
+    size_t buffsize = _pagesize;
+    state->capacity = std::ceil(buffsize*cvtratio)+2*_kernel->zero_cross;
+    state->buffer.resize(state->capacity*getChannels(),0.0f);
+    state->avail  = 0;
+    state->offset = state->capacity;
+    _filter.store(state);
 }
 
 /**
@@ -758,29 +869,35 @@ void AudioResampler::setup() {
  *
  * This method processes all of the channels for the current audio frame and
  * stores the results in buffer (in order by channel). The current audio frame
- * is determined by the _cvtoffset value.
+ * is determined by the offset of the filter state.
  *
- * The additional parameters passed to this method are to ensure thread safety.
- * For example, inrate is the input sampling rate at the time of the buffer
- * computation, and not necessarily the current input rate.
+ * The filter state is the snapshot pinned by {@link #read}, and not
+ * necessarily the most recently published one.
  *
+ * @param state     The filter state at the time of computation
  * @param buffer    The buffer to store the audio frame
- * @param inrate    The input rate at the time of computation
  * @param limit     The number of elements in the intermediate buffer
  */
-void AudioResampler::filter(float* buffer, double inrate, Uint32 limit) {
-    Uint32 index = (Uint32)_cvtoffset;
+void AudioResampler::filter(Filter* state, float* buffer, Uint32 limit) {
+    const Kernel* kernel = state->kernel.get();
+    const float* cvtbuffer = state->buffer.data();
+    const float* filter_table = kernel->table.data();
+    const float* filter_diffs = kernel->diffs.data();
+    Uint32 per_crossing = kernel->per_crossing;
+    double inrate = state->inrate;
+
+    Uint32 index = (Uint32)state->offset;
     double currtime =  index / inrate;
     double nexttime = (index + 1) / inrate;
-    index += _zero_cross;
+    index += kernel->zero_cross;
     
-    double interp0 = 1.0 - ((nexttime - (_cvtoffset/inrate)) / (nexttime - currtime));
-    Uint32 filterindex0 = (Uint32)(interp0 * _per_crossing);
+    double interp0 = 1.0 - ((nexttime - (state->offset/inrate)) / (nexttime - currtime));
+    Uint32 filterindex0 = (Uint32)(interp0 * per_crossing);
     double interp1 = 1.0 - interp0;
-    Uint32 filterindex1 = (Uint32)(interp1 * _per_crossing);
+    Uint32 filterindex1 = (Uint32)(interp1 * per_crossing);
     
-    Uint32 leftbound = (Uint32)((_filter_size-filterindex0)/(double)_per_crossing);
-    Uint32 rghtbound = (Uint32)((_filter_size-filterindex1)/(double)_per_crossing);
+    Uint32 leftbound = (Uint32)((kernel->size-filterindex0)/(double)per_crossing);
+    Uint32 rghtbound = (Uint32)((kernel->size-filterindex1)/(double)per_crossing);
     
     Uint32 leftwing = index-leftbound+1;
     Uint32 midpoint = index+1;
@@ -789,21 +906,218 @@ void AudioResampler::filter(float* buffer, double inrate, Uint32 limit) {
     for(Uint32 chan = 0; chan < _channels; chan++) {
         float outsample = 0.0;
 
-        Uint32 leftindex = filterindex0 + ((leftbound-1) * _per_crossing);
+        Uint32 leftindex = filterindex0 + ((leftbound-1) * per_crossing);
         for(Uint32 srcframe = leftwing; srcframe < midpoint; srcframe++) {
-            float insample = _cvtbuffer[srcframe*_channels+chan];
-            outsample += insample * (_filter_table[leftindex] + interp0 * _filter_diffs[leftindex]);
-            leftindex -= _per_crossing;
+            float insample = cvtbuffer[srcframe*_channels+chan];
+            outsample += insample * (filter_table[leftindex] + interp0 * filter_diffs[leftindex]);
+            leftindex -= per_crossing;
         }
         
         Uint32 rightindex = filterindex1;
         for(Uint32 srcframe = midpoint; srcframe < rghtwing; srcframe++) {
-            float insample = _cvtbuffer[srcframe*_channels+chan];
-            outsample += insample * (_filter_table[rightindex] + interp1 * _filter_diffs[rightindex]);
-            rightindex += _per_crossing;
+            float insample = cvtbuffer[srcframe*_channels+chan];
+            outsample += insample * (filter_table[rightindex] + interp1 * filter_diffs[rightindex]);
+            rightindex += per_crossing;
         }
         buffer[chan] = outsample;
     }
-    _cvtoffset += inrate/_sampling;
+    state->offset += inrate/_sampling;
+}
+
+/**
+ * Reads and resamples frames using fixed-ratio interpolation.
+ *
+ * This is the algorithm for every filter except the continuous sinc
+ * filter.  The ratio is tracked exactly as an integer phase, so there
+ * is no drift over long streams.
+ *
+ * @param state     The filter state pinned by {@link #read}
+ * @param input     The input node
+ * @param buffer    The read buffer to store the results
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioResampler::interpolate(Filter* state, AudioNode* input, float* buffer, Uint32 frames) {
+    const Bank* bank = state->bank.get();
+    const Uint32 taps = state->taps;
+    const Uint32 outstep = state->outstep;
+    const Uint32 instep  = state->instep;
+    const size_t rowsize = state->planar.size()/_channels;
+    float* cvtbuffer = state->buffer.data();
+    float* planar = state->planar.data();
+    
+    Uint32 take = 0;
+    while (take < frames) {
+        if (state->base+taps > state->head) {
+            if (state->base > state->head) {
+                // Steep downsampling can step past the history, so skip the
+                // input frames in between before refilling
+                state->base -= state->head;
+                state->head  = 0;
+                Uint32 amount = input->read(cvtbuffer,std::min(state->base,state->rowsize));
+                if (amount == 0) {
+                    break;
+                }
+                state->base -= amount;
+                continue;
+            }
+
+            // Discard the consumed history
+            Uint32 keep = state->head-state->base;
+            if (state->base > 0) {
+                for(Uint32 chan = 0; chan < _channels; chan++) {
+                    float* row = planar+chan*rowsize;
+                    std::memmove(row,row+state->base,keep*sizeof(float));
+                }
+                state->head = keep;
+                state->base = 0;
+            }
+
+            // Refill and de-interleave the history
+            Uint32 amount = input->read(cvtbuffer,state->rowsize-keep);
+            if (amount == 0) {
+                break;
+            }
+            for(Uint32 chan = 0; chan < _channels; chan++) {
+                float* row = planar+chan*rowsize+keep;
+                const float* src = cvtbuffer+chan;
+                for(Uint32 ii = 0; ii < amount; ii++) {
+                    row[ii] = src[ii*_channels];
+                }
+            }
+            state->head = keep+amount;
+            continue;
+        }
+        
+        float* output = buffer+take*_channels;
+        const float* window = planar+state->base;
+        if (bank != nullptr) {
+            const float* coeffs = bank->table.data()+state->phase*bank->stride;
+            for(Uint32 chan = 0; chan < _channels; chan++) {
+                output[chan] = dsp::DSPMath::dot(coeffs, window+chan*rowsize, bank->stride);
+            }
+        } else if (taps == 4) {
+            float t = (float)state->phase/outstep;
+            for(Uint32 chan = 0; chan < _channels; chan++) {
+                const float* row = window+chan*rowsize;
+                output[chan] = cubic(row[0],row[1],row[2],row[3],t);
+            }
+        } else {
+            float t = (float)state->phase/outstep;
+            for(Uint32 chan = 0; chan < _channels; chan++) {
+                const float* row = window+chan*rowsize;
+                output[chan] = row[0]+t*(row[1]-row[0]);
+            }
+        }
+        
+        state->phase += instep;
+        state->base  += state->phase/outstep;
+        state->phase %= outstep;
+        take++;
+    }
+    return take;
+}
+
+/**
+ * Clears the history of the given filter state.
+ *
+ * The state is returned to how it was when the filter was published.
+ *
+ * @param state     The filter state pinned by {@link #read}
+ */
+void AudioResampler::clearHistory(Filter* state) {
+    std::fill(state->buffer.begin(),state->buffer.end(),0.0f);
+    std::fill(state->planar.begin(),state->planar.end(),0.0f);
+    state->avail = 0;
+    if (state->taps > 0) {
+        state->head   = state->taps/2-1;
+        state->base   = 0;
+        state->phase  = 0;
+        state->offset = 0;
+    } else {
+        state->offset = state->capacity;
+    }
+}
+
+/**
+ * Returns the shared polyphase bank for the given ratio and properties.
+ *
+ * Banks are cached for as long as a resampler is using them.  This method
+ * returns nullptr if the ratio has too many phases.
+ *
+ * Each phase is a kaiser-windowed sinc filter centered on a fractional
+ * input position.  When downsampling, the cutoff is lowered to the output
+ * Nyquist frequency, which widens the filter. Every phase is normalized to
+ * unity gain so that the phases do not introduce a ripple of their own.
+ *
+ * @param outstep   The reduced output rate
+ * @param instep    The reduced input rate
+ * @param crossings The number of zero crossings
+ * @param stopband  The filter attenuation in decibels
+ *
+ * @return the shared polyphase bank for the given ratio and properties.
+ */
+std::shared_ptr<const AudioResampler::Bank> AudioResampler::acquireBank(Uint32 outstep, Uint32 instep,
+                                                                         Uint32 crossings, float stopband) {
+    if (outstep == 0 || outstep > RESAMPLER_MAX_PHASES || crossings == 0) {
+        return nullptr;
+    }
+    
+    typedef std::tuple<Uint32,Uint32,Uint32,float> BankKey;
+    static std::mutex lock;
+    static std::map<BankKey,std::weak_ptr<const Bank>> cache;
+    
+    BankKey key(outstep,instep,crossings,stopband);
+    std::lock_guard<std::mutex> guard(lock);
+    std::shared_ptr<const Bank> result = cache[key].lock();
+    if (result != nullptr) {
+        return result;
+    }
+    
+    std::shared_ptr<Bank> bank = std::make_shared<Bank>();
+    double cutoff = instep > outstep ? ((double)outstep)/instep : 1.0;
+    Uint32 halfwidth = (Uint32)std::ceil(crossings/cutoff);
+    bank->phases = outstep;
+    bank->taps   = 2*halfwidth;
+    bank->stride = 4*((bank->taps+3)/4);
+    bank->table.resize(bank->phases*bank->stride,0.0f);
+    
+    double beta = filter_beta(stopband);
+    double norm = bessel(beta);
+    for(Uint32 phase = 0; phase < bank->phases; phase++) {
+        float* row = bank->table.data()+phase*bank->stride;
+        double frac = ((double)phase)/outstep;
+        double total = 0;
+        for(Uint32 tap = 0; tap < bank->taps; tap++) {
+            // Distance (in input frames) from the output position
+            double dist = tap-(halfwidth-1.0)-frac;
+            double ratio = dist/halfwidth;
+            double value = 0;
+            if (ratio > -1.0 && ratio < 1.0) {
+                double x = M_PI*cutoff*dist;
+                double sinc = x == 0 ? 1.0 : std::sin(x)/x;
+                value = cutoff*sinc*bessel(beta*std::sqrt(1.0-ratio*ratio))/norm;
+            }
+            row[tap] = value;
+            total += value;
+        }
+        if (total != 0) {
+            for(Uint32 tap = 0; tap < bank->taps; tap++) {
+                row[tap] = (float)(row[tap]/total);
+            }
+        }
+    }
+    
+    // Drop any expired entries while we have the lock
+    for(auto it = cache.begin(); it != cache.end(); ) {
+        if (it->second.expired()) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    cache[key] = bank;
+    return bank;
 }
 
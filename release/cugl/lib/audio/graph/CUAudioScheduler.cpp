@@ -40,6 +40,9 @@
 
 using namespace cugl::audio;
 
+/** A trim request that removes every node in the queue */
+#define TRIM_ALL    0xFFFFFFFF
+
 #pragma mark Player Queue
 /**
  * Creates an empty player queue
@@ -49,6 +52,7 @@ AudioNodeQueue::AudioNodeQueue() {
     _first = new Entry(std::shared_ptr<AudioNode>(),0);
     _divide.store(_first, std::memory_order_relaxed);
     _last.store(_first, std::memory_order_relaxed);
+    _retain.store(_first, std::memory_order_relaxed);
 }
 
 
@@ -81,10 +85,11 @@ void AudioNodeQueue::push(const std::shared_ptr<AudioNode>& node, Sint32 loops)
     
     // Add the new item
     last->next = new Entry(node,loops);
-    _last.store(last->next, std::memory_order_relaxed);
+    _last.store(last->next, std::memory_order_release);
     
-    // Trim unused nodes
-    while( _first != _divide) {
+    // Trim nodes the consumer is done with
+    Entry* retain = _retain.load(std::memory_order_acquire);
+    while( _first != retain) {
         Entry* tmp = _first;
         _first = _first->next;
         delete tmp;
@@ -106,11 +111,11 @@ void AudioNodeQueue::push(const std::shared_ptr<AudioNode>& node, Sint32 loops)
  * @return true if the operation was successful
  */
 bool AudioNodeQueue::pop(std::shared_ptr<AudioNode>& node, Sint32& loop) {
-    if ( _divide != _last ) {
-        Entry* div = _divide.load(std::memory_order_relaxed);
+    Entry* div = _divide.load(std::memory_order_relaxed);
+    if ( div != _last.load(std::memory_order_acquire) ) {
         node = div->next->value;
         loop = div->next->loops;
-        _divide.store(div->next, std::memory_order_relaxed);
+        _divide.store(div->next, std::memory_order_release);
         return true;
     }
     return false;
@@ -131,8 +136,8 @@ bool AudioNodeQueue::pop(std::shared_ptr<AudioNode>& node, Sint32& loop) {
  * @return true if the operation was successful
  */
 bool AudioNodeQueue::peek(std::shared_ptr<AudioNode>& node, Sint32& loop) const {
-    if ( _divide != _last ) {
-        Entry* div = _divide.load(std::memory_order_relaxed);
+    Entry* div = _divide.load(std::memory_order_acquire);
+    if ( div != _last.load(std::memory_order_acquire) ) {
         node = div->next->value;
         loop = div->next->loops;
         return true;
@@ -154,8 +159,8 @@ bool AudioNodeQueue::peek(std::shared_ptr<AudioNode>& node, Sint32& loop) const
  * @return true if the operation was successful
  */
 bool AudioNodeQueue::fill(std::deque<std::shared_ptr<AudioNode>>& container) const {
-    if ( _divide != _last ) {
-        Entry* div = _divide.load(std::memory_order_relaxed);
+    Entry* div = _divide.load(std::memory_order_acquire);
+    if ( div != _last.load(std::memory_order_acquire) ) {
         while (div->next) {
             div = div->next;
             container.push_back(div->value);
@@ -172,10 +177,18 @@ bool AudioNodeQueue::fill(std::deque<std::shared_ptr<AudioNode>>& container) con
  */
 void AudioNodeQueue::clear() {
     // Defer clean up to push
-    while ( _divide != _last ) {
-        Entry* div = _divide.load(std::memory_order_relaxed);
-        _divide.store(div->next, std::memory_order_relaxed);
-    }
+    _divide.store(_last.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+/**
+ * Allows the producer to delete every entry before the most recent pop.
+ *
+ * Until this method is called, the nodes returned by {@link pop} are
+ * guaranteed to stay alive.  This method is a consumer method.  It should
+ * only be called in the same thread as {@link pop}.
+ */
+void AudioNodeQueue::release() {
+    _retain.store(_divide.load(std::memory_order_relaxed), std::memory_order_release);
 }
 
 
@@ -188,11 +201,14 @@ void AudioNodeQueue::clear() {
  */
 AudioScheduler::AudioScheduler() : AudioNode(),
 _previous(nullptr),
-_buffer(nullptr),
+_active(nullptr),
 _loops(0),
+_overlap(0),
+_buffer(nullptr),
 _qsize(0),
 _qskip(0),
-_overlap(0),
+_qtrim(0),
+_qpurge(false),
 _mempos(-1) {
     _classname = "AudioScheduler";
 }
@@ -255,7 +271,7 @@ bool AudioScheduler::init(Uint8 channels, Uint32 rate) {
  */
 void AudioScheduler::dispose() {
     if (_booted) {
-        clear(true);
+        purge();
         if (_buffer) {
             free(_buffer);
             _buffer = nullptr;
@@ -265,10 +281,10 @@ void AudioScheduler::dispose() {
         _loops = 0;
         _qsize = 0;
         _qskip = 0;
+        _qtrim = 0;
+        _qpurge = false;
         _overlap = 0;
         _mempos = 0;
-        _current  = nullptr;
-        _previous = nullptr;
     }
 }
 
@@ -308,10 +324,10 @@ void AudioScheduler::play(const std::shared_ptr<AudioNode>& node, Sint32 loop) {
                      node->getRate());
         return;
     }
+    // Count first, as the audio thread only decrements on a successful pop
+    Uint32 size = _qsize.fetch_add(1,std::memory_order_acq_rel)+1;
     _queue.push(node,loop);
-    _qsize.exchange(_qsize.load(std::memory_order_relaxed)+1,std::memory_order_release);
-    _qskip.store(_qsize.load(std::memory_order_relaxed),std::memory_order_release);
-
+    _qskip.store(size,std::memory_order_release);
 }
 
 /**
@@ -347,8 +363,8 @@ void AudioScheduler::append(const std::shared_ptr<AudioNode>& node, Sint32 loop)
         return;
     }
     
+    _qsize.fetch_add(1,std::memory_order_acq_rel);
     _queue.push(node,loop);
-    _qsize.store(_qsize.load(std::memory_order_relaxed)+1,std::memory_order_release);
 }
 
 /**
@@ -360,9 +376,9 @@ void AudioScheduler::append(const std::shared_ptr<AudioNode>& node, Sint32 loop)
  * @return the audio node currently being played.
  */
 std::shared_ptr<AudioNode> AudioScheduler::getCurrent() const {
-    // Most compilers do not appear to support an atomic operation here
-    // But the failure mode is acceptable.
-    return _current;
+    // The queue keeps the active node alive until the next push
+    AudioNode* node = _active.load(std::memory_order_acquire);
+    return node == nullptr ? nullptr : node->shared_from_this();
 }
 
 /**
@@ -374,20 +390,17 @@ std::shared_ptr<AudioNode> AudioScheduler::getCurrent() const {
  * nodes removed from the queue (as well as the current node). The complete
  * flag will be false, indicating that they were interrupted.
  *
- * The optional force argument allows for sounds to be purged immediately
- * (such as during clean-up).  However, doing so will not invoke the callback
- * function, even if it is provided.
+ * The optional force argument purges the sounds at the next read without
+ * invoking the callback function, even if it is provided.  It does not
+ * wait for any nodes earlier in the queue.
  *
- * @param force whether to delete the queue immediately, in the current thread
+ * @param force whether to purge the queue without the callback function
  */
 void AudioScheduler::clear(bool force) {
     if (!force) {
         _qskip.store(_qsize.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
     } else {
-        bool orig = _paused.exchange(true,std::memory_order_relaxed);
-        _queue.clear();
-        _current = nullptr;
-        _paused.store(orig, std::memory_order_relaxed);
+        _qpurge.store(true,std::memory_order_release);
     }
 }
 
@@ -435,25 +448,24 @@ void AudioScheduler::skip(Uint32 n) {
 }
 
 /**
- * Empties the queue without stopping the current playback.
+ * Removes nodes from the queue without stopping the current playback.
  *
  * This method is useful when we want to clear the queue, but to smoothly
- * fade-out the current playback.
+ * fade-out the current playback.  The value size is the number of nodes
+ * to remove from the front of the queue.  If it is negative, the queue
+ * is emptied.  The callback function is not invoked for these nodes.
+ *
+ * The nodes are removed at the next read in the audio thread.
+ *
+ * @param size  The number of nodes to remove from the queue
  */
 void AudioScheduler::trim(Sint32 size) {
-    if (size < 0) {
-        _queue.clear();
-    } else {
-        Uint32 qsize = _qsize.load(std::memory_order_relaxed);
-        Sint32 actly = (Sint32)qsize-size;
-        actly = std::max(actly,0);
-        actly = _qsize.exchange(actly,std::memory_order_relaxed);
-        size -= (qsize-actly);
-        std::shared_ptr<AudioNode> result;
-        while(size--) {
-            _queue.pop(result,actly);
-        }
-    }
+    Uint32 amount = size < 0 ? TRIM_ALL : (Uint32)size;
+    Uint32 prev = _qtrim.load(std::memory_order_relaxed);
+    Uint32 next;
+    do {
+        next = amount > TRIM_ALL-prev ? TRIM_ALL : prev+amount;
+    } while (!_qtrim.compare_exchange_weak(prev,next,std::memory_order_release,std::memory_order_relaxed));
 }
 
 /**
@@ -465,10 +477,8 @@ void AudioScheduler::trim(Sint32 size) {
  * return true if the scheduler has an active audio node
  */
 bool AudioScheduler::isPlaying() {
-    // Most compilers do not appear to support an atomic operation here
-    // But the failure mode is acceptable.
     Uint32 size = _qsize.load(std::memory_order_acquire);
-    return _current != nullptr || size > 0;
+    return _active.load(std::memory_order_acquire) != nullptr || size > 0;
 }
 
 /**
@@ -488,7 +498,6 @@ bool AudioScheduler::isPlaying() {
  * @param time  The overlap time in seconds.
  */
 void AudioScheduler::setOverlap(double time) {
-    _previous = nullptr;
     _overlap.store((Uint32)(time*_sampling),std::memory_order_release);
 }
 
@@ -569,6 +578,23 @@ void AudioScheduler::setLoops(Sint32 loop) {
  * @return the actual number of frames read
  */
 Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
+    // Apply the requests from the main thread
+    if (_qpurge.exchange(false,std::memory_order_acquire)) {
+        purge();
+    }
+    Uint32 drop = _qtrim.exchange(0,std::memory_order_acquire);
+    if (drop) {
+        std::shared_ptr<AudioNode> node;
+        Sint32 loop;
+        Uint32 popped = 0;
+        while (drop && _queue.pop(node,loop)) {
+            drop--;
+            popped++;
+        }
+        _qsize.fetch_sub(popped,std::memory_order_acq_rel);
+    }
+
     if (_paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*sizeof(float)*_channels);
         return frames;
@@ -578,9 +604,12 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
     Uint32 skip = _qskip.exchange(0);
     
     Sint32 loop;
+    Uint32 overlap = _overlap.load(std::memory_order_acquire);
+    if (overlap == 0) {
+        _previous = nullptr;
+    }
     std::shared_ptr<AudioNode> previous = _previous;
     std::shared_ptr<AudioNode> current  = acquire(loop,skip,Action::INTERRUPT);
-    Uint32 overlap = _overlap.load(std::memory_order_acquire);
     
     Uint32 amt = 0;
     while (amt < frames && current != nullptr) {
@@ -606,14 +635,14 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
             Uint32 step = std::min((Uint32)remain,overlap);
             while (real--) {
                 float factor = (float)(step)/overlap;
-                *output = *input*factor+*output*(1-factor);
+                *output = (1-factor)*(*output)+factor*(*input);
                 output++;
                 input++;
                 if (real % _channels == 0 && step > 0) {
                     step--;
                 }
             }
-\
+
             // And shift if we are done.
             if (goal >= remain) {
                 if (_calling.load(std::memory_order_relaxed)) {
@@ -627,7 +656,7 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
             if (current->completed()) {
                 current = acquire(loop,1,Action::COMPLETE);
             }
-        } else if (overlap > 0 && loop == 0 && _qsize.load(std::memory_order_acquire)) {
+        } else if (overlap > 0 && loop == 0 && !_queue.empty()) {
             // Check whether we need to overlap
             Sint64 remain = current->getRemaining()*_sampling;
             if (remain >= 0 && remain-overlap <= need) {
@@ -636,8 +665,11 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
                 }
                 _previous = current;
                 previous = _previous;
-                _queue.pop(_current,loop);
-                current = _current;
+                current = nullptr;
+                if (_queue.pop(current,loop)) {
+                    _qsize.fetch_sub(1,std::memory_order_acq_rel);
+                }
+                setCurrent(current);
             } else {
                 amt += current->read(&(buffer[amt*_channels]),need);
                 if (amt < frames || current->completed()) {
@@ -650,7 +682,7 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
             if (loop && amt < frames) {
                 if (!current->reset()) {
                     current = nullptr;
-                    _current = nullptr;
+                    setCurrent(nullptr);
                 } else if (_calling.load(std::memory_order_acquire)) {
                     notify(current,Action::LOOPBACK);
                 }
@@ -666,6 +698,10 @@ Uint32 AudioScheduler::read(float* buffer, Uint32 frames) {
         std::memset(buffer+amt*_channels,0,(frames-amt)*sizeof(float)*_channels);
     }
     
+    // Let the main thread release everything we are done with
+    if (_previous == nullptr) {
+        _queue.release();
+    }
     _loops.store(loop,std::memory_order_relaxed);
     _polling.store(false);
     return frames;
@@ -894,20 +930,21 @@ double AudioScheduler::setElapsed(double time)  {
  * @return the next audio instance for playback
  */
 std::shared_ptr<AudioNode> AudioScheduler::acquire(Sint32& loop, Uint32 skip, AudioNode::Action action) {
-    // Most compilers do not appear to support an atomic operation here
-    // But getting a local variable is good enough.
     std::shared_ptr<AudioNode> result = _current;
-    Uint32 size = _qsize.load(std::memory_order_acquire);
     bool callback = _calling.load(std::memory_order_relaxed);
     bool change = false;
+    Uint32 popped = 0;
     
+    std::shared_ptr<AudioNode> next;
+    Sint32 nextloop;
     loop = _loops.load(std::memory_order_relaxed);
-    while (skip && size) {
+    while (skip && _queue.pop(next,nextloop)) {
         if (result != nullptr && callback) {
             notify(result,action);
         }
-        _queue.pop(result,loop);
-        size--;
+        result = next;
+        loop = nextloop;
+        popped++;
         skip--;
         change = true;
     }
@@ -918,16 +955,53 @@ std::shared_ptr<AudioNode> AudioScheduler::acquire(Sint32& loop, Uint32 skip, Au
         result = nullptr;
         loop = 0;
         change = true;
-    } else if (result == nullptr && size) {
-        _queue.pop(result,loop);
-        size--;
+    } else if (result == nullptr && _queue.pop(next,nextloop)) {
+        result = next;
+        loop = nextloop;
+        popped++;
         change = true;
     }
 
+    if (popped) {
+        _qsize.fetch_sub(popped,std::memory_order_acq_rel);
+    }
     if (change) {
-        _qsize.store(size,std::memory_order_release);
         _loops.store(loop,std::memory_order_relaxed);
-        _current = result;
+        setCurrent(result);
     }
     return result;
 }
+
+/**
+ * Sets the currently active audio node.
+ *
+ * AUDIO THREAD ONLY: This is an internal method for queue management.
+ *
+ * @param node  The currently active audio node
+ */
+void AudioScheduler::setCurrent(const std::shared_ptr<AudioNode>& node) {
+    _current = node;
+    _active.store(node.get(),std::memory_order_release);
+}
+
+/**
+ * Removes all nodes from the queue without invoking the callback.
+ *
+ * AUDIO THREAD ONLY: This is an internal method for queue management.
+ * It is also called by {@link dispose}, when the audio thread can no
+ * longer read from this node.
+ */
+void AudioScheduler::purge() {
+    std::shared_ptr<AudioNode> node;
+    Sint32 loop;
+    Uint32 popped = 0;
+    while (_queue.pop(node,loop)) {
+        popped++;
+    }
+    node = nullptr;
+    _qsize.fetch_sub(popped,std::memory_order_acq_rel);
+    _qskip.store(0,std::memory_order_relaxed);
+    _previous = nullptr;
+    setCurrent(nullptr);
+    _queue.release();
+}
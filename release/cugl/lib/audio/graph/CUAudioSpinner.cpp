@@ -577,6 +577,7 @@ bool AudioSpinner::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioSpinner::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     
     Uint32 take = 0;
@@ -0,0 +1,303 @@
+//
+//  CUAudioStems.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an audio graph node for adaptive music.  It mixes a
+//  fixed set of synchronized stems (layers of the same piece of music), each
+//  with its own gain.  The game sets a target gain for each stem, and the
+//  node ramps to that target on the audio thread.  The ramps are computed
+//  per frame, so they are independent of the game frame rate.
+//
+//  The targets are published to the audio thread as an immutable snapshot.
+//  Changing the targets copies the parameter block and swaps in the new copy,
+//  so the audio thread never waits on the main thread.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/audio/graph/CUAudioStems.h>
+#include <cugl/math/dsp/CUDSPMath.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+using namespace cugl::audio;
+
+#pragma mark Constructors
+/**
+ * Creates a degenerate stem mixer that takes no stems
+ *
+ * The node must be initialized to be used.
+ */
+AudioStems::AudioStems() : AudioMixer(),
+_generation(0) {
+    _classname = "AudioStems";
+}
+
+/**
+ * Initializes the node for the given stems
+ *
+ * The number of channels and the sample rate are those of the first
+ * stem, and all other stems must agree with it.  Every stem starts at
+ * full gain.  There must be at least one stem.
+ *
+ * @param stems     The stems to mix
+ *
+ * @return true if initialization was successful
+ */
+bool AudioStems::init(const std::vector<std::shared_ptr<AudioNode>>& stems) {
+    if (stems.empty() || stems.size() > 255 || stems[0] == nullptr) {
+        CUAssertLog(false, "Stem count %d is out of range", (int)stems.size());
+        return false;
+    }
+    Uint8 width = (Uint8)stems.size();
+    if (!AudioMixer::init(width,stems[0]->getChannels(),stems[0]->getRate())) {
+        return false;
+    }
+
+    Slots* slots = new Slots(width);
+    for(Uint8 ii = 0; ii < width; ii++) {
+        if (stems[ii] == nullptr || stems[ii]->getChannels() != _channels ||
+            stems[ii]->getRate() != _sampling) {
+            CUAssertLog(false, "Stem %d does not match the format of the first stem",ii);
+            delete slots;
+            dispose();
+            return false;
+        }
+        (*slots)[ii] = stems[ii];
+    }
+    _inputs.store(slots);
+
+    Targets* targets = new Targets();
+    targets->gains.resize(width,1.0f);
+    targets->fades.resize(width,0);
+    targets->serials.resize(width,0);
+    _targets.store(targets);
+
+    _current.assign(width,1.0f);
+    _goals.assign(width,1.0f);
+    _serials.assign(width,0);
+    _steps.assign(width,0.0f);
+    _ramps.assign(width,0);
+    _generation = 0;
+    return true;
+}
+
+/**
+ * Disposes any resources allocated for this stem mixer
+ *
+ * The state of the node is reset to that of an uninitialized constructor.
+ * Unlike the destructor, this method allows the node to be reinitialized.
+ */
+void AudioStems::dispose() {
+    if (_booted) {
+        AudioMixer::dispose();
+        _targets.store(nullptr);
+        _current.clear();
+        _goals.clear();
+        _serials.clear();
+        _steps.clear();
+        _ramps.clear();
+        _generation = 0;
+    }
+}
+
+#pragma mark -
+#pragma mark Stem Targets
+/**
+ * Returns the target gain of the given stem
+ *
+ * This is the gain the stem is ramping to, which may not yet be the gain
+ * that is heard.
+ *
+ * @param stem  The stem index
+ *
+ * @return the target gain of the given stem
+ */
+float AudioStems::getTarget(Uint8 stem) const {
+    SnapshotPointer<Targets>::Reader targets = _targets.read();
+    if (targets && stem < targets->gains.size()) {
+        return targets->gains[stem];
+    }
+    return 0;
+}
+
+/**
+ * Sets the target gain of the given stem
+ *
+ * The stem ramps linearly from its current gain to the target over the
+ * given number of seconds.  If fade is 0, the gain changes at the start
+ * of the next buffer.  The other stems keep their current targets.
+ *
+ * @param stem  The stem index
+ * @param gain  The target gain
+ * @param fade  The seconds to reach the target
+ */
+void AudioStems::setTarget(Uint8 stem, float gain, double fade) {
+    CUAssertLog(stem < getWidth(), "Stem %d is out of range",stem);
+    Uint64 frames = (Uint64)(std::max(fade,0.0)*_sampling);
+    _targets.update([&](Targets& targets) {
+        if (stem < targets.gains.size()) {
+            targets.gains[stem] = gain;
+            targets.fades[stem] = frames;
+            targets.serials[stem]++;
+        }
+        targets.generation++;
+    });
+}
+
+/**
+ * Sets the target gains of all of the stems at once
+ *
+ * Each stem ramps linearly from its current gain to its target over the
+ * given number of seconds.  If fade is 0, the gains change at the start
+ * of the next buffer.  The audio thread sees all of the new targets at
+ * the same time.  Any stem without a target in the vector keeps its
+ * current target (and ramp).
+ *
+ * @param gains The target gains
+ * @param fade  The seconds to reach the targets
+ */
+void AudioStems::setTargets(const std::vector<float>& gains, double fade) {
+    Uint64 frames = (Uint64)(std::max(fade,0.0)*_sampling);
+    _targets.update([&](Targets& targets) {
+        size_t size = std::min(gains.size(),targets.gains.size());
+        for(size_t ii = 0; ii < size; ii++) {
+            targets.gains[ii] = gains[ii];
+            targets.fades[ii] = frames;
+            targets.serials[ii]++;
+        }
+        targets.generation++;
+    });
+}
+
+/**
+ * Updates the ramps of each stem for the given parameter block
+ *
+ * AUDIO THREAD ONLY: This is called when the audio thread sees a new
+ * parameter block.  Only the stems whose target was set start a new
+ * ramp; the others continue the ramp they are on.
+ *
+ * @param targets   The new parameter block
+ */
+void AudioStems::retarget(const Targets* targets) {
+    size_t size = std::min(targets->gains.size(),_current.size());
+    for(size_t ii = 0; ii < size; ii++) {
+        if (targets->serials[ii] == _serials[ii]) {
+            continue;
+        }
+        float goal = targets->gains[ii];
+        Uint64 fade = targets->fades[ii];
+        _serials[ii] = targets->serials[ii];
+        _goals[ii] = goal;
+        if (fade == 0 || goal == _current[ii]) {
+            _current[ii] = goal;
+            _steps[ii] = 0;
+            _ramps[ii] = 0;
+        } else {
+            _steps[ii] = (goal-_current[ii])/fade;
+            _ramps[ii] = fade;
+        }
+    }
+    _generation = targets->generation;
+}
+
+#pragma mark -
+#pragma mark Overriden Methods
+/**
+ * Reads up to the specified number of frames into the given buffer
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly, unless
+ * part of a custom audio graph node.
+ *
+ * The buffer should have enough room to store frames * channels elements.
+ * The channels are interleaved into the output buffer.
+ *
+ * Reading the buffer has no affect on the read position.  You must manually
+ * move the frame position forward.  This is to allow for a frame window to
+ * be reread if necessary.
+ *
+ * @param buffer    The read buffer to store the results
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioStems::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
+    std::memset(buffer,0,frames*_channels*sizeof(float));
+    frames = std::min(frames,_capacity);
+    Uint32 actual = 0;
+    if (!_paused.load(std::memory_order_relaxed)) {
+        {
+            SnapshotPointer<Targets>::Reader targets = _targets.read();
+            if (targets && targets->generation != _generation) {
+                retarget(targets.get());
+            }
+        }
+
+        SnapshotPointer<Slots>::Reader slots = _inputs.read();
+        if (slots) {
+            size_t size = std::min(slots->size(),_current.size());
+            for(size_t ii = 0; ii < size; ii++) {
+                const std::shared_ptr<AudioNode>& stem = (*slots)[ii];
+                if (stem == nullptr) {
+                    continue;
+                }
+
+                // Always read, so that silent stems stay in sync
+                Uint32 amt = stem->read(_buffer,frames);
+                actual = std::max(amt,actual);
+                if (amt < frames) {
+                    std::memset(_buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
+                }
+
+                Uint32 done = 0;
+                if (_ramps[ii] > 0) {
+                    done = (Uint32)std::min((Uint64)frames,_ramps[ii]);
+                    float start = _current[ii];
+                    float end = start+_steps[ii]*done;
+                    dsp::DSPMath::slide_add(_buffer,buffer,start,end,buffer,done*_channels);
+                    _ramps[ii] -= done;
+                    _current[ii] = _ramps[ii] == 0 ? _goals[ii] : end;
+                }
+                if (done < frames && _current[ii] != 0) {
+                    dsp::DSPMath::scale_add(_buffer+done*_channels,buffer+done*_channels,
+                                            _current[ii],buffer+done*_channels,
+                                            (frames-done)*_channels);
+                }
+            }
+        }
+        dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,frames*_channels);
+        float knee = _knee.load(std::memory_order_relaxed);
+        if (knee == 1) {
+            dsp::DSPMath::clamp(buffer,-1,1,frames*_channels);
+        } else if (knee > 0) {
+            dsp::DSPMath::ease(buffer,1,knee,frames*_channels);
+        }
+    } else {
+        std::memset(buffer,0,frames*sizeof(float)*_channels);
+        actual = frames;
+    }
+
+    Uint64 pos = _offset.load(std::memory_order_relaxed);
+    _offset.store(pos+actual,std::memory_order_relaxed);
+    return actual;
+}
@@ -282,6 +282,7 @@ bool AudioSynchronizer::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioSynchronizer::read(float* buffer, Uint32 frames) {
+    ProfileScope profile(this,frames);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     _liveStart.store(_waitStart.load(std::memory_order_relaxed),std::memory_order_relaxed);
     _liveDone.store(_waitDone.load(std::memory_order_relaxed),std::memory_order_relaxed);
@@ -62,17 +62,19 @@ Application* Application::_theapp = nullptr;
 Application::Application() :
 _name("CUGL Game"),
 _org("GDIAC"),
-_savesdir(""),
 _assetdir(""),
+_savesdir(""),
 _state(State::NONE),
 _fullscreen(false),
 _highdpi(true),
 _fps(0),
 _vsync(true),
+_clearColor(Color4f::CORNFLOWER), // Ah, XNA
 _funcid(0),
-_clearColor(Color4f::CORNFLOWER) // Ah, XNA
+_deferBudget(DEFAULT_DEFER_BUDGET)
 {
     _display.size.set(DEFAULT_WIDTH,DEFAULT_HEIGHT);
+    resetDeferredStats();
 #if (CU_PLATFORM == CU_PLATFORM_IPHONE || CU_PLATFORM == CU_PLATFORM_ANDROID)
     _fullscreen = true;
 #endif
@@ -98,6 +100,8 @@ void Application::dispose() {
     _highdpi = true;
     _fpswindow.clear();
     _clearColor = Color4f::CORNFLOWER;
+    _deferBudget = DEFAULT_DEFER_BUDGET;
+    resetDeferredStats();
     setFPS(60.0f);
 }
 
@@ -274,6 +278,7 @@ bool Application::step() {
     if (running &&  _state == State::FOREGROUND) {
         processCallbacks((micros)/1000);
         //processCallbacks(millis);
+        processDeferred();
 
         _fpswindow.pop_front();
         _fpswindow.push_back(1000000.0f/micros);
@@ -458,6 +463,93 @@ void Application::processCallbacks(Uint32 millis) {
 }
 
 
+/**
+ * Defers a one-time function to the main thread.
+ *
+ * Unlike {@link schedule}, this method is lock-free and is intended for
+ * worker threads that hand off results to the main thread in bulk, such
+ * as asset loaders.  Deferred work is processed after the scheduled
+ * callbacks, but before the main {@link update} method.
+ *
+ * To keep frames smooth, deferred work is limited to a per-frame time
+ * budget (see {@link setDeferBudget}).  Work that does not fit in the
+ * budget waits for the next frame.  Work is processed in priority order,
+ * and FIFO order within a priority.  Critical work ignores the budget
+ * and is always processed at the next frame.
+ *
+ * This method may be called from any thread.
+ *
+ * @param work      The function to execute on the main thread
+ * @param priority  The priority of this work
+ */
+void Application::defer(std::function<void()> work, TaskScheduler::Priority priority) {
+    _deferred[(int)priority].push(std::move(work));
+}
+
+/**
+ * Resets the accumulated statistics for the deferred work queue.
+ */
+void Application::resetDeferredStats() {
+    _deferStats.executed = 0;
+    _deferStats.pending  = 0;
+    _deferStats.micros = 0;
+    _deferStats.peak  = 0;
+    _deferStats.total = 0;
+    _deferStats.overruns = 0;
+}
+
+/**
+ * Processes the deferred work queue within the frame budget.
+ *
+ * Critical work is always processed in full.  Other work is processed in
+ * priority order until the budget is exhausted, though at least one such
+ * item is processed each frame to guarantee progress.
+ */
+void Application::processDeferred() {
+    Timestamp start;
+    Uint32 executed = 0;
+    std::function<void()> work;
+
+    // Snapshot the critical count so work deferring more work cannot starve the frame
+    MPSCQueue<std::function<void()>>& critical = _deferred[(int)TaskScheduler::Priority::CRITICAL];
+    for(size_t count = critical.size(); count > 0 && critical.pop(work); count--) {
+        work();
+        executed++;
+    }
+
+    bool exhausted = false;
+    for(int level = (int)TaskScheduler::Priority::NORMAL; level < TaskScheduler::PRIORITIES && !exhausted; level++) {
+        while (_deferred[level].pop(work)) {
+            work();
+            executed++;
+            if (_deferBudget) {
+                Timestamp now;
+                if (now.ellapsedMicros(start) >= _deferBudget) {
+                    exhausted = true;
+                    break;
+                }
+            }
+        }
+    }
+    work = nullptr;
+
+    Uint32 pending = 0;
+    for(int level = 0; level < TaskScheduler::PRIORITIES; level++) {
+        pending += (Uint32)_deferred[level].size();
+    }
+
+    Timestamp finish;
+    _deferStats.executed = executed;
+    _deferStats.pending  = pending;
+    _deferStats.micros = finish.ellapsedMicros(start);
+    _deferStats.peak   = std::max(_deferStats.peak,_deferStats.micros);
+    _deferStats.total += executed;
+    if (exhausted && pending > 0) {
+        _deferStats.overruns++;
+    }
+}
+
+
 #pragma mark -
 #pragma mark Initialization Attributes
 /**
@@ -33,6 +33,8 @@
 //
 #include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
+#include <cstring>
+#include <cmath>
 #include "cuDSP128.inl"
 
 using namespace cugl;
@@ -258,6 +260,52 @@ size_t DSPMath::scale_add(float* input1, float* input2, float scalar, float* out
     }
     return size;
 }
+
+/**
+ * Returns the dot product of two input signals
+ *
+ * This is the inner loop of a convolution (such as a polyphase filter).
+ *
+ * @param input1    The first input buffer
+ * @param input2    The second input buffer
+ * @param size      The number of elements to process
+ *
+ * @return the dot product of two input signals
+ */
+float DSPMath::dot(const float* input1, const float* input2, size_t size) {
+    float result = 0;
+    size_t start = 0;
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        __m128 accum = _mm_setzero_ps();
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            accum = _mm_fmadd_ps(_mm_loadu_ps(input1+ii),_mm_loadu_ps(input2+ii),accum);
+        }
+        accum = _mm_add_ps(accum,_mm_movehl_ps(accum,accum));
+        accum = _mm_add_ss(accum,_mm_shuffle_ps(accum,accum,1));
+        result = _mm_cvtss_f32(accum);
+        start = size-(size % 4);
+    }
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        float32x4_t accum = vdupq_n_f32(0);
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            accum = vmlaq_f32(accum,vld1q_f32(input1+ii),vld1q_f32(input2+ii));
+        }
+        result = vaddvq_f32(accum);
+        start = size-(size % 4);
+    }
+#endif
+    for(size_t ii = start; ii < size; ii++) {
+        result += input1[ii]*input2[ii];
+    }
+    return result;
+}
         
         
 #pragma mark -
@@ -572,3 +620,259 @@ size_t DSPMath::ease(float* data, float bound, float knee, size_t size) {
     }
     return size;
 }
+
+#pragma mark -
+#pragma mark Conversion Methods
+/** The scale factor from 16-bit PCM to floats */
+#define PCM16_TO_FLOAT  (1.0f/32768.0f)
+/** The scale factor from floats to 16-bit PCM */
+#define FLOAT_TO_PCM16  32767.0f
+
+/**
+ * Converts 16-bit PCM samples to floats, storing the result in output
+ *
+ * The samples are scaled to the range [-1,1).
+ *
+ * @param input     The input buffer
+ * @param output    The output buffer
+ * @param size      The number of elements to convert
+ *
+ * @return the number of elements successfully converted
+ */
+size_t DSPMath::decode_pcm16(const Sint16* input, float* output, size_t size) {
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        const __m128 gain = _mm_set1_ps(PCM16_TO_FLOAT);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            __m128i pcm = _mm_loadu_si128((const __m128i*)(input+ii));
+            __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(pcm,pcm),16);
+            __m128i hgh = _mm_srai_epi32(_mm_unpackhi_epi16(pcm,pcm),16);
+            _mm_storeu_ps(output+ii,   _mm_mul_ps(_mm_cvtepi32_ps(low),gain));
+            _mm_storeu_ps(output+ii+4, _mm_mul_ps(_mm_cvtepi32_ps(hgh),gain));
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(int ii = (Uint32)(size-rem); ii < size; ii++) {
+                output[ii] = input[ii]*PCM16_TO_FLOAT;
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        const float32x4_t gain = vdupq_n_f32(PCM16_TO_FLOAT);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            int16x8_t pcm = vld1q_s16(input+ii);
+            float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm)));
+            float32x4_t hgh = vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm)));
+            vst1q_f32(output+ii,   vmulq_f32(low,gain));
+            vst1q_f32(output+ii+4, vmulq_f32(hgh,gain));
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(int ii = (Uint32)(size-rem); ii < size; ii++) {
+                output[ii] = input[ii]*PCM16_TO_FLOAT;
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        for(int ii = 0; ii < size; ii++) {
+            output[ii] = input[ii]*PCM16_TO_FLOAT;
+        }
+    }
+    return size;
+}
+
+/**
+ * Converts floats to 16-bit PCM samples, storing the result in output
+ *
+ * Values outside of the range [-1,1] are clamped, and all values are
+ * rounded to the nearest sample.
+ *
+ * @param input     The input buffer
+ * @param output    The output buffer
+ * @param size      The number of elements to convert
+ *
+ * @return the number of elements successfully converted
+ */
+size_t DSPMath::encode_pcm16(const float* input, Sint16* output, size_t size) {
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        const __m128 gain = _mm_set1_ps(FLOAT_TO_PCM16);
+        const __m128 vmin = _mm_set1_ps(-1.0f);
+        const __m128 vmax = _mm_set1_ps( 1.0f);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+ii),vmin),vmax);
+            __m128 hgh = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input+ii+4),vmin),vmax);
+            __m128i pcm = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(low,gain)),
+                                          _mm_cvtps_epi32(_mm_mul_ps(hgh,gain)));
+            _mm_storeu_si128((__m128i*)(output+ii),pcm);
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(int ii = (Uint32)(size-rem); ii < size; ii++) {
+                float value = std::min(std::max(input[ii],-1.0f),1.0f);
+                output[ii] = (Sint16)std::lrint(value*FLOAT_TO_PCM16);
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        const float32x4_t gain = vdupq_n_f32(FLOAT_TO_PCM16);
+        const float32x4_t vmin = vdupq_n_f32(-1.0f);
+        const float32x4_t vmax = vdupq_n_f32( 1.0f);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            float32x4_t low = vminq_f32(vmaxq_f32(vld1q_f32(input+ii),vmin),vmax);
+            float32x4_t hgh = vminq_f32(vmaxq_f32(vld1q_f32(input+ii+4),vmin),vmax);
+            int16x4_t pcm0 = vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(low,gain)));
+            int16x4_t pcm1 = vqmovn_s32(vcvtnq_s32_f32(vmulq_f32(hgh,gain)));
+            vst1q_s16(output+ii,vcombine_s16(pcm0,pcm1));
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(int ii = (Uint32)(size-rem); ii < size; ii++) {
+                float value = std::min(std::max(input[ii],-1.0f),1.0f);
+                output[ii] = (Sint16)std::lrint(value*FLOAT_TO_PCM16);
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        for(int ii = 0; ii < size; ii++) {
+            float value = std::min(std::max(input[ii],-1.0f),1.0f);
+            output[ii] = (Sint16)std::lrint(value*FLOAT_TO_PCM16);
+        }
+    }
+    return size;
+}
+
+#pragma mark -
+#pragma mark Channel Methods
+/**
+ * Mixes interleaved input channels into interleaved output channels
+ *
+ * The matrix has a row for each input channel and a column for each
+ * output channel. Hence matrix[ii*outchan+jj] is the gain applied to
+ * input channel ii when it is added to output channel jj. This is the
+ * transpose of the usual redistribution matrix, as it allows the vector
+ * version to process all of the output channels of a frame at once.
+ *
+ * It is safe for output to be the same as input.  If there are more
+ * output channels than input channels, the frames are processed from
+ * back to front to support this.  Neither count may exceed
+ * {@link DSP_MAX_CHANNELS}.
+ *
+ * @param input     The input buffer
+ * @param inchan    The number of input channels
+ * @param matrix    The inchan x outchan gain matrix
+ * @param outchan   The number of output channels
+ * @param output    The output buffer
+ * @param frames    The number of audio frames to mix
+ *
+ * @return the number of frames successfully mixed
+ */
+size_t DSPMath::mix_matrix(const float* input, Uint32 inchan, const float* matrix,
+                           Uint32 outchan, float* output, size_t frames) {
+    CUAssertLog(inchan <= DSP_MAX_CHANNELS && outchan <= DSP_MAX_CHANNELS,
+                "Channel counts %d x %d exceed the maximum", inchan, outchan);
+    // Every input frame is read before its output frame is written
+    bool reverse = outchan > inchan;
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE && outchan <= 8) {
+        // Pad each row to two vectors so the loads are uniform
+        float table[DSP_MAX_CHANNELS*8];
+        for(Uint32 ii = 0; ii < inchan; ii++) {
+            for(Uint32 jj = 0; jj < 8; jj++) {
+                table[ii*8+jj] = jj < outchan ? matrix[ii*outchan+jj] : 0.0f;
+            }
+        }
+        for(size_t kk = 0; kk < frames; kk++) {
+            size_t frame = reverse ? frames-kk-1 : kk;
+            const float* src = input+frame*inchan;
+            float* dst = output+frame*outchan;
+            __m128 low = _mm_setzero_ps();
+            __m128 hgh = _mm_setzero_ps();
+            for(Uint32 ii = 0; ii < inchan; ii++) {
+                __m128 value = _mm_set1_ps(src[ii]);
+                low = _mm_add_ps(low,_mm_mul_ps(value,_mm_loadu_ps(table+ii*8)));
+                if (outchan > 4) {
+                    hgh = _mm_add_ps(hgh,_mm_mul_ps(value,_mm_loadu_ps(table+ii*8+4)));
+                }
+            }
+            if (outchan > 4) {
+                _mm_storeu_ps(dst,low);
+                _mm_storepart_ps(dst+4,hgh,outchan-4);
+            } else {
+                _mm_storepart_ps(dst,low,outchan);
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && outchan <= 8 && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE && outchan <= 8) {
+#endif
+        // Pad each row to two vectors so the loads are uniform
+        float table[DSP_MAX_CHANNELS*8];
+        for(Uint32 ii = 0; ii < inchan; ii++) {
+            for(Uint32 jj = 0; jj < 8; jj++) {
+                table[ii*8+jj] = jj < outchan ? matrix[ii*outchan+jj] : 0.0f;
+            }
+        }
+        for(size_t kk = 0; kk < frames; kk++) {
+            size_t frame = reverse ? frames-kk-1 : kk;
+            const float* src = input+frame*inchan;
+            float* dst = output+frame*outchan;
+            float32x4_t low = vdupq_n_f32(0.0f);
+            float32x4_t hgh = vdupq_n_f32(0.0f);
+            for(Uint32 ii = 0; ii < inchan; ii++) {
+                float32x4_t value = vdupq_n_f32(src[ii]);
+                low = vmlaq_f32(low,value,vld1q_f32(table+ii*8));
+                if (outchan > 4) {
+                    hgh = vmlaq_f32(hgh,value,vld1q_f32(table+ii*8+4));
+                }
+            }
+            if (outchan > 4) {
+                vst1q_f32(dst,low);
+                vst1q_part_f32(dst+4,hgh,outchan-4);
+            } else {
+                vst1q_part_f32(dst,low,outchan);
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        float total[DSP_MAX_CHANNELS];
+        for(size_t kk = 0; kk < frames; kk++) {
+            size_t frame = reverse ? frames-kk-1 : kk;
+            const float* src = input+frame*inchan;
+            float* dst = output+frame*outchan;
+            for(Uint32 jj = 0; jj < outchan; jj++) {
+                total[jj] = 0.0f;
+            }
+            for(Uint32 ii = 0; ii < inchan; ii++) {
+                const float* row = matrix+ii*outchan;
+                for(Uint32 jj = 0; jj < outchan; jj++) {
+                    total[jj] += row[jj]*src[ii];
+                }
+            }
+            std::memcpy(dst,total,outchan*sizeof(float));
+        }
+    }
+    return frames;
+}
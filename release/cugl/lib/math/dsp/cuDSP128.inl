@@ -61,6 +61,34 @@ static inline __m128 _mm_skipload_ps(float* src, size_t stride) {
     return result;
 }
 
+/**
+ * Stores the first size elements of a __m128 float vector into an array
+ *
+ * Elements past size are not written, so this is safe at the end of a buffer
+ * or when the array is also being read (such as an in-place conversion).
+ *
+ * @param dst       The destination array
+ * @param src       The float vector
+ * @param size      The number of elements to store (at most 4)
+ */
+static inline void _mm_storepart_ps(float* dst, __m128 src, size_t size) {
+    switch (size) {
+        case 4:
+            _mm_storeu_ps(dst, src);
+            break;
+        case 3:
+            _mm_storel_pi((__m64*)dst, src);
+            _mm_store_ss(dst+2, _mm_movehl_ps(src, src));
+            break;
+        case 2:
+            _mm_storel_pi((__m64*)dst, src);
+            break;
+        case 1:
+            _mm_store_ss(dst, src);
+            break;
+    }
+}
+
 #elif defined (CU_MATH_VECTOR_NEON64)
 /**
  * Stores a float32x4_t vector into a strided array
@@ -114,4 +142,32 @@ static inline float32x2_t vld1_skip_f32(float* src, size_t stride) {
     return result;
 }
 
+/**
+ * Stores the first size elements of a float32x4_t vector into an array
+ *
+ * Elements past size are not written, so this is safe at the end of a buffer
+ * or when the array is also being read (such as an in-place conversion).
+ *
+ * @param dst       The destination array
+ * @param src       The float vector
+ * @param size      The number of elements to store (at most 4)
+ */
+static inline void vst1q_part_f32(float* dst, float32x4_t src, size_t size) {
+    switch (size) {
+        case 4:
+            vst1q_f32(dst, src);
+            break;
+        case 3:
+            vst1_f32(dst, vget_low_f32(src));
+            vst1q_lane_f32(dst+2, src, 2);
+            break;
+        case 2:
+            vst1_f32(dst, vget_low_f32(src));
+            break;
+        case 1:
+            vst1q_lane_f32(dst, src, 0);
+            break;
+    }
+}
+
 #endif
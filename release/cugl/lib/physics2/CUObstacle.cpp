@@ -63,7 +63,12 @@ using namespace cugl::physics2;
 Obstacle::Obstacle() :
 _scene(nullptr),
 _debug(nullptr),
-_listener(nullptr)
+_listener(nullptr),
+_slot((size_t)-1),
+_always(false),
+_wasAwake(true),
+_synced(false),
+_syncAngle(0)
 { }
 
 /**
@@ -48,6 +48,13 @@
 #include <box2d/b2_collision.h>
 #include <cugl/physics2/CUObstacleWorld.h>
 #include <cugl/physics2/CUObstacle.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/io/CUTextWriter.h>
+#include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUStrings.h>
+#include <cugl/util/CUTimestamp.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace cugl;
 using namespace cugl::physics2;
@@ -153,6 +160,53 @@ public:
 };
 
 
+/**
+ * A b2TaskExecutor proxy for a TaskScheduler.
+ *
+ * The range is split into one chunk per worker (plus the calling thread).
+ * The calling thread executes the first chunk and then helps with the rest,
+ * so the step never waits on an idle scheduler.
+ */
+class SchedulerProxy : public b2TaskExecutor {
+public:
+    /** The scheduler to run the tasks */
+    std::shared_ptr<TaskScheduler> scheduler;
+
+    /**
+     * Creates a new proxy for the given scheduler
+     *
+     * @param scheduler The scheduler to run the tasks
+     */
+    SchedulerProxy(const std::shared_ptr<TaskScheduler>& scheduler) : scheduler(scheduler) {}
+
+    /**
+     * Executes the task over [0, count), returning when every range is done.
+     *
+     * @param count     The number of items
+     * @param minRange  The minimum number of items in a range
+     * @param task      The task to execute
+     */
+    void ParallelFor(int32 count, int32 minRange, b2RangeTask* task) override {
+        int32 chunks = (int32)scheduler->size()+1;
+        chunks = std::max(1,std::min(chunks,count/std::max(minRange,1)));
+        if (chunks == 1 || scheduler->isStopped()) {
+            task->Execute(0,count);
+            return;
+        }
+
+        std::shared_ptr<TaskGroup> group = TaskGroup::alloc();
+        for(int32 ii = 1; ii < chunks; ii++) {
+            int32 begin = (int32)(((Sint64)count*ii)/chunks);
+            int32 end = (int32)(((Sint64)count*(ii+1))/chunks);
+            scheduler->addTask([=] { task->Execute(begin,end); },
+                               TaskScheduler::Priority::CRITICAL, group);
+        }
+        task->Execute(0,count/chunks);
+        scheduler->wait(group);
+    }
+};
+
+
 #pragma mark -
 #pragma mark Constructors
 
@@ -165,12 +219,14 @@ ObstacleWorld::ObstacleWorld() :
 _world(nullptr),
 _collide(false),
 _filters(false),
-_destroy(false) {
+_destroy(false),
+_profiling(false) {
     _lockstep   = false;
     _stepssize  = DEFAULT_WORLD_STEP;
     _itvelocity = DEFAULT_WORLD_VELOC;
     _itposition = DEFAULT_WORLD_POSIT;
     _gravity = Vec2(0,DEFAULT_GRAVITY);
+    std::memset(&_profile,0,sizeof(Profile));
     
     onBeginContact = nullptr;
     onEndContact   = nullptr;
@@ -190,6 +246,10 @@ void ObstacleWorld::dispose() {
         delete _world;
         _world  = nullptr;
     }
+    _executor = nullptr;
+    _scheduler = nullptr;
+    closeProfileLog();
+    _profiling = false;
     onBeginContact = nullptr;
     onEndContact   = nullptr;
     beforeSolve    = nullptr;
@@ -234,6 +294,7 @@ bool ObstacleWorld::init(const Rect bounds, const Vec2 gravity) {
     _bounds = bounds;
     _world = new b2World(b2Vec2(gravity.x,gravity.y));
     if (_world) {
+        _world->SetTaskExecutor(_executor.get());
         return true;
     }
     return false;
@@ -257,6 +318,9 @@ bool ObstacleWorld::init(const Rect bounds, const Vec2 gravity) {
  */
 void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
     CUAssertLog(inBounds(obj.get()), "Obstacle is not in bounds");
+    obj->_slot = _objects.size();
+    obj->_wasAwake = true;
+    obj->_synced = false;
     _objects.push_back(obj);
     obj->activatePhysics(*_world);
 }
@@ -267,25 +331,79 @@ void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
  * The object will be released immediately.  If no more objects assert ownership,
  * then the object will be garbage collected.
  *
- * This method of removing objects is very heavy weight, and should only be used
- * for single object removal.  If you want to remove multiple objects, then you
- * should mark them for removal and call garbageCollect.
+ * This takes constant time, as the last obstacle is moved into the slot of the
+ * removed one.  Hence this changes the order of {@link #getObstacles}.
+ *
+ * This method should not be called during a step of the physics world (e.g.
+ * in a collision callback).  Use {@link #deferRemoval} instead.
  *
  * param obj The object to remove
  *
  * @release a reference to the obstacle
  */
 void ObstacleWorld::removeObstacle(Obstacle* obj) {
-    for(auto it = _objects.begin(); it != _objects.end(); ++it) {
-        if (it->get() == obj) {
-            obj->deactivatePhysics(*_world);
-            _objects.erase(it);
-            return;
-        }
+    size_t slot = obj->_slot;
+    if (slot < _objects.size() && _objects[slot].get() == obj) {
+        removeSlot(slot);
+        return;
     }
     CUAssertLog(false, "Physics object not present in world");
 }
 
+/**
+ * Removes an obstacle from the physics world at the next update
+ *
+ * The queued obstacles are removed in one pass, both before and after the
+ * Box2D step of {@link #update}.  Hence an obstacle queued by game logic
+ * is never simulated again, and an obstacle queued in a collision callback
+ * is removed before the obstacles are updated.  The world retains the
+ * obstacle until then.  Queueing an obstacle more than once, or removing
+ * it immediately afterwards, is safe.
+ *
+ * param obj The obstacle to remove
+ */
+void ObstacleWorld::deferRemoval(Obstacle* obj) {
+    size_t slot = obj->_slot;
+    if (slot < _objects.size() && _objects[slot].get() == obj) {
+        _removals.push_back(_objects[slot]);
+        return;
+    }
+    CUAssertLog(false, "Physics object not present in world");
+}
+
+/**
+ * Removes the obstacle in the given slot
+ *
+ * The last obstacle is moved into the slot, so this takes constant time.
+ *
+ * @param slot  The slot of the obstacle to remove
+ */
+void ObstacleWorld::removeSlot(size_t slot) {
+    Obstacle* obj = _objects[slot].get();
+    obj->deactivatePhysics(*_world);
+    obj->_slot = (size_t)-1;
+    if (slot+1 < _objects.size()) {
+        _objects[slot] = std::move(_objects.back());
+        _objects[slot]->_slot = slot;
+    }
+    _objects.pop_back();
+}
+
+/**
+ * Removes all obstacles queued by {@link #deferRemoval}
+ */
+void ObstacleWorld::applyRemovals() {
+    for(auto it = _removals.begin(); it != _removals.end(); ++it) {
+        Obstacle* obj = it->get();
+        size_t slot = obj->_slot;
+        // Skip obstacles queued twice or already removed
+        if (slot < _objects.size() && _objects[slot].get() == obj) {
+            removeSlot(slot);
+        }
+    }
+    _removals.clear();
+}
+
 /**
  * Remove all objects marked for removal.
  *
@@ -300,10 +418,12 @@ void ObstacleWorld::garbageCollect() {
     for(size_t ii = 0; ii < _objects.size(); ii++) {
         if (_objects[ii]->isRemoved()) {
             _objects[ii]->deactivatePhysics(*_world);
+            _objects[ii]->_slot = (size_t)-1;
             _objects[ii] = nullptr;
         } else {
             if (pos != ii) {
                 _objects[pos] = _objects[ii];
+                _objects[pos]->_slot = pos;
                 _objects[ii]  = nullptr;
             }
             pos++;
@@ -323,14 +443,41 @@ void ObstacleWorld::clear() {
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
         obj->deactivatePhysics(*_world);
+        obj->_slot = (size_t)-1;
     }
     _objects.clear();
+    _removals.clear();
     update(0);
 }
 
 
 #pragma mark -
 #pragma mark Physics Handling
+/**
+ * Sets the scheduler for the parallel parts of the physics step.
+ *
+ * When there is a scheduler, the narrow-phase of the contacts (computing
+ * the contact manifolds) is split across its workers.  The calling thread
+ * helps, and waits until it is done.  The contact callbacks are still
+ * executed on the calling thread, in the same order as a single threaded
+ * step, and the simulation is identical.  Only the workload changes.
+ *
+ * Set this to nullptr to run the step on the calling thread only.
+ *
+ * @param scheduler The scheduler for the parallel parts of the step
+ */
+void ObstacleWorld::setScheduler(const std::shared_ptr<TaskScheduler>& scheduler) {
+    _scheduler = scheduler;
+    if (scheduler == nullptr) {
+        _executor = nullptr;
+    } else {
+        _executor.reset(new SchedulerProxy(scheduler));
+    }
+    if (_world != nullptr) {
+        _world->SetTaskExecutor(_executor.get());
+    }
+}
+
 
 /**
  * Sets the global gravity vector.
@@ -358,17 +505,79 @@ void ObstacleWorld::setGravity(const Vec2 gravity) {
  * physics.  The primary method is the step() method in world.  This implementation
  * works for all applications and should not need to be overwritten.
  *
+ * Only obstacles that have moved since their last update are updated after
+ * the step (see {@link Obstacle#setAlwaysUpdated}).  Static and sleeping
+ * obstacles are skipped.
+ *
  * @param delta Number of seconds since last animation frame
  */
 void ObstacleWorld::update(float dt) {
+    Timestamp start;
+    if (_profiling) {
+        _profile.callbacks = 0;
+        _profile.updated = 0;
+    }
+
+    // Remove anything queued since the last step
+    applyRemovals();
+
     // Turn the physics engine crank.
     _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+
+    // Remove anything queued by the collision callbacks
+    applyRemovals();
     
-    // Post process all objects after physics (this updates graphics)
+    // Post process the moving objects after physics (this updates graphics)
+    Timestamp sync;
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
-        obj->update(dt);
+        if (isMoving(obj)) {
+            obj->update(dt);
+            _profile.updated++;
+        }
+    }
+
+    if (_profiling) {
+        Timestamp end;
+        recordProfile(Timestamp::ellapsedMicros(sync,end),Timestamp::ellapsedMicros(start,end));
+    }
+}
+
+/**
+ * Returns true if the obstacle must be updated after this step
+ *
+ * An obstacle is updated if it is always updated, if its shape is dirty,
+ * or if its body has moved since its last update.  Static bodies never
+ * move, and sleeping bodies only need one update after they fall asleep.
+ * Hence only the moving obstacles pay for the (virtual) update.
+ *
+ * @param obj   The obstacle to check
+ *
+ * @return true if the obstacle must be updated after this step
+ */
+bool ObstacleWorld::isMoving(Obstacle* obj) {
+    if (obj->_always || obj->isDirty()) {
+        return true;
+    } else if (obj->_synced && obj->getBodyType() == b2_staticBody) {
+        return false;
     }
+
+    // A body that fell asleep this step gets one last update
+    bool awake = obj->isAwake();
+    if (obj->_synced && !awake && !obj->_wasAwake) {
+        return false;
+    }
+    obj->_wasAwake = awake;
+
+    Vec2 pos = obj->getPosition();
+    float angle = obj->getAngle();
+    if (obj->_synced && pos == obj->_syncPosition && angle == obj->_syncAngle) {
+        return false;
+    }
+    obj->_synced = true;
+    obj->_syncPosition = pos;
+    obj->_syncAngle = angle;
+    return true;
 }
 
 /**
@@ -388,6 +597,101 @@ bool ObstacleWorld::inBounds(Obstacle* obj) {
     return horiz && vert;
 }
 
+#pragma mark -
+#pragma mark Profiling
+/**
+ * Sets whether each physics step is measured.
+ *
+ * Profiling is disabled by default.  When enabled, each step is timed and
+ * the bodies and contacts are counted, which costs a pass over both.
+ * Profiling cannot be disabled while a profile log is open.
+ *
+ * @param value Whether each physics step is measured
+ */
+void ObstacleWorld::setProfiling(bool value) {
+    _profiling = value || _profileLog != nullptr;
+    std::memset(&_profile,0,sizeof(Profile));
+}
+
+/**
+ * Starts logging the measurements of each step to a CSV file.
+ *
+ * This enables profiling.  The file starts with a header row, and has
+ * one row per step until {@link #closeProfileLog} is called.  Relative
+ * paths are written to the application save directory.
+ *
+ * @param file  The path to the CSV file
+ *
+ * @return true if the file was opened successfully
+ */
+bool ObstacleWorld::openProfileLog(const std::string& file) {
+    closeProfileLog();
+    std::string path = file;
+    if (!filetool::is_absolute(file)) {
+        path = Application::get()->getSaveDirectory()+file;
+    }
+    _profileLog = TextWriter::alloc(path);
+    if (_profileLog == nullptr) {
+        return false;
+    }
+    _profileLog->writeLine("step_ms,broadphase_ms,narrowphase_ms,solve_ms,toi_ms,callbacks_ms,sync_ms,"
+                           "bodies,awake,contacts,touching,updated");
+    setProfiling(true);
+    return true;
+}
+
+/**
+ * Stops logging the measurements of each step, closing the CSV file.
+ *
+ * Profiling stays enabled.
+ */
+void ObstacleWorld::closeProfileLog() {
+    if (_profileLog != nullptr) {
+        _profileLog->close();
+        _profileLog = nullptr;
+    }
+}
+
+/**
+ * Measures the last step, after the Box2d step and obstacle updates
+ *
+ * @param sync  The microseconds updating the obstacles
+ * @param total The microseconds of the entire update
+ */
+void ObstacleWorld::recordProfile(Uint64 sync, Uint64 total) {
+    const b2Profile& profile = _world->GetProfile();
+    _profile.step = total/1000.0f;
+    _profile.broadphase = profile.broadphase;
+    _profile.narrowphase = profile.collide;
+    _profile.solve = profile.solve;
+    _profile.solveTOI = profile.solveTOI;
+    _profile.sync = sync/1000.0f;
+
+    _profile.bodies = (Uint32)_world->GetBodyCount();
+    _profile.awake = 0;
+    for(b2Body* body = _world->GetBodyList(); body != nullptr; body = body->GetNext()) {
+        if (body->IsAwake() && body->GetType() != b2_staticBody) {
+            _profile.awake++;
+        }
+    }
+    _profile.contacts = (Uint32)_world->GetContactCount();
+    _profile.touching = 0;
+    for(b2Contact* contact = _world->GetContactList(); contact != nullptr; contact = contact->GetNext()) {
+        if (contact->IsTouching()) {
+            _profile.touching++;
+        }
+    }
+
+    if (_profileLog != nullptr) {
+        _profileLog->writeLine(strtool::format("%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u,%u,%u",
+                                               _profile.step, _profile.broadphase, _profile.narrowphase,
+                                               _profile.solve, _profile.solveTOI, _profile.callbacks,
+                                               _profile.sync, _profile.bodies, _profile.awake,
+                                               _profile.contacts, _profile.touching, _profile.updated));
+    }
+}
+
+
 #pragma mark -
 #pragma mark Callback Activation
 
@@ -444,6 +748,51 @@ void ObstacleWorld::activateDestructionCallbacks(bool flag) {
 }
 
 
+#pragma mark -
+#pragma mark Collision Callback Functions
+/**
+ * Called when two fixtures begin to touch
+ *
+ * This method is the static callback required by the Box2d API.  It should
+ * not be altered.
+ *
+ * @param  contact  the contact information
+ */
+void ObstacleWorld::BeginContact(b2Contact* contact) {
+    if (onBeginContact != nullptr) {
+        if (_profiling) {
+            Timestamp start;
+            onBeginContact(contact);
+            Timestamp end;
+            _profile.callbacks += Timestamp::ellapsedMicros(start,end)/1000.0f;
+        } else {
+            onBeginContact(contact);
+        }
+    }
+}
+
+/**
+ * Called when two fixtures cease to touch
+ *
+ * This method is the static callback required by the Box2d API.  It should
+ * not be altered.
+ *
+ * @param  contact  the contact information
+ */
+void ObstacleWorld::EndContact(b2Contact* contact) {
+    if (onEndContact != nullptr) {
+        if (_profiling) {
+            Timestamp start;
+            onEndContact(contact);
+            Timestamp end;
+            _profile.callbacks += Timestamp::ellapsedMicros(start,end)/1000.0f;
+        } else {
+            onEndContact(contact);
+        }
+    }
+}
+
+
 #pragma mark -
 #pragma mark Query Functions
 
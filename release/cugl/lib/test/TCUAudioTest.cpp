@@ -0,0 +1,166 @@
+//
+//  TCUAudioTest.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite for the audio graph nodes.  The tests
+//  read the nodes directly, so they need an audio device manager but no
+//  audio device.
+//
+//  These test classes only use asserts and have no audible side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "TCUAudioTest.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <cugl/cugl.h>
+
+using namespace cugl;
+using namespace cugl::audio;
+
+/** The number of input frames for each resampler test */
+#define RESAMPLE_FRAMES 48000
+/** The output frames requested by each read */
+#define RESAMPLE_PAGE   512
+
+/**
+ * A finite audio node with a known signal
+ *
+ * Every channel is a ramp from -1 to 1 over the length of the node.
+ */
+class RampNode : public AudioNode {
+protected:
+    /** The total number of frames */
+    Uint32 _length;
+    /** The next frame to read */
+    Uint32 _frame;
+
+public:
+    /**
+     * Creates a ramp of the given length
+     */
+    RampNode(Uint32 length) : _length(length), _frame(0) {}
+
+    /**
+     * Returns true if the ramp has no more data
+     */
+    virtual bool completed() override { return _frame >= _length; }
+
+    /**
+     * Reads up to the given number of frames of the ramp
+     */
+    virtual Uint32 read(float* buffer, Uint32 frames) override {
+        Uint32 take = 0;
+        for(; take < frames && _frame < _length; take++, _frame++) {
+            float value = 2.0f*_frame/_length-1.0f;
+            for(Uint32 chan = 0; chan < _channels; chan++) {
+                buffer[take*_channels+chan] = value;
+            }
+        }
+        return take;
+    }
+};
+
+/**
+ * Resamples a ramp and checks the output
+ *
+ * The output must have (roughly) the expected length and stay in range.
+ * Reading past the history buffer corrupts memory or produces garbage,
+ * so this also catches any error in the window bookkeeping.
+ *
+ * @param quality   The resampler quality
+ * @param inrate    The input sample rate
+ * @param outrate   The output sample rate
+ */
+static void resampleRamp(AudioResampler::Quality quality, Uint32 inrate, Uint32 outrate) {
+    std::shared_ptr<RampNode> ramp = std::make_shared<RampNode>(RESAMPLE_FRAMES);
+    ramp->init(2,inrate);
+    std::shared_ptr<AudioResampler> resampler = AudioResampler::alloc(ramp,outrate);
+    CUAssertAlwaysLog(resampler != nullptr, "Resampler allocation failed");
+    resampler->setQuality(quality);
+
+    std::vector<float> buffer(RESAMPLE_PAGE*2);
+    Uint64 total = 0;
+    bool inrange = true;
+    Uint32 amount = 0;
+    do {
+        amount = resampler->read(buffer.data(),RESAMPLE_PAGE);
+        for(Uint32 ii = 0; ii < amount*2; ii++) {
+            inrange = inrange && std::isfinite(buffer[ii]) && std::fabs(buffer[ii]) <= 1.5f;
+        }
+        total += amount;
+    } while (amount > 0 && total < 2*RESAMPLE_FRAMES);
+
+    double expected = ((double)RESAMPLE_FRAMES*outrate)/inrate;
+    CUAssertAlwaysLog(inrange, "Resampling %u Hz to %u Hz (quality %d) went out of range",
+                      inrate, outrate, (int)quality);
+    CUAssertAlwaysLog(std::fabs(total-expected) <= 64,
+                      "Resampling %u Hz to %u Hz (quality %d) read %llu frames (expected %.0f)",
+                      inrate, outrate, (int)quality, (unsigned long long)total, expected);
+    resampler->dispose();
+    ramp->dispose();
+}
+
+#pragma mark -
+#pragma mark Resampler
+/**
+ * Unit test for the audio resampler
+ *
+ * This resamples at every quality, including downsampling ratios large
+ * enough to step past the whole interpolation window.
+ */
+void cugl::testResampler() {
+    CULog("Running tests for AudioResampler.\n");
+
+    const AudioResampler::Quality qualities[] = {
+        AudioResampler::Quality::LINEAR,
+        AudioResampler::Quality::CUBIC,
+        AudioResampler::Quality::SINC
+    };
+    for(AudioResampler::Quality quality : qualities) {
+        // Upsampling and mild downsampling
+        resampleRamp(quality, 22050, 48000);
+        resampleRamp(quality, 48000, 44100);
+        // Downsampling by more than 4x (more than the cubic window)
+        resampleRamp(quality, 48000, 8000);
+        resampleRamp(quality, 44100, 8000);
+        resampleRamp(quality, 96000, 11025);
+    }
+
+    CULog("AudioResampler tests complete.\n");
+}
+
+#pragma mark -
+#pragma mark Complete Test
+/**
+ * Master unit test that invokes all others in this module.
+ */
+void cugl::audioUnitTest() {
+    bool started = AudioDevices::get() != nullptr;
+    if (!started) {
+        AudioDevices::start();
+    }
+    testResampler();
+    if (!started) {
+        AudioDevices::stop();
+    }
+}
@@ -0,0 +1,51 @@
+//
+//  TCUAudioTest.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module is a unit test suite for the audio graph nodes.  The tests
+//  read the nodes directly, so they need an audio device manager but no
+//  audio device.
+//
+//  These test classes only use asserts and have no audible side-effects.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef __T_CU_AUDIO_TEST_H__
+#define __T_CU_AUDIO_TEST_H__
+
+namespace cugl {
+
+/**
+ * Unit test for the audio resampler
+ *
+ * This resamples at every quality, including downsampling ratios large
+ * enough to step past the whole interpolation window.
+ */
+void testResampler();
+
+/**
+ * Master unit test that invokes all others in this module.
+ */
+void audioUnitTest();
+
+}
+
+#endif /* __T_CU_AUDIO_TEST_H__ */
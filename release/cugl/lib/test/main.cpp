@@ -14,6 +14,7 @@
 
 #include "TCUMathTest.h"
 #include "TCU2DTest.h"
+#include "TCUAudioTest.h"
 
 #include <Accelerate/Accelerate.h>
 
@@ -196,6 +197,7 @@ int main(int argc, char * argv[]) {
 #endif
     
     cugl::mathUnitTest();
+    cugl::audioUnitTest();
 
     //cugl::sceneUnitTest();
     //testBinary();
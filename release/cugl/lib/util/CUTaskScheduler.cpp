@@ -0,0 +1,433 @@
+//
+//  CUTaskScheduler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a work-stealing scheduler of asynchronous tasks.  This is a
+//  sibling of ThreadPool for workloads that need more than a FIFO queue.
+//  Each worker owns a deque of tasks for every priority level, and idle
+//  workers steal from the others.  Tasks may be collected into groups which
+//  can be waited on or cancelled as a unit, and both tasks and groups may
+//  have completion callbacks that are executed on the main thread via
+//  Application::defer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+#include <cugl/util/CUTaskScheduler.h>
+#include <cugl/base/CUApplication.h>
+#include <chrono>
+
+using namespace cugl;
+
+/** The scheduler owning the current thread (if it is a worker) */
+static thread_local const TaskScheduler* tl_scheduler = nullptr;
+/** The worker index of the current thread (if it is a worker) */
+static thread_local int tl_index = -1;
+
+/**
+ * Executes the callback on the main thread
+ *
+ * The callback is deferred with the given priority, so it respects the
+ * application frame budget.  If there is no running application (e.g. in a
+ * headless tool), the callback is executed immediately on the current thread.
+ *
+ * @param callback  The callback to execute
+ * @param priority  The priority of the callback
+ */
+static void post(const std::function<void()>& callback, TaskScheduler::Priority priority) {
+    Application* app = Application::get();
+    if (app == nullptr) {
+        callback();
+        return;
+    }
+    app->defer(callback, priority);
+}
+
+#pragma mark -
+#pragma mark Task Group
+/**
+ * Records that a task in this group has finished (or was skipped)
+ *
+ * If this was the last task, all waiting threads are woken and the
+ * continuations are passed to the main thread.
+ */
+void TaskGroup::leave() {
+    std::vector<std::function<void(bool)>> ready;
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        ready.swap(_continuations);
+        _finished.notify_all();
+    }
+
+    bool success = !isCancelled();
+    for (auto it = ready.begin(); it != ready.end(); ++it) {
+        std::function<void(bool)> callback = *it;
+        post([=](void) { callback(success); }, TaskScheduler::Priority::NORMAL);
+    }
+}
+
+/**
+ * Blocks the current thread until every task in this group has finished.
+ *
+ * This method does not help execute tasks.  If called from a worker of
+ * the scheduler running these tasks, use {@link TaskScheduler#wait}
+ * instead to avoid deadlock.
+ */
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _finished.wait(lk, [this] { return isDone(); });
+}
+
+/**
+ * Adds a continuation to execute on the main thread when this group is done.
+ *
+ * The continuation is passed true if the group completed normally, and
+ * false if it was cancelled.  If the group is already done, the
+ * continuation is scheduled immediately.
+ *
+ * @param callback  The continuation to execute
+ */
+void TaskGroup::then(const std::function<void(bool)>& callback) {
+    {
+        std::unique_lock<std::mutex> lk(_mutex);
+        if (!isDone()) {
+            _continuations.push_back(callback);
+            return;
+        }
+    }
+    bool success = !isCancelled();
+    post([=](void) { callback(success); }, TaskScheduler::Priority::NORMAL);
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes this scheduler, releasing all memory.
+ *
+ * Any tasks that have not yet started are skipped. This method will block
+ * until all running tasks complete.
+ */
+void TaskScheduler::dispose() {
+    stop();
+    _workers.clear();
+    _complete = 0;
+}
+
+/**
+ * Initializes a scheduler with the given number of threads.
+ *
+ * If threads is 0, the scheduler uses one less than the number of cores
+ * on this device (leaving a core for the main thread), but at least one.
+ *
+ * @param threads   the number of threads in this scheduler
+ *
+ * @return true if the scheduler is initialized properly, false otherwise.
+ */
+bool TaskScheduler::init(int threads) {
+    if (!_workers.empty()) {
+        return false;
+    }
+    if (threads <= 0) {
+        threads = std::max(1, SDL_GetCPUCount()-1);
+    }
+
+    _stop = false;
+    _complete = 0;
+    for (int index = 0; index < threads; ++index) {
+        _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        _workers.back()->owner = this;
+        _workers.back()->index = index;
+    }
+
+    // Start the threads only once every worker exists (they steal from each other)
+    for (auto it = _workers.begin(); it != _workers.end(); ++it) {
+        Worker* worker = it->get();
+#ifdef CU_SDL_THREADS
+        worker->thread = SDL_CreateThread(TaskScheduler::sdlThreadFunc,"Task Worker",(void*)worker);
+#else
+        worker->thread = std::thread(std::bind(&TaskScheduler::run, this, worker->index));
+#endif
+    }
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Thread Execution
+/**
+ * The body function of a single worker.
+ *
+ * @param index The worker index
+ */
+void TaskScheduler::run(int index) {
+    tl_scheduler = this;
+    tl_index = index;
+
+    Task task;
+    while (!_stop) {
+        if (acquire(index, task)) {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _wakeup.wait(lk, [this] { return _stop || _queued.load() > 0; });
+    }
+    _complete++;
+}
+
+/**
+ * The body function of a single worker using the SDL thread API.
+ *
+ * This should be used on Android and Windows, which have special thread
+ * requirements.
+ */
+int TaskScheduler::sdlThreadFunc(void* ptr) {
+    Worker* worker = (Worker*)ptr;
+    worker->owner->run(worker->index);
+    return 0;
+}
+
+/**
+ * Removes the next task to execute, returning true if one was found.
+ *
+ * Higher priorities are searched first.  Within a priority, the worker's
+ * own deque is checked first, then the injection queue, and finally the
+ * other workers are robbed.
+ *
+ * @param index The worker index (or -1 if not a worker)
+ * @param task  The task to store the result
+ *
+ * @return true if a task was found
+ */
+bool TaskScheduler::acquire(int index, Task& task) {
+    if (_queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    int size = (int)_workers.size();
+    for (int level = 0; level < PRIORITIES; level++) {
+        // Our own work first, newest first
+        if (index >= 0) {
+            Worker* self = _workers[index].get();
+            std::unique_lock<std::mutex> lk(self->mutex);
+            std::deque<Task>& queue = self->queues[level];
+            if (!queue.empty()) {
+                task = std::move(queue.back());
+                queue.pop_back();
+                _queued--;
+                return true;
+            }
+        }
+
+        // Then external work, oldest first
+        {
+            std::unique_lock<std::mutex> lk(_injectMutex);
+            std::deque<Task>& queue = _inject[level];
+            if (!queue.empty()) {
+                task = std::move(queue.front());
+                queue.pop_front();
+                _queued--;
+                return true;
+            }
+        }
+
+        // Then steal the oldest work from everyone else
+        for (int offset = 1; offset <= size; offset++) {
+            int victim = (index+offset) % size;
+            if (victim == index) {
+                continue;
+            }
+            Worker* other = _workers[victim].get();
+            std::unique_lock<std::mutex> lk(other->mutex);
+            std::deque<Task>& queue = other->queues[level];
+            if (!queue.empty()) {
+                task = std::move(queue.front());
+                queue.pop_front();
+                _queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Executes the given task, notifying its group when done.
+ *
+ * @param task  The task to execute
+ */
+void TaskScheduler::execute(Task& task) {
+    if (task.group == nullptr || !task.group->isCancelled()) {
+        task.work();
+        if (task.callback) {
+            post(task.callback, task.priority);
+        }
+    }
+    if (task.group != nullptr) {
+        task.group->leave();
+    }
+    task.work = nullptr;
+    task.callback = nullptr;
+    task.group = nullptr;
+}
+
+/**
+ * Returns the worker index of the current thread, or -1 if not a worker.
+ *
+ * @return the worker index of the current thread, or -1 if not a worker.
+ */
+int TaskScheduler::currentIndex() const {
+    return tl_scheduler == this ? tl_index : -1;
+}
+
+
+#pragma mark -
+#pragma mark Task Management
+/**
+ * Adds a task to this scheduler.
+ *
+ * If group is not nullptr, the task is counted as part of that group. If
+ * the group is cancelled before the task starts, the task is skipped.
+ *
+ * If callback is not nullptr, it is executed on the main thread (via
+ * {@link Application#defer} at the same priority) after the task
+ * completes.  The callback is not executed if the task was skipped.
+ *
+ * @param task      The task function to execute on a worker
+ * @param priority  The task priority
+ * @param group     The group for this task (may be nullptr)
+ * @param callback  The main-thread continuation (may be nullptr)
+ */
+void TaskScheduler::addTask(const std::function<void()>& task, Priority priority,
+                            const std::shared_ptr<TaskGroup>& group,
+                            const std::function<void()>& callback) {
+    CUAssertLog(!_workers.empty(), "Scheduler has not been initialized");
+    if (group != nullptr) {
+        group->enter();
+    }
+
+    Task entry;
+    entry.work = task;
+    entry.callback = callback;
+    entry.group = group;
+    entry.priority = priority;
+    if (_stop) {
+        // Never strand a group on a dead scheduler
+        if (group != nullptr) {
+            group->leave();
+        }
+        return;
+    }
+
+    int level = (int)priority;
+    int index = currentIndex();
+    if (index >= 0) {
+        Worker* self = _workers[index].get();
+        std::unique_lock<std::mutex> lk(self->mutex);
+        self->queues[level].push_back(std::move(entry));
+    } else {
+        std::unique_lock<std::mutex> lk(_injectMutex);
+        _inject[level].push_back(std::move(entry));
+    }
+
+    // Increment before taking the sleep lock so no worker misses the wakeup
+    _queued++;
+    std::unique_lock<std::mutex> lk(_sleepMutex);
+    _wakeup.notify_one();
+}
+
+/**
+ * Blocks until every task in the group has finished.
+ *
+ * Unlike {@link TaskGroup#wait}, the calling thread helps execute queued
+ * tasks while it waits.  This makes it safe to call from within a task
+ * on this scheduler, as well as from the main thread.  Note that the
+ * calling thread may run tasks from other groups as well.
+ *
+ * @param group The group to wait on
+ */
+void TaskScheduler::wait(const std::shared_ptr<TaskGroup>& group) {
+    int index = currentIndex();
+    Task task;
+    while (!group->isDone()) {
+        if (acquire(index, task)) {
+            execute(task);
+        } else {
+            // Everything left is running elsewhere
+            std::unique_lock<std::mutex> lk(group->_mutex);
+            group->_finished.wait_for(lk, std::chrono::milliseconds(1),
+                                      [&] { return group->isDone(); });
+        }
+    }
+}
+
+/**
+ * Stop the scheduler, marking it for shut down.
+ *
+ * This method waits for the running tasks to finish.  Any tasks that
+ * have not yet started are skipped, but their groups are still notified.
+ */
+void TaskScheduler::stop() {
+    {
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        if (_stop && isShutdown()) {
+            return;
+        }
+        _stop = true;
+        _wakeup.notify_all();
+    }
+
+    for (auto it = _workers.begin(); it != _workers.end(); ++it) {
+#ifdef CU_SDL_THREADS
+        int status;
+        SDL_WaitThread((*it)->thread,&status);
+#else
+        if ((*it)->thread.joinable()) {
+            (*it)->thread.join();
+        }
+#endif
+    }
+
+    // Release any abandoned groups
+    std::vector<std::shared_ptr<TaskGroup>> orphans;
+    for (int level = 0; level < PRIORITIES; level++) {
+        for (auto it = _workers.begin(); it != _workers.end(); ++it) {
+            for (auto jt = (*it)->queues[level].begin(); jt != (*it)->queues[level].end(); ++jt) {
+                orphans.push_back(jt->group);
+            }
+            (*it)->queues[level].clear();
+        }
+        for (auto jt = _inject[level].begin(); jt != _inject[level].end(); ++jt) {
+            orphans.push_back(jt->group);
+        }
+        _inject[level].clear();
+    }
+    _queued = 0;
+    for (auto it = orphans.begin(); it != orphans.end(); ++it) {
+        if (*it != nullptr) {
+            (*it)->cancel();
+            (*it)->leave();
+        }
+    }
+}
@@ -7,6 +7,7 @@
 //
 
 #include "AIController.hpp"
+#include "Random.hpp"
 
 using namespace cugl;
 
@@ -111,7 +112,7 @@ float AIController::getLostMovement(shared_ptr<Lost> lost, Vec2 player_pos, floa
                 
             while (!lost->targetX || abs(lost->targetX - lost->getPosition().x) < 0.2) {
                 lost->targetX = lost->getWidth() + (30-lost->getWidth()) *
-                std::sqrt(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+                std::sqrt(Random::get(Random::Stream::AI).nextFloat());
             }
                 
                 
@@ -165,8 +166,8 @@ Vec2 AIController::getPhantomMovement(shared_ptr<Phantom> phantom, Vec2 player_p
 
         Vec2 vector = phantom->targetPosition - phantom->getPosition();
         while(phantom->targetPosition == Vec2() || phantom->targetPosition.distance(phantom->getPosition()) <= 1 || !vector.x || !vector.y) {
-            float r = 10 + 10 * std::sqrt(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
-            float alpha = angle - M_PI/4 + static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * M_PI/2;
+            float r = 10 + 10 * std::sqrt(Random::get(Random::Stream::AI).nextFloat());
+            float alpha = angle - M_PI/4 + Random::get(Random::Stream::AI).nextFloat() * M_PI/2;
             phantom->targetPosition = Vec2(r * std::cos(alpha), r * std::sin(alpha)) + phantom->getPosition();
             vector = phantom->targetPosition - phantom->getPosition();
         }
@@ -254,8 +255,8 @@ Vec2 AIController::getSeekerMovement(shared_ptr<Seeker> seeker, Vec2 player_pos,
         }
         if (!seeker->targetPosition.x) {
             while (seeker->targetPosition.x <= seeker->getWidth()/2 || seeker->targetPosition.x >= worldwidth-seeker->getWidth()/2 || seeker->targetPosition.y <= seeker->getHeight()/2 + bottomwall || seeker->targetPosition.y + seeker->getHeight()/2 >= worldheight) {
-                float r = 5 + 10 * std::sqrt(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
-                float alpha = angle - M_PI/4 + static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * M_PI/2;
+                float r = 5 + 10 * std::sqrt(Random::get(Random::Stream::AI).nextFloat());
+                float alpha = angle - M_PI/4 + Random::get(Random::Stream::AI).nextFloat() * M_PI/2;
                 seeker->targetPosition = Vec2(r * std::cos(alpha), r * std::sin(alpha)) + seeker->getPosition();
             }
         }
@@ -280,8 +281,8 @@ Vec2 AIController::getSeekerMovement(shared_ptr<Seeker> seeker, Vec2 player_pos,
             if (player_pos.distance(seeker->getPosition())>6) {
                 seeker->targetPosition = Vec2(0,0);
                 while (seeker->targetPosition.x <= seeker->getWidth()/2 || seeker->targetPosition.x >= worldwidth-seeker->getWidth()/2 || seeker->targetPosition.y <= seeker->getHeight()/2 + bottomwall || seeker->targetPosition.y + seeker->getHeight()/2 >= worldheight) {
-                    float r = 5 + 10 * std::sqrt(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
-                    float alpha = angle - M_PI/4 + static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * M_PI/2;
+                    float r = 5 + 10 * std::sqrt(Random::get(Random::Stream::AI).nextFloat());
+                    float alpha = angle - M_PI/4 + Random::get(Random::Stream::AI).nextFloat() * M_PI/2;
                     seeker->targetPosition = Vec2(r * std::cos(alpha), r * std::sin(alpha)) + seeker->getPosition();
                 }
             } else {
@@ -303,8 +304,8 @@ Vec2 AIController::getSeekerMovement(shared_ptr<Seeker> seeker, Vec2 player_pos,
             seeker->setTimePast(0.0f);
             Vec2 newxy;
             while (newxy.x <= seeker->getWidth()/2 || newxy.x >= worldwidth-seeker->getWidth()/2 || newxy.y <= seeker->getHeight()/2 + bottomwall || newxy.y + seeker->getHeight()/2 >= worldheight) {
-                float r = 5 + 10 * std::sqrt(static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
-                float alpha = M_PI/4 + static_cast<float>(rand()) / static_cast<float>(RAND_MAX) * 3*M_PI/4;
+                float r = 5 + 10 * std::sqrt(Random::get(Random::Stream::AI).nextFloat());
+                float alpha = M_PI/4 + Random::get(Random::Stream::AI).nextFloat() * 3*M_PI/4;
                 newxy = seeker->getPosition() + Vec2(r * std::cos(alpha), r * std::sin(alpha));
             }
             seeker->targetPosition = newxy;
@@ -8,6 +8,10 @@
 
 #include "AttackController.hpp"
 #include "PlayerModel.h"
+#include "Random.hpp"
+#include <box2d/b2_distance.h>
+#include <box2d/b2_circle_shape.h>
+#include <algorithm>
 
 /** Debug color for sensor */
 #define DEBUG_COLOR Color4::RED
@@ -32,12 +36,11 @@ bool AttackController::Attack::init(const cugl::Vec2 p, float radius, float a, f
     _offset = oof;
     _active = true;
     //_ball = b.makeCircle(_position, _radius);
-    _UID = rand();
+    _UID = (float)Random::get(Random::Stream::GAMEPLAY).next();
     _attackID = attackID;
     _timer = 0;
     _maxFrames = frames;
     _sensorFixture = nullptr;
-    _homingSensorFixture = nullptr;
     _bodySensorFixture = nullptr;
     _homingEnemy = nullptr;
     _dirtyHoming = false;
@@ -48,7 +51,6 @@ bool AttackController::Attack::init(const cugl::Vec2 p, float radius, float a, f
         switch (_type) {
             case Type::p_range:
             case Type::p_exp_package:
-                _homingSensorName = "player" + _sensorName + "homing";
             case Type::p_dash:
             case Type::p_melee:
                 _sensorName = "player" + _sensorName;
@@ -71,6 +73,16 @@ bool AttackController::Attack::init(const cugl::Vec2 p, float radius, float a, f
                 break;
         }
 
+        _hitMask = filter.maskBits;
+        if (isProjectile()) {
+            // Projectiles are swept against the world instead
+            filter.categoryBits = 0;
+            filter.maskBits = 0;
+            setFilterData(filter);
+        }
+        _sweepStart = _position;
+        _touching.clear();
+
         this->setSensor(true);
         return true;
     }
@@ -95,40 +107,21 @@ void AttackController::Attack::createFixtures() {
         vec.rotate(M_PI / 4.0f);
     }
 
-    sensorShape.Set(corners, 8);
-    sensorDef.shape = &sensorShape;
-    sensorDef.userData.pointer = reinterpret_cast<uintptr_t>(getSensorName());
-    _sensorFixture = _body->CreateFixture(&sensorDef);
-
+    if (!isProjectile()) {
+        sensorShape.Set(corners, 8);
+        sensorDef.shape = &sensorShape;
+        sensorDef.userData.pointer = reinterpret_cast<uintptr_t>(getSensorName());
+        _sensorFixture = _body->CreateFixture(&sensorDef);
+    }
 
+    // Homing is found by the sweep, so the circle is only for debugging
     if (_type == p_range || _type == p_exp_package) {
-        b2FixtureDef sensorDef3;
-        sensorDef3.density = 0;
-        sensorDef3.isSensor = true;
-        b2PolygonShape sensorShape3;
-        b2Vec2 corners3[8];
-        
-        if (_type == p_exp_package) {
-            cugl::Vec2 vec(0, _radius * 10.0);//TODO: 10.0 is random
-            for (int i = 0; i < 8; i++) {
-                corners3[i] = b2Vec2(vec.x, vec.y);
-                _debugVerticies3.push_back(Vec2(vec));
-                vec.rotate(M_PI / 4.0f);
-            }
-        } else {
-            cugl::Vec2 vec(0, _radius * 5.0);//TODO: 5.0 is random
-            for (int i = 0; i < 8; i++) {
-                corners3[i] = b2Vec2(vec.x, vec.y);
-                _debugVerticies3.push_back(Vec2(vec));
-                vec.rotate(M_PI / 4.0f);
-            }
+        float scale = (_type == p_exp_package ? PACKAGE_HOMING_SCALE : RANGE_HOMING_SCALE);
+        cugl::Vec2 vec(0, _radius * scale);
+        for (int i = 0; i < 8; i++) {
+            _debugVerticies3.push_back(Vec2(vec));
+            vec.rotate(M_PI / 4.0f);
         }
-        
-        
-        sensorShape3.Set(corners3, 8);
-        sensorDef3.shape = &sensorShape3;
-        sensorDef3.userData.pointer = reinterpret_cast<uintptr_t>(getHomingSensorName());
-        _homingSensorFixture = _body->CreateFixture(&sensorDef3);
     }
 
     
@@ -163,11 +156,6 @@ void AttackController::Attack::releaseFixtures() {
         _sensorFixture = nullptr;
     }
 
-    if (_homingSensorFixture != nullptr) {
-        _body->DestroyFixture(_homingSensorFixture);
-        _homingSensorFixture = nullptr;
-    }
-
 
     if (_bodySensorFixture != nullptr) {
         _body->DestroyFixture(_bodySensorFixture);
@@ -201,7 +189,7 @@ void AttackController::Attack::update(const cugl::Vec2 p, bool follow, float dt,
         setNodeAngle(getLinearVelocity().getAngle());
 
        //animations
-        if (_maxFrames != 0) {
+        if (_maxFrames != 0 && _node != nullptr) {
             _timer += dt;
             if (_type == p_exp) {
                 if (_timer > .03) {
@@ -220,6 +208,132 @@ void AttackController::Attack::update(const cugl::Vec2 p, bool follow, float dt,
     }
 }
 
+/**
+ * Returns true if a moving circle hits the given fixture.
+ *
+ * The circle is the proxyB of the input, moving by translationB. If so, the
+ * fraction of the move at the hit is stored in lambda (0 if the circle
+ * overlaps the fixture from the start).
+ */
+static bool sweepFixture(const b2Fixture* fixture, b2ShapeCastInput& input, float& lambda) {
+    const b2Shape* shape = fixture->GetShape();
+    input.transformA = fixture->GetBody()->GetTransform();
+    bool moving = input.translationB.LengthSquared() > b2_epsilon;
+
+    bool hit = false;
+    lambda = 1.0f;
+    for (int32 child = 0; child < shape->GetChildCount(); child++) {
+        input.proxyA.Set(shape, child);
+
+        // The cast does not report an initial overlap
+        b2DistanceInput overlap;
+        overlap.proxyA = input.proxyA;
+        overlap.proxyB = input.proxyB;
+        overlap.transformA = input.transformA;
+        overlap.transformB = input.transformB;
+        overlap.useRadii = true;
+        b2SimplexCache cache;
+        cache.count = 0;
+        b2DistanceOutput distance;
+        b2Distance(&distance, &cache, &overlap);
+        if (distance.distance <= b2_linearSlop) {
+            lambda = 0.0f;
+            return true;
+        }
+
+        b2ShapeCastOutput output;
+        if (moving && b2ShapeCast(&output, &input) && output.lambda <= lambda) {
+            lambda = output.lambda;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+void AttackController::Attack::sweep(const std::shared_ptr<physics2::ObstacleWorld>& world,
+                                     const std::function<void(Attack*, physics2::Obstacle*, std::string*)>& onHit) {
+    Vec2 start = _sweepStart;
+    Vec2 end = getPosition();
+    _sweepStart = end;
+
+    b2CircleShape circle;
+    circle.m_radius = _radius;
+    b2ShapeCastInput input;
+    input.proxyB.Set(&circle, 0);
+    input.transformB.Set(b2Vec2(start.x, start.y), 0);
+    input.translationB = b2Vec2(end.x-start.x, end.y-start.y);
+
+    float homing = 0;
+    if (!_homingEnemy && !_dirtyHoming) {
+        if (_type == p_range) {
+            homing = _radius*RANGE_HOMING_SCALE;
+        } else if (_type == p_exp_package) {
+            homing = _radius*PACKAGE_HOMING_SCALE;
+        }
+    }
+
+    // Search the bounds of the swept circle (or the homing circle if larger)
+    float reach = std::max(_radius, homing);
+    Rect bounds(std::min(start.x, end.x)-reach, std::min(start.y, end.y)-reach,
+                fabsf(end.x-start.x)+2*reach, fabsf(end.y-start.y)+2*reach);
+
+    std::vector<std::pair<float, b2Fixture*>> hits;
+    std::vector<b2Fixture*> tested;
+    BaseEnemyModel* nearest = nullptr;
+    float nearDist = homing*homing;
+    world->queryAABB([&](b2Fixture* fixture) {
+        if (fixture->GetBody() == _body) {
+            return true;
+        }
+        // Fixtures with many children are reported once per child
+        if (std::find(tested.begin(), tested.end(), fixture) != tested.end()) {
+            return true;
+        }
+        tested.push_back(fixture);
+
+        physics2::Obstacle* obstacle = reinterpret_cast<physics2::Obstacle*>(fixture->GetBody()->GetUserData().pointer);
+        if (homing > 0 && obstacle) {
+            if (BaseEnemyModel* enemy = dynamic_cast<BaseEnemyModel*>(obstacle)) {
+                float dist = enemy->getPosition().distanceSquared(end);
+                if (dist < nearDist) {
+                    nearDist = dist;
+                    nearest = enemy;
+                }
+            }
+        }
+
+        float lambda;
+        if ((fixture->GetFilterData().categoryBits & _hitMask) && sweepFixture(fixture, input, lambda)) {
+            hits.push_back(std::make_pair(lambda, fixture));
+        }
+        return true;
+    }, bounds);
+
+    if (nearest) {
+        setDIRTYHomingEnemy(nearest);
+    }
+
+    // Report the new hits in the order they happen
+    std::stable_sort(hits.begin(), hits.end(), [](const std::pair<float, b2Fixture*>& a,
+                                                  const std::pair<float, b2Fixture*>& b) {
+        return a.first < b.first;
+    });
+    std::vector<b2Fixture*> touching;
+    for (auto it = hits.begin(); it != hits.end(); ++it) {
+        b2Fixture* fixture = it->second;
+        touching.push_back(fixture);
+        if (std::find(_touching.begin(), _touching.end(), fixture) == _touching.end()) {
+            physics2::Obstacle* obstacle = reinterpret_cast<physics2::Obstacle*>(fixture->GetBody()->GetUserData().pointer);
+            std::string* name = reinterpret_cast<std::string*>(fixture->GetUserData().pointer);
+            onHit(this, obstacle, name);
+            if (!_active) {
+                break;
+            }
+        }
+    }
+    _touching.swap(touching);
+}
+
 void AttackController::Attack::dispose() {
     _core = nullptr;
     _node = nullptr;
@@ -314,6 +428,15 @@ void AttackController::update(const cugl::Vec2 p, b2Vec2 VX, float dt, vector<st
     }
 }
 
+void AttackController::sweep(const std::shared_ptr<physics2::ObstacleWorld>& world,
+                             const std::function<void(Attack*, physics2::Obstacle*, std::string*)>& onHit) {
+    for (auto it = _current.begin(); it != _current.end(); ++it) {
+        if ((*it)->isProjectile() && (*it)->isActive() && !(*it)->isRemoved()) {
+            (*it)->sweep(world, onHit);
+        }
+    }
+}
+
 void AttackController::attackLeft(cugl::Vec2 p, SwipeController::SwipeAttack attack, float angle, bool grounded, float timer, std::shared_ptr<SoundController> sound) {
     // Subtract 90 degrees from the angle because vector rotates with the angle starting from the north
     float angleAdjusted = angle - 90;
@@ -19,6 +19,11 @@
 #define DASHY 25
 #define DASHTIME 0.8
 
+/** Homing radius of a ranged attack, as a multiple of its radius */
+#define RANGE_HOMING_SCALE 5.0f
+/** Homing radius of an explosive package, as a multiple of its radius */
+#define PACKAGE_HOMING_SCALE 10.0f
+
 #include <cugl/cugl.h>
 #include <unordered_set>
 #include "SwipeController.hpp"
@@ -119,12 +124,9 @@ public:
         b2Fixture* _sensorFixture;
         /**Attack sensor for inside player body (melee only) */
         b2Fixture* _bodySensorFixture;
-        /**homing sensor for projectiles */
-        b2Fixture* _homingSensorFixture;
         /** Name of sensor */
         std::string _sensorName;
 
-        std::string _homingSensorName;
         /** Debug Sensor */
         std::shared_ptr<cugl::scene2::WireNode> _sensorNode;
 
@@ -158,6 +160,15 @@ public:
         bool _dirtyHoming;
 
         std::shared_ptr<BaseEnemyModel> _homingEnemy;
+
+        /** The collision categories a projectile hits (projectiles have no contacts) */
+        uint16 _hitMask;
+
+        /** The position at the end of the last sweep */
+        cugl::Vec2 _sweepStart;
+
+        /** The fixtures touched by the last sweep (to report each hit once) */
+        std::vector<b2Fixture*> _touching;
         
     public:
         /**
@@ -207,8 +218,6 @@ public:
 
         std::string* getSensorName() { return &_sensorName; }
 
-        std::string* getHomingSensorName() { return &_homingSensorName; }
-
         void setSensorName(string s) { _sensorName = s; }
 
         bool isSplitable() { return _splitable; }
@@ -217,6 +226,32 @@ public:
 
         bool isSame(Attack* a);
 
+        /**
+         * Returns true if this attack is a projectile.
+         *
+         * Projectiles move too fast for sensor contacts, so their bodies
+         * generate no contacts at all. Instead, they are swept each frame
+         * with {@link #sweep}.
+         */
+        bool isProjectile() const {
+            return _type == p_range || _type == p_exp_package || _type == e_range;
+        }
+
+        /**
+         * Sweeps this projectile from its last position to its current one.
+         *
+         * The attack is a circle of its radius, tested exactly against every
+         * fixture in its hit categories along the path.  Hits are reported in
+         * the order they happen, and a fixture is only reported again once the
+         * projectile has left it (like a begin contact).  A homing projectile
+         * without a target also picks the nearest enemy in its homing radius.
+         *
+         * @param world The physics world
+         * @param onHit The function to report a hit of an obstacle and fixture
+         */
+        void sweep(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world,
+                   const std::function<void(Attack*, cugl::physics2::Obstacle*, std::string*)>& onHit);
+
         cugl::Vec2 getVel() { return _vel; }
         float getScale() { return _scale; }
 
@@ -286,7 +321,9 @@ public:
             return (result->init(p, radius, age, dmg, scale, t, m, oof, b, vel, angle, timer, attackID, frames) ? result : nullptr);
         }
         void setNodeAngle(float angle) {
-            _node->setAngle(angle);
+            if (_node != nullptr) {
+                _node->setAngle(angle);
+            }
         }
 
     };
@@ -355,6 +392,17 @@ public:
      *  @param dt   The timestep
      */
     void update(const cugl::Vec2 p, b2Vec2 VX, float dt, vector < std::shared_ptr<BaseEnemyModel>> enemies);
+
+    /**
+     *  Sweeps all active projectiles, reporting their hits.
+     *
+     *  This should be called after each physics step, as projectiles have no contacts.
+     *
+     *  @param world    The physics world
+     *  @param onHit    The function to report a hit of an obstacle and fixture
+     */
+    void sweep(const std::shared_ptr<cugl::physics2::ObstacleWorld>& world,
+               const std::function<void(Attack*, cugl::physics2::Obstacle*, std::string*)>& onHit);
     
     
     /**
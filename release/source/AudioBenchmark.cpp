@@ -0,0 +1,277 @@
+//
+//  AudioBenchmark.cpp
+//  Liminal Spirit Game
+//
+//  This class measures the throughput of the audio graph without sound
+//  hardware. See the header for details.
+//
+#include "AudioBenchmark.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace cugl;
+
+/** Every enemy music layer active */
+static const Uint8 ALL_LAYERS = (1 << SoundController::layerCount)-1;
+/** No enemy music layer active */
+static const Uint8 NO_LAYERS  = 0;
+/** The sample rate of the node benchmarks */
+static const Uint32 NODE_RATE = 48000;
+
+/**
+ * An endless audio node that repeats a single page of samples
+ *
+ * This is the input to the node benchmarks, as it costs no more than a copy.
+ */
+class PageNode : public audio::AudioNode {
+protected:
+    /** The repeated page of samples */
+    std::vector<float> _page;
+
+public:
+    /**
+     * Initializes the page with a quiet sine wave on every channel
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in HZ
+     *
+     * @return true if initialization was successful
+     */
+    virtual bool init(Uint8 channels, Uint32 rate) override {
+        if (!AudioNode::init(channels,rate)) {
+            return false;
+        }
+        _page.resize(BENCHMARK_NODE_PAGE*channels);
+        for(size_t ii = 0; ii < _page.size(); ii++) {
+            _page[ii] = 0.5f*std::sin(0.01f*(ii/channels));
+        }
+        return true;
+    }
+
+    /**
+     * Reads up to a page of frames
+     *
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    virtual Uint32 read(float* buffer, Uint32 frames) override {
+        frames = frames < BENCHMARK_NODE_PAGE ? frames : BENCHMARK_NODE_PAGE;
+        std::memcpy(buffer,_page.data(),frames*_channels*sizeof(float));
+        return frames;
+    }
+};
+
+/**
+ * Runs a single scenario and records the result
+ *
+ * The update function is called once per simulated game frame, before
+ * the audio for that frame is rendered. It returns the number of sound
+ * effects it triggered.  Only the rendering is timed.
+ *
+ * @param name      The scenario name
+ * @param seconds   The seconds of audio to render
+ * @param update    The per-frame update for the scenario
+ */
+void AudioBenchmark::runScenario(const std::string& name, double seconds,
+                                 const std::function<Uint32(Uint32 frame)>& update) {
+    AudioEngine* engine = AudioEngine::get();
+    Uint32 frames = (Uint32)(seconds*BENCHMARK_FRAME_RATE);
+
+    Result result;
+    result.name = name;
+    result.audio = 0;
+    result.wall  = 0;
+    result.effects = 0;
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        result.effects += update(ii);
+        Timestamp start;
+        Uint64 amount = engine->render(1.0/BENCHMARK_FRAME_RATE);
+        Timestamp end;
+        result.audio += ((double)amount)/engine->getOutput()->getRate();
+        result.wall  += Timestamp::ellapsedMicros(start,end)/1.0e6;
+    }
+    _results.push_back(result);
+
+    // Let the scenario fade out before the next one starts
+    engine->clear(0.1f);
+    engine->render(0.25);
+}
+
+/**
+ * Times a single node benchmark and records the result
+ *
+ * The read function processes one page of BENCHMARK_NODE_PAGE frames.
+ * It is called BENCHMARK_NODE_PAGES times with DSPMath vectorization
+ * off, and then again with it on.
+ *
+ * @param name      The node and channel layout
+ * @param read      The function to process a single page
+ */
+void AudioBenchmark::runNode(const std::string& name, const std::function<void()>& read) {
+    bool vectorize = dsp::DSPMath::VECTORIZE;
+    double micros[2];
+    for(int pass = 0; pass < 2; pass++) {
+        dsp::DSPMath::VECTORIZE = (pass == 1);
+        read(); // Warm the caches before timing
+        Timestamp start;
+        for(Uint32 ii = 0; ii < BENCHMARK_NODE_PAGES; ii++) {
+            read();
+        }
+        Timestamp end;
+        micros[pass] = ((double)Timestamp::ellapsedMicros(start,end))/BENCHMARK_NODE_PAGES;
+    }
+    dsp::DSPMath::VECTORIZE = vectorize;
+
+    NodeResult result;
+    result.name = name;
+    result.scalar = micros[0];
+    result.vector = micros[1];
+    _nodeResults.push_back(result);
+}
+
+/**
+ * Times the redistributor, the panner and the output sample conversion
+ *
+ * These nodes do not need the AudioEngine, and are read directly.
+ */
+void AudioBenchmark::runNodes() {
+    _nodeResults.clear();
+    std::vector<float> buffer(BENCHMARK_NODE_PAGE*2);
+
+    // Downmix (or upmix) each channel layout to stereo
+    const Uint8 layouts[] = { 1, 2, 6, 8 };
+    for(Uint8 channels : layouts) {
+        std::shared_ptr<PageNode> source = std::make_shared<PageNode>();
+        source->init(channels,NODE_RATE);
+        std::shared_ptr<audio::AudioRedistributor> node = audio::AudioRedistributor::alloc(source,2);
+        runNode("redistributor "+std::to_string(channels)+"->2", [&](void) {
+            node->read(buffer.data(),BENCHMARK_NODE_PAGE);
+        });
+        node->dispose();
+        source->dispose();
+    }
+
+    // Pan a mono and a stereo field. The panner may read less than a page.
+    const Uint8 fields[] = { 1, 2 };
+    for(Uint8 field : fields) {
+        std::shared_ptr<PageNode> source = std::make_shared<PageNode>();
+        source->init(field,NODE_RATE);
+        std::shared_ptr<audio::AudioPanner> node = audio::AudioPanner::alloc(2,field,NODE_RATE);
+        node->attach(source);
+        runNode("panner "+std::to_string(field)+"->2", [&](void) {
+            Uint32 take = 0;
+            while (take < BENCHMARK_NODE_PAGE) {
+                take += node->read(buffer.data()+take*2,BENCHMARK_NODE_PAGE-take);
+            }
+        });
+        node->dispose();
+        source->dispose();
+    }
+
+    // The S16 conversion performed by AudioOutput
+    std::vector<Sint16> pcm(BENCHMARK_NODE_PAGE*2);
+    runNode("output float->s16 2", [&](void) {
+        dsp::DSPMath::encode_pcm16(buffer.data(),pcm.data(),BENCHMARK_NODE_PAGE*2);
+    });
+}
+
+/**
+ * Runs every scenario and returns the report
+ *
+ * This method stops the active AudioEngine and starts an offline one.
+ * When done, it restarts the engine on the default device with the
+ * given number of slots.  Hence it should only be called when no
+ * sounds are playing, such as at the end of loading.
+ *
+ * @param seconds   The seconds of audio to render for each scenario
+ * @param slots     The number of slots for the restored engine
+ *
+ * @return the benchmark report
+ */
+std::string AudioBenchmark::run(double seconds, Uint32 slots) {
+    AudioEngine::stop();
+    if (!AudioEngine::startOffline(slots)) {
+        AudioEngine::start(slots);
+        return "Audio benchmark could not start an offline engine";
+    }
+    AudioEngine::get()->setProfiling(true);
+    AudioEngine::get()->resetProfile();
+
+    _results.clear();
+    _sound = std::make_shared<SoundController>();
+    _sound->init(_assets);
+
+    runScenario("menu", seconds, [this](Uint32) {
+        _sound->play_menu_music();
+        return 0;
+    });
+
+    runScenario("cave, no layers", seconds, [this](Uint32) {
+        _sound->play_level_music("cave", NO_LAYERS);
+        return 0;
+    });
+
+    runScenario("shroom, all layers", seconds, [this](Uint32) {
+        _sound->play_level_music("shroom", ALL_LAYERS);
+        return 0;
+    });
+
+    // Steady combat: a player action every 6 frames, an enemy every 10
+    runScenario("forest, combat", seconds, [this](Uint32 frame) {
+        _sound->play_level_music("forest", ALL_LAYERS);
+        Uint32 effects = 0;
+        if (frame % 6 == 0) {
+            _sound->play_player_sound((SoundController::playerSType)((frame/6) % 14));
+            effects++;
+        }
+        if (frame % 10 == 0) {
+            _sound->play_enemy_sound((SoundController::enemy)((frame/10) % 6),
+                                     (frame/10) % 2 ? SoundController::ehurt : SoundController::attack);
+            effects++;
+        }
+        return effects;
+    });
+
+    // Worst case: a burst of effects every frame, forcing voice stealing
+    runScenario("cave, sfx burst", seconds, [this](Uint32 frame) {
+        _sound->play_level_music("cave", ALL_LAYERS);
+        for(int ii = 0; ii < 4; ii++) {
+            _sound->play_enemy_sound((SoundController::enemy)((frame+ii) % 6), SoundController::attack);
+        }
+        _sound->play_death_sound(frame % 2 == 0);
+        return 5;
+    });
+
+    std::string report = "Audio benchmark (offline, unpaced)\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-24s %10s %10s %10s %8s\n",
+                  "scenario", "audio(s)", "wall(ms)", "rtf", "sfx");
+    report += line;
+    for(auto it = _results.begin(); it != _results.end(); ++it) {
+        double factor = it->wall > 0 ? it->audio/it->wall : 0;
+        std::snprintf(line, sizeof(line), "%-24s %10.2f %10.2f %10.1f %8u\n",
+                      it->name.c_str(), it->audio, it->wall*1000, factor, it->effects);
+        report += line;
+    }
+    report += AudioEngine::get()->dumpProfile();
+
+    runNodes();
+    std::snprintf(line, sizeof(line), "\nAudio nodes (%u frame page)\n%-24s %10s %10s %8s\n",
+                  BENCHMARK_NODE_PAGE, "node", "scalar(us)", "vector(us)", "speedup");
+    report += line;
+    for(auto it = _nodeResults.begin(); it != _nodeResults.end(); ++it) {
+        double speedup = it->vector > 0 ? it->scalar/it->vector : 0;
+        std::snprintf(line, sizeof(line), "%-24s %10.2f %10.2f %8.1f\n",
+                      it->name.c_str(), it->scalar, it->vector, speedup);
+        report += line;
+    }
+
+    _sound = nullptr;
+    AudioEngine::get()->setProfiling(false);
+    AudioEngine::stop();
+    AudioEngine::start(slots);
+    return report;
+}
@@ -0,0 +1,138 @@
+//
+//  AudioBenchmark.hpp
+//  Liminal Spirit Game
+//
+//  This class measures the throughput of the audio graph without sound
+//  hardware. It restarts the AudioEngine on an offline output and drives a
+//  SoundController through representative scenarios: menu music, layered
+//  level music, and level music under bursts of sound effects. Each
+//  scenario is rendered as fast as possible, and the report gives the
+//  real-time factor (seconds of audio per second of wall time) together
+//  with the per-class timing of the audio graph.
+//
+//  It also times the channel mixing nodes on their own (the redistributor,
+//  the panner and the output sample conversion), once with the scalar path
+//  and once with the vectorized path of DSPMath.
+//
+//  The benchmark is only run when BENCHMARK_AUDIO is enabled in
+//  LiminalSpiritApp.hpp.  It restores a device-backed AudioEngine when done.
+//
+
+#ifndef __AUDIO_BENCHMARK_HPP__
+#define __AUDIO_BENCHMARK_HPP__
+#include <cugl/cugl.h>
+#include "SoundController.hpp"
+
+/** The number of simulated game frames per second */
+#define BENCHMARK_FRAME_RATE    60
+/** The frames in each page read by the node benchmarks */
+#define BENCHMARK_NODE_PAGE     512
+/** The number of pages read for each node benchmark */
+#define BENCHMARK_NODE_PAGES    4096
+
+class AudioBenchmark {
+public:
+    /** The result of a single benchmark scenario */
+    struct Result {
+        /** The scenario name */
+        std::string name;
+        /** The seconds of audio rendered */
+        double audio;
+        /** The seconds of wall time spent rendering */
+        double wall;
+        /** The number of sound effects triggered */
+        Uint32 effects;
+    };
+
+    /** The result of a single node benchmark */
+    struct NodeResult {
+        /** The node and channel layout */
+        std::string name;
+        /** The average microseconds per page with the scalar path */
+        double scalar;
+        /** The average microseconds per page with the vectorized path */
+        double vector;
+    };
+
+protected:
+    /** The assets for the sound controller */
+    std::shared_ptr<cugl::AssetManager> _assets;
+    /** The sound controller driven by the scenarios */
+    std::shared_ptr<SoundController> _sound;
+    /** The results of the scenarios run so far */
+    std::vector<Result> _results;
+    /** The results of the node benchmarks run so far */
+    std::vector<NodeResult> _nodeResults;
+
+    /**
+     * Runs a single scenario and records the result
+     *
+     * The update function is called once per simulated game frame, before
+     * the audio for that frame is rendered. It returns the number of sound
+     * effects it triggered.  Only the rendering is timed.
+     *
+     * @param name      The scenario name
+     * @param seconds   The seconds of audio to render
+     * @param update    The per-frame update for the scenario
+     */
+    void runScenario(const std::string& name, double seconds,
+                     const std::function<Uint32(Uint32 frame)>& update);
+
+    /**
+     * Times a single node benchmark and records the result
+     *
+     * The read function processes one page of BENCHMARK_NODE_PAGE frames.
+     * It is called BENCHMARK_NODE_PAGES times with DSPMath vectorization
+     * off, and then again with it on.
+     *
+     * @param name      The node and channel layout
+     * @param read      The function to process a single page
+     */
+    void runNode(const std::string& name, const std::function<void()>& read);
+
+    /**
+     * Times the redistributor, the panner and the output sample conversion
+     *
+     * These nodes do not need the AudioEngine, and are read directly.
+     */
+    void runNodes();
+
+public:
+    /**
+     * Creates a benchmark for the given assets
+     *
+     * @param assets    The (fully loaded) asset manager
+     */
+    AudioBenchmark(const std::shared_ptr<cugl::AssetManager>& assets) : _assets(assets) {}
+
+    /**
+     * Runs every scenario and returns the report
+     *
+     * This method stops the active AudioEngine and starts an offline one.
+     * When done, it restarts the engine on the default device with the
+     * given number of slots.  Hence it should only be called when no
+     * sounds are playing, such as at the end of loading.
+     *
+     * @param seconds   The seconds of audio to render for each scenario
+     * @param slots     The number of slots for the restored engine
+     *
+     * @return the benchmark report
+     */
+    std::string run(double seconds, Uint32 slots);
+
+    /**
+     * Returns the results of the scenarios run so far
+     *
+     * @return the results of the scenarios run so far
+     */
+    const std::vector<Result>& getResults() const { return _results; }
+
+    /**
+     * Returns the results of the node benchmarks run so far
+     *
+     * @return the results of the node benchmarks run so far
+     */
+    const std::vector<NodeResult>& getNodeResults() const { return _nodeResults; }
+};
+
+#endif /* __AUDIO_BENCHMARK_HPP__ */
@@ -7,6 +7,7 @@
 //
 
 #include "BaseEnemyModel.h"
+#include "Random.hpp"
 #include <cugl/scene2/graph/CUPolygonNode.h>
 #include <cugl/scene2/graph/CUTexturedNode.h>
 #include <cugl/assets/CUAssetManager.h>
@@ -45,10 +46,10 @@ bool BaseEnemyModel::init(const cugl::Vec2& pos, const cugl::Size& realSize, con
 	_drawScale = scale;
 	_health = props.health;
 	_maxhealth = props.health;
-	_verticalSpeed = props.vspeed - (static_cast <float> (rand()) / static_cast <float> (RAND_MAX));
-	_horizontalSpeed = props.hspeed - (static_cast <float> (rand()) / static_cast <float> (RAND_MAX));
+	_verticalSpeed = props.vspeed - Random::get(Random::Stream::GAMEPLAY).nextFloat();
+	_horizontalSpeed = props.hspeed - Random::get(Random::Stream::GAMEPLAY).nextFloat();
 	_attackCooldown = props.attackCooldown;
-	_attackRadius = props.attackRadius - (static_cast <float> (rand()) / static_cast <float> (RAND_MAX/3));
+	_attackRadius = props.attackRadius - Random::get(Random::Stream::GAMEPLAY).nextFloat(0, 3);
     _damage = props.damage;
 	_timePast = 0.0f;
 	_attackAnimationTime = 0;
@@ -69,6 +70,7 @@ bool BaseEnemyModel::init(const cugl::Vec2& pos, const cugl::Size& realSize, con
 		filter.categoryBits = 0b10;
 		filter.maskBits = 0b111100;
 		setFilterData(filter);
+		setAlwaysUpdated(true); // Animations run in update, even at rest
 		return true;
 	}
 	return false;
@@ -125,7 +127,9 @@ void BaseEnemyModel::releaseFixtures() {
 /** Disposes all resources and assets of this enemy model */
 void BaseEnemyModel::dispose() {
 	_core = nullptr;
-	_node->removeAllChildren();
+	if (_node != nullptr) {
+		_node->removeAllChildren();
+	}
 	_node = nullptr;
 	_sensorNode = nullptr;
 }
@@ -208,19 +212,17 @@ void BaseEnemyModel::update(float dt) {
 			_node->removeChildByName("healthbar");
 			_node->removeChildByName("healthbarback");
 		}
-
-
-		//TODO: THE CODE BELOW BREAKS ATTACKS
-		b2Filter filter = getFilterData();
-		if (getVY() > 0.1) {
-			filter.maskBits = 0b111000;
-		}
-		else {
-			filter.maskBits = 0b111100;
-		}
-		setFilterData(filter);
 	}
 
+	//TODO: THE CODE BELOW BREAKS ATTACKS
+	b2Filter filter = getFilterData();
+	if (getVY() > 0.1) {
+		filter.maskBits = 0b111000;
+	}
+	else {
+		filter.maskBits = 0b111100;
+	}
+	setFilterData(filter);
 }
 
 #pragma mark -
@@ -305,7 +305,12 @@ public:
 	void setAttackAnimationTimer(float value) { _attackAnimationTime = value; }
 
 	/** Sets the pointer to the enemy's glow */
-	void setGlow(std::shared_ptr<Glow> glow) { _glow = glow; }
+	void setGlow(std::shared_ptr<Glow> glow) {
+		_glow = glow;
+		if (_glow != nullptr) {
+			_glow->setFollow(this);
+		}
+	}
 
 	/** Sets whether or not the enemy has played their damage particles */
 	void setPlayedDamagedParticle(bool didIt) { _playedDamagedParticles = didIt; }
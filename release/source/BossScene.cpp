@@ -51,8 +51,7 @@
 #include "RRParticleNode.h"
 #include "RRParticlePool.h"
 
-// Add support for simple random number generation
-#include <cstdlib>
+#include "Random.hpp"
 #include <ctime>
 
 // This keeps us from having to write cugl:: all the time
@@ -125,16 +124,16 @@ void BossScene::update(float timestep)
 }
 
 void BossScene::seedBarrage() {
-    int seeds = rand() % 5 + 10;
+    int seeds = Random::get(Random::Stream::GAMEPLAY).nextInt(5) + 10;
     float radius = 0.5f;
     float damage = 1.0f;
     Vec2 play_p = _player->getPosition();
     Vec2 en_p = Vec2(16.0, 4.0);
     for (int ii = 0; ii < seeds; ii++) {
         float age = 3.0f;//rand() % 20 / 5;
-        float random = rand() % 50;
+        float random = Random::get(Random::Stream::GAMEPLAY).nextInt(50);
         Vec2 vel = Vec2(0.5, 0).scale(.2 + random / 75);
-        random = rand() % 100;
+        random = Random::get(Random::Stream::GAMEPLAY).nextInt(100);
         vel = vel.rotate((play_p - en_p).getAngle()).rotate((M_PI / 6.0f * (random) / 100) - M_PI / 12);
         _attacks->createAttack(en_p, radius, age, damage, AttackController::Type::e_range, vel, 0, "seed", 1);
     }
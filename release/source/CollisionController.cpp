@@ -2,6 +2,9 @@
 #include <box2d/b2_contact.h>
 #include "PlayerModel.h"
 #include "AttackController.hpp"
+#include "Random.hpp"
+#include "SaveController.hpp"
+#include "LevelCollision.hpp"
 using namespace cugl;
 
 #define MAX_STALEING 0.2
@@ -14,10 +17,9 @@ void CollisionController::init(std::shared_ptr<SoundController> sound) {
     
     _stale = 50;
     
-    std::shared_ptr<JsonReader> reader = JsonReader::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    std::shared_ptr<JsonValue> save = reader->readJson();
-    std::shared_ptr<JsonValue> progress = save->get("progress");
-    _unlock_count = progress->get("unlock_count")->asInt();
+    // Without a save (as in a headless simulation) nothing is unlocked yet
+    SaveController* save = SaveController::get();
+    _unlock_count = save == nullptr ? 0 : save->getProgress().unlockCount;
 }
 
 /**
@@ -42,21 +44,31 @@ void CollisionController::beginContact(b2Contact* contact, std::shared_ptr<Attac
     physics2::Obstacle* bd1 = reinterpret_cast<physics2::Obstacle*>(body1->GetUserData().pointer);
     physics2::Obstacle* bd2 = reinterpret_cast<physics2::Obstacle*>(body2->GetUserData().pointer);
 
-    if (fd1 && *fd1 == "playerattacksensorhoming") {
-        int breaking = 1;
-    }
-    if (fd2 && *fd2 == "playerattacksensorhoming") {
-        int breaking = 2;
-    }
+    handleContact(bd1, fd1, bd2, fd2, AC, timer);
+}
 
+/**
+ * Processes a hit found by sweeping a projectile
+ *
+ * The projectile hits with its attack sensor, as if it had one.
+ */
+void CollisionController::projectileHit(AttackController::Attack* attack, physics2::Obstacle* bd, std::string* fd,
+                                        std::shared_ptr<AttackController> AC, float timer) {
+    handleContact(attack, attack->getSensorName(), bd, fd, AC, timer);
+}
 
+/**
+* helper method for handling the start of any collision
+*/
+void CollisionController::handleContact(physics2::Obstacle* bd1, std::string* fd1, physics2::Obstacle* bd2, std::string* fd2,
+                                        std::shared_ptr<AttackController> AC, float timer) {
     if (AttackController::Attack* attack = dynamic_cast<AttackController::Attack*>(bd1)) {
         string test = fd1 ? *fd1 : "NULLLLLLL";
-        handleAttackCollision(attack, fd1, bd2, fd2, AC, timer);
+        handleAttackCollision(attack, bd2, fd2, AC, timer);
     }
     else if (AttackController::Attack* attack = dynamic_cast<AttackController::Attack*>(bd2)) {
         string test = fd2 ? *fd2 : "NULLLLLLL";
-        handleAttackCollision(attack, fd2, bd1, fd1, AC, timer);
+        handleAttackCollision(attack, bd1, fd1, AC, timer);
     }
 
     //handle enemy collision
@@ -104,7 +116,7 @@ void CollisionController::handleEnemyCollision(BaseEnemyModel* enemy, physics2::
                     float angle_change;
                     cugl::Vec2 linvel = attack->getVel();
                     int angle = 60;
-                    float randAngle = (rand() % angle) - angle / 2.0f;
+                    float randAngle = Random::get(Random::Stream::GAMEPLAY).nextInt(angle) - angle / 2.0f;
                     randAngle = randAngle * M_PI / 180.0f;
                     switch (mirror->getType()) {
                     case Mirror::Type::square:
@@ -335,12 +347,12 @@ void CollisionController::handlePlayerCollision(PlayerModel* player, physics2::O
     }
     
     // Check if player is on the floor
-    if(!bd->getName().compare("floor")) {
+    if(!LevelCollision::getPartName(bd, fd).compare("floor")) {
         player->setFloored(true);
         player->setGrounded(true);
     }
     // Check if player is on platform
-    if(!bd->getName().compare("platform")) {
+    if(!LevelCollision::getPartName(bd, fd).compare("platform")) {
         player->setGrounded(true);
     }
     
@@ -374,18 +386,11 @@ BaseEnemyModel::AttackType CollisionController::mapToBaseAttackType(AttackContro
 }
 
 
-void CollisionController::handleAttackCollision(AttackController::Attack* attack, std::string* fd1, physics2::Obstacle* bd, std::string* fd2, std::shared_ptr<AttackController> AC, float timer) {
+void CollisionController::handleAttackCollision(AttackController::Attack* attack, physics2::Obstacle* bd, std::string* fd, std::shared_ptr<AttackController> AC, float timer) {
     if (!attack->isActive()) {
         return;
     }
-    if (fd1 && *fd1 == "playerattacksensorhoming") {
-        if (BaseEnemyModel* enemy = dynamic_cast<BaseEnemyModel*>(bd)) {
-            attack->setDIRTYHomingEnemy(enemy);
-            //CULog("%f, %f", attack->getLinearVelocity().x, attack->getLinearVelocity().y);
-
-        }
-
-    }else if (AttackController::Attack* attack2 = dynamic_cast<AttackController::Attack*>(bd)) {
+    if (AttackController::Attack* attack2 = dynamic_cast<AttackController::Attack*>(bd)) {
         if (!attack2->isActive()) {
             return;
         }
@@ -401,7 +406,7 @@ void CollisionController::handleAttackCollision(AttackController::Attack* attack
             //TODO: stun both player and enemy?
         }
     }
-    else if ((bd && (bd->getName().find("wall") != std::string::npos || (bd->getName().find("floor") != std::string::npos)))){
+    else if ((bd && (LevelCollision::getPartName(bd, fd).find("wall") != std::string::npos || (LevelCollision::getPartName(bd, fd).find("floor") != std::string::npos)))){
         switch(attack->getType()) {
         case AttackController::p_exp_package:
             AC->createAttack(attack->getPosition(), 5, 0.15, 30, AttackController::p_exp, cugl::Vec2::ZERO, timer, PLAYER_RANGE, PLAYER_EXP_FRAMES);
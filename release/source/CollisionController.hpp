@@ -32,6 +32,20 @@ public:
     void beginContact(b2Contact* contact, std::shared_ptr<AttackController> AC, float timer);
 
     void endContact(b2Contact* contact);
+
+    /**
+     * Processes a hit found by sweeping a projectile
+     *
+     * Projectiles have no contacts, so this is the beginContact for them.
+     *
+     * @param attack    The projectile
+     * @param bd        The obstacle hit
+     * @param fd        The name of the fixture hit
+     * @param AC        The attack controller
+     * @param timer     The game timer
+     */
+    void projectileHit(AttackController::Attack* attack, cugl::physics2::Obstacle* bd, std::string* fd,
+                       std::shared_ptr<AttackController> AC, float timer);
     
     int getSpawnerKilled() {return _spawner_killed;};
     void setSpawnerKilled(int v) { _spawner_killed = v;};
@@ -64,6 +78,10 @@ private:
     int _spawner_killed;
     string _name_of_killed_spawner_enemy;
     int _index_spawner;
+    /** handle the start of a collision between two obstacles (and fixtures) */
+    void handleContact(cugl::physics2::Obstacle* bd1, std::string* fd1, cugl::physics2::Obstacle* bd2, std::string* fd2,
+                       std::shared_ptr<AttackController> AC, float timer);
+
     /** handle collision between enemy and an obstacle */
     void handleEnemyCollision(BaseEnemyModel* enemy, cugl::physics2::Obstacle* bd, string* fd, std::shared_ptr<AttackController> AC, float timer);
 
@@ -71,7 +89,7 @@ private:
     void handlePlayerCollision(PlayerModel* player, cugl::physics2::Obstacle* bd, std::string* fd);
 
     /** handle collision between attack and a non-enemy obstacle (i.e, if bd is an enemy, nothing will happen) */
-    void handleAttackCollision(AttackController::Attack* attack1, std::string* fd1, cugl::physics2::Obstacle* bd, std::string* fd2, std::shared_ptr<AttackController> AC, float timer);
+    void handleAttackCollision(AttackController::Attack* attack1, cugl::physics2::Obstacle* bd, std::string* fd, std::shared_ptr<AttackController> AC, float timer);
     
     /** determine the amount of damage an enemy is going to take from a particular attack */
     int getDamageDealt(AttackController::Attack* attack, BaseEnemyModel* enemy);
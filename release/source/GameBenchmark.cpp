@@ -0,0 +1,241 @@
+//
+//  GameBenchmark.cpp
+//  Liminal Spirit Game
+//
+//  This class measures the time of a gameplay step without a player. See
+//  the header for details.
+//
+#include "GameBenchmark.hpp"
+#include "Random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace cugl;
+
+/** The bytes of a PNG file up to the width (signature, IHDR length and type) */
+#define PNG_HEADER_SIZE 16
+
+/**
+ * Creates a benchmark for the given asset directory
+ *
+ * The directory is not read until the benchmark is run.
+ *
+ * @param directory The absolute path to the asset directory
+ */
+GameBenchmark::GameBenchmark(const std::string& directory) : _directory(directory) {
+    if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\') {
+        _directory.push_back('/');
+    }
+}
+
+/**
+ * Returns the JSON value in the given file (nullptr on failure)
+ *
+ * @param file  The absolute path to the JSON file
+ *
+ * @return the JSON value in the given file (nullptr on failure)
+ */
+std::shared_ptr<JsonValue> GameBenchmark::readJson(const std::string& file) {
+    std::shared_ptr<JsonReader> reader = JsonReader::alloc(file);
+    if (reader == nullptr) {
+        CULogError("Game benchmark could not open %s", file.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<JsonValue> json = reader->readJson();
+    reader->close();
+    return json;
+}
+
+/**
+ * Returns the size of the given PNG image (zero on failure)
+ *
+ * Only the header of the image is read.
+ *
+ * @param file  The absolute path to the PNG image
+ *
+ * @return the size of the given PNG image (zero on failure)
+ */
+Size GameBenchmark::readImageSize(const std::string& file) {
+    std::shared_ptr<BinaryReader> reader = BinaryReader::alloc(file, 2*PNG_HEADER_SIZE);
+    if (reader == nullptr) {
+        return Size::ZERO;
+    }
+
+    // The IHDR chunk comes first, and its width and height are big-endian
+    Size result = Size::ZERO;
+    char header[PNG_HEADER_SIZE];
+    if (reader->read(header, PNG_HEADER_SIZE) == PNG_HEADER_SIZE &&
+        std::memcmp(header+12, "IHDR", 4) == 0 && reader->ready(8)) {
+        result.width  = reader->readUint32();
+        result.height = reader->readUint32();
+    }
+    reader->close();
+    return result;
+}
+
+/**
+ * Reads the level files and texture sizes from the asset directory
+ *
+ * @return true if the asset directory was read successfully
+ */
+bool GameBenchmark::loadDirectory() {
+    std::shared_ptr<JsonValue> manifest = readJson(_directory+"json/assets.json");
+    if (manifest == nullptr || manifest->get("textures") == nullptr) {
+        return false;
+    }
+    _levels = manifest->get("jsons");
+
+    _textures = JsonValue::allocObject();
+    std::shared_ptr<JsonValue> textures = manifest->get("textures");
+    for(auto it = textures->children().begin(); it != textures->children().end(); ++it) {
+        std::string file = (*it)->isString() ? (*it)->asString() : (*it)->getString("file");
+        Size size = readImageSize(_directory+file);
+        if (size == Size::ZERO) {
+            CULogError("Game benchmark could not read the size of %s", file.c_str());
+            continue;
+        }
+        std::shared_ptr<JsonValue> entry = JsonValue::allocArray();
+        entry->appendValue((double)size.width);
+        entry->appendValue((double)size.height);
+        _textures->appendChild((*it)->key(), entry);
+    }
+    return _levels != nullptr;
+}
+
+/**
+ * Returns the given percentile of the sorted samples
+ *
+ * @param samples   The samples in ascending order
+ * @param percent   The percentile in [0,1]
+ *
+ * @return the given percentile of the sorted samples
+ */
+double GameBenchmark::percentile(const std::vector<double>& samples, double percent) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t rank = (size_t)std::ceil(percent*samples.size());
+    return samples[rank > 0 ? std::min(rank,samples.size())-1 : 0];
+}
+
+/**
+ * Simulates a single level and records the result
+ *
+ * The level is given by its asset key, such as "forest10" or "BOSS".
+ * The simulation stops early if the level is won.
+ *
+ * @param level The level asset key
+ * @param steps The maximum number of steps to simulate
+ * @param wave  The wave to start at
+ * @param trace The scripted input (nullptr for no input)
+ */
+void GameBenchmark::runLevel(const std::string& level, Uint32 steps, int wave,
+                             const std::shared_ptr<InputTrace>& trace) {
+    std::shared_ptr<JsonValue> entry = _levels->get(level);
+    if (entry == nullptr) {
+        CULogError("Game benchmark has no level %s", level.c_str());
+        return;
+    }
+    std::shared_ptr<JsonValue> constants = readJson(_directory+(entry->isString() ? entry->asString() : entry->getString("file")));
+    if (constants == nullptr) {
+        return;
+    }
+
+    // Split the key into the biome and stage number (if any)
+    std::string biome = level;
+    int stage = -1;
+    size_t split = level.find_last_not_of("0123456789")+1;
+    if (split < level.size()) {
+        biome = level.substr(0,split);
+        stage = std::stoi(level.substr(split));
+    }
+
+    Random::seedAll(GAME_BENCHMARK_SEED);
+    std::shared_ptr<GameScene> scene = std::make_shared<GameScene>();
+    if (!scene->initHeadless(constants, _textures, biome, stage)) {
+        CULogError("Game benchmark could not start level %s", level.c_str());
+        return;
+    }
+    scene->getWorld()->setProfiling(true);
+    scene->skipToWave(wave);
+
+    Result result;
+    result.level = level;
+    result.enemies = 0;
+    result.physics = 0;
+
+    std::vector<double> times;
+    times.reserve(steps);
+    for(Uint32 ii = 0; ii < steps && !scene->next(); ii++) {
+        // The player is immortal, so the waves keep coming
+        scene->getPlayer()->setHealth(scene->getPlayer()->getMaxHealth());
+        if (trace != nullptr) {
+            scene->getInput().feed(trace->get(ii));
+        }
+
+        Timestamp start;
+        scene->update(GAME_BENCHMARK_STEP, GAME_BENCHMARK_UNLOCKS);
+        Timestamp end;
+        times.push_back(Timestamp::ellapsedMicros(start,end)/1000.0);
+        result.physics += scene->getWorld()->getProfile().step;
+        result.enemies = std::max(result.enemies,scene->getEnemyCount());
+    }
+    result.steps = (Uint32)times.size();
+    result.wave  = scene->getWave();
+    scene->dispose();
+
+    result.mean = 0;
+    for(auto it = times.begin(); it != times.end(); ++it) {
+        result.mean += *it;
+    }
+    if (!times.empty()) {
+        result.mean /= times.size();
+        result.physics /= times.size();
+    }
+    std::sort(times.begin(),times.end());
+    result.p50 = percentile(times,0.50);
+    result.p90 = percentile(times,0.90);
+    result.p99 = percentile(times,0.99);
+    result.max = times.empty() ? 0 : times.back();
+    _results.push_back(result);
+}
+
+/**
+ * Simulates every level and returns the report
+ *
+ * This method only touches the file system, so it may be called with or
+ * without a running application.
+ *
+ * @param levels    The level asset keys
+ * @param steps     The maximum number of steps to simulate per level
+ * @param wave      The wave to start each level at
+ * @param trace     The scripted input (nullptr for no input)
+ *
+ * @return the benchmark report
+ */
+std::string GameBenchmark::run(const std::vector<std::string>& levels, Uint32 steps, int wave,
+                               const std::shared_ptr<InputTrace>& trace) {
+    if (!loadDirectory()) {
+        return "Game benchmark could not read the assets in "+_directory;
+    }
+
+    _results.clear();
+    for(auto it = levels.begin(); it != levels.end(); ++it) {
+        runLevel(*it, steps, wave, trace);
+    }
+
+    std::string report = "Game benchmark (headless, fixed step)\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-12s %6s %5s %7s %8s %8s %8s %8s %8s %8s\n",
+                  "level", "steps", "wave", "enemies", "mean", "p50", "p90", "p99", "max", "physics");
+    report += line;
+    for(auto it = _results.begin(); it != _results.end(); ++it) {
+        std::snprintf(line, sizeof(line), "%-12s %6u %5d %7zu %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+                      it->level.c_str(), it->steps, it->wave, it->enemies, it->mean,
+                      it->p50, it->p90, it->p99, it->max, it->physics);
+        report += line;
+    }
+    return report;
+}
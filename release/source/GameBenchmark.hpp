@@ -0,0 +1,159 @@
+//
+//  GameBenchmark.hpp
+//  Liminal Spirit Game
+//
+//  This class measures the time of a gameplay step without a player. It
+//  plays levels in a headless GameScene at a fixed timestep, with the input
+//  scripted by an InputTrace.  A headless scene has no scene graph, sound or
+//  input devices, so the benchmark needs no window, GL context or audio
+//  device.  The player cannot die, so that the late waves of a level can be
+//  stressed for as long as needed.
+//
+//  The benchmark does not use the AssetManager.  It reads the level JSON
+//  files listed in json/assets.json directly, and the sizes of the textures
+//  (which size the physics bodies) from the PNG headers.
+//
+//  The report gives the percentiles of the step time for each level, and the
+//  share of that time spent in the physics step.  The random streams are
+//  seeded identically for each level, so runs are repeatable.
+//
+//  The benchmark is run after loading when BENCHMARK_GAME is enabled, or
+//  from the command line without the application when BENCHMARK_HEADLESS
+//  is enabled (see LiminalSpiritApp.hpp and main.cpp).
+//
+
+#ifndef __GAME_BENCHMARK_HPP__
+#define __GAME_BENCHMARK_HPP__
+#include <cugl/cugl.h>
+#include "GameScene.hpp"
+#include "InputTrace.hpp"
+
+/** The fixed timestep of the simulation */
+#define GAME_BENCHMARK_STEP     (1.0f/60.0f)
+/** The number of player unlocks (all abilities) */
+#define GAME_BENCHMARK_UNLOCKS  5
+/** The seed for the random number generator */
+#define GAME_BENCHMARK_SEED     1
+
+class GameBenchmark {
+public:
+    /** The result of a single level */
+    struct Result {
+        /** The level asset key */
+        std::string level;
+        /** The number of steps simulated */
+        Uint32 steps;
+        /** The number of waves spawned at the end */
+        int wave;
+        /** The most enemies alive at once */
+        size_t enemies;
+        /** The mean step time in milliseconds */
+        double mean;
+        /** The median step time in milliseconds */
+        double p50;
+        /** The 90th percentile step time in milliseconds */
+        double p90;
+        /** The 99th percentile step time in milliseconds */
+        double p99;
+        /** The slowest step time in milliseconds */
+        double max;
+        /** The mean physics step time in milliseconds */
+        double physics;
+    };
+
+protected:
+    /** The asset directory (ending in a path separator) */
+    std::string _directory;
+    /** The level files, keyed by level asset key */
+    std::shared_ptr<cugl::JsonValue> _levels;
+    /** The texture sizes, keyed by texture name */
+    std::shared_ptr<cugl::JsonValue> _textures;
+    /** The results of the levels run so far */
+    std::vector<Result> _results;
+
+    /**
+     * Returns the JSON value in the given file (nullptr on failure)
+     *
+     * @param file  The absolute path to the JSON file
+     *
+     * @return the JSON value in the given file (nullptr on failure)
+     */
+    static std::shared_ptr<cugl::JsonValue> readJson(const std::string& file);
+
+    /**
+     * Returns the size of the given PNG image (zero on failure)
+     *
+     * Only the header of the image is read.
+     *
+     * @param file  The absolute path to the PNG image
+     *
+     * @return the size of the given PNG image (zero on failure)
+     */
+    static cugl::Size readImageSize(const std::string& file);
+
+    /**
+     * Reads the level files and texture sizes from the asset directory
+     *
+     * @return true if the asset directory was read successfully
+     */
+    bool loadDirectory();
+
+    /**
+     * Returns the given percentile of the sorted samples
+     *
+     * @param samples   The samples in ascending order
+     * @param percent   The percentile in [0,1]
+     *
+     * @return the given percentile of the sorted samples
+     */
+    static double percentile(const std::vector<double>& samples, double percent);
+
+    /**
+     * Simulates a single level and records the result
+     *
+     * The level is given by its asset key, such as "forest10" or "BOSS".
+     * The simulation stops early if the level is won.
+     *
+     * @param level The level asset key
+     * @param steps The maximum number of steps to simulate
+     * @param wave  The wave to start at
+     * @param trace The scripted input (nullptr for no input)
+     */
+    void runLevel(const std::string& level, Uint32 steps, int wave,
+                  const std::shared_ptr<InputTrace>& trace);
+
+public:
+    /**
+     * Creates a benchmark for the given asset directory
+     *
+     * The directory is not read until the benchmark is run.
+     *
+     * @param directory The absolute path to the asset directory
+     */
+    GameBenchmark(const std::string& directory);
+
+    /**
+     * Simulates every level and returns the report
+     *
+     * This method only touches the file system, so it may be called with or
+     * without a running application.
+     *
+     * @param levels    The level asset keys
+     * @param steps     The maximum number of steps to simulate per level
+     * @param wave      The wave to start each level at
+     * @param trace     The scripted input (nullptr for no input)
+     *
+     * @return the benchmark report
+     */
+    std::string run(const std::vector<std::string>& levels, Uint32 steps, int wave,
+                    const std::shared_ptr<InputTrace>& trace);
+
+    /**
+     * Returns the results of the levels run so far
+     *
+     * @return the results of the levels run so far
+     */
+    const std::vector<Result>& getResults() const { return _results; }
+};
+
+#endif /* __GAME_BENCHMARK_HPP__ */
@@ -42,6 +42,7 @@
 #include "AttackController.hpp"
 #include "AIController.hpp"
 #include "CollisionController.hpp"
+#include "SaveController.hpp"
 
 #include "Glow.hpp"
 
@@ -49,8 +50,7 @@
 #include "RRParticleNode.h"
 #include "RRParticlePool.h"
 
-// Add support for simple random number generation
-#include <cstdlib>
+#include "Random.hpp"
 #include <ctime>
 
 // This keeps us from having to write cugl:: all the time
@@ -78,6 +78,20 @@ float DEFAULT_HEIGHT = DEFAULT_WIDTH / SCENE_WIDTH * SCENE_HEIGHT;
 #define PLATFORMTEXTURE "platform"
 #define TUTORIAL_INIT_TIMER 2
 #define TUTORIAL_READING_TIMER 5
+/** The fewest cores for which the physics step runs in parallel */
+#define PARALLEL_PHYSICS_CORES 4
+/** Whether to log the physics profile of every step to a CSV file */
+#ifndef PROFILE_PHYSICS
+#define PROFILE_PHYSICS 0
+#endif
+/** The file name for the physics profile (in the save directory) */
+#define PROFILE_PHYSICS_FILE "physics_profile.csv"
+/** Whether to record the input of every level for replay */
+#ifndef RECORD_INPUT
+#define RECORD_INPUT 0
+#endif
+/** The file name for the input recording (in the save directory) */
+#define RECORD_INPUT_FILE "input.lsr"
 /** The initial position of the player*/
 float PLAYER_POS[] = {1.0f, 1.0f};
 
@@ -96,31 +110,11 @@ float LEVEL_HEIGHT = 54;
  */
 bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const std::shared_ptr<SoundController> sound, string biome, int stageNum, int tutorial)
 {
-    _back = false;
-    _levelselect = false;
-    _restart = false;
-    _step = false;
-    _winInit = true;
-    _lose = false;
-    _next = false;
-    _pause = false;
-    _options = false;
-    _tutorial = tutorial;
-    _initTutorial = tutorial;
-    _tutorialTimer = TUTORIAL_INIT_TIMER;
-    _spawnParticleTimer = 0.0f;
-    _tutorialActionDone = false;
-    _tutorialInd = 0;
-    _chargeSoundCueM = true;
-    _chargeSoundCueR = true;
-    std::shared_ptr<JsonReader> reader = JsonReader::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    std::shared_ptr<JsonValue> save = reader->readJson();
-    _progress = save->get("progress");
-    std::shared_ptr<JsonValue> settings = save->get("settings");
-    reader->close();
-    _swap = settings->get("swap")->asInt();
-    _sfx = settings->get("sfx")->asInt();
-    _music = settings->get("music")->asInt();
+    _headless = false;
+    const SaveController::Settings& settings = SaveController::get()->getSettings();
+    _swap = settings.swap;
+    _sfx = settings.sfx;
+    _music = settings.music;
 
     Size dimen = Application::get()->getDisplaySize();
     float boundScale = SCENE_WIDTH / dimen.width;
@@ -145,95 +139,14 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     // set assets
     _assets = assets;
 
-    // Get constant values from assets/level.json
-    _constants = assets->get<JsonValue>(biome + to_string(stageNum));
-    _biome = _constants->getString("biome");
-    _stageNum = stageNum;
-    LEVEL_HEIGHT = _constants->getFloat("level_height");
-    PLAYER_POS[0] = _constants->get("start_pos")->get(0)->asFloat();
-    PLAYER_POS[1] = _constants->get("start_pos")->get(1)->asFloat();
-    auto platformsAttr = _constants->get("platforms")->children();
-    _platforms_attr.clear();
-    for (auto it = platformsAttr.begin(); it != platformsAttr.end(); ++it)
-    {
-        std::shared_ptr<JsonValue> entry = (*it);
-        float *attr = new float[3];
-        attr[0] = entry->get(0)->asFloat();
-        attr[1] = entry->get(1)->asFloat();
-        attr[2] = entry->get(2)->asFloat();
-
-        _platforms_attr.push_back(attr);
-    }
+    // Get constant values from assets/level.json (a negative stage is a level without a number)
+    initLevel(assets->get<JsonValue>(stageNum < 0 ? biome : biome + to_string(stageNum)), biome, stageNum, tutorial);
 
     // Sound controller
     _sound = sound;
 
     // Get Particle Info
-    _particleInfo = assets->get<JsonValue>("particles");
-
-    auto spawn = _constants->get("spawn_order")->children();
-    auto spawnPos = _constants->get("spawn_pos");
-    auto spawnTime = _constants->get("spawn_times");
-    int index = 0;
-    Vec2 pos;
-    _spawn_order.clear();
-    _spawn_pos.clear();
-    _spawn_times.clear();
-    for (auto it = spawn.begin(); it != spawn.end(); ++it)
-    {
-        std::shared_ptr<JsonValue> entry = (*it);
-        std::vector<string> enemies;
-        std::vector<Vec2> enemies_pos;
-        for (int i = 0; i < entry->size(); i++)
-        {
-            enemies.push_back(entry->get(i)->asString());
-            pos.x = spawnPos->get(index)->get(i)->get(0)->asFloat();
-            pos.y = spawnPos->get(index)->get(i)->get(1)->asFloat();
-            enemies_pos.push_back(pos);
-        }
-        _spawn_order.push_back(enemies);
-        _spawn_pos.push_back(enemies_pos);
-        _spawn_times.push_back(spawnTime->get(index)->asFloat());
-        index++;
-    }
-    _numWaves = index;
-    // Set enemy wave number
-    _nextWaveNum = 0;
-    _spawner_enemy_types.clear();
-    _living_spawners.clear();
-    _spawnParticlesDone = false;
-    _spawner_pos.clear();
-    if (_constants->get("spawner_types"))
-    {
-        auto spawnTypes = _constants->get("spawner_types")->children();
-        for (auto it = spawnTypes.begin(); it != spawnTypes.end(); ++it)
-        {
-            std::shared_ptr<JsonValue> entry = (*it);
-            std::unordered_map<string, spawnerEnemy> enemy_types;
-
-            for (int i = 0; i < entry->size(); i++)
-            {
-                string enemy = entry->get(i)->asString();
-                std::transform(enemy.begin(), enemy.end(), enemy.begin(),
-                               [](unsigned char c)
-                               { return std::tolower(c); });
-                if (!enemy_types[enemy].max_count)
-                {
-                    enemy_types[enemy].max_count = 1;
-                    enemy_types[enemy].current_count = 0;
-                    enemy_types[enemy].timer = 10.0f;
-                }
-                else
-                {
-                    enemy_types[enemy].max_count++;
-                }
-            }
-            _spawner_enemy_types.push_back(enemy_types);
-            _living_spawners.push_back(0);
-        }
-    }
-    _spawner_ind = -1;
-    _spawnerCount = 0;
+    _particleLibrary = assets->get<ParticleLibrary>("particles");
 
     // Create a scene graph the same size as the window
     //_scene = Scene2::alloc(dimen.width, dimen.height);
@@ -259,21 +172,6 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     // Activate mouse or touch screen input as appropriate
     // We have to do this BEFORE the scene, because the scene has a button
 
-    // Enable physics -jdg274
-    _world = physics2::ObstacleWorld::alloc(Rect(0, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT), Vec2(0, -GRAVITY));
-    _world->activateCollisionCallbacks(true);
-    //    _world->PreSolve = [this](b2Contact* contact, const b2Manifold *oldManifold) {
-    //        preSolve(contact, oldManifold);
-    //    };
-    _world->onBeginContact = [this](b2Contact *contact)
-    {
-        _collider.beginContact(contact, _attacks, _timer);
-    };
-    _world->onEndContact = [this](b2Contact *contact)
-    {
-        _collider.endContact(contact);
-    };
-
     // Only want to get swipes within safe bounds
     Rect bounds = Application::get()->getSafeBounds();
     _input.init(bounds.getMinX(), bounds.size.width);
@@ -284,6 +182,8 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     _scale = bounds.size.width / DEFAULT_WIDTH;
     Vec2 offset(bounds.getMinX(), 0);
 
+    initPhysics();
+
     // Create the scene graph
     // Bounds do not matter when constraint is false
     _worldnode = scene2::ScrollPane::allocWithBounds(bounds.size);
@@ -302,21 +202,10 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     _debugnode->setPosition(offset);
     scene->addChild(_debugnode);
 
-    // TODO this init might be wrong, Nick had _scale/2.0f
     _pMeleeTexture = _assets->get<Texture>(PATTACK_TEXTURE);
-    _attacks = std::make_shared<AttackController>();
-    _attacks->init(_scale, _scale * 1.5, 3, cugl::Vec2(0, 1.25), cugl::Vec2(0, 0.5), 0.8, 1, 0.25, 0.1, DEFAULT_WIDTH, DEFAULT_HEIGHT);
-    _dashTime = 0;
-    _dashXVel = 0;
-    _dashYVel = 0;
-    _cancelDash = false;
-
-    _ai = AIController();
-
-    _collider = CollisionController();
-    _collider.init(sound);
 
     setDebug(false);
+    buildLevel();
     buildScene(scene);
     addChildWithName(scene, "scene");
 
@@ -562,6 +451,10 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     _timer_text = TextLayout::allocWithText(msg, assets->get<Font>("marker"));
     _timer_text->layout();
 
+    _physics_text = TextLayout::allocWithText("Physics", assets->get<Font>("marker"));
+    _physics_text->setHorizontalAlignment(HorizontalAlign::LEFT);
+    _physics_text->layout();
+
     //Number Texture getting
 
     _numberTextures.push_back(_assets->get<Texture>("zero"));
@@ -608,7 +501,6 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
      _rangeParticleList.push_back(_assets->get<Texture>("attack_particle3"));
      _rangeParticleList.push_back(_assets->get<Texture>("attack_particle4"));
 
-    _timer = 0.0f;
     _worldnode->setColor(Color4::WHITE);
     _healthbar->setColor(Color4::WHITE);
     _pauseButton->setColor(Color4::WHITE);
@@ -616,9 +508,220 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager> &assets, const st
     _melee_charge->setColor(Color4::WHITE);
     _frameIncrement = 1;
     this->setColor(Color4::WHITE);
+
+#if RECORD_INPUT
+    startRecording(RECORD_INPUT_FILE);
+#endif
     return true;
 }
 
+/**
+ * Initializes the gameplay without a scene graph, sound or input devices
+ *
+ * A headless scene only simulates the level: the AI, attacks, physics and
+ * spawning.  It creates no scene graph nodes or textures, so it needs no
+ * window or GL context.  It never touches the audio engine, and its input
+ * is scripted (see {@link InputController#feed}).  It cannot be rendered.
+ *
+ * The physics bodies are sized by their textures, so the texture sizes are
+ * given as a JSON object mapping each texture key to [width, height].
+ *
+ * @param constants The JSON value for the level
+ * @param textures  The texture sizes, keyed by texture name
+ * @param biome     The biome (or level key)
+ * @param stageNum  The stage number (negative for a level without a number)
+ *
+ * @return true if the controller is initialized properly, false otherwise.
+ */
+bool GameScene::initHeadless(const std::shared_ptr<JsonValue>& constants, const std::shared_ptr<JsonValue>& textures, string biome, int stageNum)
+{
+    if (constants == nullptr || textures == nullptr)
+    {
+        return false;
+    }
+    _headless = true;
+    _textureSizes = textures;
+    _swap = false;
+
+    initLevel(constants, biome, stageNum, 0);
+
+    // A sound controller that is never initialized is silent
+    _sound = std::make_shared<SoundController>();
+    _input.setScripted(true);
+
+    // The scale of a display without a notch
+    _scale = SCENE_WIDTH / DEFAULT_WIDTH;
+    initPhysics();
+    buildLevel();
+    return true;
+}
+
+/**
+ * Internal helper to reset the game state and read the level
+ *
+ * This reads the constants, platforms and waves of the level.  It does not
+ * need any assets, so it is shared by {@link #init} and {@link #initHeadless}.
+ *
+ * @param constants The JSON value for the level
+ * @param biome     The biome (or level key)
+ * @param stageNum  The stage number (negative for a level without a number)
+ * @param tutorial  The tutorial number (0 for none)
+ */
+void GameScene::initLevel(const std::shared_ptr<JsonValue>& constants, string biome, int stageNum, int tutorial)
+{
+    _back = false;
+    _levelselect = false;
+    _restart = false;
+    _step = false;
+    _winInit = true;
+    _lose = false;
+    _next = false;
+    _pause = false;
+    _options = false;
+    _debug = false;
+    _tutorial = tutorial;
+    _initTutorial = tutorial;
+    _tutorialTimer = TUTORIAL_INIT_TIMER;
+    _spawnParticleTimer = 0.0f;
+    _tutorialActionDone = false;
+    _tutorialInd = 0;
+    _chargeSoundCueM = true;
+    _chargeSoundCueR = true;
+    _timer = 0.0f;
+    _replay = nullptr;
+    _replayFrame = 0;
+
+    _constants = constants;
+    _biome = _constants->getString("biome");
+    _stageNum = stageNum;
+    _level = biome;
+    LEVEL_HEIGHT = _constants->getFloat("level_height");
+    PLAYER_POS[0] = _constants->get("start_pos")->get(0)->asFloat();
+    PLAYER_POS[1] = _constants->get("start_pos")->get(1)->asFloat();
+    auto platformsAttr = _constants->get("platforms")->children();
+    _platforms_attr.clear();
+    for (auto it = platformsAttr.begin(); it != platformsAttr.end(); ++it)
+    {
+        std::shared_ptr<JsonValue> entry = (*it);
+        float *attr = new float[3];
+        attr[0] = entry->get(0)->asFloat();
+        attr[1] = entry->get(1)->asFloat();
+        attr[2] = entry->get(2)->asFloat();
+
+        _platforms_attr.push_back(attr);
+    }
+
+    auto spawn = _constants->get("spawn_order")->children();
+    auto spawnPos = _constants->get("spawn_pos");
+    auto spawnTime = _constants->get("spawn_times");
+    int index = 0;
+    Vec2 pos;
+    _spawn_order.clear();
+    _spawn_pos.clear();
+    _spawn_times.clear();
+    for (auto it = spawn.begin(); it != spawn.end(); ++it)
+    {
+        std::shared_ptr<JsonValue> entry = (*it);
+        std::vector<string> enemies;
+        std::vector<Vec2> enemies_pos;
+        for (int i = 0; i < entry->size(); i++)
+        {
+            enemies.push_back(entry->get(i)->asString());
+            pos.x = spawnPos->get(index)->get(i)->get(0)->asFloat();
+            pos.y = spawnPos->get(index)->get(i)->get(1)->asFloat();
+            enemies_pos.push_back(pos);
+        }
+        _spawn_order.push_back(enemies);
+        _spawn_pos.push_back(enemies_pos);
+        _spawn_times.push_back(spawnTime->get(index)->asFloat());
+        index++;
+    }
+    _numWaves = index;
+    // Set enemy wave number
+    _nextWaveNum = 0;
+    _spawner_enemy_types.clear();
+    _living_spawners.clear();
+    _spawnParticlesDone = false;
+    _spawner_pos.clear();
+    if (_constants->get("spawner_types"))
+    {
+        auto spawnTypes = _constants->get("spawner_types")->children();
+        for (auto it = spawnTypes.begin(); it != spawnTypes.end(); ++it)
+        {
+            std::shared_ptr<JsonValue> entry = (*it);
+            std::unordered_map<string, spawnerEnemy> enemy_types;
+
+            for (int i = 0; i < entry->size(); i++)
+            {
+                string enemy = entry->get(i)->asString();
+                std::transform(enemy.begin(), enemy.end(), enemy.begin(),
+                               [](unsigned char c)
+                               { return std::tolower(c); });
+                if (!enemy_types[enemy].max_count)
+                {
+                    enemy_types[enemy].max_count = 1;
+                    enemy_types[enemy].current_count = 0;
+                    enemy_types[enemy].timer = 10.0f;
+                }
+                else
+                {
+                    enemy_types[enemy].max_count++;
+                }
+            }
+            _spawner_enemy_types.push_back(enemy_types);
+            _living_spawners.push_back(0);
+        }
+    }
+    _spawner_ind = -1;
+    _spawnerCount = 0;
+}
+
+/**
+ * Internal helper to create the physics world and the gameplay controllers
+ *
+ * The drawing scale must be set first, as the attacks are sized by it.
+ */
+void GameScene::initPhysics()
+{
+    // Enable physics -jdg274
+    _world = physics2::ObstacleWorld::alloc(Rect(0, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT), Vec2(0, -GRAVITY));
+    _world->activateCollisionCallbacks(true);
+    // Contacts are computed in parallel, but the callbacks stay in order
+    if (SDL_GetCPUCount() >= PARALLEL_PHYSICS_CORES) {
+        _physicsThreads = TaskScheduler::alloc();
+        _world->setScheduler(_physicsThreads);
+    }
+#if PROFILE_PHYSICS
+    if (!_headless) {
+        _world->openProfileLog(PROFILE_PHYSICS_FILE);
+    }
+#endif
+    //    _world->PreSolve = [this](b2Contact* contact, const b2Manifold *oldManifold) {
+    //        preSolve(contact, oldManifold);
+    //    };
+    _world->onBeginContact = [this](b2Contact *contact)
+    {
+        _collider.beginContact(contact, _attacks, _timer);
+    };
+    _world->onEndContact = [this](b2Contact *contact)
+    {
+        _collider.endContact(contact);
+    };
+
+    // TODO this init might be wrong, Nick had _scale/2.0f
+    _attacks = std::make_shared<AttackController>();
+    _attacks->init(_scale, _scale * 1.5, 3, cugl::Vec2(0, 1.25), cugl::Vec2(0, 0.5), 0.8, 1, 0.25, 0.1, DEFAULT_WIDTH, DEFAULT_HEIGHT);
+    _dashTime = 0;
+    _dashXVel = 0;
+    _dashYVel = 0;
+    _cancelDash = false;
+
+    _ai = AIController();
+
+    _collider = CollisionController();
+    _collider.init(_sound);
+}
+
 void GameScene::addOptionsButtons(float buttonScale) {
 
     _optionReturnButton = std::dynamic_pointer_cast<scene2::Button>(_assets->get<scene2::SceneNode>("optionScene_return"));
@@ -699,6 +802,12 @@ void GameScene::addSFXButtons(float buttonScale) {
  */
 void GameScene::dispose()
 {
+    stopRecording();
+    if (_replay != nullptr) {
+        _replay = nullptr;
+        _input.setScripted(false);
+    }
+
     // Resetting input stuff because dispose is currently being used for switching levels
     _input.reset();
     _swipes.reset();
@@ -744,7 +853,9 @@ void GameScene::dispose()
     _batch = nullptr;
     _assets = nullptr;
     _constants = nullptr;
+    _textureSizes = nullptr;
     _world = nullptr;
+    _physicsThreads = nullptr;
     if (_worldnode)
         _worldnode->removeAllChildren();
     _worldnode = nullptr;
@@ -758,6 +869,7 @@ void GameScene::dispose()
     _sound = nullptr;
     _text = nullptr;
     _timer_text = nullptr;
+    _physics_text = nullptr;
     _font = nullptr;
     _endText = nullptr;
     _healthbar = nullptr;
@@ -765,6 +877,7 @@ void GameScene::dispose()
     _melee_charge = nullptr;
     _numberTextures.clear();
     _mirrorShardList.clear();
+    _particleLibrary = nullptr;
     _deathParticleList.clear();
     _rangeParticleList.clear();
     _meleeParticleList.clear();
@@ -778,189 +891,71 @@ void GameScene::dispose()
     }
     _lose = false;
     
-    // TODO: CHECK IF THIS IS RIGHT FOR DISPOSING
-    //    for (auto it = _enemies.begin(); it != _enemies.end(); ++it) {
-    //        (*it).~shared_ptr();
-    //    }
-    // This should work because smart pointers free themselves when vector is cleared
-    _enemies.clear();
-    _platforms.clear();
-    _spawners.clear();
-    _spawner_pos.clear();
-    if (_attacks)
-    {
-        _attacks->_current.clear();
-        _attacks->_pending.clear();
-    }
-    _platformNodes.clear();
-    _player = nullptr;
-    _attacks = nullptr;
-
-    _ai.dispose();
-    if (auto scene = getChildByName("scene"))
-    {
-        //scene->removeChildByName("HUD");
-        scene->removeAllChildren();
-    }
-    _musicButtons.clear();
-    _sfxButtons.clear();
-    removeAllChildren();
-}
-
-/**
- * The method called to update the game mode.
- *
- * This method contains any gameplay code that is not an OpenGL call.
- *
- * @param timestep  The amount of time (in seconds) since the last frame
- * @param unlockCount The amount of unlocks the player has.
- *                  1 - ranged attack
- *                  2 - charged ranged attack
- *                  3 - attack upgrade 1
- *                  4 - charged melee attack
- *                  5 - attack upgrade 2
- */
-void GameScene::update(float timestep, int unlockCount)
-{
-    if (_options)
-    {
-        _optionScene->setVisible(true);
-        _pauseScene->setVisible(false);
-        _loseScene->setVisible(false);
-        _optionReturnButton->activate();
-        _swapHandsButton->activate();
-
-        _returnButton->deactivate();
-        _homeButton->deactivate();
-        _optionButton->deactivate();
-        _restartButton->deactivate();
-        _pauseButton->setVisible(false);
-        _pauseButton->deactivate();
-        int counter = 1;
-        for (auto it = _musicButtons.begin(); it != _musicButtons.end(); ++it) {
-            (*it)->activate();
-            (*it)->setVisible(true);
-            if (counter <= _music) {
-                (*it)->setColor(Color4(255, 255, 255));
-            }
-            else {
-                (*it)->setColor(Color4(150, 150, 150));
-            }
-            counter++;
-        }
-        counter = 1;
-        for (auto it = _sfxButtons.begin(); it != _sfxButtons.end(); ++it) {
-            (*it)->activate();
-            (*it)->setVisible(true);
-            if (counter <= _sfx) {
-                (*it)->setColor(Color4(255, 255, 255));
-            }
-            else {
-                (*it)->setColor(Color4(150, 150, 150));
-            }
-            counter++;
-        }
-        if (!_swap) {
-            _leftText->setText("range");
-            _rightText->setText("melee");
-        }
-        else {
-            _leftText->setText("melee");
-            _rightText->setText("range");
-        }
-        std::vector<bool> e = std::vector<bool>(5);
-
-        for (auto it = _enemies.begin(); it != _enemies.end(); ++it)
-        {
-            string n = (*it)->getName();
-            if (n == "Glutton")
-            {
-                e[0] = true;
-            }
-            else if (n == "Phantom")
-            {
-                e[1] = true;
-            }
-            else if (n == "Mirror")
-            {
-                e[2] = true;
-            }
-            else if (n == "Spawner")
-            {
-                e[3] = true;
-            }
-            else if (n == "Seeker")
-            {
-                e[4] = true;
-            }
-        }
-        _sound->play_level_music(_biome, e);
-        return;
-    }
-    else
-    {
-        _optionScene->setVisible(false);
-        _pauseScene->setVisible(false);
-        _optionReturnButton->deactivate();
-        _swapHandsButton->deactivate();
-        for (auto it = _musicButtons.begin(); it != _musicButtons.end(); ++it) {
-            (*it)->deactivate();
-        }
-        for (auto it = _sfxButtons.begin(); it != _sfxButtons.end(); ++it) {
-            (*it)->deactivate();
-        }
-    }
-
-    if (_pause)
-    {
-        _pauseScene->setVisible(true);
-        _optionScene->setVisible(false);
-        _loseScene->setVisible(false);
-        _returnButton->activate();
-        _homeButton->activate();
-        _optionButton->activate();
-        _restartButton->activate();
-
-        _pauseButton->setVisible(false);
-        _pauseButton->deactivate();
-        return;
+    // TODO: CHECK IF THIS IS RIGHT FOR DISPOSING
+    //    for (auto it = _enemies.begin(); it != _enemies.end(); ++it) {
+    //        (*it).~shared_ptr();
+    //    }
+    // This should work because smart pointers free themselves when vector is cleared
+    _enemies.clear();
+    _levelCollision = nullptr;
+    _spawners.clear();
+    _spawner_pos.clear();
+    if (_attacks)
+    {
+        _attacks->_current.clear();
+        _attacks->_pending.clear();
     }
-    else
+    _player = nullptr;
+    _attacks = nullptr;
+
+    _ai.dispose();
+    if (auto scene = getChildByName("scene"))
     {
-        _pauseScene->setVisible(false);
-        _optionScene->setVisible(false);
-        _returnButton->deactivate();
-        _homeButton->deactivate();
-        _optionButton->deactivate();
-        _pauseButton->setVisible(true);
-        _pauseButton->activate();
-        _restartButton->deactivate();
+        //scene->removeChildByName("HUD");
+        scene->removeAllChildren();
     }
+    _musicButtons.clear();
+    _sfxButtons.clear();
+    removeAllChildren();
+}
 
-    if (_lose)
+/**
+ * The method called to update the game mode.
+ *
+ * This method contains any gameplay code that is not an OpenGL call.
+ *
+ * @param timestep  The amount of time (in seconds) since the last frame
+ * @param unlockCount The amount of unlocks the player has.
+ *                  1 - ranged attack
+ *                  2 - charged ranged attack
+ *                  3 - attack upgrade 1
+ *                  4 - charged melee attack
+ *                  5 - attack upgrade 2
+ */
+void GameScene::update(float timestep, int unlockCount)
+{
+    if (updateOverlays())
     {
-        _sound->level_transition();
-        _pauseScene->setVisible(false);
-        _optionScene->setVisible(false);
-        _loseScene->setVisible(true);
-        _loseHomeButton->activate();
-        _loseLevelButton->activate();
-        _loseRestartButton->activate();
-        _pauseButton->setVisible(true);
-        _pauseButton->deactivate();
         return;
     }
-    else
-    {
-        _loseScene->setVisible(false);
-        _loseHomeButton->deactivate();
-        _loseLevelButton->deactivate();
-        _loseRestartButton->deactivate();
-        _pauseButton->setVisible(true);
-        _pauseButton->activate();
+
+    // A replay overrides the input and the timestep
+    if (_replay != nullptr) {
+        if (_replayFrame < _replay->size()) {
+            timestep = _replay->getTimestep(_replayFrame);
+            unlockCount = _replay->getUnlocks();
+            _input.feed(_replay->getFrame(_replayFrame++));
+        } else {
+            CULog("Input replay finished after %zu frames", _replayFrame);
+            _replay = nullptr;
+            _input.setScripted(false);
+        }
     }
 
     updateSoundInputParticlesAndTilt(timestep);
+    if (_recording != nullptr) {
+        _recording->append(timestep, unlockCount, _input.getFrame());
+    }
 
     if (updateWin())
     {
@@ -1003,38 +998,12 @@ void GameScene::update(float timestep, int unlockCount)
         updateAnimations(timestep, unlockCount, SwipeController::noAttack, SwipeController::noAttack);
         updateRemoveDeletedAttacks();
         _world->update(timestep);
+        updateGlows(timestep);
         updateCamera();
         updateMeleeArm(timestep);
         return;
     } else {
-        std::vector<bool> e = std::vector<bool>(5);
-
-        for (auto it = _enemies.begin(); it != _enemies.end(); ++it)
-        {
-            string n = (*it)->getName();
-            if (n == "Glutton")
-            {
-                e[0] = true;
-            }
-            else if (n == "Phantom")
-            {
-                e[1] = true;
-            }
-            else if (n == "Mirror")
-            {
-                e[2] = true;
-            }
-            else if (n == "Spawner")
-            {
-                e[3] = true;
-            }
-            else if (n == "Seeker")
-            {
-                e[4] = true;
-            }
-        }
-        
-        _sound->play_level_music(_biome, e);
+        _sound->play_level_music(_biome, getMusicLayers());
     }
 
     updateTilt();
@@ -1098,12 +1067,144 @@ void GameScene::update(float timestep, int unlockCount)
 
 }
 
+/**
+ * Updates the options, pause and lose overlays
+ *
+ * A headless scene has no overlays, so this only reports a loss.
+ *
+ * @return true if an overlay (or a loss) stops the gameplay this frame
+ */
+bool GameScene::updateOverlays()
+{
+    if (_headless)
+    {
+        return _lose;
+    }
+
+    if (_options)
+    {
+        _optionScene->setVisible(true);
+        _pauseScene->setVisible(false);
+        _loseScene->setVisible(false);
+        _optionReturnButton->activate();
+        _swapHandsButton->activate();
+
+        _returnButton->deactivate();
+        _homeButton->deactivate();
+        _optionButton->deactivate();
+        _restartButton->deactivate();
+        _pauseButton->setVisible(false);
+        _pauseButton->deactivate();
+        int counter = 1;
+        for (auto it = _musicButtons.begin(); it != _musicButtons.end(); ++it) {
+            (*it)->activate();
+            (*it)->setVisible(true);
+            if (counter <= _music) {
+                (*it)->setColor(Color4(255, 255, 255));
+            }
+            else {
+                (*it)->setColor(Color4(150, 150, 150));
+            }
+            counter++;
+        }
+        counter = 1;
+        for (auto it = _sfxButtons.begin(); it != _sfxButtons.end(); ++it) {
+            (*it)->activate();
+            (*it)->setVisible(true);
+            if (counter <= _sfx) {
+                (*it)->setColor(Color4(255, 255, 255));
+            }
+            else {
+                (*it)->setColor(Color4(150, 150, 150));
+            }
+            counter++;
+        }
+        if (!_swap) {
+            _leftText->setText("range");
+            _rightText->setText("melee");
+        }
+        else {
+            _leftText->setText("melee");
+            _rightText->setText("range");
+        }
+        _sound->play_level_music(_biome, getMusicLayers());
+        return true;
+    }
+    else
+    {
+        _optionScene->setVisible(false);
+        _pauseScene->setVisible(false);
+        _optionReturnButton->deactivate();
+        _swapHandsButton->deactivate();
+        for (auto it = _musicButtons.begin(); it != _musicButtons.end(); ++it) {
+            (*it)->deactivate();
+        }
+        for (auto it = _sfxButtons.begin(); it != _sfxButtons.end(); ++it) {
+            (*it)->deactivate();
+        }
+    }
+
+    if (_pause)
+    {
+        _pauseScene->setVisible(true);
+        _optionScene->setVisible(false);
+        _loseScene->setVisible(false);
+        _returnButton->activate();
+        _homeButton->activate();
+        _optionButton->activate();
+        _restartButton->activate();
+
+        _pauseButton->setVisible(false);
+        _pauseButton->deactivate();
+        return true;
+    }
+    else
+    {
+        _pauseScene->setVisible(false);
+        _optionScene->setVisible(false);
+        _returnButton->deactivate();
+        _homeButton->deactivate();
+        _optionButton->deactivate();
+        _pauseButton->setVisible(true);
+        _pauseButton->activate();
+        _restartButton->deactivate();
+    }
+
+    if (_lose)
+    {
+        _sound->level_transition();
+        _pauseScene->setVisible(false);
+        _optionScene->setVisible(false);
+        _loseScene->setVisible(true);
+        _loseHomeButton->activate();
+        _loseLevelButton->activate();
+        _loseRestartButton->activate();
+        _pauseButton->setVisible(true);
+        _pauseButton->deactivate();
+        return true;
+    }
+    else
+    {
+        _loseScene->setVisible(false);
+        _loseHomeButton->deactivate();
+        _loseLevelButton->deactivate();
+        _loseRestartButton->deactivate();
+        _pauseButton->setVisible(true);
+        _pauseButton->activate();
+    }
+    return false;
+}
+
 void GameScene::updateSoundInputParticlesAndTilt(float timestep)
 {
     
 
     // Update input controller
     _input.update(_swap);
+    if (_headless)
+    {
+        return;
+    }
     // Debug Mode on/off
     if (_input.getDebugKeyPressed())
     {
@@ -1139,7 +1240,7 @@ void GameScene::updateSoundInputParticlesAndTilt(float timestep)
             if (sp->getFrame() == 4) {
                 sp->setVisible(false);
             }
-            else if (rand() % 100 < 25) { // dead bodies decay at random rate
+            else if (Random::get(Random::Stream::GAMEPLAY).nextInt(100) < 25) { // dead bodies decay at random rate
                 sp->setFrame(sp->getFrame() + 1);
             }
             
@@ -1149,7 +1250,7 @@ void GameScene::updateSoundInputParticlesAndTilt(float timestep)
             if (sp->getFrame() == 5) {
                 sp->setVisible(false);
             }
-            else if (rand() % 100 < 25) { // dead bodies decay at random rate
+            else if (Random::get(Random::Stream::GAMEPLAY).nextInt(100) < 25) { // dead bodies decay at random rate
                 sp->setFrame(sp->getFrame() + 1);
             }
         }
@@ -1158,7 +1259,7 @@ void GameScene::updateSoundInputParticlesAndTilt(float timestep)
             if (sp->getFrame() == 4) {
                 sp->setVisible(false);
             }
-            else if (rand() % 100 < 10) { // dead bodies decay at random rate
+            else if (Random::get(Random::Stream::GAMEPLAY).nextInt(100) < 10) { // dead bodies decay at random rate
                 sp->setFrame(sp->getFrame() + 1);
             }
         }
@@ -1167,7 +1268,7 @@ void GameScene::updateSoundInputParticlesAndTilt(float timestep)
             if (sp->getFrame() == 4) {
                 sp->setVisible(false);
             }
-            else if (rand() % 100 < 25) { // dead bodies decay at random rate
+            else if (Random::get(Random::Stream::GAMEPLAY).nextInt(100) < 25) { // dead bodies decay at random rate
                 sp->setFrame(sp->getFrame() + 1);
             }
         }
@@ -1194,6 +1295,11 @@ void GameScene::updateTilt()
 
 void GameScene::updateAnimations(float timestep, int unlockCount, SwipeController::SwipeAttack left, SwipeController::SwipeAttack right)
 {
+    // Animations only change sprites and glows, which a headless scene lacks
+    if (_headless)
+    {
+        return;
+    }
     ///////////////////////////////////////
     // Start Player and Arm Animations ////
     ///////////////////////////////////////
@@ -2081,9 +2187,6 @@ void GameScene::updateAnimations(float timestep, int unlockCount, SwipeControlle
     ////////////////////////////////////////
     ///////End Player and Arm Animations////
     ////////////////////////////////////////
-
-    // TODO: MAKE SURE MOVING THIS FROM BOTTOM OF UPDATE LOOP DOES NOT BREAK ANYTHING
-    _playerGlow->setPosition(_player->getPosition());
 }
 
 void GameScene::updateMeleeArm(float timestep)
@@ -2134,12 +2237,33 @@ void GameScene::updateMeleeArm(float timestep)
     }
 }
 
+void GameScene::updateGlows(float timestep)
+{
+    _playerGlow->update(timestep);
+    _rangedArm->update(timestep);
+    _rangedArmCharge->update(timestep);
+    _meleeArm->update(timestep);
+    _meleeArmDash->update(timestep);
+    for (auto it = _enemies.begin(); it != _enemies.end(); ++it)
+    {
+        if ((*it)->getGlow() != nullptr)
+        {
+            (*it)->getGlow()->update(timestep);
+        }
+    }
+}
+
 void GameScene::updateEnemies(float timestep)
 {
     // Enemy AI logic
     // For each enemy
-    std::shared_ptr<Texture> melee_impact = _assets->get<Texture>("melee_impact");
-    std::shared_ptr<Texture> ranged_impact = _assets->get<Texture>("ranged_impact");
+    std::shared_ptr<Texture> melee_impact;
+    std::shared_ptr<Texture> ranged_impact;
+    if (!_headless)
+    {
+        melee_impact = _assets->get<Texture>("melee_impact");
+        ranged_impact = _assets->get<Texture>("ranged_impact");
+    }
     for (auto it = _enemies.begin(); it != _enemies.end(); ++it)
     {
         Vec2 direction = _ai.getMovement(*it, _player->getPosition(), timestep, 0, DEFAULT_WIDTH, DEFAULT_HEIGHT);
@@ -2171,7 +2295,6 @@ void GameScene::updateEnemies(float timestep)
         {
             (*it)->setVY(direction.y);
         }
-        (*it)->getGlow()->setPosition((*it)->getPosition());
         (*it)->setAttackAnimationTimer((*it)->getAttackAnimationTimer() + timestep);
         (*it)->setInvincibilityTimer((*it)->getInvincibilityTimer() - timestep);
         (*it)->setIdleAnimationTimer((*it)->getIdleAnimationTimer() + timestep);
@@ -2191,41 +2314,48 @@ void GameScene::updateEnemies(float timestep)
         if ((*it)->getInvincibilityTimer() > 0 && !(*it)->getPlayedDamagedParticle())
         {
             (*it)->setPlayedDamagedParticle(true);
-            float damageParticleScale;
-            if ((*it)->getName() == "Spawner") {
-                damageParticleScale = 0.15;
-            }
-            else if ((*it)->getName() == "Glutton") {
-                damageParticleScale = 0.2;
-            }
-            else {
-                damageParticleScale = 0.1;
-            }
-            if ((*it)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_melee || (*it)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_dash)
+            if (!_headless)
             {
-                createParticles(melee_impact, (*it)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
-                createParticles(_meleeParticleList, (*it)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
-            }
-            else
-            {
-                createParticles(ranged_impact, (*it)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
-                createParticles(_rangeParticleList, (*it)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
-            }
-            if ((*it)->getLastDamageAmount() < 10)
-            {
-                std::vector<std::shared_ptr<Texture> > num;
-                num.push_back(_numberTextures[(*it)->getLastDamageAmount()]);
-                createParticles(num, (*it)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(), 0);
-            }
-            else
-            {
-                std::vector<std::shared_ptr<Texture> > num = getTexturesFromNumber((*it)->getLastDamageAmount());
-                createParticles(num, (*it)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(-10, 0), 0);
+                float damageParticleScale;
+                if ((*it)->getName() == "Spawner") {
+                    damageParticleScale = 0.15;
+                }
+                else if ((*it)->getName() == "Glutton") {
+                    damageParticleScale = 0.2;
+                }
+                else {
+                    damageParticleScale = 0.1;
+                }
+                if ((*it)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_melee || (*it)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_dash)
+                {
+                    createParticles(melee_impact, (*it)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
+                    createParticles(_meleeParticleList, (*it)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
+                }
+                else
+                {
+                    createParticles(ranged_impact, (*it)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
+                    createParticles(_rangeParticleList, (*it)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
+                }
+                if ((*it)->getLastDamageAmount() < 10)
+                {
+                    std::vector<std::shared_ptr<Texture> > num;
+                    num.push_back(_numberTextures[(*it)->getLastDamageAmount()]);
+                    createParticles(num, (*it)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(), 0);
+                }
+                else
+                {
+                    std::vector<std::shared_ptr<Texture> > num = getTexturesFromNumber((*it)->getLastDamageAmount());
+                    createParticles(num, (*it)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(-10, 0), 0);
+                }
             }
         }
 
         // For running idle animations specific (for speed) to enemies
-        if ((*it)->getName() == "Phantom")
+        if (sprite == nullptr)
+        {
+            // A headless scene has no sprites to animate
+        }
+        else if ((*it)->getName() == "Phantom")
         {
 
             if ((*it)->getInvincibilityTimer() > 0)
@@ -2559,25 +2689,25 @@ std::vector<std::shared_ptr<Texture> > GameScene::getTexturesFromNumber(int num)
     return nums;
 }
 
-void GameScene::createParticles(std::shared_ptr<Texture> texture, Vec2 pos, string poolName, Color4 tint, Vec2 pointOffset, float scale)
+void GameScene::createParticles(std::shared_ptr<Texture> texture, Vec2 pos, const string& poolName, Color4 tint, Vec2 pointOffset, float scale)
 {
     std::shared_ptr<ParticleNode> pn;
-    std::shared_ptr<ParticlePool> pool = ParticlePool::allocPoint(_particleInfo->get(poolName), pointOffset);
+    std::shared_ptr<ParticlePool> pool = ParticlePool::allocPoint(_particleLibrary->get(poolName), pointOffset);
     pn = ParticleNode::alloc(pos, texture, pool);
     pn->setScale(scale);
     pn->setColor(tint);
     _worldnode->addChildWithTag(pn, 100);
 }
 
-void GameScene::createParticles(std::vector<std::shared_ptr<Texture> > textures, Vec2 pos, string poolName, Color4 tint, Vec2 pointOffset, float scale, bool hasMultipleLinkedTextures, Vec2 linkOffset, int numTex)
+void GameScene::createParticles(std::vector<std::shared_ptr<Texture> > textures, Vec2 pos, const string& poolName, Color4 tint, Vec2 pointOffset, float scale, bool hasMultipleLinkedTextures, Vec2 linkOffset, int numTex)
 {
     std::shared_ptr<ParticleNode> pn;
     std::shared_ptr<ParticlePool> pool;
     if (!hasMultipleLinkedTextures) {
-        pool = ParticlePool::allocPoint(_particleInfo->get(poolName), pointOffset, numTex);
+        pool = ParticlePool::allocPoint(_particleLibrary->get(poolName), pointOffset, numTex);
     }
     else {
-        pool = ParticlePool::allocPoint(_particleInfo->get(poolName), pointOffset);
+        pool = ParticlePool::allocPoint(_particleLibrary->get(poolName), pointOffset);
     }
     pn = ParticleNode::alloc(pos, textures, pool, hasMultipleLinkedTextures, linkOffset);
     pn->setScale(scale);
@@ -2933,20 +3063,23 @@ void GameScene::updateAttacks(float timestep, int unlockCount, SwipeController::
     if (_player->getInvincibilityTimer() > 0 && _player->getPostStunnedInvincibilityTimer() >= 0.1 && !_player->isStunned())
     {
         //_player->getSceneNode()->setVisible(!_player->getSceneNode()->isVisible());
-        int a = _player->getSceneNode()->getColor().a;
-        if (a == 255)
+        if (!_headless)
         {
-            a = 255 / 2;
-        }
-        else
-        {
-            a = 255;
+            int a = _player->getSceneNode()->getColor().a;
+            if (a == 255)
+            {
+                a = 255 / 2;
+            }
+            else
+            {
+                a = 255;
+            }
+            _player->getSceneNode()->setColor(Color4(255, 255, 255, a));
         }
-        _player->getSceneNode()->setColor(Color4(255, 255, 255, a));
         _player->setPostStunnedInvincibilityTimer(0);
     }
 
-    if (_player->getInvincibilityTimer() < 0)
+    if (_player->getInvincibilityTimer() < 0 && !_headless)
     {
         _player->getSceneNode()->setVisible(true);
         _player->getSceneNode()->setColor(Color4(255, 255, 255, 255));
@@ -2960,9 +3093,19 @@ void GameScene::updateAttacks(float timestep, int unlockCount, SwipeController::
     _player->setInvincibilityTimer(_player->getInvincibilityTimer() - timestep);
     _player->setPostStunnedInvincibilityTimer(_player->getPostStunnedInvincibilityTimer() + timestep);
     _world->update(timestep);
+    updateGlows(timestep);
+    // Projectiles have no contacts, so sweep them for hits
+    _attacks->sweep(_world, [this](AttackController::Attack *attack, physics2::Obstacle *bd, std::string *fd)
+                    { _collider.projectileHit(attack, bd, fd, _attacks, _timer); });
 
     for (auto it = _attacks->_pending.begin(); it != _attacks->_pending.end(); ++it)
     {
+        // The rest of this loop only picks sprites and arm animations
+        if (_headless)
+        {
+            addObstacle((*it), nullptr, true);
+            continue;
+        }
 
         AttackController::Type attackType = (*it)->getType();
         std::shared_ptr<scene2::PolygonNode> attackSprite;
@@ -3183,8 +3326,11 @@ void GameScene::updateRemoveDeletedAttacks()
         {
             // int log1 = _world->getObstacles().size();
             cugl::physics2::Obstacle *obj = dynamic_cast<cugl::physics2::Obstacle *>(&**ait);
-            _world->removeObstacle(obj);
-            _worldnode2->removeChild(obj->_node);
+            _world->deferRemoval(obj);
+            if (!_headless)
+            {
+                _worldnode2->removeChild(obj->_node);
+            }
 
             // int log2 = _world->getObstacles().size();
             ait = _attacks->_current.erase(ait);
@@ -3192,8 +3338,11 @@ void GameScene::updateRemoveDeletedAttacks()
         // Delete dash attack if dash cancelled
         else if ((*ait)->getType() == AttackController::Type::p_dash && _cancelDash) {
             cugl::physics2::Obstacle *obj = dynamic_cast<cugl::physics2::Obstacle *>(&**ait);
-            _world->removeObstacle(obj);
-            _worldnode2->removeChild(obj->_node);
+            _world->deferRemoval(obj);
+            if (!_headless)
+            {
+                _worldnode2->removeChild(obj->_node);
+            }
 
             ait = _attacks->_current.erase(ait);
             _cancelDash = false;
@@ -3221,71 +3370,74 @@ void GameScene::updateRemoveDeletedEnemies()
         }
         if (!bypass && (*eit)->isRemoved())
         {
-
-            float damageParticleScale;
-            if ((*eit)->getName() == "Spawner") {
-                damageParticleScale = 0.15;
-            }
-            else if ((*eit)->getName() == "Glutton") {
-                damageParticleScale = 0.2;
-            }
-            else {
-                damageParticleScale = 0.1;
-            }
-            //Plays damage particles then death particles shortly after (they fade-in on a delay)
-            if ((*eit)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_melee || (*eit)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_dash) {
-                createParticles(_assets->get<Texture>("melee_impact"), (*eit)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
-                createParticles(_meleeParticleList, (*eit)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
-            }
-            else {
-                createParticles(_assets->get<Texture>("ranged_impact"), (*eit)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
-                createParticles(_rangeParticleList, (*eit)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
-            }
-            
-            if ((*eit)->getLastDamageAmount() < 10)
-            {
-                std::vector<std::shared_ptr<Texture> > num;
-                num.push_back(_numberTextures[(*eit)->getLastDamageAmount()]);
-                createParticles(num, (*eit)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(), 0);
-            }
-            else
+            if (!_headless)
             {
-                std::vector<std::shared_ptr<Texture> > num = getTexturesFromNumber((*eit)->getLastDamageAmount());
-                createParticles(num, (*eit)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(-10, 0), 0);
-            }
+                float damageParticleScale;
+                if ((*eit)->getName() == "Spawner") {
+                    damageParticleScale = 0.15;
+                }
+                else if ((*eit)->getName() == "Glutton") {
+                    damageParticleScale = 0.2;
+                }
+                else {
+                    damageParticleScale = 0.1;
+                }
+                //Plays damage particles then death particles shortly after (they fade-in on a delay)
+                if ((*eit)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_melee || (*eit)->getLastDamagedBy() == BaseEnemyModel::AttackType::p_dash) {
+                    createParticles(_assets->get<Texture>("melee_impact"), (*eit)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
+                    createParticles(_meleeParticleList, (*eit)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
+                }
+                else {
+                    createParticles(_assets->get<Texture>("ranged_impact"), (*eit)->getPosition() * _scale, "devil", Color4::WHITE, Vec2(0, 0), damageParticleScale);
+                    createParticles(_rangeParticleList, (*eit)->getPosition() * _scale, "sparks", Color4::WHITE, Vec2(0, 0), damageParticleScale*2, false, Vec2(), 7);
+                }
+            
+                if ((*eit)->getLastDamageAmount() < 10)
+                {
+                    std::vector<std::shared_ptr<Texture> > num;
+                    num.push_back(_numberTextures[(*eit)->getLastDamageAmount()]);
+                    createParticles(num, (*eit)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(), 0);
+                }
+                else
+                {
+                    std::vector<std::shared_ptr<Texture> > num = getTexturesFromNumber((*eit)->getLastDamageAmount());
+                    createParticles(num, (*eit)->getPosition() * _scale, "number", Color4::WHITE, Vec2(0, 10), 0.1f, true, Vec2(-10, 0), 0);
+                }
 
-            //Mirror shard breaking
-            if (std::shared_ptr<Mirror> mirror = dynamic_pointer_cast<Mirror>(*eit)) {
-                createParticles(_mirrorShardList, (*eit)->getPosition() * _scale, "mirror_death", Color4::WHITE, Vec2(0, 10), 0.05f, false, Vec2(), 6);
-                _sound->play_death_sound(true);
-            }
-            else if (std::shared_ptr<Lost> lost = dynamic_pointer_cast<Lost>(*eit)) {
-                createAndAddDeathAnimationObstacle("lost_death", (*eit)->getPosition(), 0.125f, 5, 200);
-                createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.15f, false, Vec2(), 4);
-            }
-            else if (std::shared_ptr<Phantom> phantom = dynamic_pointer_cast<Phantom>(*eit)) {
-                createAndAddDeathAnimationObstacle("phantom_death", (*eit)->getPosition(), 0.2f, 6, 201);
-                createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.25f, false, Vec2(), 4);
-            } 
-            else if (std::shared_ptr<Glutton> glutton = dynamic_pointer_cast<Glutton>(*eit)) {
-                createAndAddDeathAnimationObstacle("glutton_death", (*eit)->getPosition(), 0.2f, 5, 202);
-                createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "big_death", Color4::WHITE, Vec2(0, -20), 0.4f, false, Vec2(), 4);
-            }
-            else if (std::shared_ptr<Seeker> seeker = dynamic_pointer_cast<Seeker>(*eit)) {
-                createAndAddDeathAnimationObstacle("seeker_death", (*eit)->getPosition(), 0.125f, 6, 203);
-                createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.35f, false, Vec2(), 4);
-            }
-            else if (std::shared_ptr<Spawner> spawner = dynamic_pointer_cast<Spawner>(*eit)) {
-                createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "big_death", Color4::WHITE, Vec2(0, -20), 0.35f, false, Vec2(), 4);
+                //Mirror shard breaking
+                if (std::shared_ptr<Mirror> mirror = dynamic_pointer_cast<Mirror>(*eit)) {
+                    createParticles(_mirrorShardList, (*eit)->getPosition() * _scale, "mirror_death", Color4::WHITE, Vec2(0, 10), 0.05f, false, Vec2(), 6);
+                    _sound->play_death_sound(true);
+                }
+                else if (std::shared_ptr<Lost> lost = dynamic_pointer_cast<Lost>(*eit)) {
+                    createAndAddDeathAnimationObstacle("lost_death", (*eit)->getPosition(), 0.125f, 5, 200);
+                    createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.15f, false, Vec2(), 4);
+                }
+                else if (std::shared_ptr<Phantom> phantom = dynamic_pointer_cast<Phantom>(*eit)) {
+                    createAndAddDeathAnimationObstacle("phantom_death", (*eit)->getPosition(), 0.2f, 6, 201);
+                    createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.25f, false, Vec2(), 4);
+                } 
+                else if (std::shared_ptr<Glutton> glutton = dynamic_pointer_cast<Glutton>(*eit)) {
+                    createAndAddDeathAnimationObstacle("glutton_death", (*eit)->getPosition(), 0.2f, 5, 202);
+                    createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "big_death", Color4::WHITE, Vec2(0, -20), 0.4f, false, Vec2(), 4);
+                }
+                else if (std::shared_ptr<Seeker> seeker = dynamic_pointer_cast<Seeker>(*eit)) {
+                    createAndAddDeathAnimationObstacle("seeker_death", (*eit)->getPosition(), 0.125f, 6, 203);
+                    createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "lost_death", Color4::WHITE, Vec2(0, -20), 0.35f, false, Vec2(), 4);
+                }
+                else if (std::shared_ptr<Spawner> spawner = dynamic_pointer_cast<Spawner>(*eit)) {
+                    createParticles(_deathParticleList, (*eit)->getPosition() * _scale, "big_death", Color4::WHITE, Vec2(0, -20), 0.35f, false, Vec2(), 4);
+                }
             }
             
             // int log1 = _world->getObstacles().size();
-            cugl::physics2::Obstacle *glowObj = dynamic_cast<cugl::physics2::Obstacle *>(&*(*eit)->getGlow());
             cugl::physics2::Obstacle *obj = dynamic_cast<cugl::physics2::Obstacle *>(&**eit);
-            _world->removeObstacle(glowObj);
-            _worldnode2->removeChild(glowObj->_node);
-            _world->removeObstacle(obj);
-            _worldnode2->removeChild(obj->_node);
+            _world->deferRemoval(obj);
+            if (!_headless)
+            {
+                _worldnode2->removeChild((*eit)->getGlow()->getSceneNode());
+                _worldnode2->removeChild(obj->_node);
+            }
 
             // int log2 = _world->getObstacles().size();
             eit = _enemies.erase(eit);
@@ -3299,7 +3451,7 @@ void GameScene::updateRemoveDeletedEnemies()
 
 void GameScene::createAndAddDeathAnimationObstacle(string textureName, Vec2 startPos, float scale, int frames, int tag) {
     std::shared_ptr<Texture> image = _assets->get<Texture>(textureName);
-    std::shared_ptr<Glow> glow = Glow::alloc(startPos, image->getSize() / _scale, _scale);
+    std::shared_ptr<Glow> glow = Glow::alloc(startPos, _scale);
     std::shared_ptr<scene2::SpriteNode> sprite = scene2::SpriteNode::alloc(image, 1, frames);
     glow->setSceneNode(sprite);
     glow->setAnimeTimer(0.f);
@@ -3314,12 +3466,28 @@ void GameScene::createAndAddDeathAnimationObstacle(string textureName, Vec2 star
 
 void GameScene::updateText()
 {
+    if (_headless)
+    {
+        return;
+    }
     _text->setText(strtool::format("Wave: %d / %d", _nextWaveNum, _numWaves));
     _text->layout();
 
     int duration = _nextWaveNum < _spawn_times.size() ? (int)_spawn_times[_nextWaveNum] - (int)_timer : -1;
     _timer_text->setText(strtool::format("Next Wave In: %d", duration > 0 ? duration : 0));
     _timer_text->layout();
+
+    if (_debug) {
+        const physics2::ObstacleWorld::Profile& profile = _world->getProfile();
+        _physics_text->setText(strtool::format("Step %.2f ms (broad %.2f, narrow %.2f, solve %.2f, toi %.2f)\n"
+                                               "Callbacks %.2f ms, sync %.2f ms\n"
+                                               "Bodies %u (%u awake, %u synced), contacts %u (%u touching)",
+                                               profile.step, profile.broadphase, profile.narrowphase,
+                                               profile.solve, profile.solveTOI, profile.callbacks, profile.sync,
+                                               profile.bodies, profile.awake, profile.updated,
+                                               profile.contacts, profile.touching));
+        _physics_text->layout();
+    }
 }
 
 /**
@@ -3343,9 +3511,12 @@ void GameScene::updateRemoveDeletedPlayer()
     if (_player->isRemoved())
     {
         _lose = true;
-        _player->getSceneNode()->setVisible(false);
-        _rangedArm->getSceneNode()->setVisible(false);
-        _meleeArm->getSceneNode()->setVisible(false);
+        if (!_headless)
+        {
+            _player->getSceneNode()->setVisible(false);
+            _rangedArm->getSceneNode()->setVisible(false);
+            _meleeArm->getSceneNode()->setVisible(false);
+        }
         //        reset();
         //        _player->markRemoved(false);
     }
@@ -3353,6 +3524,10 @@ void GameScene::updateRemoveDeletedPlayer()
 
 void GameScene::updateHUD(int unlockCount)
 {
+    if (_headless)
+    {
+        return;
+    }
     // Update the health meter
     // left offset is additive, makes progress end at most leftOff*rightOff from left edge
     float leftOff = .2;
@@ -3422,8 +3597,45 @@ void GameScene::updateHUD(int unlockCount)
     _range_charge->setProgress(_swipes.getRangeCharge());
 }
 
+/**
+ * Returns the mask of enemy music layers for the enemies on screen
+ */
+Uint8 GameScene::getMusicLayers()
+{
+    Uint8 layers = 0;
+    for (auto it = _enemies.begin(); it != _enemies.end(); ++it)
+    {
+        const string& n = (*it)->getName();
+        if (n == "Glutton")
+        {
+            layers |= 1 << SoundController::gluttonLayer;
+        }
+        else if (n == "Phantom")
+        {
+            layers |= 1 << SoundController::phantomLayer;
+        }
+        else if (n == "Mirror")
+        {
+            layers |= 1 << SoundController::mirrorLayer;
+        }
+        else if (n == "Spawner")
+        {
+            layers |= 1 << SoundController::spawnerLayer;
+        }
+        else if (n == "Seeker")
+        {
+            layers |= 1 << SoundController::seekerLayer;
+        }
+    }
+    return layers;
+}
+
 void GameScene::updateCamera()
 {
+    if (_headless)
+    {
+        return;
+    }
     // Camera following player, with some non-linear smoothing
     float dy = getChild(0)->getContentSize().height / 2 - _worldnode->getPaneTransform().transform(_player->getSceneNode()->getPosition()).y;
     Vec2 pan = Vec2(0, dy);
@@ -3441,12 +3653,15 @@ void GameScene::updateSpawnEnemies(float timestep)
     _spawnParticleTimer += timestep;
     if (_nextWaveNum < _numWaves && _timer >= _spawn_times[_nextWaveNum] - 3 && !_spawnParticlesDone)
     {
-        for (std::shared_ptr<scene2::SceneNode> s : _worldnode2->getChildren()) {
-            if (s->getTag() == 69) {
-                s->removeFromParent();
+        if (!_headless)
+        {
+            for (std::shared_ptr<scene2::SceneNode> s : _worldnode2->getChildren()) {
+                if (s->getTag() == 69) {
+                    s->removeFromParent();
+                }
             }
+            createSpawnParticles();
         }
-        createSpawnParticles();
         _spawnParticlesDone = true;
         _spawnParticleTimer = 0.0f;
     }
@@ -3605,6 +3820,8 @@ void GameScene::render(const std::shared_ptr<cugl::SpriteBatch> &batch)
     
         if (_nextWaveNum < _spawn_times.size())
         batch->drawText(_timer_text, Vec2(getSize().width - _timer_text->getBounds().size.width - 20, getSize().height - _timer_text->getBounds().size.height - 50));
+
+        batch->drawText(_physics_text, Vec2(20, 20 - _physics_text->getBounds().origin.y));
     }
 
     batch->setColor(Color4::GREEN);
@@ -3617,6 +3834,24 @@ void GameScene::render(const std::shared_ptr<cugl::SpriteBatch> &batch)
 
 void GameScene::createMirror(Vec2 enemyPos, Mirror::Type type, std::string assetName, std::shared_ptr<Glow> enemyGlow)
 {
+    Size mirrorSize = getTextureSize(assetName);
+    std::shared_ptr<Mirror> mirror = Mirror::alloc(enemyPos, mirrorSize, mirrorSize / _scale / 15, _scale, type); // TODO this is not right, fix this to be closest enemy
+    mirror->setGlow(enemyGlow);
+    mirror->setAttackAnimationTimer(0);
+    mirror->setDebugColor(Color4::BLUE);
+    if (_headless)
+    {
+        // Draw the shard picks anyway, so the gameplay stream stays in step
+        for (int ii = 0; ii < 3; ii++)
+        {
+            Random::get(Random::Stream::GAMEPLAY).nextInt(6);
+        }
+        mirror->showAttack(false);
+        addObstacle(mirror, nullptr, true);
+        _enemies.push_back(mirror);
+        return;
+    }
+
     std::shared_ptr<Texture> mirrorImage = _assets->get<Texture>(assetName);
     std::shared_ptr<Texture> mirrorHurtImage = _assets->get<Texture>(assetName + "_hurt");
     std::shared_ptr<Texture> mirror_reflectattackImage = _assets->get<Texture>(MIRROR_REFLECT_TEXTURE);
@@ -3629,11 +3864,8 @@ void GameScene::createMirror(Vec2 enemyPos, Mirror::Type type, std::string asset
     mirrorShards[4] = scene2::PolygonNode::allocWithTexture(_mirrorShardList[4]);
     mirrorShards[5] = scene2::PolygonNode::allocWithTexture(_mirrorShardList[5]);
 
-    std::shared_ptr<Mirror> mirror = Mirror::alloc(enemyPos, mirrorImage->getSize(), mirrorImage->getSize() / _scale / 15, _scale, type); // TODO this is not right, fix this to be closest enemy
     std::shared_ptr<scene2::PolygonNode> mirrorSprite = scene2::PolygonNode::allocWithTexture(mirrorImage);
     std::shared_ptr<scene2::PolygonNode> mirrorHurtSprite = scene2::PolygonNode::allocWithTexture(mirrorHurtImage);
-    mirror->setGlow(enemyGlow);
-    mirror->setAttackAnimationTimer(0);
     mirror->setHurtSprite(mirrorHurtSprite);
     std::shared_ptr<scene2::SpriteNode> attackSprite = scene2::SpriteNode::alloc(mirror_reflectattackImage, MIRROR_REFLECT_ROWS, MIRROR_REFLECT_COLS);
     attackSprite->setFrame(0);
@@ -3642,18 +3874,17 @@ void GameScene::createMirror(Vec2 enemyPos, Mirror::Type type, std::string asset
     mirror->showAttack(false);
 
     std::shared_ptr<scene2::PolygonNode> mirrorShard1 = mirrorShards[1];
-    mirrorShards[rand() % 6]->copy(mirrorShard1);
+    mirrorShards[Random::get(Random::Stream::GAMEPLAY).nextInt(6)]->copy(mirrorShard1);
     std::shared_ptr<scene2::PolygonNode> mirrorShard2 = mirrorShards[2];
-    mirrorShards[rand() % 6]->copy(mirrorShard2);
+    mirrorShards[Random::get(Random::Stream::GAMEPLAY).nextInt(6)]->copy(mirrorShard2);
     std::shared_ptr<scene2::PolygonNode> mirrorShard3 = mirrorShards[3];
-    mirrorShards[rand() % 6]->copy(mirrorShard3);
+    mirrorShards[Random::get(Random::Stream::GAMEPLAY).nextInt(6)]->copy(mirrorShard3);
 
     mirror->setThreeShards(mirrorShard1, mirrorShard2, mirrorShard3);
     mirror->setSceneNode(mirrorSprite);
     // mirrorSprite->addChildWithName(mirrorShard1, "shard1");
     // mirrorSprite->addChildWithName(mirrorShard2, "shard2");
     // mirrorSprite->addChildWithName(mirrorShard3, "shard3");
-    mirror->setDebugColor(Color4::BLUE);
     mirrorSprite->setScale(0.15f);
     mirrorSprite->setPriority(1.4);
     addObstacle(mirror, mirrorSprite, true);
@@ -3674,51 +3905,62 @@ void GameScene::createSpawnerEnemy(int spawnerInd, string enemyName)
 
 void GameScene::createEnemy(string enemyName, Vec2 enemyPos, int spawnerInd) {
 
-    std::shared_ptr<Texture> enemyGlowImage = _assets->get<Texture>(GLOW_TEXTURE);
-    std::shared_ptr<Glow> enemyGlow = Glow::alloc(enemyPos, enemyGlowImage->getSize() / _scale, _scale);
-    std::shared_ptr<scene2::PolygonNode> enemyGlowSprite = scene2::PolygonNode::allocWithTexture(enemyGlowImage);
-    enemyGlow->setSceneNode(enemyGlowSprite);
-    std::shared_ptr<Gradient> grad = Gradient::allocRadial(Color4(255, 255, 255, 85), Color4(111, 111, 111, 0), Vec2(0.5, 0.5), .2f);
-    enemyGlowSprite->setGradient(grad);
-    enemyGlowSprite->setRelativeColor(false);
-    enemyGlowSprite->setScale(.65f);
-    addObstacle(enemyGlow, enemyGlowSprite, true);
+    // A headless scene has no glows or sprites, only bodies sized by the textures
+    std::shared_ptr<Glow> enemyGlow;
+    if (!_headless)
+    {
+        std::shared_ptr<Texture> enemyGlowImage = _assets->get<Texture>(GLOW_TEXTURE);
+        enemyGlow = Glow::alloc(enemyPos, _scale);
+        std::shared_ptr<scene2::PolygonNode> enemyGlowSprite = scene2::PolygonNode::allocWithTexture(enemyGlowImage);
+        enemyGlow->setSceneNode(enemyGlowSprite);
+        std::shared_ptr<Gradient> grad = Gradient::allocRadial(Color4(255, 255, 255, 85), Color4(111, 111, 111, 0), Vec2(0.5, 0.5), .2f);
+        enemyGlowSprite->setGradient(grad);
+        enemyGlowSprite->setRelativeColor(false);
+        enemyGlowSprite->setScale(.65f);
+        _worldnode2->addChild(enemyGlowSprite);
+    }
     if (!enemyName.compare("lost"))
     {
-        std::shared_ptr<Texture> lostHitBoxImage = _assets->get<Texture>("lost");
-        std::shared_ptr<Texture> lostImage = _assets->get<Texture>("lost_ani");
-        std::shared_ptr<Lost> lost = Lost::alloc(enemyPos, Size(lostImage->getSize().width / 4.0f, lostImage->getSize().height / 3.0f), lostHitBoxImage->getSize() / _scale / 10, _scale);
-        std::shared_ptr<scene2::SpriteNode> lostSprite = scene2::SpriteNode::alloc(lostImage, 3, 4);
-        lostSprite->setFrame(0);
-        lostSprite->setAnchor(Vec2(0.5, 0.25));
+        Size lostSize = getTextureSize("lost_ani");
+        std::shared_ptr<Lost> lost = Lost::alloc(enemyPos, Size(lostSize.width / 4.0f, lostSize.height / 3.0f), getTextureSize("lost") / _scale / 10, _scale);
+        std::shared_ptr<scene2::SpriteNode> lostSprite;
+        if (!_headless)
+        {
+            lostSprite = scene2::SpriteNode::alloc(_assets->get<Texture>("lost_ani"), 3, 4);
+            lostSprite->setFrame(0);
+            lostSprite->setAnchor(Vec2(0.5, 0.25));
+            lostSprite->setScale(0.15f);
+            lostSprite->setPriority(1.3);
+            lost->setSceneNode(lostSprite);
+        }
         lost->setGlow(enemyGlow);
-        lost->setSceneNode(lostSprite);
         lost->setDebugColor(Color4::RED);
         lost->setPlayedDamagedParticle(false);
         if (spawnerInd > -1) {
             lost->setSpawnerInd(spawnerInd);
         }
-        lostSprite->setScale(0.15f);
-        lostSprite->setPriority(1.3);
         addObstacle(lost, lostSprite, true);
         _enemies.push_back(lost);
     }
     else if (!enemyName.compare("phantom"))
     {
-        std::shared_ptr<Texture> phantomHitboxImage = _assets->get<Texture>("phantom");
-        std::shared_ptr<Texture> phantomImage = _assets->get<Texture>("phantom_ani");
-        std::shared_ptr<Phantom> phantom = Phantom::alloc(enemyPos, Vec2(phantomImage->getSize().width / 7, phantomImage->getSize().height/2), phantomHitboxImage->getSize() / _scale / 10, _scale);
-        std::shared_ptr<scene2::SpriteNode> phantomSprite = scene2::SpriteNode::alloc(phantomImage, 2, 7);
-        phantom->setSceneNode(phantomSprite);
+        Size phantomSize = getTextureSize("phantom_ani");
+        std::shared_ptr<Phantom> phantom = Phantom::alloc(enemyPos, Vec2(phantomSize.width / 7, phantomSize.height/2), getTextureSize("phantom") / _scale / 10, _scale);
+        std::shared_ptr<scene2::SpriteNode> phantomSprite;
+        if (!_headless)
+        {
+            phantomSprite = scene2::SpriteNode::alloc(_assets->get<Texture>("phantom_ani"), 2, 7);
+            phantomSprite->setScale(0.2f);
+            phantomSprite->setFrame(0);
+            phantomSprite->setPriority(1.2);
+            phantom->setSceneNode(phantomSprite);
+        }
         phantom->setDebugColor(Color4::BLUE);
         phantom->setGlow(enemyGlow);
         phantom->setPlayedDamagedParticle(false);
         if (spawnerInd > -1) {
             phantom->setSpawnerInd(spawnerInd);
         }
-        phantomSprite->setScale(0.2f);
-        phantomSprite->setFrame(0);
-        phantomSprite->setPriority(1.2);
         addObstacle(phantom, phantomSprite, true);
         _enemies.push_back(phantom);
     }
@@ -3736,41 +3978,47 @@ void GameScene::createEnemy(string enemyName, Vec2 enemyPos, int spawnerInd) {
     }
     else if (!enemyName.compare("seeker"))
     {
-        std::shared_ptr<Texture> seekerHitboxImage = _assets->get<Texture>("seeker");
-        std::shared_ptr<Texture> seekerImage = _assets->get<Texture>("seeker_ani");
-        std::shared_ptr<Seeker> seeker = Seeker::alloc(enemyPos, seekerHitboxImage->getSize(), seekerHitboxImage->getSize() / _scale / 10, _scale);
-        std::shared_ptr<scene2::SpriteNode> seekerSprite = scene2::SpriteNode::alloc(seekerImage, 3, 6);
-        seeker->setSceneNode(seekerSprite);
+        Size seekerSize = getTextureSize("seeker");
+        std::shared_ptr<Seeker> seeker = Seeker::alloc(enemyPos, seekerSize, seekerSize / _scale / 10, _scale);
+        std::shared_ptr<scene2::SpriteNode> seekerSprite;
+        if (!_headless)
+        {
+            seekerSprite = scene2::SpriteNode::alloc(_assets->get<Texture>("seeker_ani"), 3, 6);
+            seekerSprite->setFrame(0);
+            seekerSprite->setScale(0.15f);
+            seekerSprite->setPriority(1.1);
+            seeker->setSceneNode(seekerSprite);
+        }
         seeker->setDebugColor(Color4::GREEN);
         seeker->setGlow(enemyGlow);
         seeker->setPlayedDamagedParticle(false);
         if (spawnerInd > -1) {
             seeker->setSpawnerInd(spawnerInd);
         }
-        seekerSprite->setFrame(0);
-        seekerSprite->setScale(0.15f);
-        seekerSprite->setPriority(1.1);
         addObstacle(seeker, seekerSprite, true);
         _enemies.push_back(seeker);
     }
     else if (!enemyName.compare("glutton"))
     {
-        std::shared_ptr<Texture> gluttonHitboxImage = _assets->get<Texture>("glutton");
-        std::shared_ptr<Texture> gluttonImage = _assets->get<Texture>("glutton_ani");
-        std::shared_ptr<Glutton> glutton = Glutton::alloc(enemyPos + Vec2(0, 2), Vec2(gluttonImage->getSize().width / 7.0f, gluttonHitboxImage->getSize().height / 2.0f), gluttonHitboxImage->getSize() / _scale / 5, _scale);
-        std::shared_ptr<scene2::SpriteNode> gluttonSprite = scene2::SpriteNode::alloc(gluttonImage, 4, 7);
-        // fix the anchor slightly for glutton only
-        gluttonSprite->setAnchor(.5, .4);
-        glutton->setSceneNode(gluttonSprite);
+        Size gluttonHitboxSize = getTextureSize("glutton");
+        std::shared_ptr<Glutton> glutton = Glutton::alloc(enemyPos + Vec2(0, 2), Vec2(getTextureSize("glutton_ani").width / 7.0f, gluttonHitboxSize.height / 2.0f), gluttonHitboxSize / _scale / 5, _scale);
+        std::shared_ptr<scene2::SpriteNode> gluttonSprite;
+        if (!_headless)
+        {
+            gluttonSprite = scene2::SpriteNode::alloc(_assets->get<Texture>("glutton_ani"), 4, 7);
+            // fix the anchor slightly for glutton only
+            gluttonSprite->setAnchor(.5, .4);
+            gluttonSprite->setScale(0.2f);
+            gluttonSprite->setFrame(0);
+            gluttonSprite->setPriority(1);
+            glutton->setSceneNode(gluttonSprite);
+        }
         glutton->setDebugColor(Color4::BLUE);
         glutton->setGlow(enemyGlow);
         glutton->setPlayedDamagedParticle(false);
         if (spawnerInd > -1) {
             glutton->setSpawnerInd(spawnerInd);
         }
-        gluttonSprite->setScale(0.2f);
-        gluttonSprite->setFrame(0);
-        gluttonSprite->setPriority(1);
         addObstacle(glutton, gluttonSprite, true);
         _enemies.push_back(glutton);
     }
@@ -3780,20 +4028,23 @@ void GameScene::createEnemy(string enemyName, Vec2 enemyPos, int spawnerInd) {
         _spawnerCount++;
 
         _spawner_pos.push_back(enemyPos);
-        std::shared_ptr<Texture> spawnerHitBoxImage = _assets->get<Texture>("glutton");
-        std::shared_ptr<Texture> spawnerImage = _assets->get<Texture>("spawner_ani");
-        std::shared_ptr<Spawner> spawner = Spawner::alloc(enemyPos, Vec2(spawnerImage->getSize().width / 5.0f, spawnerImage->getSize().height / 5.0f), spawnerHitBoxImage->getSize() / _scale / 10, _scale);
-        std::shared_ptr<scene2::SpriteNode> spawnerSprite = scene2::SpriteNode::alloc(spawnerImage, 5, 5);
+        Size spawnerSize = getTextureSize("spawner_ani");
+        std::shared_ptr<Spawner> spawner = Spawner::alloc(enemyPos, Vec2(spawnerSize.width / 5.0f, spawnerSize.height / 5.0f), getTextureSize("glutton") / _scale / 10, _scale);
+        std::shared_ptr<scene2::SpriteNode> spawnerSprite;
+        if (!_headless)
+        {
+            spawnerSprite = scene2::SpriteNode::alloc(_assets->get<Texture>("spawner_ani"), 5, 5);
+            spawnerSprite->setAnchor(0.5, 0.4);
+            spawnerSprite->setScale(0.75f);
+            spawnerSprite->setPriority(1.01);
+            spawnerSprite->setFrame(0);
+            spawner->setSceneNode(spawnerSprite);
+        }
         spawner->setSpawned(false);
-        spawner->setSceneNode(spawnerSprite);
         spawner->setDebugColor(Color4::BLACK);
         spawner->setGlow(enemyGlow);
         spawner->setIndex(_spawner_ind);
         spawner->setPlayedDamagedParticle(false);
-        spawnerSprite->setAnchor(0.5, 0.4);
-        spawnerSprite->setScale(0.75f);
-        spawnerSprite->setPriority(1.01);
-        spawnerSprite->setFrame(0);
         addObstacle(spawner, spawnerSprite, true);
         _enemies.push_back(spawner);
         _spawners.push_back(spawner);
@@ -3852,9 +4103,92 @@ void GameScene::createEnemies(int wave)
     }
 }
 
+/**
+ * Internal helper to build the level and the player.
+ *
+ * This creates the physics bodies of the level and player, and the glows
+ * that follow the player.  It creates no scene graph nodes, so a headless
+ * scene stops here.  {@link #buildScene} adds the sprites afterwards.
+ */
+void GameScene::buildLevel()
+{
+    // The floor, ceiling, walls and platforms are baked into one static body
+    _levelCollision = LevelCollision::alloc();
+    _levelCollision->setDebugColor(Color4::RED);
+
+    // Making the floor -jdg274
+    Rect floorRect = Rect(0, 0, DEFAULT_WIDTH, 0.5);
+    b2Filter filter = b2Filter();
+    filter.categoryBits = 0b1000;
+    // filter.maskBits = 0b1100;
+    _levelCollision->addBox(floorRect, "floor", filter);
+
+    // Making the ceiling -jdg274
+    Rect ceilingRect = Rect(0, DEFAULT_HEIGHT - 0.5, DEFAULT_WIDTH, 0.5);
+    _levelCollision->addBox(ceilingRect, "topwall", filter);
+
+    // Making the left wall -jdg274
+    Rect leftRect = Rect(0, 0, 0.5, DEFAULT_HEIGHT);
+    _levelCollision->addBox(leftRect, "leftwall", filter);
+
+    // Making the right wall -jdg274
+    Rect rightRect = Rect(DEFAULT_WIDTH - 0.5, 0, 0.5, DEFAULT_HEIGHT);
+    _levelCollision->addBox(rightRect, "rightwall", filter);
+
+    // Add platforms to the world
+    b2Filter platformFilter = b2Filter();
+    platformFilter.categoryBits = 0b100;
+    for (int i = 0; i < _platforms_attr.size(); i++)
+    {
+        Rect platRect = Rect(_platforms_attr[i][0], _platforms_attr[i][1], _platforms_attr[i][2], PLATFORM_HEIGHT);
+        _levelCollision->addBox(platRect, "platform", platformFilter);
+    }
+    addObstacle(_levelCollision, nullptr, false);
+
+    // Glow effect on player
+    _playerGlow = Glow::alloc(PLAYER_POS, _scale);
+
+    // Player creation
+    Vec2 playerPos = PLAYER_POS;
+    _player = PlayerModel::alloc(playerPos + Vec2(0, .5), getTextureSize(PLAYER_TEXTURE) / _scale / 8, _scale);
+    _player->setDebugColor(Color4::BLUE);
+    addObstacle(_player, nullptr, true);
+    _playerGlow->setFollow(_player.get());
+
+    // Ranged Arm for the player
+    _rangedArm = Glow::alloc(PLAYER_POS, _scale);
+    _rangedArm->setAttackAngle(0);
+    _rangedArm->setGlowTimer(0);
+    _rangedArm->setAnimeTimer(0);
+    _rangedArm->setLastType(Glow::MeleeState::cool);
+
+    // Ranged Arm for the charge shot for player
+    _rangedArmCharge = Glow::alloc(PLAYER_POS, _scale);
+    _rangedArmCharge->setAttackAngle(0);
+    _rangedArmCharge->setGlowTimer(0);
+    _rangedArmCharge->setAnimeTimer(0);
+    _rangedArmCharge->setLastType(Glow::MeleeState::cool);
+
+    // Melee Arm for the player
+    _meleeArm = Glow::alloc(PLAYER_POS, _scale);
+    _meleeArm->setAttackAngle(0);
+    _meleeArm->setGlowTimer(0);
+    _meleeArm->setAnimeTimer(0);
+    _meleeArm->setLastType(Glow::MeleeState::cool);
+
+    // Melee Arm for the dash for player
+    _meleeArmDash = Glow::alloc(PLAYER_POS, _scale);
+    _meleeArmDash->setAttackAngle(0);
+    _meleeArmDash->setGlowTimer(0);
+    _meleeArmDash->setAnimeTimer(0);
+    _meleeArmDash->setLastType(Glow::MeleeState::cool);
+}
+
 /**
  * Internal helper to build the scene graph.
  *
+ * This adds the sprites for the level and player built by {@link #buildLevel}.
+ *
  * Scene graphs are not required.  You could manage all scenes just like
  * you do in 3152.  However, they greatly simplify scene management, and
  * have become standard in most game engines.
@@ -3893,21 +4227,7 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
     float bOffset = (size.height) - (safe.origin.y + safe.size.height);
     float rOffset = (size.width) - (safe.origin.x + safe.size.width);
 
-    // Making the floor -jdg274
-    Rect floorRect = Rect(0, 0, DEFAULT_WIDTH, 0.5);
-    std::shared_ptr<physics2::PolygonObstacle> floor = physics2::PolygonObstacle::allocWithAnchor(floorRect, Vec2::ANCHOR_CENTER);
-    floor->setBodyType(b2_staticBody);
-
-    std::shared_ptr<scene2::PolygonNode> floorNode = scene2::PolygonNode::allocWithPoly(floorRect * _scale);
-    floorNode->setColor(Color4::CLEAR);
-    floor->setName("floor");
-    b2Filter filter = b2Filter();
-    filter.categoryBits = 0b1000;
-    // filter.maskBits = 0b1100;
-    floor->setFilterData(filter);
-    addObstacle(floor, floorNode, 1);
-    
-    // Split floor into parts to repeat texture
+    // Split floor into parts to repeat texture (sprites only)
     Rect safebounds = Application::get()->getSafeBounds();
     float safeWidth = safebounds.size.width;
     Rect screenbounds = Application::get()->getDisplayBounds();
@@ -3956,8 +4276,6 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
     
     for (int i = 0; i < split; i++) {
         Rect floorRect = Rect(positions[i], 0, platformCoors, 0.5);
-        std::shared_ptr<physics2::PolygonObstacle> floor = physics2::PolygonObstacle::allocWithAnchor(floorRect, Vec2::ANCHOR_CENTER);
-        floor->setBodyType(b2_staticBody);
 
         std::shared_ptr<Texture> floorImage = _assets->get<Texture>("platform");
         if (!_biome.compare("cave"))
@@ -3986,49 +4304,17 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
         } else {
             floorSprite->setAnchor(xAnchor, 0.5);
         }
-        addObstacle(floor, floorSprite, 1);
+        floorSprite->setPosition(floorRect.getMidX() * _scale, floorRect.getMidY() * _scale);
+        _levelCollision->addSprite(floorSprite);
     }
 
-    // Making the ceiling -jdg274
-    Rect ceilingRect = Rect(0, DEFAULT_HEIGHT - 0.5, DEFAULT_WIDTH, 0.5);
-    std::shared_ptr<physics2::PolygonObstacle> ceiling = physics2::PolygonObstacle::allocWithAnchor(ceilingRect, Vec2::ANCHOR_CENTER);
-    ceiling->setName("topwall");
-    // filter.maskBits = 0b1100;
-    ceiling->setFilterData(filter);
-
-    std::shared_ptr<scene2::PolygonNode> ceilingNode = scene2::PolygonNode::allocWithPoly(ceilingRect * _scale);
-    ceilingNode->setColor(Color4::CLEAR);
-    addObstacle(ceiling, ceilingNode, 1);
-
-    // Making the left wall -jdg274
-    Rect leftRect = Rect(0, 0, 0.5, DEFAULT_HEIGHT);
-    std::shared_ptr<physics2::PolygonObstacle> left = physics2::PolygonObstacle::allocWithAnchor(leftRect, Vec2::ANCHOR_CENTER);
-    left->setBodyType(b2_staticBody);
-    left->setName("leftwall");
-    left->setFilterData(filter);
-
-    std::shared_ptr<scene2::PolygonNode> leftNode = scene2::PolygonNode::allocWithPoly(leftRect * _scale);
-    leftNode->setColor(Color4::CLEAR);
-    addObstacle(left, leftNode, 1);
-
-    // Making the right wall -jdg274
-    Rect rightRect = Rect(DEFAULT_WIDTH - 0.5, 0, 0.5, DEFAULT_HEIGHT);
-    std::shared_ptr<physics2::PolygonObstacle> right = physics2::PolygonObstacle::allocWithAnchor(rightRect, Vec2::ANCHOR_CENTER);
-    right->setBodyType(b2_staticBody);
-    right->setName("rightwall");
-    right->setFilterData(filter);
-    std::shared_ptr<scene2::PolygonNode> rightNode = scene2::PolygonNode::allocWithPoly(rightRect * _scale);
-    rightNode->setColor(Color4::CLEAR);
-    addObstacle(right, rightNode, 1);
-
     // Position the button in the bottom right corner
     _pauseButton->setAnchor(Vec2(0, 1));
     _pauseButton->setPosition(size.width - (bsize.width + rOffset) / 2, size.height);// - (bsize.height + bOffset) / 2);
 
-    // Add platforms to the world
+    // Add platforms to the scene graph
     Vec2 pos;
     Rect platRect;
-    std::shared_ptr<PlatformModel> platform;
     std::shared_ptr<scene2::PolygonNode> platformSprite;
     // putting this default to see if that fixes platforms being occasionally invisible
     std::shared_ptr<Texture> platformImage = _assets->get<Texture>("platform");
@@ -4113,22 +4399,31 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
         float scale = desiredWidth / platformSprite->getWidth();
         platformSprite->setScale(scale);
         platformSprite->setAnchor(0.5, yAnchor);
-        platform = PlatformModel::alloc(pos, width, PLATFORM_HEIGHT, _scale);
-        _platforms.push_back(platform);
-        _platformNodes.push_back(platformSprite);
-        platform->setName("platform");
-        platform->setSceneNode(_platformNodes[i]);
-        platform->setDebugColor(Color4::RED);
+        platRect = Rect(pos.x, pos.y, width, PLATFORM_HEIGHT);
+        platformSprite->setPosition(platRect.getMidX() * _scale, platRect.getMidY() * _scale);
         platformSprite->setPriority(0.1);
-        addObstacle(platform, platformSprite, true);
+        _levelCollision->addSprite(platformSprite);
+    }
+
+    // Bake the level sprites at the display resolution
+    std::shared_ptr<scene2::SceneNode> levelNode = _levelCollision->bake(1 / scale);
+    if (levelNode == nullptr)
+    {
+        levelNode = scene2::SceneNode::alloc();
+        levelNode->setPriority(0.1);
+        for (auto it = _levelCollision->getSprites().begin(); it != _levelCollision->getSprites().end(); ++it)
+        {
+            _worldnode2->addChild(*it);
+        }
     }
+    attachNode(_levelCollision, levelNode, false);
 
     float xBackgroundAnchor = (leftWorldCoors / totalWorldCoors);
     //CULog("%f", xBackgroundAnchor);
     if (!_biome.compare("cave")) {
         Vec2 test_pos = Vec2(0, 0);
         std::shared_ptr<Texture> backgroundImage = _assets->get<Texture>("cave_background");
-        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, backgroundImage->getSize() / _scale, _scale);
+        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, _scale);
         std::shared_ptr<scene2::PolygonNode> bSprite = scene2::PolygonNode::allocWithTexture(backgroundImage);
         bSprite->setAnchor(xBackgroundAnchor, 0);
         testBackground->setSceneNode(bSprite);
@@ -4140,7 +4435,7 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
     else if (!_biome.compare("shroom")) {
         Vec2 test_pos = Vec2(0, 0);
         std::shared_ptr<Texture> backgroundImage = _assets->get<Texture>("shroom_background");
-        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, backgroundImage->getSize() / _scale, _scale);
+        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, _scale);
         std::shared_ptr<scene2::PolygonNode> bSprite = scene2::PolygonNode::allocWithTexture(backgroundImage);
         bSprite->setAnchor(xBackgroundAnchor, 0);
         testBackground->setSceneNode(bSprite);
@@ -4152,7 +4447,7 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
     else {
         Vec2 test_pos = Vec2(0, 0);
         std::shared_ptr<Texture> backgroundImage = _assets->get<Texture>("forest_background");
-        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, backgroundImage->getSize() / _scale, _scale);
+        std::shared_ptr<Glow> testBackground = Glow::alloc(test_pos, _scale);
         std::shared_ptr<scene2::PolygonNode> bSprite = scene2::PolygonNode::allocWithTexture(backgroundImage);
         bSprite->setAnchor(xBackgroundAnchor, 0);
         testBackground->setSceneNode(bSprite);
@@ -4166,96 +4461,63 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
     scene->addChildWithName(_pauseButton, "pauseButton");
 
     // Glow effect on player
-    Vec2 testPos = PLAYER_POS;
     std::shared_ptr<Texture> imaget = _assets->get<Texture>(GLOW_TEXTURE);
-    _playerGlow = Glow::alloc(testPos, imaget->getSize() / _scale, _scale);
     std::shared_ptr<scene2::PolygonNode> spritet = scene2::PolygonNode::allocWithTexture(imaget);
     _playerGlow->setSceneNode(spritet);
     std::shared_ptr<Gradient> grad = Gradient::allocRadial(Color4(255, 255, 255, 55), Color4(111, 111, 111, 0), Vec2(0.5, 0.5), .3f);
     spritet->setGradient(grad);
     spritet->setRelativeColor(false);
     spritet->setScale(.65f);
-    addObstacle(_playerGlow, spritet, true);
+    _worldnode2->addChild(spritet);
 
-    // Player creation
-    Vec2 playerPos = PLAYER_POS;
-    std::shared_ptr<scene2::SceneNode> node = scene2::SceneNode::alloc();
+    // Player sprite
     std::shared_ptr<Texture> image = _assets->get<Texture>(PLAYER_WALK_TEXTURE);
-    std::shared_ptr<Texture> hitboxImage = _assets->get<Texture>(PLAYER_TEXTURE);
-    _player = PlayerModel::alloc(playerPos + Vec2(0, .5), hitboxImage->getSize() / _scale / 8, _scale);
     std::shared_ptr<scene2::SpriteNode> sprite = scene2::SpriteNode::alloc(image, 5, 8);
     sprite->setFrame(12);
     _prevFrame = 12;
     _player->setSceneNode(sprite);
-    _player->setDebugColor(Color4::BLUE);
     sprite->setScale(0.175f);
     sprite->setPriority(4);
-    addObstacle(_player, sprite, true);
+    attachNode(_player, sprite, true);
 
     // Ranged Arm for the player
-    Vec2 rangeArmPos = PLAYER_POS;
-    std::shared_ptr<Texture> rangeHitboxImage = _assets->get<Texture>(PLAYER_RANGE_TEXTURE);
     std::shared_ptr<Texture> rangeImage = _assets->get<Texture>("player_range_arm_ani");
-    _rangedArm = Glow::alloc(rangeArmPos, rangeHitboxImage->getSize() / _scale, _scale);
-    _rangedArm->setAttackAngle(0);
-    _rangedArm->setGlowTimer(0);
-    _rangedArm->setAnimeTimer(0);
-    _rangedArm->setLastType(Glow::MeleeState::cool);
     std::shared_ptr<scene2::SpriteNode> rangeArmSprite = scene2::SpriteNode::alloc(rangeImage, 2, 5);
     _rangedArm->setSceneNode(rangeArmSprite);
     _rangedArm->getSceneNode()->setVisible(false);
     rangeArmSprite->setFrame(0);
     rangeArmSprite->setScale(0.22);
     rangeArmSprite->setPriority(5);
-    addObstacle(_rangedArm, rangeArmSprite, true);
+    _worldnode2->addChild(rangeArmSprite);
 
     // Ranged Arm for the charge shot for player
-    std::shared_ptr<Texture> rangeChargeHitboxImage = _assets->get<Texture>(PLAYER_RANGE_TEXTURE);
     std::shared_ptr<Texture> rangeChargeImage = _assets->get<Texture>("player_range_arm_charge");
-    _rangedArmCharge = Glow::alloc(rangeArmPos, rangeChargeHitboxImage->getSize() / _scale, _scale);
-    _rangedArmCharge->setAttackAngle(0);
-    _rangedArmCharge->setGlowTimer(0);
-    _rangedArmCharge->setAnimeTimer(0);
-    _rangedArmCharge->setLastType(Glow::MeleeState::cool);
     std::shared_ptr<scene2::SpriteNode> rangeChargeSprite = scene2::SpriteNode::alloc(rangeChargeImage, 1, 8);
     _rangedArmCharge->setSceneNode(rangeChargeSprite);
     _rangedArmCharge->getSceneNode()->setVisible(false);
     rangeChargeSprite->setFrame(0);
     rangeChargeSprite->setScale(0.22);
     rangeChargeSprite->setPriority(5);
-    addObstacle(_rangedArmCharge, rangeChargeSprite, true);
+    _worldnode2->addChild(rangeChargeSprite);
     
     // Melee Arm for the player
-    Vec2 meleeArmPos = PLAYER_POS;
-    std::shared_ptr<Texture> meleeHitboxImage = _assets->get<Texture>(PLAYER_MELEE_TEXTURE);
     std::shared_ptr<Texture> meleeImage = _assets->get<Texture>(PLAYER_MELEE_THREE_TEXTURE);
-    _meleeArm = Glow::alloc(meleeArmPos, meleeHitboxImage->getSize() / _scale, _scale);
-    _meleeArm->setAttackAngle(0);
-    _meleeArm->setGlowTimer(0);
-    _meleeArm->setLastType(Glow::MeleeState::cool);
     std::shared_ptr<scene2::SpriteNode> meleeArmSprite = scene2::SpriteNode::alloc(meleeImage, 4, 7);
     meleeArmSprite->setFrame(21);
     _meleeArm->setSceneNode(meleeArmSprite);
-    _meleeArm->setAnimeTimer(0);
     meleeArmSprite->setScale(0.36);
     meleeArmSprite->setPriority(6);
-    addObstacle(_meleeArm, meleeArmSprite, true);
+    _worldnode2->addChild(meleeArmSprite);
 
     // Melee Arm for the dash for player
-    std::shared_ptr<Texture> meleeDashHitboxImage = _assets->get<Texture>(PLAYER_MELEE_TEXTURE);
     std::shared_ptr<Texture> meleeDashImage = _assets->get<Texture>("player_melee_dash");
-    _meleeArmDash = Glow::alloc(meleeArmPos, meleeDashHitboxImage->getSize() / _scale, _scale);
-    _meleeArmDash->setAttackAngle(0);
-    _meleeArmDash->setGlowTimer(0);
-    _meleeArmDash->setLastType(Glow::MeleeState::cool);
     std::shared_ptr<scene2::SpriteNode> meleeDashSprite = scene2::SpriteNode::alloc(meleeDashImage, 1, 7);
     meleeDashSprite->setFrame(0);
     _meleeArmDash->setSceneNode(meleeDashSprite);
     _meleeArmDash->getSceneNode()->setVisible(false);
-    _meleeArmDash->setAnimeTimer(0);
     meleeDashSprite->setScale(0.24);
     meleeDashSprite->setPriority(6);
-    addObstacle(_meleeArmDash, meleeDashSprite, true);
+    _worldnode2->addChild(meleeDashSprite);
 
     // We can only activate a button AFTER it is added to a scene
     _pauseButton->activate();
@@ -4270,7 +4532,7 @@ void GameScene::buildScene(std::shared_ptr<scene2::SceneNode> scene)
  * the two.  This function is an example of the latter.
  *
  * @param obj             The physics object to add
- * @param node            The scene graph node to attach it to
+ * @param node            The scene graph node to attach it to (nullptr for none)
  * @param useObjPosition  Whether to update the node's position to be at the object's position
  */
 void GameScene::addObstacle(const std::shared_ptr<cugl::physics2::Obstacle> &obj,
@@ -4278,6 +4540,23 @@ void GameScene::addObstacle(const std::shared_ptr<cugl::physics2::Obstacle> &obj
                             bool useObjPosition)
 {
     _world->addObstacle(obj);
+    if (node != nullptr)
+    {
+        attachNode(obj, node, useObjPosition);
+    }
+}
+
+/**
+ * Couples a physics object already in the world to the scene graph
+ *
+ * @param obj             The physics object to attach
+ * @param node            The scene graph node to attach it to
+ * @param useObjPosition  Whether to update the node's position to be at the object's position
+ */
+void GameScene::attachNode(const std::shared_ptr<cugl::physics2::Obstacle> &obj,
+                           const std::shared_ptr<cugl::scene2::SceneNode> &node,
+                           bool useObjPosition)
+{
     obj->setDebugScene(_debugnode);
 
     // Position the scene graph node (enough for static objects)
@@ -4300,11 +4579,105 @@ void GameScene::addObstacle(const std::shared_ptr<cugl::physics2::Obstacle> &obj
     }
 }
 
+/**
+ * Returns the size of the texture with the given key
+ *
+ * A headless scene has no textures, so it reads the size from the table
+ * given to {@link #initHeadless}.
+ *
+ * @param key   The texture key
+ *
+ * @return the size of the texture with the given key
+ */
+cugl::Size GameScene::getTextureSize(const std::string& key) const
+{
+    if (!_headless)
+    {
+        return _assets->get<Texture>(key)->getSize();
+    }
+    std::shared_ptr<JsonValue> size = _textureSizes->get(key);
+    if (size == nullptr || size->size() < 2)
+    {
+        CULogError("No size for texture '%s'", key.c_str());
+        return Size::ZERO;
+    }
+    return Size(size->get(0)->asFloat(), size->get(1)->asFloat());
+}
+
 /** Saves progress */
 void GameScene::save() {
-    std::shared_ptr<TextWriter> writer = TextWriter::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    writer->write("{\"progress\":" + _progress->toString() + ",\"settings\":{\"swap\": " + to_string(_swap) +", \"music\": " + to_string(_music) +", \"sfx\": " + to_string(_sfx) +"}}");
-    writer->close();
+    SaveController::Settings settings;
+    settings.swap = _swap;
+    settings.music = _music;
+    settings.sfx = _sfx;
+    SaveController::get()->setSettings(settings);
+    SaveController::get()->save();
+}
+
+/**
+ * Starts recording the input of this level
+ *
+ * This reseeds the random streams, so it should be called
+ * right after {@link #init}.  The recording is written to the given file
+ * when the scene is disposed.  Relative paths are in the save directory.
+ *
+ * @param file  The file to write the recording to
+ */
+void GameScene::startRecording(const std::string& file) {
+    Uint32 seed = (Uint32)std::time(nullptr);
+    Random::seedAll(seed);
+    _recording = InputRecording::alloc(_level, _stageNum, _initTutorial, seed);
+    _recordingFile = file;
+}
+
+/**
+ * Stops recording the input of this level, writing the recording
+ *
+ * This method does nothing if the level is not being recorded.
+ */
+void GameScene::stopRecording() {
+    if (_recording != nullptr) {
+        if (_recording->save(_recordingFile)) {
+            CULog("Recorded %zu frames of input to %s", _recording->size(), _recordingFile.c_str());
+        }
+        _recording = nullptr;
+    }
+}
+
+/**
+ * Replays the given input recording
+ *
+ * This reseeds the random streams, so it should be called
+ * right after {@link #init}, with the level of the recording.  Each
+ * update then uses the input and timestep of the next recorded frame,
+ * ignoring its arguments.  Control returns to the player when the
+ * recording runs out.
+ *
+ * @param recording The input recording to replay
+ */
+void GameScene::replay(const std::shared_ptr<InputRecording>& recording) {
+    Random::seedAll(recording->getSeed());
+    _replay = recording;
+    _replayFrame = 0;
+    _input.setScripted(true);
+}
+
+/**
+ * Skips ahead so that the given wave spawns on the next update
+ *
+ * The earlier waves are never spawned.  This is used to benchmark the
+ * late waves of a level without playing through the early ones.
+ *
+ * @param wave  The wave to spawn next
+ */
+void GameScene::skipToWave(int wave) {
+    if (wave <= 0 || _numWaves == 0) {
+        return;
+    }
+    wave = std::min(wave, _numWaves - 1);
+    _nextWaveNum = wave;
+    _timer = _spawn_times[wave];
+    _spawnParticlesDone = false;
 }
 
 void GameScene::updateTutorialv1(float timestep, int ind) {
@@ -42,9 +42,10 @@
 #include "AttackController.hpp"
 #include "AIController.hpp"
 #include "InputController.hpp"
+#include "InputRecording.hpp"
 #include "TiltController.hpp"
 #include "CollisionController.hpp"
-#include "Platform.hpp"
+#include "LevelCollision.hpp"
 #include "Glow.hpp"
 #include "SoundController.hpp"
 
@@ -71,8 +72,8 @@ protected:
     std::shared_ptr<cugl::AssetManager> _assets;
     /** The JSON value with all of the constants */
     std::shared_ptr<cugl::JsonValue> _constants;
-    /** The JSON value with all particle effects*/
-    std::shared_ptr<cugl::JsonValue> _particleInfo;
+    /** The precompiled emitter definitions for all particle effects */
+    std::shared_ptr<ParticleLibrary> _particleLibrary;
     /** A scene graph, used to display our 2D scenes */
     // std::shared_ptr<cugl::Scene2> _scene;
     /** A 3152 style SpriteBatch to render the scene */
@@ -86,6 +87,8 @@ protected:
 
     /** The physics world */
     std::shared_ptr<cugl::physics2::ObstacleWorld> _world;
+    /** The worker threads for the physics step (nullptr on small devices) */
+    std::shared_ptr<cugl::TaskScheduler> _physicsThreads;
     /** Reference to the physics root of the scene graph */
     std::shared_ptr<cugl::scene2::ScrollPane> _worldnode;
     /** ordered world node to take over _worldnode */
@@ -121,6 +124,8 @@ protected:
     std::shared_ptr<cugl::TextLayout> _text;
     /** The text with the wave timer */
     std::shared_ptr<cugl::TextLayout> _timer_text;
+    /** The text with the physics profile (debug mode only) */
+    std::shared_ptr<cugl::TextLayout> _physics_text;
     /** Text font */
     std::shared_ptr<cugl::Font> _font;
 
@@ -168,8 +173,8 @@ protected:
     std::shared_ptr<PlayerModel> _player;
     /** Platform character */
     std::vector<float*> _platforms_attr;
-    std::vector<std::shared_ptr<PlatformModel>> _platforms;
-    std::vector <std::shared_ptr<scene2::PolygonNode>> _platformNodes;
+    /** The floor, ceiling, walls and platforms as one static body */
+    std::shared_ptr<LevelCollision> _levelCollision;
     
     /**spawn info */
     std::vector<vector<string>> _spawn_order;
@@ -251,6 +256,23 @@ protected:
 
     int _stageNum;
 
+    /** The biome (or level key) given to init */
+    string _level;
+
+    /** The input recording in progress (nullptr if not recording) */
+    std::shared_ptr<InputRecording> _recording;
+    /** The file to write the input recording to */
+    std::string _recordingFile;
+    /** The input recording being replayed (nullptr if not replaying) */
+    std::shared_ptr<InputRecording> _replay;
+    /** The next frame of the replay */
+    size_t _replayFrame;
+
+    /** Whether this scene only simulates (no scene graph, sound or devices) */
+    bool _headless;
+    /** The texture sizes of a headless scene, keyed by texture name */
+    std::shared_ptr<cugl::JsonValue> _textureSizes;
+
     bool _pause;
 
     bool _options;
@@ -314,20 +336,81 @@ protected:
     std::shared_ptr<scene2::SceneNode> _tutorialSceneSecond;
     
     std::shared_ptr<scene2::SceneNode> _tutorialSceneThird;
-    std::shared_ptr<JsonValue> _progress;
 
     void save();
 
-    
+    /**
+     * Internal helper to reset the game state and read the level
+     *
+     * This reads the constants, platforms and waves of the level.  It does not
+     * need any assets, so it is shared by {@link #init} and {@link #initHeadless}.
+     *
+     * @param constants The JSON value for the level
+     * @param biome     The biome (or level key)
+     * @param stageNum  The stage number (negative for a level without a number)
+     * @param tutorial  The tutorial number (0 for none)
+     */
+    void initLevel(const std::shared_ptr<cugl::JsonValue>& constants, string biome, int stageNum, int tutorial);
+
+    /**
+     * Internal helper to create the physics world and the gameplay controllers
+     *
+     * The drawing scale must be set first, as the attacks are sized by it.
+     */
+    void initPhysics();
+
+    /**
+     * Internal helper to build the level and the player.
+     *
+     * This creates the physics bodies of the level and player, and the glows
+     * that follow the player.  It creates no scene graph nodes, so a headless
+     * scene stops here.  {@link #buildScene} adds the sprites afterwards.
+     */
+    void buildLevel();
+
     /**
      * Internal helper to build the scene graph.
      *
+     * This adds the sprites for the level and player built by {@link #buildLevel}.
+     *
      * Scene graphs are not required.  You could manage all scenes just like
      * you do in 3152.  However, they greatly simplify scene management, and
      * have become standard in most game engines.
      */
     void buildScene(std::shared_ptr<cugl::scene2::SceneNode> scene);
 
+    /**
+     * Couples a physics object already in the world to the scene graph
+     *
+     * @param obj             The physics object to attach
+     * @param node            The scene graph node to attach it to
+     * @param useObjPosition  Whether to update the node's position to be at the object's position
+     */
+    void attachNode(const std::shared_ptr<cugl::physics2::Obstacle> &obj,
+                    const std::shared_ptr<cugl::scene2::SceneNode> &node,
+                    bool useObjPosition);
+
+    /**
+     * Returns the size of the texture with the given key
+     *
+     * A headless scene has no textures, so it reads the size from the table
+     * given to {@link #initHeadless}.
+     *
+     * @param key   The texture key
+     *
+     * @return the size of the texture with the given key
+     */
+    cugl::Size getTextureSize(const std::string& key) const;
+
+    /**
+     * Updates the options, pause and lose overlays
+     *
+     * A headless scene has no overlays, so this only reports a loss.
+     *
+     * @return true if an overlay (or a loss) stops the gameplay this frame
+     */
+    bool updateOverlays();
+
 public:
     /**
      * Creates a new game mode with the default values.
@@ -335,7 +418,7 @@ public:
      * This constructor does not allocate any objects or start the game.
      * This allows us to use the object without a heap pointer.
      */
-    GameScene() : cugl::Scene2() {}
+    GameScene() : cugl::Scene2(), _headless(false) {}
 
     /**
      * Disposes of all (non-static) resources allocated to this mode.
@@ -363,6 +446,29 @@ public:
      */
     bool init(const std::shared_ptr<cugl::AssetManager>& assets, const std::shared_ptr<SoundController> sound, string biome, int stageNum, int tutorial);
 
+    /**
+     * Initializes the gameplay without a scene graph, sound or input devices
+     *
+     * A headless scene only simulates the level: the AI, attacks, physics and
+     * spawning.  It creates no scene graph nodes or textures, so it needs no
+     * window or GL context.  It never touches the audio engine, and its input
+     * is scripted (see {@link InputController#feed}).  It cannot be rendered.
+     *
+     * The physics bodies are sized by their textures, so the texture sizes are
+     * given as a JSON object mapping each texture key to [width, height].
+     *
+     * @param constants The JSON value for the level
+     * @param textures  The texture sizes, keyed by texture name
+     * @param biome     The biome (or level key)
+     * @param stageNum  The stage number (negative for a level without a number)
+     *
+     * @return true if the controller is initialized properly, false otherwise.
+     */
+    bool initHeadless(const std::shared_ptr<cugl::JsonValue>& constants, const std::shared_ptr<cugl::JsonValue>& textures, string biome, int stageNum);
+
+    /** Returns true if this scene only simulates (see {@link #initHeadless}) */
+    bool isHeadless() const { return _headless; }
+
     bool goingToRestart() { return _restart; }
 
     bool goingBack() { return _back; }
@@ -406,6 +512,10 @@ public:
     * helper method to update melee arm animations
     */
     void updateMeleeArm(float timestep);
+    /**
+     * helper method to move the glows and arms to their positions (after each world update)
+     */
+    void updateGlows(float timestep);
     /**
      * helper method to update all enemies 
      */
@@ -446,6 +556,10 @@ public:
      * helper method to update camera 
      */
     void updateCamera();
+    /**
+     * helper method to get the mask of enemy music layers
+     */
+    Uint8 getMusicLayers();
     /**
      * helper method to spawn enemies 
      */
@@ -493,7 +607,8 @@ public:
     /**
      * Sets whether debug mode is active.
      *
-     * If true, all objects will display their physics bodies.
+     * If true, all objects will display their physics bodies, and the
+     * physics step is profiled.
      *
      * @param value whether debug mode is active.
      */
@@ -501,6 +616,7 @@ public:
     {
         _debug = value;
         _debugnode->setVisible(value);
+        _world->setProfiling(value);
     }
 
     /**
@@ -526,8 +642,8 @@ public:
     std::shared_ptr<BaseEnemyModel> getNearestNonMirror(cugl::Vec2 pos);
 
     /** Helpers to create particles in GameScene */
-    void createParticles(std::shared_ptr<Texture> texture, Vec2 pos, string poolName, Color4 tint, Vec2 pointOffset, float scale);
-    void createParticles(std::vector<std::shared_ptr<Texture>> textures, Vec2 pos, string poolName, Color4 tint, Vec2 pointOffset, float scale, bool hasMultipleLinkedTextures, Vec2 linkOffset, int numTex);
+    void createParticles(std::shared_ptr<Texture> texture, Vec2 pos, const string& poolName, Color4 tint, Vec2 pointOffset, float scale);
+    void createParticles(std::vector<std::shared_ptr<Texture>> textures, Vec2 pos, const string& poolName, Color4 tint, Vec2 pointOffset, float scale, bool hasMultipleLinkedTextures, Vec2 linkOffset, int numTex);
 
 
     /** Helper to convert numbers into Textures **/
@@ -541,6 +657,101 @@ public:
 
     void updateTutorialv2(float timestep, int ind);
 
+#pragma mark -
+#pragma mark Simulation
+    /**
+     * Returns the input controller for this scene
+     *
+     * This allows a benchmark to script the input with
+     * {@link InputController#feed}.
+     *
+     * @return the input controller for this scene
+     */
+    InputController& getInput() { return _input; }
+
+    /**
+     * Returns the physics world for this scene
+     *
+     * @return the physics world for this scene
+     */
+    const std::shared_ptr<cugl::physics2::ObstacleWorld>& getWorld() const { return _world; }
+
+    /**
+     * Returns the player character
+     *
+     * @return the player character
+     */
+    const std::shared_ptr<PlayerModel>& getPlayer() const { return _player; }
+
+    /**
+     * Returns the number of living enemies (including spawners)
+     *
+     * @return the number of living enemies
+     */
+    size_t getEnemyCount() const { return _enemies.size(); }
+
+    /**
+     * Returns the number of waves spawned so far
+     *
+     * @return the number of waves spawned so far
+     */
+    int getWave() const { return _nextWaveNum; }
+
+    /**
+     * Returns true if the player has lost the level
+     *
+     * @return true if the player has lost the level
+     */
+    bool isLost() const { return _lose; }
+
+    /**
+     * Starts recording the input of this level
+     *
+     * This reseeds the random streams, so it should be called
+     * right after {@link #init}.  The recording is written to the given file
+     * when the scene is disposed.  Relative paths are in the save directory.
+     *
+     * @param file  The file to write the recording to
+     */
+    void startRecording(const std::string& file);
+
+    /**
+     * Stops recording the input of this level, writing the recording
+     *
+     * This method does nothing if the level is not being recorded.
+     */
+    void stopRecording();
+
+    /**
+     * Replays the given input recording
+     *
+     * This reseeds the random streams, so it should be called
+     * right after {@link #init}, with the level of the recording.  Each
+     * update then uses the input and timestep of the next recorded frame,
+     * ignoring its arguments.  Control returns to the player when the
+     * recording runs out.
+     *
+     * @param recording The input recording to replay
+     */
+    void replay(const std::shared_ptr<InputRecording>& recording);
+
+    /**
+     * Returns true if there are frames left to replay
+     *
+     * @return true if there are frames left to replay
+     */
+    bool isReplaying() const { return _replay != nullptr && _replayFrame < _replay->size(); }
+
+    /**
+     * Skips ahead so that the given wave spawns on the next update
+     *
+     * The earlier waves are never spawned.  This is used to benchmark the
+     * late waves of a level without playing through the early ones.
+     *
+     * @param wave  The wave to spawn next
+     */
+    void skipToWave(int wave);
+
 };
 
 #endif /* __Game_Scene_hpp__ */
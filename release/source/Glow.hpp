@@ -3,6 +3,11 @@
 //  Liminal Spirit Game
 //
 //  This class tracks creates the glow effects and alters them depending on situation
+//
+//  A glow is not a physics object. It is a transform for a scene graph node,
+//  which either holds a fixed position or follows an obstacle (such as the
+//  player or an enemy). Glows are never added to the ObstacleWorld, so they
+//  cost nothing in the physics step.
 // 
 //
 
@@ -10,24 +15,23 @@
 #ifndef __GLOW_HPP__
 #define __GLOW_HPP__
 #include <cugl/cugl.h>
-#include <cugl/physics2/CUBoxObstacle.h>
-#include <cugl/physics2/CUCapsuleObstacle.h>
-#include <cugl/scene2/graph/CUWireNode.h>
+#include <cugl/physics2/CUObstacle.h>
 
 #pragma mark - 
 #pragma mark Drawing Constants
 /** Texture for the glow*/
 #define GLOW_TEXTURE "whiteGrad"
-/** ID for the sensor*/
-#define GLOW_SENSOR_NAME "glowsensor"
 
 #pragma mark - 
 #pragma mark Glow Model
 /**
 * The glow model for Liminal Spirit
 *
+* A glow either has a fixed position (set with setPosition) or follows an
+* obstacle at an offset (set with setFollow). The scene node is only moved
+* when the glow is updated, so glows in use must be updated once a frame.
 */
-class Glow : public cugl::physics2::CapsuleObstacle {
+class Glow {
 public:
 	enum MeleeState {
 		first,
@@ -42,16 +46,20 @@ public:
 	};
 
 protected:
-	/** Name of sensor */
-	std::string _sensorName;
-	/** Debug Sensor */
-	std::shared_ptr<cugl::scene2::WireNode> _sensorNode;
-
 	/** Scene Graph Node */
 	std::shared_ptr<cugl::scene2::SceneNode> _node;
 	/** Draw Scale*/
 	float _drawScale;
 
+	/** Position in physics coordinates */
+	cugl::Vec2 _position;
+
+	/** Obstacle to follow (nullptr for a fixed position) */
+	const cugl::physics2::Obstacle* _follow;
+
+	/** Offset from the followed obstacle in physics coordinates */
+	cugl::Vec2 _offset;
+
 	/** Time passed since glow initialized */
 	float _glowTime;
 
@@ -64,12 +72,10 @@ protected:
     /** Angle of last projectile in degrees*/
     float _attackAngle;
 
-	/** Redraws outline of physics fixtures */
-	virtual void resetDebug() override;
-
 public:
 	/** Creates a degenerate Glow */
-	Glow() : CapsuleObstacle(), _sensorName(GLOW_SENSOR_NAME) { }
+	Glow() : _drawScale(1.0f), _follow(nullptr), _glowTime(0), _animeTime(0),
+		_attackType(MeleeState::cool), _attackAngle(0) { }
 
 	/**Destroys this Glow, releasing all resources */
 	virtual ~Glow(void) { dispose(); }
@@ -78,14 +84,14 @@ public:
 	void dispose();
 
 	/** Base init function */
-	virtual bool init(const cugl::Vec2& pos, const cugl::Size& size, float scale);
+	virtual bool init(const cugl::Vec2& pos, float scale);
 
 #pragma mark - 
 #pragma mark Static Constructors
 	/** Allocates a glow*/
-	static std::shared_ptr<Glow> alloc(const cugl::Vec2& pos, const cugl::Size& size, float scale) {
+	static std::shared_ptr<Glow> alloc(const cugl::Vec2& pos, float scale) {
 		std::shared_ptr<Glow> result = std::make_shared<Glow>();
-		return (result->init(pos, size, scale) ? result : nullptr);
+		return (result->init(pos, scale) ? result : nullptr);
 	}
 
 #pragma mark -
@@ -99,11 +105,34 @@ public:
 		_node->setPosition(getPosition() * _drawScale);
 	}
 
+#pragma mark -
+#pragma mark Transform
+	/** Returns the position of this glow in physics coordinates */
+	cugl::Vec2 getPosition() const { return _position; }
+
+	/** Sets the position of this glow in physics coordinates */
+	void setPosition(const cugl::Vec2& value) { _position = value; }
+
+	/** Sets the position of this glow in physics coordinates */
+	void setPosition(float x, float y) { _position.set(x, y); }
+
+	/**
+	 * Sets the obstacle for this glow to follow
+	 *
+	 * The glow is positioned at the obstacle plus the offset on each update.
+	 * The glow does not own the obstacle, so the obstacle must outlive it (or
+	 * be cleared with nullptr first). Use nullptr for a fixed position.
+	 */
+	void setFollow(const cugl::physics2::Obstacle* obstacle, const cugl::Vec2& offset = cugl::Vec2::ZERO) {
+		_follow = obstacle;
+		_offset = offset;
+	}
+
+	/** Returns the obstacle this glow follows (nullptr if none) */
+	const cugl::physics2::Obstacle* getFollow() const { return _follow; }
+
 #pragma mark - 
 #pragma mark Attribute Properties
-	/** Returns the name of the ground sensor */
-	std::string* getSensorName() { return &_sensorName; }
-
 	/** Returns the amount of time past since the glow was initialized */
 	float getGlowTimer() { return _glowTime; }
 
@@ -127,20 +156,11 @@ public:
 
 	/** Sets the amount of time past since the last animation frame played */
 	void setAnimeTimer(float value) { _animeTime = value; }
-#pragma mark - 
-#pragma mark Physics Methods
-	/**Creates and adds the physics body(s) to the world */
-	void createFixtures() override;
-
-	/** Sets the vertical velocity of the enemy */
-	void setVX(float value) override;
-
-	/** Releases the fixtures of this body(s) from the world */
-	void releaseFixtures() override;
-	/** Updates the object's physics state (not game logic) */
-	void update(float dt) override;
-	/** Applies the force of the body of this glow */
-	void applyForce();
+
+#pragma mark -
+#pragma mark Update
+	/** Moves the glow to its followed obstacle, and the scene node to the glow */
+	void update(float dt);
 
 };
 #endif /* Glow Model*/
@@ -30,6 +30,7 @@
 #include "HomeScene.hpp"
 #include <cugl/cugl.h>
 #include "InputController.hpp"
+#include "SaveController.hpp"
 
 using namespace cugl;
 
@@ -50,14 +51,10 @@ using namespace cugl;
 bool HomeScene::init(const std::shared_ptr<cugl::AssetManager>& assets)
 {
     _choice = Choice::MENU;
-    std::shared_ptr<JsonReader> reader = JsonReader::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    std::shared_ptr<JsonValue> save = reader->readJson();
-    _progress = save->get("progress");
-    std::shared_ptr<JsonValue> settings = save->get("settings");
-    reader->close();
-    _swap = settings->get("swap")->asInt();
-    _sfx = settings->get("sfx")->asInt();
-    _music = settings->get("music")->asInt();
+    const SaveController::Settings& settings = SaveController::get()->getSettings();
+    _swap = settings.swap;
+    _sfx = settings.sfx;
+    _music = settings.music;
     Size dimen = Application::get()->getDisplaySize();
     float boundScale = SCENE_WIDTH / dimen.width;
     dimen *= boundScale;
@@ -342,8 +339,10 @@ void HomeScene::render(const std::shared_ptr<cugl::SpriteBatch> &batch)
 }
 
 void HomeScene::save() {
-    std::shared_ptr<TextWriter> writer = TextWriter::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    string test = _progress->toString();
-    writer->write("{\"progress\":" + _progress->toString() + ",\"settings\":{\"swap\": " + to_string(_swap) +", \"music\": " + to_string(_music) +", \"sfx\": " + to_string(_sfx) +"}}");
-    writer->close();
+    SaveController::Settings settings;
+    settings.swap = _swap;
+    settings.music = _music;
+    settings.sfx = _sfx;
+    SaveController::get()->setSettings(settings);
+    SaveController::get()->save();
 }
@@ -84,8 +84,6 @@ protected:
 
   int _sfx;
 
-  std::shared_ptr<cugl::JsonValue> _progress;
-
   void save();
 
 public:
@@ -26,7 +26,16 @@ InputController::InputController() : _active(false),
                                      _leftFingerDown(false),
                                      _rightFingerDown(false),
                                      _touchKey(0),
-                                     _debugKeyPressed(false)
+                                     _rightHeld(0),
+                                     _leftHeld(0),
+                                     _reversed(false),
+                                     _scripted(false),
+                                     _leftCode(0),
+                                     _rightCode(0),
+                                     _moveCode(0),
+                                     _debugKeyPressed(false),
+                                     _leftCharged(false),
+                                     _rightCharged(false)
 {
 }
 
@@ -171,6 +180,31 @@ void InputController::dispose()
  */
 void InputController::update(bool swap)
 {
+    if (_scripted) {
+        // The frame already accounts for swapped hands
+        _prevRightDown = _currRightDown;
+        _currRightDown = _rightFingerDown = _frame.rightDown;
+        _prevLeftDown = _currLeftDown;
+        _currLeftDown = _leftFingerDown = _frame.leftDown;
+        _leftStartPos  = _frame.leftStart;
+        _leftEndPos    = _frame.leftEnd;
+        _rightStartPos = _frame.rightStart;
+        _rightEndPos   = _frame.rightEnd;
+        _leftHeld  = _frame.leftHeld;
+        _rightHeld = _frame.rightHeld;
+        _acceleration = _frame.acceleration;
+        _reversed = _frame.reversed;
+
+        _leftCode  = _frame.leftCode;
+        _rightCode = _frame.rightCode;
+        _moveCode  = _frame.moveCode;
+        _leftCharged  = _frame.leftCharged;
+        _rightCharged = _frame.rightCharged;
+        _debugKeyPressed = _frame.debugKey;
+        _swap = swap;
+        return;
+    }
+
     if (_swap != swap) {
         _prevRightDown = _currLeftDown;
         _currRightDown = _leftFingerDown;
@@ -201,11 +235,52 @@ void InputController::update(bool swap)
     
     _swap = swap;
 
+    // Measure presses once, so every reader this frame sees the same time
+    Timestamp now;
+    if (_currLeftDown || _prevLeftDown) {
+        _leftHeld = (Uint32)Timestamp::ellapsedMillis(_leftStartTime, now);
+    }
+    if (_currRightDown || _prevRightDown) {
+        _rightHeld = (Uint32)Timestamp::ellapsedMillis(_rightStartTime, now);
+    }
+
+    // Only track landscape orientations
+    Display::Orientation orientation = Display::get()->getDeviceOrientation();
+    if (orientation == Display::Orientation::LANDSCAPE_REVERSED) {
+        _reversed = true;
+    } else if (orientation == Display::Orientation::LANDSCAPE) {
+        _reversed = false;
+    }
+
 #ifdef CU_TOUCH_SCREEN
     _acceleration = Input::get<Accelerometer>()->getAcceleration();
 #else
     readInput();
 #endif
+    capture();
+}
+
+/**
+ * Captures the current input state as the frame of this update
+ */
+void InputController::capture()
+{
+    _frame.leftCode  = _leftCode;
+    _frame.rightCode = _rightCode;
+    _frame.moveCode  = _moveCode;
+    _frame.leftCharged  = _leftCharged;
+    _frame.rightCharged = _rightCharged;
+    _frame.debugKey  = _debugKeyPressed;
+    _frame.leftDown  = _currLeftDown;
+    _frame.rightDown = _currRightDown;
+    _frame.leftStart  = _leftStartPos;
+    _frame.leftEnd    = _leftEndPos;
+    _frame.rightStart = _rightStartPos;
+    _frame.rightEnd   = _rightEndPos;
+    _frame.leftHeld  = _leftHeld;
+    _frame.rightHeld = _rightHeld;
+    _frame.acceleration = _acceleration;
+    _frame.reversed = _reversed;
 }
 
 /**
@@ -222,6 +297,23 @@ void InputController::reset()
     _debugKeyPressed = false;
 }
 
+#pragma mark Scripted Input
+/**
+ * Sets whether this controller is fed frames instead of polling devices.
+ *
+ * A scripted controller ignores the keyboard, touches and accelerometer,
+ * and applies the last frame given to {@link #feed} on each update.  This
+ * is used to drive the game without a player, such as in benchmarks and
+ * input replays.
+ *
+ * @param value whether this controller is fed frames
+ */
+void InputController::setScripted(bool value)
+{
+    _scripted = value;
+    _frame = Frame();
+}
+
 #pragma mark Touchscreen Callbacks
 
 /**
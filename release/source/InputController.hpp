@@ -19,6 +19,56 @@
  * for desktop testing. This interface hides the details.
  */
 class InputController {
+public:
+    /**
+     * The input state of a single frame
+     *
+     * This is everything the swipe and tilt controllers read from this
+     * controller in one update: the keyboard codes on desktop, and the
+     * touches, accelerometer and orientation on mobile.  A scripted
+     * controller is fed one frame per update instead of polling the devices,
+     * and a live controller captures one frame per update for recording.
+     */
+    struct Frame {
+        /** The left swipe code (0 = none, 1-4 = up/left/down/right, 5 = jump) */
+        int leftCode;
+        /** The right swipe code (0 = none, 1-4 = up/left/down/right, 5 = jump) */
+        int rightCode;
+        /** The movement code (-1 = left, 0 = none, 1 = right) */
+        int moveCode;
+        /** Whether the left attack is charged */
+        bool leftCharged;
+        /** Whether the right attack is charged */
+        bool rightCharged;
+        /** Whether the debug key is pressed */
+        bool debugKey;
+        /** Whether the left finger is down */
+        bool leftDown;
+        /** Whether the right finger is down */
+        bool rightDown;
+        /** The left swipe start position */
+        cugl::Vec2 leftStart;
+        /** The left swipe end position */
+        cugl::Vec2 leftEnd;
+        /** The right swipe start position */
+        cugl::Vec2 rightStart;
+        /** The right swipe end position */
+        cugl::Vec2 rightEnd;
+        /** The milliseconds since the left finger went down */
+        Uint32 leftHeld;
+        /** The milliseconds since the right finger went down */
+        Uint32 rightHeld;
+        /** The accelerometer reading */
+        cugl::Vec3 acceleration;
+        /** Whether the device is in reversed landscape orientation */
+        bool reversed;
+
+        /** Creates a frame with no input */
+        Frame() : leftCode(0), rightCode(0), moveCode(0),
+        leftCharged(false), rightCharged(false), debugKey(false),
+        leftDown(false), rightDown(false), leftHeld(0), rightHeld(0),
+        reversed(false) {}
+    };
 
 protected:
     /** Whether the input device was successfully initialized */
@@ -68,13 +118,31 @@ protected:
     /** Time that the left finger went down*/
     cugl::Timestamp _leftStartTime;
     
+    /** Milliseconds the right finger has been down (as of the last update) */
+    Uint32 _rightHeld;
+    /** Milliseconds the left finger has been down (as of the last update) */
+    Uint32 _leftHeld;
+
     // Acceloremeter variables
     /** Current acceleration */
     cugl::Vec3 _acceleration;
+    /** Whether the device was last in reversed landscape orientation */
+    bool _reversed;
     
     // Swap
     bool _swap;
 
+    // Scripted input
+    /** Whether this controller is fed frames instead of polling devices */
+    bool _scripted;
+    /** The frame applied (scripted) or captured (live) on the last update */
+    Frame _frame;
+
+    /**
+     * Captures the current input state as the frame of this update
+     */
+    void capture();
+
 #pragma mark Input Control
 public:
     // Variables for keyboard input
@@ -144,6 +212,48 @@ public:
      */
     void reset();
 
+#pragma mark Scripted Input
+    /**
+     * Returns true if this controller is fed frames instead of polling devices.
+     *
+     * @return true if this controller is fed frames instead of polling devices.
+     */
+    bool isScripted() const { return _scripted; }
+
+    /**
+     * Sets whether this controller is fed frames instead of polling devices.
+     *
+     * A scripted controller ignores the keyboard, touches and accelerometer,
+     * and applies the last frame given to {@link #feed} on each update.  This
+     * is used to drive the game without a player, such as in benchmarks and
+     * input replays.
+     *
+     * @param value whether this controller is fed frames
+     */
+    void setScripted(bool value);
+
+    /**
+     * Sets the frame to apply on the next update.
+     *
+     * The frame stays in effect until the next call to this method.  It has
+     * no effect unless the controller is scripted.  The frame is applied as
+     * is, so it should already account for swapped hands.
+     *
+     * @param frame The frame to apply on the next update
+     */
+    void feed(const Frame& frame) { _frame = frame; }
+
+    /**
+     * Returns the input state of the last update.
+     *
+     * This is the frame that was fed to a scripted controller, or the state
+     * read from the devices by a live one.  Feeding the frames of a live
+     * controller to a scripted one replays the input exactly.
+     *
+     * @return the input state of the last update.
+     */
+    const Frame& getFrame() const { return _frame; }
+
 #pragma mark Attributes
     /**
      * Returns true if this control is active.
@@ -184,12 +294,15 @@ public:
     }
     
     /**
-     * Returns the time the left swipe started at
+     * Returns the milliseconds the left finger has been down
+     *
+     * This is measured once per update, so it is the same for every reader
+     * in a frame.  After a release, it is the length of the press.
      *
-     * @return the left swipe start time
+     * @return the milliseconds the left finger has been down
      */
-    const cugl::Timestamp getLeftStartTime() const {
-        return _leftStartTime;
+    Uint32 getLeftHeldTime() const {
+        return _leftHeld;
     }
     
     /**
@@ -220,12 +333,15 @@ public:
     }
     
     /**
-     * Returns the time the right swipe started at
+     * Returns the milliseconds the right finger has been down
+     *
+     * This is measured once per update, so it is the same for every reader
+     * in a frame.  After a release, it is the length of the press.
      *
-     * @return the right swipe start time
+     * @return the milliseconds the right finger has been down
      */
-    const cugl::Timestamp getRightStartTime() const {
-        return _rightStartTime;
+    Uint32 getRightHeldTime() const {
+        return _rightHeld;
     }
     
 
@@ -287,6 +403,18 @@ public:
         return _acceleration;
     }
 
+    /**
+     * Returns true if the device was last in reversed landscape orientation
+     *
+     * Portrait orientations are ignored, so this is the last landscape
+     * orientation of the device.
+     *
+     * @return true if the device was last in reversed landscape orientation
+     */
+    bool isReversed() const {
+        return _reversed;
+    }
+
 
 #pragma mark Touchscreen Callbacks
     /**
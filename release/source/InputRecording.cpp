@@ -0,0 +1,246 @@
+//
+//  InputRecording.cpp
+//  Liminal Spirit Game
+//
+//  This class is a recording of the input of a single level, frame by frame.
+//  See the header for details.
+//
+#include "InputRecording.hpp"
+
+using namespace cugl;
+
+/** The magic number at the start of a recording ("LSIR") */
+#define RECORDING_MAGIC     0x4C534952
+/** The version of the recording format */
+#define RECORDING_VERSION   1
+
+/** The frame has a new timestep */
+#define CHANGED_TIMESTEP    0x01
+/** The frame has new keyboard codes */
+#define CHANGED_KEYS        0x02
+/** The frame has a new left touch */
+#define CHANGED_LEFT        0x04
+/** The frame has a new right touch */
+#define CHANGED_RIGHT       0x08
+/** The frame has a new accelerometer reading */
+#define CHANGED_TILT        0x10
+
+/**
+ * Returns the given path, resolved against the save directory if relative
+ *
+ * @param file  The path to resolve
+ *
+ * @return the given path, resolved against the save directory if relative
+ */
+static std::string resolve(const std::string& file) {
+    if (filetool::is_absolute(file)) {
+        return file;
+    }
+    return Application::get()->getSaveDirectory()+file;
+}
+
+/**
+ * Returns the bit flags for the keyboard state of a frame
+ *
+ * @param frame The input frame
+ *
+ * @return the bit flags for the keyboard state of a frame
+ */
+static Uint8 key_flags(const InputController::Frame& frame) {
+    return (frame.leftCharged ? 1 : 0) | (frame.rightCharged ? 2 : 0) | (frame.debugKey ? 4 : 0);
+}
+
+#pragma mark Constructors
+/**
+ * Initializes an empty recording for the given level
+ *
+ * The arguments are those given to {@link GameScene#init}.
+ *
+ * @param biome     The biome (or level key) of the level
+ * @param stage     The stage number of the level
+ * @param tutorial  The tutorial mode of the level
+ * @param seed      The random seed of the level
+ *
+ * @return true if the recording was initialized successfully
+ */
+bool InputRecording::init(const std::string& biome, int stage, int tutorial, Uint32 seed) {
+    _biome = biome;
+    _stage = stage;
+    _tutorial = tutorial;
+    _seed = seed;
+    _unlocks = 0;
+    _timesteps.clear();
+    _frames.clear();
+    return true;
+}
+
+/**
+ * Initializes this recording from the given binary file
+ *
+ * @param file  The path to the recording
+ *
+ * @return true if the recording was read successfully
+ */
+bool InputRecording::initWithFile(const std::string& file) {
+    std::string path = resolve(file);
+    std::shared_ptr<BinaryReader> reader = BinaryReader::alloc(path);
+    if (reader == nullptr) {
+        CULogError("Unable to open input recording %s", path.c_str());
+        return false;
+    }
+    if (!reader->ready(6) || reader->readUint32() != RECORDING_MAGIC ||
+        reader->readUint16() != RECORDING_VERSION) {
+        CULogError("%s is not an input recording", path.c_str());
+        reader->close();
+        return false;
+    }
+
+    Uint16 length = reader->readUint16();
+    std::string biome(length, ' ');
+    reader->read(&biome[0], length);
+    int stage = reader->readSint32();
+    int tutorial = reader->readSint32();
+    int unlocks = reader->readSint32();
+    Uint32 seed = reader->readUint32();
+    Uint32 count = reader->readUint32();
+    init(biome, stage, tutorial, seed);
+    _timesteps.reserve(count);
+    _frames.reserve(count);
+
+    float timestep = 0;
+    InputController::Frame frame;
+    for(Uint32 ii = 0; ii < count; ii++) {
+        if (!reader->ready()) {
+            CULogError("Input recording %s is truncated", path.c_str());
+            break;
+        }
+        Uint8 changed = reader->readByte();
+        if (changed & CHANGED_TIMESTEP) {
+            timestep = reader->readFloat();
+        }
+        if (changed & CHANGED_KEYS) {
+            frame.leftCode  = (Sint8)reader->readByte();
+            frame.rightCode = (Sint8)reader->readByte();
+            frame.moveCode  = (Sint8)reader->readByte();
+            Uint8 flags = reader->readByte();
+            frame.leftCharged  = flags & 1;
+            frame.rightCharged = flags & 2;
+            frame.debugKey = flags & 4;
+        }
+        if (changed & CHANGED_LEFT) {
+            frame.leftDown = reader->readByte();
+            frame.leftStart.x = reader->readFloat();
+            frame.leftStart.y = reader->readFloat();
+            frame.leftEnd.x = reader->readFloat();
+            frame.leftEnd.y = reader->readFloat();
+            frame.leftHeld  = reader->readUint32();
+        }
+        if (changed & CHANGED_RIGHT) {
+            frame.rightDown = reader->readByte();
+            frame.rightStart.x = reader->readFloat();
+            frame.rightStart.y = reader->readFloat();
+            frame.rightEnd.x = reader->readFloat();
+            frame.rightEnd.y = reader->readFloat();
+            frame.rightHeld  = reader->readUint32();
+        }
+        if (changed & CHANGED_TILT) {
+            frame.acceleration.x = reader->readFloat();
+            frame.acceleration.y = reader->readFloat();
+            frame.acceleration.z = reader->readFloat();
+            frame.reversed = reader->readByte();
+        }
+        append(timestep, unlocks, frame);
+    }
+    reader->close();
+    return true;
+}
+
+/**
+ * Writes this recording to the given binary file
+ *
+ * Relative paths are written to the save directory.
+ *
+ * @param file  The path to the recording
+ *
+ * @return true if the recording was written successfully
+ */
+bool InputRecording::save(const std::string& file) const {
+    std::string path = resolve(file);
+    std::shared_ptr<BinaryWriter> writer = BinaryWriter::alloc(path);
+    if (writer == nullptr) {
+        CULogError("Unable to write input recording %s", path.c_str());
+        return false;
+    }
+    writer->writeUint32(RECORDING_MAGIC);
+    writer->writeUint16(RECORDING_VERSION);
+    writer->writeUint16((Uint16)_biome.size());
+    writer->write(_biome.c_str(), _biome.size());
+    writer->writeSint32(_stage);
+    writer->writeSint32(_tutorial);
+    writer->writeSint32(_unlocks);
+    writer->writeUint32(_seed);
+    writer->writeUint32((Uint32)_frames.size());
+
+    // Every part counts as changed on the first frame
+    InputController::Frame last;
+    float timestep = 0;
+    for(size_t ii = 0; ii < _frames.size(); ii++) {
+        const InputController::Frame& frame = _frames[ii];
+        Uint8 changed = 0;
+        if (ii == 0 || _timesteps[ii] != timestep) {
+            changed |= CHANGED_TIMESTEP;
+        }
+        if (ii == 0 || frame.leftCode != last.leftCode || frame.rightCode != last.rightCode ||
+            frame.moveCode != last.moveCode || key_flags(frame) != key_flags(last)) {
+            changed |= CHANGED_KEYS;
+        }
+        if (ii == 0 || frame.leftDown != last.leftDown || frame.leftHeld != last.leftHeld ||
+            frame.leftStart != last.leftStart || frame.leftEnd != last.leftEnd) {
+            changed |= CHANGED_LEFT;
+        }
+        if (ii == 0 || frame.rightDown != last.rightDown || frame.rightHeld != last.rightHeld ||
+            frame.rightStart != last.rightStart || frame.rightEnd != last.rightEnd) {
+            changed |= CHANGED_RIGHT;
+        }
+        if (ii == 0 || frame.acceleration != last.acceleration || frame.reversed != last.reversed) {
+            changed |= CHANGED_TILT;
+        }
+
+        writer->writeUint8(changed);
+        if (changed & CHANGED_TIMESTEP) {
+            writer->writeFloat(_timesteps[ii]);
+        }
+        if (changed & CHANGED_KEYS) {
+            writer->writeUint8((Uint8)frame.leftCode);
+            writer->writeUint8((Uint8)frame.rightCode);
+            writer->writeUint8((Uint8)frame.moveCode);
+            writer->writeUint8(key_flags(frame));
+        }
+        if (changed & CHANGED_LEFT) {
+            writer->writeUint8(frame.leftDown);
+            writer->writeFloat(frame.leftStart.x);
+            writer->writeFloat(frame.leftStart.y);
+            writer->writeFloat(frame.leftEnd.x);
+            writer->writeFloat(frame.leftEnd.y);
+            writer->writeUint32(frame.leftHeld);
+        }
+        if (changed & CHANGED_RIGHT) {
+            writer->writeUint8(frame.rightDown);
+            writer->writeFloat(frame.rightStart.x);
+            writer->writeFloat(frame.rightStart.y);
+            writer->writeFloat(frame.rightEnd.x);
+            writer->writeFloat(frame.rightEnd.y);
+            writer->writeUint32(frame.rightHeld);
+        }
+        if (changed & CHANGED_TILT) {
+            writer->writeFloat(frame.acceleration.x);
+            writer->writeFloat(frame.acceleration.y);
+            writer->writeFloat(frame.acceleration.z);
+            writer->writeUint8(frame.reversed);
+        }
+        last = frame;
+        timestep = _timesteps[ii];
+    }
+    writer->close();
+    return true;
+}
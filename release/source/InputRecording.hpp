@@ -0,0 +1,186 @@
+//
+//  InputRecording.hpp
+//  Liminal Spirit Game
+//
+//  This class is a recording of the input of a single level, frame by frame.
+//  Each frame is the InputController state consumed by one GameScene update,
+//  together with the timestep of that update.  The recording also has the
+//  level and the random seed, so that replaying it plays the level exactly
+//  as it was recorded.
+//
+//  Recordings are saved in a compact binary file.  Each frame starts with a
+//  byte marking which parts of the input changed since the previous frame,
+//  and only those parts follow.  A frame with no change is a single byte.
+//
+#ifndef __INPUT_RECORDING_HPP__
+#define __INPUT_RECORDING_HPP__
+#include <cugl/cugl.h>
+#include "InputController.hpp"
+
+class InputRecording {
+protected:
+    /** The biome (or level key) the level was initialized with */
+    std::string _biome;
+    /** The stage number (negative for a level without one) */
+    int _stage;
+    /** The tutorial mode of the level */
+    int _tutorial;
+    /** The player unlocks during the level */
+    int _unlocks;
+    /** The random seed of the level */
+    Uint32 _seed;
+    /** The timestep of each frame */
+    std::vector<float> _timesteps;
+    /** The input of each frame */
+    std::vector<InputController::Frame> _frames;
+
+public:
+    /**
+     * Creates an empty recording
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. Use {@link #alloc} instead.
+     */
+    InputRecording() : _stage(0), _tutorial(0), _unlocks(0), _seed(0) {}
+
+    /**
+     * Initializes an empty recording for the given level
+     *
+     * The arguments are those given to {@link GameScene#init}.
+     *
+     * @param biome     The biome (or level key) of the level
+     * @param stage     The stage number of the level
+     * @param tutorial  The tutorial mode of the level
+     * @param seed      The random seed of the level
+     *
+     * @return true if the recording was initialized successfully
+     */
+    bool init(const std::string& biome, int stage, int tutorial, Uint32 seed);
+
+    /**
+     * Initializes this recording from the given binary file
+     *
+     * @param file  The path to the recording
+     *
+     * @return true if the recording was read successfully
+     */
+    bool initWithFile(const std::string& file);
+
+    /**
+     * Returns a newly allocated recording for the given level
+     *
+     * The arguments are those given to {@link GameScene#init}.
+     *
+     * @param biome     The biome (or level key) of the level
+     * @param stage     The stage number of the level
+     * @param tutorial  The tutorial mode of the level
+     * @param seed      The random seed of the level
+     *
+     * @return a newly allocated recording for the given level
+     */
+    static std::shared_ptr<InputRecording> alloc(const std::string& biome, int stage, int tutorial, Uint32 seed) {
+        std::shared_ptr<InputRecording> result = std::make_shared<InputRecording>();
+        return (result->init(biome, stage, tutorial, seed) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated recording from the given binary file
+     *
+     * Relative paths are read from the save directory.
+     *
+     * @param file  The path to the recording
+     *
+     * @return a newly allocated recording from the given binary file
+     */
+    static std::shared_ptr<InputRecording> allocWithFile(const std::string& file) {
+        std::shared_ptr<InputRecording> result = std::make_shared<InputRecording>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+    /**
+     * Writes this recording to the given binary file
+     *
+     * Relative paths are written to the save directory.
+     *
+     * @param file  The path to the recording
+     *
+     * @return true if the recording was written successfully
+     */
+    bool save(const std::string& file) const;
+
+#pragma mark Attributes
+    /**
+     * Returns the biome (or level key) of the level
+     *
+     * @return the biome (or level key) of the level
+     */
+    const std::string& getBiome() const { return _biome; }
+
+    /**
+     * Returns the stage number of the level
+     *
+     * @return the stage number of the level
+     */
+    int getStage() const { return _stage; }
+
+    /**
+     * Returns the tutorial mode of the level
+     *
+     * @return the tutorial mode of the level
+     */
+    int getTutorial() const { return _tutorial; }
+
+    /**
+     * Returns the player unlocks during the level
+     *
+     * @return the player unlocks during the level
+     */
+    int getUnlocks() const { return _unlocks; }
+
+    /**
+     * Returns the random seed of the level
+     *
+     * @return the random seed of the level
+     */
+    Uint32 getSeed() const { return _seed; }
+
+#pragma mark Frames
+    /**
+     * Returns the number of frames in this recording
+     *
+     * @return the number of frames in this recording
+     */
+    size_t size() const { return _frames.size(); }
+
+    /**
+     * Returns the timestep of the given frame
+     *
+     * @param frame The frame number
+     *
+     * @return the timestep of the given frame
+     */
+    float getTimestep(size_t frame) const { return _timesteps[frame]; }
+
+    /**
+     * Returns the input of the given frame
+     *
+     * @param frame The frame number
+     *
+     * @return the input of the given frame
+     */
+    const InputController::Frame& getFrame(size_t frame) const { return _frames[frame]; }
+
+    /**
+     * Appends a frame to this recording
+     *
+     * @param timestep  The timestep of the frame
+     * @param unlocks   The player unlocks during the frame
+     * @param frame     The input of the frame
+     */
+    void append(float timestep, int unlocks, const InputController::Frame& frame) {
+        _timesteps.push_back(timestep);
+        _frames.push_back(frame);
+        _unlocks = unlocks;
+    }
+};
+
+#endif /* __INPUT_RECORDING_HPP__ */
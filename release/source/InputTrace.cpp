@@ -0,0 +1,91 @@
+//
+//  InputTrace.cpp
+//  Liminal Spirit Game
+//
+//  This class is a script of per-frame inputs for the InputController. See
+//  the header for the file format.
+//
+#include "InputTrace.hpp"
+
+using namespace cugl;
+
+/**
+ * Initializes this trace from the given JSON value
+ *
+ * @param json  The JSON value with the trace runs
+ *
+ * @return true if the trace was initialized successfully
+ */
+bool InputTrace::init(const std::shared_ptr<JsonValue>& json) {
+    if (json == nullptr) {
+        return false;
+    }
+    _loop = json->getBool("loop", false);
+    _frames.clear();
+
+    std::shared_ptr<JsonValue> runs = json->get("frames");
+    if (runs == nullptr) {
+        return true;
+    }
+    for(int ii = 0; ii < (int)runs->size(); ii++) {
+        std::shared_ptr<JsonValue> run = runs->get(ii);
+        InputController::Frame frame;
+        frame.leftCode  = run->getInt("left", 0);
+        frame.rightCode = run->getInt("right", 0);
+        frame.moveCode  = run->getInt("move", 0);
+        std::shared_ptr<JsonValue> charged = run->get("charged");
+        if (charged != nullptr && charged->size() >= 2) {
+            frame.leftCharged  = charged->get(0)->asBool();
+            frame.rightCharged = charged->get(1)->asBool();
+        }
+        int hold = std::max(run->getInt("hold", 1), 0);
+        _frames.insert(_frames.end(), hold, frame);
+    }
+    return true;
+}
+
+/**
+ * Returns a newly allocated trace from the given JSON file
+ *
+ * Relative paths are read from the asset directory.
+ *
+ * @param file  The path to the JSON file
+ *
+ * @return a newly allocated trace from the given JSON file
+ */
+std::shared_ptr<InputTrace> InputTrace::allocWithFile(const std::string& file) {
+    std::shared_ptr<JsonReader> reader;
+    if (filetool::is_absolute(file)) {
+        reader = JsonReader::alloc(file);
+    } else {
+        reader = JsonReader::allocWithAsset(file);
+    }
+    if (reader == nullptr) {
+        CULogError("Unable to open input trace %s", file.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<JsonValue> json = reader->readJson();
+    reader->close();
+    return alloc(json);
+}
+
+/**
+ * Returns the input for the given frame
+ *
+ * If the frame is past the end of the trace, this is the frame modulo
+ * the trace length if the trace loops, and no input otherwise.
+ *
+ * @param frame The frame number
+ *
+ * @return the input for the given frame
+ */
+InputController::Frame InputTrace::get(Uint64 frame) const {
+    if (!_frames.empty()) {
+        if (frame < _frames.size()) {
+            return _frames[frame];
+        } else if (_loop) {
+            return _frames[frame % _frames.size()];
+        }
+    }
+    return InputController::Frame();
+}
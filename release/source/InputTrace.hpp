@@ -0,0 +1,99 @@
+//
+//  InputTrace.hpp
+//  Liminal Spirit Game
+//
+//  This class is a script of per-frame inputs for the InputController. It is
+//  used to drive a GameScene without a player, so that a level can be played
+//  the same way on every run.
+//
+//  A trace is read from a JSON file of runs.  Each run is the keyboard state
+//  of a frame and the number of frames to hold it for, as in
+//
+//      { "loop": true,
+//        "frames": [ { "move": 1, "hold": 30 },
+//                    { "left": 1 },
+//                    { "right": 4, "charged": [false, true], "hold": 2 } ] }
+//
+//  The codes are those of InputController::readInput.  Missing fields are 0
+//  (or false), and hold defaults to 1 frame.
+//
+#ifndef __INPUT_TRACE_HPP__
+#define __INPUT_TRACE_HPP__
+#include <cugl/cugl.h>
+#include "InputController.hpp"
+
+class InputTrace {
+protected:
+    /** The input of each frame */
+    std::vector<InputController::Frame> _frames;
+    /** Whether the trace restarts when it runs out of frames */
+    bool _loop;
+
+public:
+    /**
+     * Creates an empty trace
+     *
+     * An empty trace has no input on every frame.
+     */
+    InputTrace() : _loop(false) {}
+
+    /**
+     * Initializes this trace from the given JSON value
+     *
+     * @param json  The JSON value with the trace runs
+     *
+     * @return true if the trace was initialized successfully
+     */
+    bool init(const std::shared_ptr<cugl::JsonValue>& json);
+
+    /**
+     * Returns a newly allocated trace from the given JSON value
+     *
+     * @param json  The JSON value with the trace runs
+     *
+     * @return a newly allocated trace from the given JSON value
+     */
+    static std::shared_ptr<InputTrace> alloc(const std::shared_ptr<cugl::JsonValue>& json) {
+        std::shared_ptr<InputTrace> result = std::make_shared<InputTrace>();
+        return (result->init(json) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated trace from the given JSON file
+     *
+     * Relative paths are read from the asset directory.
+     *
+     * @param file  The path to the JSON file
+     *
+     * @return a newly allocated trace from the given JSON file
+     */
+    static std::shared_ptr<InputTrace> allocWithFile(const std::string& file);
+
+    /**
+     * Returns the number of frames in this trace
+     *
+     * @return the number of frames in this trace
+     */
+    size_t size() const { return _frames.size(); }
+
+    /**
+     * Returns true if the trace restarts when it runs out of frames
+     *
+     * @return true if the trace restarts when it runs out of frames
+     */
+    bool isLooping() const { return _loop; }
+
+    /**
+     * Returns the input for the given frame
+     *
+     * If the frame is past the end of the trace, this is the frame modulo
+     * the trace length if the trace loops, and no input otherwise.
+     *
+     * @param frame The frame number
+     *
+     * @return the input for the given frame
+     */
+    InputController::Frame get(Uint64 frame) const;
+};
+
+#endif /* __INPUT_TRACE_HPP__ */
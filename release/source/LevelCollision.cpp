@@ -0,0 +1,177 @@
+//
+//  LevelCollision.cpp
+//  Liminal Spirit Game
+//
+//  This class bakes the immovable geometry of a level into a single static
+//  body. See the header for details.
+//
+
+#include "LevelCollision.hpp"
+#include <algorithm>
+
+using namespace cugl;
+
+/** The largest texture dimension to bake */
+#define MAX_BAKE_SIZE 4096
+
+#pragma mark -
+#pragma mark Constructors
+/** Initializes an empty level */
+bool LevelCollision::init() {
+    if (SimpleObstacle::init(Vec2::ZERO)) {
+        setBodyType(b2_staticBody);
+        setDensity(0);
+        setFriction(0);
+        setName("level");
+        return true;
+    }
+    return false;
+}
+
+/** Disposes all resources and assets of this level */
+void LevelCollision::dispose() {
+    _parts.clear();
+    _geoms.clear();
+    _sprites.clear();
+}
+
+#pragma mark -
+#pragma mark Geometry
+/**
+ * Adds a box to the level
+ *
+ * This must be called before the level is added to the world.
+ */
+void LevelCollision::addBox(const Rect& rect, const std::string& name, const b2Filter& filter) {
+    CUAssertLog(_body == nullptr, "Pieces must be added before the level is in the world");
+    Part part;
+    part.rect = rect;
+    part.name = name;
+    part.filter = filter;
+    _parts.push_back(part);
+}
+
+/** Returns the collision name of the given body and fixture */
+std::string LevelCollision::getPartName(physics2::Obstacle* obstacle, std::string* fixture) {
+    if (fixture != nullptr && dynamic_cast<LevelCollision*>(obstacle) != nullptr) {
+        return *fixture;
+    }
+    return obstacle->getName();
+}
+
+#pragma mark -
+#pragma mark Sprites
+/** Returns a single node with all of the sprites drawn into it */
+std::shared_ptr<scene2::PolygonNode> LevelCollision::bake(float resolution) const {
+    if (_sprites.empty()) {
+        return nullptr;
+    }
+
+    std::vector<std::shared_ptr<scene2::SceneNode>> sprites = _sprites;
+    std::stable_sort(sprites.begin(), sprites.end(),
+                     [](const std::shared_ptr<scene2::SceneNode>& a,
+                        const std::shared_ptr<scene2::SceneNode>& b) {
+                         return a->getPriority() < b->getPriority();
+                     });
+
+    Rect bounds = sprites[0]->getBoundingBox();
+    for (auto it = sprites.begin(); it != sprites.end(); ++it) {
+        bounds.merge((*it)->getBoundingBox());
+    }
+    float minx = floorf(bounds.getMinX());
+    float miny = floorf(bounds.getMinY());
+    float width  = ceilf(bounds.getMaxX()) - minx;
+    float height = ceilf(bounds.getMaxY()) - miny;
+    resolution = std::min(resolution, MAX_BAKE_SIZE / std::max(width, height));
+
+    std::shared_ptr<RenderTarget> target = RenderTarget::alloc((int)ceilf(width * resolution),
+                                                               (int)ceilf(height * resolution));
+    std::shared_ptr<SpriteBatch> batch = SpriteBatch::alloc();
+    if (target == nullptr || batch == nullptr) {
+        return nullptr;
+    }
+    target->setClearColor(Color4::CLEAR);
+
+    std::shared_ptr<OrthographicCamera> camera = OrthographicCamera::allocOffset(minx, miny, width, height);
+    target->begin();
+    batch->begin(camera->getCombined());
+    for (auto it = sprites.begin(); it != sprites.end(); ++it) {
+        (*it)->render(batch, Affine2::IDENTITY, Color4::WHITE);
+    }
+    batch->end();
+    target->end();
+
+    // The target is bottom up and premultiplied
+    std::shared_ptr<scene2::PolygonNode> node = scene2::PolygonNode::allocWithTexture(target->getTexture());
+    node->flipVertical(true);
+    node->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    node->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
+    node->setScale(width / node->getContentSize().width, height / node->getContentSize().height);
+    node->setPosition(minx, miny);
+    node->setPriority(sprites[0]->getPriority());
+    return node;
+}
+
+#pragma mark -
+#pragma mark Physics Methods
+/** Creates a fixture for each piece of the level */
+void LevelCollision::createFixtures() {
+    if (_body == nullptr) {
+        return;
+    }
+
+    releaseFixtures();
+    b2PolygonShape shape;
+    b2FixtureDef def = _fixture;
+    def.shape = &shape;
+    for (auto it = _parts.begin(); it != _parts.end(); ++it) {
+        Vec2 center = it->rect.origin + it->rect.size / 2;
+        shape.SetAsBox(it->rect.size.width / 2, it->rect.size.height / 2, b2Vec2(center.x, center.y), 0);
+        def.filter = it->filter;
+        def.userData.pointer = reinterpret_cast<uintptr_t>(&(it->name));
+        _geoms.push_back(_body->CreateFixture(&def));
+    }
+    markDirty(false);
+}
+
+/** Releases the fixtures of this level */
+void LevelCollision::releaseFixtures() {
+    if (_body != nullptr) {
+        for (auto it = _geoms.begin(); it != _geoms.end(); ++it) {
+            _body->DestroyFixture(*it);
+        }
+    }
+    _geoms.clear();
+}
+
+#pragma mark -
+#pragma mark Scene Graph Methods
+/** Redraws the outline of the physics fixtures */
+void LevelCollision::resetDebug() {
+    Poly2 poly;
+    for (auto it = _parts.begin(); it != _parts.end(); ++it) {
+        Uint32 base = (Uint32)poly.vertices.size();
+        const Rect& rect = it->rect;
+        poly.vertices.push_back(rect.origin);
+        poly.vertices.push_back(Vec2(rect.getMaxX(), rect.getMinY()));
+        poly.vertices.push_back(Vec2(rect.getMaxX(), rect.getMaxY()));
+        poly.vertices.push_back(Vec2(rect.getMinX(), rect.getMaxY()));
+        Uint32 quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int ii = 0; ii < 6; ii++) {
+            poly.indices.push_back(base + quad[ii]);
+        }
+    }
+
+    if (_debug == nullptr) {
+        _debug = scene2::WireNode::allocWithTraversal(poly, poly2::Traversal::INTERIOR);
+        _debug->setColor(_dcolor);
+        if (_scene != nullptr) {
+            _scene->addChild(_debug);
+        }
+    } else {
+        _debug->setTraversal(poly2::Traversal::INTERIOR);
+        _debug->setPolygon(poly);
+    }
+    _debug->setAbsolute(true);
+    _debug->setPosition(getPosition());
+}
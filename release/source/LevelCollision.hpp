@@ -0,0 +1,141 @@
+//
+//  LevelCollision.hpp
+//  Liminal Spirit Game
+//
+//  This class bakes the immovable geometry of a level (the floor, ceiling,
+//  walls and platforms) into a single static body, with one fixture per piece.
+//  Static bodies are never updated by the ObstacleWorld, so the level costs
+//  nothing per frame.  It can also bake the sprites for that geometry into a
+//  single texture, so that they are drawn as one node.
+//
+//  CollisionController identifies surfaces by name.  As the level is one body,
+//  each fixture carries the name of its piece (use getPartName to look it up).
+//
+
+#ifndef __LEVEL_COLLISION_HPP__
+#define __LEVEL_COLLISION_HPP__
+#include <cugl/cugl.h>
+#include <cugl/physics2/CUSimpleObstacle.h>
+#include <cugl/scene2/graph/CUWireNode.h>
+#include <deque>
+
+#pragma mark -
+#pragma mark Level Collision
+/**
+ * The static level geometry for Liminal Spirit
+ *
+ * Pieces are added with addBox before the obstacle is added to the world.
+ * Each piece has its own name and collision filter.
+ */
+class LevelCollision : public cugl::physics2::SimpleObstacle {
+protected:
+    /** A box of immovable geometry */
+    struct Part {
+        /** The box in physics coordinates */
+        cugl::Rect rect;
+        /** The name of the piece (the fixture user data) */
+        std::string name;
+        /** The collision filter of the piece */
+        b2Filter filter;
+    };
+
+    /** The pieces of the level (a deque, as the fixtures point to the names) */
+    std::deque<Part> _parts;
+    /** The fixtures of the pieces */
+    std::vector<b2Fixture*> _geoms;
+    /** The sprites to bake */
+    std::vector<std::shared_ptr<cugl::scene2::SceneNode>> _sprites;
+
+    /** Redraws the outline of the physics fixtures */
+    virtual void resetDebug() override;
+
+public:
+    /** Creates a degenerate level */
+    LevelCollision() : SimpleObstacle() { }
+
+    /** Destroys this level, releasing all resources */
+    virtual ~LevelCollision(void) { dispose(); }
+
+    /** Disposes all resources and assets of this level */
+    void dispose();
+
+    /** Initializes an empty level */
+    virtual bool init() override;
+
+#pragma mark -
+#pragma mark Static Constructors
+    /** Allocates an empty level */
+    static std::shared_ptr<LevelCollision> alloc() {
+        std::shared_ptr<LevelCollision> result = std::make_shared<LevelCollision>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Geometry
+    /**
+     * Adds a box to the level
+     *
+     * This must be called before the level is added to the world.
+     *
+     * @param rect      The box in physics coordinates
+     * @param name      The name of the piece for collisions
+     * @param filter    The collision filter of the piece
+     */
+    void addBox(const cugl::Rect& rect, const std::string& name, const b2Filter& filter);
+
+    /** Returns the number of pieces in this level */
+    size_t getPartCount() const { return _parts.size(); }
+
+    /**
+     * Returns the collision name of the given body and fixture
+     *
+     * For a level, this is the name of the piece the fixture belongs to.
+     * Otherwise it is the name of the obstacle.
+     *
+     * @param obstacle  The obstacle of the body
+     * @param fixture   The fixture user data (may be nullptr)
+     *
+     * @return the collision name of the given body and fixture
+     */
+    static std::string getPartName(cugl::physics2::Obstacle* obstacle, std::string* fixture);
+
+#pragma mark -
+#pragma mark Sprites
+    /**
+     * Adds a sprite to bake
+     *
+     * The sprite should be positioned in the coordinates of the node that
+     * will hold the baked sprites.  It is not added to the scene graph.
+     *
+     * @param node  The sprite to bake
+     */
+    void addSprite(const std::shared_ptr<cugl::scene2::SceneNode>& node) { _sprites.push_back(node); }
+
+    /** Returns the sprites to bake */
+    const std::vector<std::shared_ptr<cugl::scene2::SceneNode>>& getSprites() const { return _sprites; }
+
+    /**
+     * Returns a single node with all of the sprites drawn into it
+     *
+     * The sprites are drawn in order of priority (like an ascending
+     * OrderedNode) into a texture that covers their bounding box.  The
+     * node has the lowest priority of the sprites.  The texture has
+     * resolution times as many pixels as the sprite coordinates, and the
+     * node is scaled down to match.  This must be called on the thread
+     * with the OpenGL context.
+     *
+     * @param resolution    The texture pixels per sprite coordinate
+     *
+     * @return a single node with all of the sprites drawn into it
+     */
+    std::shared_ptr<cugl::scene2::PolygonNode> bake(float resolution) const;
+
+#pragma mark -
+#pragma mark Physics Methods
+    /** Creates a fixture for each piece of the level */
+    void createFixtures() override;
+
+    /** Releases the fixtures of this level */
+    void releaseFixtures() override;
+};
+#endif /* __LEVEL_COLLISION_HPP__ */
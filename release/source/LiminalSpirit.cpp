@@ -38,6 +38,9 @@ using namespace cugl;
 void LiminalSpirit::onStartup()
 {
     _assets = AssetManager::alloc();
+#if PROFILE_LOADING
+    _assets->setProfiler(LoaderProfiler::alloc());
+#endif
     _batch = SpriteBatch::alloc();
     _scene = State::LOADING;
 
@@ -60,46 +63,30 @@ void LiminalSpirit::onStartup()
 
     // TODO check this
     _assets->attach<JsonValue>(JsonLoader::alloc()->getHook());
+    _assets->attach<ParticleLibrary>(GenericLoader<ParticleLibrary>::alloc()->getHook());
 
     // Queue up the other assets
     _assets->loadDirectoryAsync("json/assets.json", nullptr);
+    // Emitter definitions are precompiled once here, not on every burst
+    _assets->loadAsync<ParticleLibrary>("particles", "json/particles.json", nullptr);
     //_assets->loadDirectory("json/assets.json");
     
-    AudioEngine::start(32);
+    AudioEngine::start(AUDIO_SLOTS);
     
-    if (!filetool::file_exists(Application::get()->getSaveDirectory() + "savedGame.json")) {
-        std::shared_ptr<TextWriter> writer = TextWriter::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-        writer->write("{\"progress\":{\"biome\": 1, \"highest_level\": 1, \"unlock_count\": 0}, \"settings\":{\"swap\": false, \"music\": 10, \"sfx\": 10}}");
-        writer->close();
-    }
-    
-    try{
-        std::shared_ptr<JsonReader> reader = JsonReader::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-        std::shared_ptr<JsonValue> save = reader->readJson();
-        std::shared_ptr<JsonValue> progress = save->get("progress");
-        std::shared_ptr<JsonValue> settings = save->get("settings");
-        reader->close();
-    
-        // Note: COMMENT THESE OUT TO DISABLE PROGRESSION!!!!!!!!
-        _biome = progress->has("biome") ? progress->get("biome")->asInt() : 1;
-        _highest_level = progress->has("highest_level") ? progress->get("highest_level")->asInt() : 1;
-        _unlock_count = progress->has("unlock_count") ? progress->get("unlock_count")->asInt() : 0;
-        // Note: COMMENT THESE OUT TO ENABLE PROGRESSION!!!!!!!!
-//      _biome = 3;
-//      _highest_level = 10;
-//      _unlock_count = 5;
-        // leave below uncommented
-        _swap = settings->has("swap") ? settings->get("swap")->asInt() : 0;
-        _music = settings->has("music") ? settings->get("music")->asInt() : 10;
-        _sfx = settings->has("sfx") ? settings->get("sfx")->asInt() : 10;
-    } catch(...){
-        _biome = 1;
-        _highest_level = 1;
-        _unlock_count = 0;
-        _swap = 0;
-        _music = 10;
-        _sfx = 10;
+    // Parse the save file once; scenes read it from the controller
+    if (!SaveController::start()) {
+        CULogError("Unable to start the save controller");
     }
+    const SaveController::Progress& progress = SaveController::get()->getProgress();
+
+    // Note: COMMENT THESE OUT TO DISABLE PROGRESSION!!!!!!!!
+    _biome = progress.biome;
+    _highest_level = progress.highestLevel;
+    _unlock_count = progress.unlockCount;
+    // Note: COMMENT THESE OUT TO ENABLE PROGRESSION!!!!!!!!
+//  _biome = 3;
+//  _highest_level = 10;
+//  _unlock_count = 5;
     this->save();
     
     //CULog("Biome: %d, Level: %d, Unlocks: %d, Swap: %d", _biome, _highest_level, _unlock_count, _swap);
@@ -137,10 +124,22 @@ void LiminalSpirit::onShutdown()
 #else
     Input::deactivate<Mouse>();
 #endif
+    SaveController::stop();
     AudioEngine::stop();
     Application::onShutdown(); // YOU MUST END with call to parent
 }
 
+/**
+ * The method called when the application is suspended and put in the background.
+ *
+ * There is no guarantee that the application will return from the
+ * background, so any pending save is flushed to disk here.
+ */
+void LiminalSpirit::onSuspend()
+{
+    SaveController::get()->flush();
+}
+
 /**
  * The method called to update the application data.
  *
@@ -197,6 +196,27 @@ void LiminalSpirit::updateLoadingScene(float timestep)
     else
     {
         _loading.dispose(); // Permanently disables the input listeners in this mode
+#if PROFILE_LOADING
+        if (_assets->getProfiler() != nullptr) {
+            _assets->getProfiler()->exportTrace(PROFILE_LOADING_FILE);
+            CULog("%s", _assets->getProfiler()->toSummary(PROFILE_LOADING_ROWS).c_str());
+            _assets->setProfiler(nullptr);
+        }
+#endif
+#if BENCHMARK_AUDIO
+        AudioBenchmark benchmark(_assets);
+        CULog("%s", benchmark.run(BENCHMARK_AUDIO_SECONDS, AUDIO_SLOTS).c_str());
+#endif
+#if BENCHMARK_GAME
+        {
+            GameBenchmark simulation(Application::get()->getAssetDirectory());
+            std::shared_ptr<InputTrace> trace = InputTrace::allocWithFile(BENCHMARK_GAME_TRACE);
+            std::string report = simulation.run(BENCHMARK_GAME_LEVELS, BENCHMARK_GAME_STEPS,
+                                                BENCHMARK_GAME_WAVE, trace);
+            CULog("%s", report.c_str());
+            Application::get()->quit();
+        }
+#endif
         // TODO add other screens
         _home.init(_assets);
         _sound_controller = make_shared<SoundController>();
@@ -204,6 +224,15 @@ void LiminalSpirit::updateLoadingScene(float timestep)
         _home.setSoundController(_sound_controller);
         _worldSelect.init(_assets);
         _scene = State::HOME;
+#if REPLAY_INPUT
+        std::shared_ptr<InputRecording> recording = InputRecording::allocWithFile(REPLAY_INPUT_FILE);
+        if (recording != nullptr) {
+            _gameplay.init(_assets, _sound_controller, recording->getBiome(),
+                           recording->getStage(), recording->getTutorial());
+            _gameplay.replay(recording);
+            _scene = State::GAME;
+        }
+#endif
     }
 }
 
@@ -498,20 +527,16 @@ void LiminalSpirit::checkPlayerUnlocks(){
             }
             break;
     }
-    std::shared_ptr<JsonReader> reader = JsonReader::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    std::shared_ptr<JsonValue> save = reader->readJson();
-    std::shared_ptr<JsonValue> settings = save->get("settings");
-    reader->close(); 
-    _swap = settings->has("swap") ? settings->get("swap")->asInt() : 0;
-    _music = settings->has("music") ? settings->get("music")->asInt() : 10;
-    _sfx = settings->has("sfx") ? settings->get("sfx")->asInt() : 10;
 }
 
 /** Saves progress */
 void LiminalSpirit::save(){
-    std::shared_ptr<TextWriter> writer = TextWriter::alloc(Application::get()->getSaveDirectory() + "savedGame.json");
-    writer->write("{\"progress\":{\"biome\": " + to_string(_biome) + ", \"highest_level\": " + to_string(_highest_level) + ", \"unlock_count\": " + to_string(_unlock_count) + "}, \"settings\":{\"swap\": " + to_string(_swap) +", \"music\": " + to_string(_music) +", \"sfx\": " + to_string(_sfx) +"}}");
-    writer->close();
+    SaveController::Progress progress;
+    progress.biome = _biome;
+    progress.highestLevel = _highest_level;
+    progress.unlockCount = _unlock_count;
+    SaveController::get()->setProgress(progress);
+    SaveController::get()->save();
 }
 
 /**
@@ -17,10 +17,87 @@
 #include "BossScene.hpp"
 #include "LoadingScene.hpp"
 #include "SoundController.hpp"
+#include "SaveController.hpp"
 #include "HomeScene.hpp"
 #include "WorldSelectScene.hpp"
 #include "LevelSelectScene.hpp"
 #include "CreditScene.hpp"
+#include "AudioBenchmark.hpp"
+#include "GameBenchmark.hpp"
+
+/**
+ * Whether to profile asset loading at startup
+ *
+ * When enabled, the loading timeline is written to loading_trace.json in the
+ * save directory (open it in chrome://tracing or Perfetto) and a summary of
+ * the most expensive assets is logged once loading completes.
+ */
+#ifndef PROFILE_LOADING
+#define PROFILE_LOADING 0
+#endif
+/** The file name for the loading timeline */
+#define PROFILE_LOADING_FILE "loading_trace.json"
+/** The number of assets to list in the loading summary */
+#define PROFILE_LOADING_ROWS 25
+
+/**
+ * Whether to benchmark the audio graph at startup
+ *
+ * When enabled, the audio engine is briefly restarted offline once loading
+ * completes, and the real-time factor of representative music and sound
+ * effect mixes is logged.  This works on machines without audio devices.
+ */
+#ifndef BENCHMARK_AUDIO
+#define BENCHMARK_AUDIO 0
+#endif
+/** The seconds of audio to render for each benchmark scenario */
+#define BENCHMARK_AUDIO_SECONDS 10
+/** The number of audio engine slots */
+#define AUDIO_SLOTS 32
+
+/**
+ * Whether to benchmark the gameplay simulation at startup
+ *
+ * When enabled, each level in BENCHMARK_GAME_LEVELS is played once loading
+ * completes, in a headless scene (no drawing, audio or input devices) with the
+ * input scripted by BENCHMARK_GAME_TRACE.  The step time percentiles are logged
+ * and then the application quits, so that the benchmark can be run from a script.
+ */
+#ifndef BENCHMARK_GAME
+#define BENCHMARK_GAME 0
+#endif
+/**
+ * Whether main runs the gameplay benchmark instead of the application
+ *
+ * When enabled, the executable never creates a window, a GL context or an
+ * audio engine.  It runs the same benchmark as BENCHMARK_GAME and exits, so
+ * it works on machines without a GPU or audio device.  The arguments are
+ * the (absolute) asset directory, the steps per level and the start wave.
+ */
+#ifndef BENCHMARK_HEADLESS
+#define BENCHMARK_HEADLESS 0
+#endif
+/** The levels (asset keys) to benchmark */
+#define BENCHMARK_GAME_LEVELS { "cave9", "shroom9", "forest10", "BOSS" }
+/** The maximum number of fixed steps to simulate per level */
+#define BENCHMARK_GAME_STEPS 3600
+/** The wave to start each level at (later waves are the most expensive) */
+#define BENCHMARK_GAME_WAVE 0
+/** The scripted input for the benchmark (relative to the asset directory) */
+#define BENCHMARK_GAME_TRACE "json/traces/combat.json"
+
+/**
+ * Whether to replay an input recording at startup
+ *
+ * When enabled, the level of the recording in REPLAY_INPUT_FILE starts once
+ * loading completes, and plays out with the recorded input and timesteps.
+ * Recordings are made by building GameScene with RECORD_INPUT.
+ */
+#ifndef REPLAY_INPUT
+#define REPLAY_INPUT 0
+#endif
+/** The input recording to replay (relative to the save directory) */
+#define REPLAY_INPUT_FILE "input.lsr"
 
 /**
  * This class represents the application root for the ship demo.
@@ -43,15 +120,6 @@ protected:
     
     /** The amount of upgrades the player has unlocked */
     int _unlock_count;
-    
-    /** Whether or not the player's hands are swapped */
-    bool _swap;
-    
-    /** The music volume (1 to 10) */
-    int _music;
-    
-    /** The sfx volume (1 to 10) */
-    int _sfx;
 
     /**
      * The current active scene
@@ -159,6 +227,14 @@ public:
      */
     virtual void onShutdown() override;
 
+    /**
+     * The method called when the application is suspended and put in the background.
+     *
+     * The application may be terminated from the background, so this
+     * blocks until any pending save has been written.
+     */
+    virtual void onSuspend() override;
+
     /**
      * The method called to update the application data.
      *
@@ -6,6 +6,7 @@
 // 
 //
 #include "Mirror.hpp"
+#include "Random.hpp"
 
 
 EnemyProperties MIRROR_PROPS{
@@ -37,19 +38,19 @@ bool Mirror::init(const cugl::Vec2& pos, const cugl::Size& realSize, const cugl:
 		_shard1Positions[1] = cugl::Vec2(_size.width / 6, _size.height /2);
 		_shard1Positions[2] = cugl::Vec2(_size.width / 6, _size.height * 4 / 10);
 		_shard1Positions[3] = cugl::Vec2(_size.width / 6, _size.height / 2);
-		_shard1Index = rand() % 4;
+		_shard1Index = Random::get(Random::Stream::GAMEPLAY).nextInt(4);
 
 		_shard2Positions[0] = cugl::Vec2(_size.width * 7 / 8, _size.height * 4 / 6);
 		_shard2Positions[1] = cugl::Vec2(_size.width * 6 / 8, _size.height * 3 / 6);
 		_shard2Positions[2] = cugl::Vec2(_size.width * 6 / 8, _size.height * 4 / 6);
 		_shard2Positions[3] = cugl::Vec2(_size.width * 7 / 8, _size.height * 5 / 6);
-		_shard2Index = rand() % 4;
+		_shard2Index = Random::get(Random::Stream::GAMEPLAY).nextInt(4);
 
 		_shard3Positions[0] = cugl::Vec2(_size.width * 5 / 8, _size.height / 6);
 		_shard3Positions[1] = cugl::Vec2(_size.width * 6 / 8, _size.height / 6);
 		_shard3Positions[2] = cugl::Vec2(_size.width * 7 / 8, _size.height / 6);
 		_shard3Positions[3] = cugl::Vec2(_size.width * 6 / 8, _size.height / 6);
-		_shard3Index = rand() % 4;
+		_shard3Index = Random::get(Random::Stream::GAMEPLAY).nextInt(4);
 		return true;
 	}
 	return false;
@@ -61,7 +62,13 @@ void Mirror::update(float dt) {
 	if (_linkedEnemy && _linkedEnemy->getHealth() <= 0) {
 		_linkedEnemy = nullptr;
 	}
-	updateAnimations(dt);
+	if (_node != nullptr) {
+		updateAnimations(dt);
+	}
+	else if (_hurtTime > 0) {
+		// The hurt animation delays removal, even without a sprite
+		_hurtTime -= dt;
+	}
 
 }
 void Mirror::updateAnimations(float dt) {
@@ -109,7 +109,13 @@ public:
 	// sets the attack timer
 	void setAttackAnimationTimer(float value) { _attackTime = value; }
 	// set if the attack should be shown, and reset the attack frame and timer
-	void showAttack(bool value) { _showAttack = value; _attackTime = 0; _attackSprite->setFrame(0); }
+	void showAttack(bool value) {
+		_showAttack = value;
+		_attackTime = 0;
+		if (_attackSprite != nullptr) {
+			_attackSprite->setFrame(0);
+		}
+	}
 
 	//sets the attack sprite
 	void setAttackSprite(std::shared_ptr<cugl::scene2::SpriteNode> sprite) {
@@ -49,6 +49,7 @@ bool PlayerModel::init(const cugl::Vec2& pos, const cugl::Size& size, float scal
         filter.categoryBits = 0b1;
         filter.maskBits = 0b101100;
         setFilterData(filter);
+        setAlwaysUpdated(true); // Timers run in update, even at rest
         // Gameplay attributes
         _health = PLAYER_HEALTH;
         _faceRight = true;
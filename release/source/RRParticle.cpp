@@ -6,6 +6,7 @@
 //
 
 #include "RRParticle.h"
+#include "Random.hpp"
 
 using namespace cugl;
 
@@ -36,7 +37,7 @@ bool Particle::initRandomTexture(cugl::Vec2 position, float size, cugl::Vec2 gra
 	init(position, size,  gravity, speed, lifetime, angle);
 	_randomTexturing = true;
 	_numTextures = numTextures;
-	_texID = (float)rand() / (float)RAND_MAX * numTextures;
+	_texID = Random::get(Random::Stream::PARTICLES).nextFloat(0, (float)numTextures);
 	return true;
 }
 
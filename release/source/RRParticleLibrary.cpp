@@ -0,0 +1,82 @@
+//
+//  RRParticleLibrary.cpp
+//  Liminal Spirit Game
+//
+//  This module precompiles the emitter definitions in particles.json.
+//
+#include "RRParticleLibrary.h"
+
+using namespace cugl;
+
+/*
+* Reads a two element range without allocating an intermediate vector
+*/
+static Vec2 readRange(const std::shared_ptr<JsonValue>& json, const std::string& key) {
+	std::shared_ptr<JsonValue> range = json->get(key);
+	return Vec2(range->get(0)->asFloat(), range->get(1)->asFloat());
+}
+
+ParticleEmitterDef ParticleEmitterDef::parse(const std::shared_ptr<JsonValue>& json) {
+	ParticleEmitterDef def;
+	// if this is a burst particle, initialize it as such
+	if (json->get("burstParticles") != nullptr) {
+		def.burst = true;
+		def.numParticlesInBurst = json->getInt("burstParticles");
+	}
+	else {
+		def.burst = false;
+		def.numParticlesInBurst = 0;
+	}
+	def.capacity = json->getInt("maxParticleCount");
+	def.gravity = readRange(json, "gravity");
+	def.emissionRateRange = readRange(json, "emissionRateRange");
+	def.lifetimeRange = readRange(json, "lifetimeRange");
+	def.angleRange = readRange(json, "angleRange");
+	def.speedRange = readRange(json, "speedRange");
+	def.sizeRange = readRange(json, "startSizeRange");
+	def.sizeChangeRateRange = readRange(json, "sizeChangeRateRange");
+	def.maxChangeTime = json->getFloat("maxSizeChangeTime");
+
+	if (json->get("angleChangeRange") != nullptr) {
+		def.angleChangeRange = readRange(json, "angleChangeRange");
+		def.angleChange = true;
+	}
+	else {
+		def.angleChange = false;
+	}
+
+	if (json->get("fadeinRange") != nullptr) {
+		def.fadeinRange = readRange(json, "fadeinRange");
+		def.fadein = json->getBool("fadein");
+	}
+	else {
+		def.fadein = false;
+	}
+	return def;
+}
+
+bool ParticleLibrary::preload(const std::string& file) {
+	std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(file);
+	if (reader == nullptr) {
+		CULogError("Unable to open particle file %s", file.c_str());
+		return false;
+	}
+	std::shared_ptr<JsonValue> json = reader->readJson();
+	reader->close();
+	return json != nullptr && preload(json);
+}
+
+bool ParticleLibrary::preload(const std::shared_ptr<JsonValue>& json) {
+	_emitters.clear();
+	for (size_t ii = 0; ii < json->size(); ii++) {
+		std::shared_ptr<JsonValue> entry = json->get(ii);
+		_emitters.emplace(entry->key(), ParticleEmitterDef::parse(entry));
+	}
+	return true;
+}
+
+const ParticleEmitterDef& ParticleLibrary::get(const std::string& name) const {
+	auto it = _emitters.find(name);
+	CUAssertLog(it != _emitters.end(), "Unknown particle emitter %s", name.c_str());
+	return it->second;
+}
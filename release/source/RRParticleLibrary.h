@@ -0,0 +1,125 @@
+//
+//  RRParticleLibrary.h
+//  Liminal Spirit Game
+//
+//  This module precompiles the emitter definitions in particles.json. Each
+//  named entry is parsed exactly once, at asset load time, into a plain
+//  ParticleEmitterDef.  Particle pools are then initialized from that struct
+//  instead of walking the JSON tree on every burst.
+//
+//  The library is a generic asset, so it is loaded through a GenericLoader
+//  attached to the asset manager.
+//
+
+#ifndef __RR_PARTICLE_LIBRARY_H__
+#define __RR_PARTICLE_LIBRARY_H__
+#include <cugl/cugl.h>
+#include <unordered_map>
+
+/**
+* The precompiled settings for a single particle emitter
+*
+* This is a plain copy of one entry in particles.json. Optional fields that
+* are missing from the JSON are recorded with the matching flag set to false.
+*/
+struct ParticleEmitterDef {
+	// Whether or not the particle system is a temporary burst
+	bool burst;
+	// The number of particles to emit in the burst if it is a temporary burst
+	int numParticlesInBurst;
+	// The maximum number of particles in the pool
+	int capacity;
+	// The gravity effecting each particle
+	cugl::Vec2 gravity;
+	// The range of emission rate values
+	cugl::Vec2 emissionRateRange;
+	// The range of particle lifetimes
+	cugl::Vec2 lifetimeRange;
+	// The range of particle angles
+	cugl::Vec2 angleRange;
+	// The range of particle speeds
+	cugl::Vec2 speedRange;
+	// The size range of the particles in the pool
+	cugl::Vec2 sizeRange;
+	// The rates of change of the particles size in the pool
+	cugl::Vec2 sizeChangeRateRange;
+	// The max time of the size change
+	float maxChangeTime;
+	// Whether or not the particles are changing angles
+	bool angleChange;
+	// The rates of change of the particles angle in the pool
+	cugl::Vec2 angleChangeRange;
+	// Whether particle fade in is enabled or not
+	bool fadein;
+	// The range of particle fade in times
+	cugl::Vec2 fadeinRange;
+
+	/**
+	* Parses a single emitter entry from particles.json
+	*
+	* @param json  The emitter entry
+	*
+	* @return  The precompiled emitter definition
+	*/
+	static ParticleEmitterDef parse(const std::shared_ptr<cugl::JsonValue>& json);
+};
+
+/**
+* The collection of all emitter definitions in particles.json
+*
+* This class is a generic asset. Parsing happens in preload, so it is safe to
+* load it asynchronously with the rest of the game assets.
+*/
+class ParticleLibrary : public cugl::Asset {
+protected:
+	// The emitter definitions, keyed by the name of the JSON entry
+	std::unordered_map<std::string, ParticleEmitterDef> _emitters;
+
+public:
+	/**
+	* Creates an empty particle library
+	*/
+	ParticleLibrary() {}
+
+	/**
+	* Destroys a particle library
+	*/
+	~ParticleLibrary() {}
+
+	/**
+	* Creates a new particle library from the given JSON file
+	*
+	* @return  A newly allocated particle library
+	*/
+	static std::shared_ptr<ParticleLibrary> alloc(const std::string& file) {
+		std::shared_ptr<ParticleLibrary> result = std::make_shared<ParticleLibrary>();
+		return (result->init(file) ? result : nullptr);
+	}
+
+	/**
+	* Parses every emitter entry in the given JSON file
+	*
+	* @return  True if the file was parsed correctly, false otherwise
+	*/
+	virtual bool preload(const std::string& file) override;
+
+	/**
+	* Parses every emitter entry in the given JSON value
+	*
+	* @return  True if the value was parsed correctly, false otherwise
+	*/
+	virtual bool preload(const std::shared_ptr<cugl::JsonValue>& json) override;
+
+	/*
+	* Gets whether an emitter with the given name exists
+	*/
+	bool has(const std::string& name) const { return _emitters.find(name) != _emitters.end(); }
+
+	/*
+	* Gets the emitter definition with the given name
+	*/
+	const ParticleEmitterDef& get(const std::string& name) const;
+
+};
+
+#endif
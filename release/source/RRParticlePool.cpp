@@ -5,60 +5,44 @@
 // 
 //
 #include "RRParticlePool.h"
+#include "Random.hpp"
 
 using namespace cugl;
 
-float randomLerp(Vec2 range) {
-	return range.x + ((float)rand() / (float)RAND_MAX) * (range.y - range.x);
+// The number of random rolls used to create a particle
+#define PARTICLE_ROLLS 6
+
+// The random rolls for a burst (reused between bursts to avoid allocation)
+static std::vector<float> burstRolls;
+
+float rollLerp(Vec2 range, float roll) {
+	return range.x + roll * (range.y - range.x);
 }
 
 int randomIntLerp(Vec2 range) {
-	return range.x + ((float)rand() / (float)RAND_MAX) * (range.y - range.x);
+	return range.x + Random::get(Random::Stream::PARTICLES).nextFloat() * (range.y - range.x);
 }
 
 float randomRoll() {
-	return ((float)rand() / (float)RAND_MAX);
-}
-
-Vec2 floatArrayToVec(std::vector<float> arr) {
-	return Vec2(arr[0], arr[1]);
+	return Random::get(Random::Stream::PARTICLES).nextFloat();
 }
 
-void ParticlePool::init(std::shared_ptr<JsonValue> constants) {
-	// if this is a burst particle, initialize it as such
-	if (constants->get("burstParticles") != nullptr) {
-		_burst = true;
-		_numparticlesinburst = constants->getInt("burstParticles");
-	}
-	else {
-		_burst = false;
-		_numparticlesinburst = 0;
-	}
-	_capacity = constants->getInt("maxParticleCount");
-	_gravity = floatArrayToVec(constants->get("gravity")->asFloatArray());
-	_emissionRateRange = floatArrayToVec(constants->get("emissionRateRange")->asFloatArray());
-	_lifetimeRange = floatArrayToVec(constants->get("lifetimeRange")->asFloatArray());
-	_angleRange = floatArrayToVec(constants->get("angleRange")->asFloatArray());
-	_speedRange = floatArrayToVec(constants->get("speedRange")->asFloatArray());
-	_sizeRange = floatArrayToVec(constants->get("startSizeRange")->asFloatArray());
-	_sizeChangeRateRange = floatArrayToVec(constants->get("sizeChangeRateRange")->asFloatArray());
-	_maxChangeTime = constants->getFloat("maxSizeChangeTime");
-
-	if (constants->get("angleChangeRange") != nullptr) {
-		_angleChangeRange = floatArrayToVec(constants->get("angleChangeRange")->asFloatArray());
-		_angleChange = true;
-	}
-	else {
-		_angleChange = false;
-	}
-
-	if (constants->get("fadeinRange") != nullptr) {
-		_fadeinRange = floatArrayToVec(constants->get("fadeinRange")->asFloatArray());
-		_fadein = constants->getBool("fadein");
-	}
-	else {
-		_fadein = false;
-	}
+void ParticlePool::init(const ParticleEmitterDef& def) {
+	_burst = def.burst;
+	_numparticlesinburst = def.numParticlesInBurst;
+	_capacity = def.capacity;
+	_gravity = def.gravity;
+	_emissionRateRange = def.emissionRateRange;
+	_lifetimeRange = def.lifetimeRange;
+	_angleRange = def.angleRange;
+	_speedRange = def.speedRange;
+	_sizeRange = def.sizeRange;
+	_sizeChangeRateRange = def.sizeChangeRateRange;
+	_maxChangeTime = def.maxChangeTime;
+	_angleChange = def.angleChange;
+	_angleChangeRange = def.angleChangeRange;
+	_fadein = def.fadein;
+	_fadeinRange = def.fadeinRange;
 
 	_complete = false;
 	_currentEmissionRate = 0;
@@ -67,53 +51,45 @@ void ParticlePool::init(std::shared_ptr<JsonValue> constants) {
 	_numTex = 0;
 }
 
-bool ParticlePool::initPoint(std::shared_ptr<JsonValue> constants, Vec2 point) {
-	init(constants);
+bool ParticlePool::initPoint(const ParticleEmitterDef& def, Vec2 point) {
+	init(def);
 	_emissionPoint = point;
-	for (int i = 0; i < _numparticlesinburst; i++) {
-		free();
-	}
+	emitBurst();
 	return true;
 }
 
-bool ParticlePool::initPointWithOffset(std::shared_ptr<JsonValue> constants, Vec2 point, float angleoffset) {
-	init(constants);
+bool ParticlePool::initPointWithOffset(const ParticleEmitterDef& def, Vec2 point, float angleoffset) {
+	init(def);
 	_angleRange = _angleRange.add(angleoffset, angleoffset);
 	_emissionPoint = point;
-	for (int i = 0; i < _numparticlesinburst; i++) {
-		free();
-	}
+	emitBurst();
 	return true;
 }
 
-bool ParticlePool::initRandomTexture(std::shared_ptr<JsonValue> constants, Vec2 point, float angleoffset, int numTex) {
-	init(constants);
+bool ParticlePool::initRandomTexture(const ParticleEmitterDef& def, Vec2 point, float angleoffset, int numTex) {
+	init(def);
 	_angleRange = _angleRange.add(angleoffset, angleoffset);
 	_emissionPoint = point;
 	_numTex = numTex;
-	for (int i = 0; i < _numparticlesinburst; i++) {
-		free();
-	}
+	emitBurst();
 	return true;
 }
 
-bool ParticlePool::initRandomTexture(std::shared_ptr<JsonValue> constants, Vec2 point, int numTex) {
-	init(constants);
+bool ParticlePool::initRandomTexture(const ParticleEmitterDef& def, Vec2 point, int numTex) {
+	init(def);
 	_emissionPoint = point;
 	_numTex = numTex;
-	for (int i = 0; i < _numparticlesinburst; i++) {
-		free();
-	}
+	emitBurst();
 	return true;
 }
 
-void ParticlePool::newParticle() {
-	float speed = randomLerp(_speedRange);
-	float lifetime = randomLerp(_lifetimeRange);
-	float angle = randomLerp(_angleRange);
-	float size = randomLerp(_sizeRange);
-	float changeRate = randomLerp(_sizeChangeRateRange);
-	float angleChange = randomLerp(_angleChangeRange);
+void ParticlePool::newParticle(const float* rolls) {
+	float speed = rollLerp(_speedRange, rolls[0]);
+	float lifetime = rollLerp(_lifetimeRange, rolls[1]);
+	float angle = rollLerp(_angleRange, rolls[2]);
+	float size = rollLerp(_sizeRange, rolls[3]);
+	float changeRate = rollLerp(_sizeChangeRateRange, rolls[4]);
+	float angleChange = rollLerp(_angleChangeRange, rolls[5]);
 	if (_numTex > 0) {
 		std::shared_ptr<Particle> p = Particle::alloc(_emissionPoint, size, _gravity, speed, lifetime, angle, _numTex);
 		_particles.push_back(p);
@@ -125,12 +101,27 @@ void ParticlePool::newParticle() {
 }
 
 void ParticlePool::free() {
+	float rolls[PARTICLE_ROLLS];
+	Random::get(Random::Stream::PARTICLES).fill(rolls, PARTICLE_ROLLS);
+	free(rolls);
+}
+
+void ParticlePool::free(const float* rolls) {
 	if (_particles.size() < _capacity) {
-		newParticle();
+		newParticle(rolls);
 	}
 	else {
 		_particles.erase(_particles.begin());
-		newParticle();
+		newParticle(rolls);
+	}
+}
+
+void ParticlePool::emitBurst() {
+	// Roll the whole burst at once instead of particle by particle
+	burstRolls.resize(_numparticlesinburst * PARTICLE_ROLLS);
+	Random::get(Random::Stream::PARTICLES).fill(burstRolls.data(), burstRolls.size());
+	for (int i = 0; i < _numparticlesinburst; i++) {
+		free(&burstRolls[i * PARTICLE_ROLLS]);
 	}
 }
 
@@ -8,6 +8,7 @@
 #ifndef __NL_PARTICLE_POOL_H__
 #define __NL_PARTICLE_POOL_H__
 #include "RRParticle.h"
+#include "RRParticleLibrary.h"
 #include <cmath>
 
 class ParticlePool {
@@ -66,18 +67,28 @@ protected:
 	cugl::Vec2 _emissionPoint;
 
 	/*
-	* Creates a new particle
+	* Creates a new particle from the given random rolls in [0,1) (one each for speed, lifetime, angle, size, size change rate and angle change)
 	*/
-	void newParticle();
+	void newParticle(const float* rolls);
 
 	/*
 	* Creates a new particle and adds it to the pool if there is free space, otherwise remove the oldest particle and add a new one to the pool.
 	*/
 	void free();
 
+	/*
+	* Like free(), but creates the particle from the given random rolls (see newParticle)
+	*/
+	void free(const float* rolls);
+
+	/*
+	* Emits all of the particles in the burst, generating their random rolls at once
+	*/
+	void emitBurst();
+
 	/* Initializes the global constants that are shared between all ParticlePool modes
 	*/
-	void init(std::shared_ptr<cugl::JsonValue> constants);
+	void init(const ParticleEmitterDef& def);
 
 
 public:
@@ -97,9 +108,9 @@ public:
 	*
 	* @return  A newly allocated particle pool
 	*/
-	static std::shared_ptr<ParticlePool> allocPoint(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point) {
+	static std::shared_ptr<ParticlePool> allocPoint(const ParticleEmitterDef& def, cugl::Vec2 point) {
 		std::shared_ptr<ParticlePool> result = std::make_shared<ParticlePool>();
-		return (result->initPoint(constants, point) ? result : nullptr);
+		return (result->initPoint(def, point) ? result : nullptr);
 	}
 
 	/**
@@ -108,9 +119,9 @@ public:
 	*
 	* @return  A newly allocated particle pool
 	*/
-	static std::shared_ptr<ParticlePool> allocPoint(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, int numTex) {
+	static std::shared_ptr<ParticlePool> allocPoint(const ParticleEmitterDef& def, cugl::Vec2 point, int numTex) {
 		std::shared_ptr<ParticlePool> result = std::make_shared<ParticlePool>();
-		return (result->initRandomTexture(constants, point, numTex) ? result : nullptr);
+		return (result->initRandomTexture(def, point, numTex) ? result : nullptr);
 	}
 
 	/**
@@ -119,9 +130,9 @@ public:
 	*
 	* @return  A newly allocated particle pool
 	*/
-	static std::shared_ptr<ParticlePool> allocPointWithOffset(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, float angleoffset) {
+	static std::shared_ptr<ParticlePool> allocPointWithOffset(const ParticleEmitterDef& def, cugl::Vec2 point, float angleoffset) {
 		std::shared_ptr<ParticlePool> result = std::make_shared<ParticlePool>();
-		return (result->initPointWithOffset(constants, point, angleoffset) ? result : nullptr);
+		return (result->initPointWithOffset(def, point, angleoffset) ? result : nullptr);
 	}
 
 	/**
@@ -130,9 +141,9 @@ public:
 	*
 	* @return  A newly allocated particle pool
 	*/
-	static std::shared_ptr<ParticlePool> allocPointWithOffset(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, float angleoffset, int numTex) {
+	static std::shared_ptr<ParticlePool> allocPointWithOffset(const ParticleEmitterDef& def, cugl::Vec2 point, float angleoffset, int numTex) {
 		std::shared_ptr<ParticlePool> result = std::make_shared<ParticlePool>();
-		return (result->initRandomTexture(constants, point, angleoffset, numTex) ? result : nullptr);
+		return (result->initRandomTexture(def, point, angleoffset, numTex) ? result : nullptr);
 	}
 
 	/**
@@ -141,7 +152,7 @@ public:
 	*
 	* @return  True if initialized correctly, false otherwise
 	*/
-	bool initPoint(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point);
+	bool initPoint(const ParticleEmitterDef& def, cugl::Vec2 point);
 
 	/**
 	* Creates a new particle pool using a point emitter
@@ -149,7 +160,7 @@ public:
 	*
 	* @return  True if initialized correctly, false otherwise
 	*/
-	bool initPointWithOffset(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, float angleoffset);
+	bool initPointWithOffset(const ParticleEmitterDef& def, cugl::Vec2 point, float angleoffset);
 
 	/**
 	* Creates a new particle pool using a point emitter
@@ -157,7 +168,7 @@ public:
 	*	
 	* @return  True if initialized correctly, false otherwise
 	*/
-	bool initRandomTexture(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, float angleoffset, int numTex);
+	bool initRandomTexture(const ParticleEmitterDef& def, cugl::Vec2 point, float angleoffset, int numTex);
 
 	/**
 	* Creates a new particle pool using a point emitter
@@ -165,7 +176,7 @@ public:
 	*
 	* @return  True if initialized correctly, false otherwise
 	*/
-	bool initRandomTexture(std::shared_ptr<cugl::JsonValue> constants, cugl::Vec2 point, int numTex);
+	bool initRandomTexture(const ParticleEmitterDef& def, cugl::Vec2 point, int numTex);
 
 	/*
 	* Gets the maximum lifetime of a particle
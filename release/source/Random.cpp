@@ -0,0 +1,88 @@
+//
+//  Random.cpp
+//  Liminal Spirit Game
+//
+//  This class is a small, fast pseudo-random number generator (PCG32) to
+//  replace rand(). See the header for details.
+//
+#include "Random.hpp"
+
+using namespace cugl;
+
+/** The generator of each system */
+Random Random::_streams[(int)Random::Stream::COUNT] = {
+    Random(RANDOM_DEFAULT_SEED, (Uint64)Random::Stream::GAMEPLAY),
+    Random(RANDOM_DEFAULT_SEED, (Uint64)Random::Stream::AI),
+    Random(RANDOM_DEFAULT_SEED, (Uint64)Random::Stream::PARTICLES),
+    Random(RANDOM_DEFAULT_SEED, (Uint64)Random::Stream::AUDIO)
+};
+
+/**
+ * Reseeds this generator with the given seed and stream
+ *
+ * Generators with the same seed and different streams produce
+ * independent sequences.
+ *
+ * @param seed      The random seed
+ * @param stream    The stream identifier
+ */
+void Random::seed(Uint64 seed, Uint64 stream) {
+    _state = 0;
+    _inc = (stream << 1u) | 1u;
+    next();
+    _state += seed;
+    next();
+}
+
+/**
+ * Fills the buffer with random floats in [0,1)
+ *
+ * This is faster than calling {@link #nextFloat} for each value, and
+ * is intended for bursts of particles.
+ *
+ * @param buffer    The buffer to fill
+ * @param count     The number of floats to generate
+ */
+void Random::fill(float* buffer, size_t count) {
+    // Keep the state in a local so that it stays in a register
+    Uint64 state = _state;
+    const Uint64 inc = _inc;
+    for(size_t ii = 0; ii < count; ii++) {
+        Uint64 old = state;
+        state = old*6364136223846793005ULL+inc;
+        Uint32 shifted = (Uint32)(((old >> 18u) ^ old) >> 27u);
+        Uint32 rot = (Uint32)(old >> 59u);
+        Uint32 bits = (shifted >> rot) | (shifted << ((-rot) & 31));
+        buffer[ii] = (bits >> 8)*(1.0f/16777216.0f);
+    }
+    _state = state;
+}
+
+/**
+ * Fills the buffer with random floats in [min,max)
+ *
+ * @param buffer    The buffer to fill
+ * @param count     The number of floats to generate
+ * @param min       The minimum value
+ * @param max       The maximum value
+ */
+void Random::fill(float* buffer, size_t count, float min, float max) {
+    fill(buffer, count);
+    float range = max-min;
+    for(size_t ii = 0; ii < count; ii++) {
+        buffer[ii] = min+buffer[ii]*range;
+    }
+}
+
+/**
+ * Reseeds the generators of every system with the same seed
+ *
+ * Each system still has an independent sequence.
+ *
+ * @param seed      The random seed
+ */
+void Random::seedAll(Uint64 seed) {
+    for(int ii = 0; ii < (int)Stream::COUNT; ii++) {
+        _streams[ii].seed(seed, (Uint64)ii);
+    }
+}
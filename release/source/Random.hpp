@@ -0,0 +1,178 @@
+//
+//  Random.hpp
+//  Liminal Spirit Game
+//
+//  This class is a small, fast pseudo-random number generator (PCG32) to
+//  replace rand().  Unlike rand(), it takes no lock, and its state can be
+//  reseeded for a recording or a benchmark so that a level always plays out
+//  the same way.
+//
+//  The game has one generator per system (a stream).  The streams share a
+//  seed but produce independent sequences, so that a system drawing more or
+//  fewer numbers (such as particles at a different frame rate) does not
+//  change the numbers drawn by the others.
+//
+#ifndef __RANDOM_HPP__
+#define __RANDOM_HPP__
+#include <cugl/cugl.h>
+
+/** The default seed for every stream (used until the streams are reseeded) */
+#define RANDOM_DEFAULT_SEED 0x853C49E6748FEA9BULL
+
+class Random {
+public:
+    /** The systems with their own random stream */
+    enum class Stream : int {
+        /** Spawning, enemy properties, corpses and attacks */
+        GAMEPLAY = 0,
+        /** Enemy movement targets */
+        AI = 1,
+        /** Particle emission (cosmetic only) */
+        PARTICLES = 2,
+        /** Music track choice */
+        AUDIO = 3,
+        /** The number of streams */
+        COUNT = 4
+    };
+
+protected:
+    /** The generator state */
+    Uint64 _state;
+    /** The stream increment (always odd) */
+    Uint64 _inc;
+
+public:
+    /**
+     * Creates a generator with the default seed
+     */
+    Random() { seed(RANDOM_DEFAULT_SEED, 0); }
+
+    /**
+     * Creates a generator with the given seed and stream
+     *
+     * @param seed      The random seed
+     * @param stream    The stream identifier
+     */
+    Random(Uint64 seed, Uint64 stream) { this->seed(seed, stream); }
+
+    /**
+     * Reseeds this generator with the given seed and stream
+     *
+     * Generators with the same seed and different streams produce
+     * independent sequences.
+     *
+     * @param seed      The random seed
+     * @param stream    The stream identifier
+     */
+    void seed(Uint64 seed, Uint64 stream);
+
+#pragma mark Generation
+    /**
+     * Returns the next 32 random bits
+     *
+     * @return the next 32 random bits
+     */
+    Uint32 next() {
+        Uint64 old = _state;
+        _state = old*6364136223846793005ULL+_inc;
+        Uint32 shifted = (Uint32)(((old >> 18u) ^ old) >> 27u);
+        Uint32 rot = (Uint32)(old >> 59u);
+        return (shifted >> rot) | (shifted << ((-rot) & 31));
+    }
+
+    /**
+     * Returns a random float in [0,1)
+     *
+     * @return a random float in [0,1)
+     */
+    float nextFloat() {
+        return (next() >> 8)*(1.0f/16777216.0f);
+    }
+
+    /**
+     * Returns a random float in [min,max)
+     *
+     * @param min   The minimum value
+     * @param max   The maximum value
+     *
+     * @return a random float in [min,max)
+     */
+    float nextFloat(float min, float max) {
+        return min+nextFloat()*(max-min);
+    }
+
+    /**
+     * Returns a random integer in [0,bound)
+     *
+     * This uses a multiply and shift instead of a modulus, so it is both
+     * faster and less biased than rand() % bound.
+     *
+     * @param bound The (positive) exclusive upper bound
+     *
+     * @return a random integer in [0,bound)
+     */
+    int nextInt(int bound) {
+        return (int)(((Uint64)next()*(Uint32)bound) >> 32);
+    }
+
+    /**
+     * Fills the buffer with random floats in [0,1)
+     *
+     * This is faster than calling {@link #nextFloat} for each value, and
+     * is intended for bursts of particles.
+     *
+     * @param buffer    The buffer to fill
+     * @param count     The number of floats to generate
+     */
+    void fill(float* buffer, size_t count);
+
+    /**
+     * Fills the buffer with random floats in [min,max)
+     *
+     * @param buffer    The buffer to fill
+     * @param count     The number of floats to generate
+     * @param min       The minimum value
+     * @param max       The maximum value
+     */
+    void fill(float* buffer, size_t count, float min, float max);
+
+#pragma mark Streams
+    /**
+     * Returns the generator for the given system
+     *
+     * The generators are not thread-safe.  They should only be used from
+     * the main (update) thread.
+     *
+     * @param stream    The system stream
+     *
+     * @return the generator for the given system
+     */
+    static Random& get(Stream stream) {
+        return _streams[(int)stream];
+    }
+
+    /**
+     * Reseeds the generator for the given system
+     *
+     * @param stream    The system stream
+     * @param seed      The random seed
+     */
+    static void seed(Stream stream, Uint64 seed) {
+        _streams[(int)stream].seed(seed, (Uint64)stream);
+    }
+
+    /**
+     * Reseeds the generators of every system with the same seed
+     *
+     * Each system still has an independent sequence.
+     *
+     * @param seed      The random seed
+     */
+    static void seedAll(Uint64 seed);
+
+private:
+    /** The generator of each system */
+    static Random _streams[(int)Stream::COUNT];
+};
+
+#endif /* __RANDOM_HPP__ */
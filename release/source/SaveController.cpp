@@ -0,0 +1,202 @@
+//
+//  SaveController.cpp
+//  Liminal Spirit Game
+//
+//  This class owns the saved game and writes it on a background thread.
+//
+#include "SaveController.hpp"
+#include <cstdio>
+
+#if defined (__WINDOWS__)
+    #include <windows.h>
+    #include <locale>
+    #include <codecvt>
+#endif
+
+using namespace cugl;
+
+/** The suffix of the temporary file used for atomic replacement */
+#define SAVE_TEMP_SUFFIX ".tmp"
+
+/** The singleton save controller */
+SaveController* SaveController::_gController = nullptr;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Initializes the save controller, reading the save file if it exists
+ *
+ * Missing or malformed entries fall back to the default values, exactly as
+ * a fresh install would see them.
+ *
+ * @return true if the controller was initialized correctly
+ */
+bool SaveController::init() {
+    _path = Application::get()->getSaveDirectory() + SAVE_FILE;
+    _progress = { 1, 1, 0 };
+    _settings = { false, 10, 10 };
+
+    if (filetool::file_exists(_path)) {
+        try {
+            std::shared_ptr<JsonReader> reader = JsonReader::alloc(_path);
+            std::shared_ptr<JsonValue> save = reader->readJson();
+            reader->close();
+            std::shared_ptr<JsonValue> progress = save->get("progress");
+            std::shared_ptr<JsonValue> settings = save->get("settings");
+            if (progress != nullptr) {
+                _progress.biome = progress->getInt("biome", 1);
+                _progress.highestLevel = progress->getInt("highest_level", 1);
+                _progress.unlockCount = progress->getInt("unlock_count", 0);
+            }
+            if (settings != nullptr) {
+                _settings.swap = settings->getInt("swap", 0);
+                _settings.music = settings->getInt("music", 10);
+                _settings.sfx = settings->getInt("sfx", 10);
+            }
+        } catch (...) {
+            CULogError("Unable to read %s, using defaults", _path.c_str());
+            _progress = { 1, 1, 0 };
+            _settings = { false, 10, 10 };
+        }
+    }
+
+    _writer = ThreadPool::alloc(1);
+    if (_writer == nullptr) {
+        CULogError("Unable to start the save thread, saving synchronously");
+    }
+    return true;
+}
+
+/**
+ * Releases the worker thread, flushing any pending save first
+ */
+void SaveController::dispose() {
+    if (_writer != nullptr) {
+        flush();
+        _writer->dispose();
+        _writer = nullptr;
+    }
+}
+
+/**
+ * Starts the singleton save controller
+ *
+ * If the worker thread cannot be created, the controller still starts, but
+ * saves are written synchronously on the calling thread.
+ *
+ * @return true if the controller was started successfully
+ */
+bool SaveController::start() {
+    if (_gController != nullptr) {
+        return false;
+    }
+    _gController = new SaveController();
+    if (!_gController->init()) {
+        delete _gController;
+        _gController = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Stops the singleton save controller, flushing any pending writes
+ */
+void SaveController::stop() {
+    if (_gController == nullptr) {
+        return;
+    }
+    _gController->dispose();
+    delete _gController;
+    _gController = nullptr;
+}
+
+#pragma mark -
+#pragma mark Saving
+/**
+ * Returns the save state as a JSON string
+ */
+std::string SaveController::serialize() const {
+    return "{\"progress\":{\"biome\": " + std::to_string(_progress.biome) +
+           ", \"highest_level\": " + std::to_string(_progress.highestLevel) +
+           ", \"unlock_count\": " + std::to_string(_progress.unlockCount) +
+           "}, \"settings\":{\"swap\": " + std::to_string(_settings.swap) +
+           ", \"music\": " + std::to_string(_settings.music) +
+           ", \"sfx\": " + std::to_string(_settings.sfx) + "}}";
+}
+
+/**
+ * Schedules the current state to be written to disk
+ *
+ * Only the latest snapshot is kept. If the worker is already busy, it will
+ * pick this snapshot up when it finishes its current write. If there is no
+ * worker, the snapshot is written immediately.
+ */
+void SaveController::save() {
+    std::string snapshot = serialize();
+    if (_writer == nullptr) {
+        if (!writeAtomic(snapshot)) {
+            CULogError("Unable to write %s", _path.c_str());
+        }
+        return;
+    }
+    std::unique_lock<std::mutex> lk(_mutex);
+    _pending = std::move(snapshot);
+    _dirty = true;
+    if (!_scheduled) {
+        _scheduled = true;
+        _writer->addTask([this](void) { this->drain(); });
+    }
+}
+
+/**
+ * Blocks until every scheduled save has been written to disk
+ */
+void SaveController::flush() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _flushed.wait(lk, [this] { return !_scheduled; });
+}
+
+/**
+ * Drains pending snapshots to disk. Runs on the worker thread.
+ */
+void SaveController::drain() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    while (_dirty) {
+        std::string contents = std::move(_pending);
+        _dirty = false;
+        lk.unlock();
+        if (!writeAtomic(contents)) {
+            CULogError("Unable to write %s", _path.c_str());
+        }
+        lk.lock();
+    }
+    _scheduled = false;
+    _flushed.notify_all();
+}
+
+/**
+ * Writes the contents to the save file via a temporary file and rename
+ *
+ * @return true if the file was replaced successfully
+ */
+bool SaveController::writeAtomic(const std::string& contents) const {
+    std::string temp = _path + SAVE_TEMP_SUFFIX;
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(temp);
+    if (writer == nullptr) {
+        return false;
+    }
+    writer->write(contents);
+    writer->close();
+
+#if defined (__WINDOWS__)
+    // std::rename will not replace an existing file on Windows
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    std::wstring source = converter.from_bytes(temp);
+    std::wstring target = converter.from_bytes(_path);
+    return MoveFileExW(source.c_str(), target.c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(temp.c_str(), _path.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,158 @@
+//
+//  SaveController.hpp
+//  Liminal Spirit Game
+//
+//  This class owns the saved game. The save file is parsed once at startup
+//  and kept in memory, so scenes read progress and settings from here rather
+//  than re-reading savedGame.json on every init.
+//
+//  Writes are coalesced and performed on a background thread. Each call to
+//  save() serializes the current state, but only the most recent snapshot is
+//  ever written. The file is replaced atomically by writing to a temporary
+//  file and renaming it over the old one, so a crash mid-write cannot corrupt
+//  the save.
+//
+//  Like AudioEngine, this is a singleton that must be started before use.
+//
+
+#ifndef __SAVE_CONTROLLER_HPP__
+#define __SAVE_CONTROLLER_HPP__
+#include <cugl/cugl.h>
+#include <condition_variable>
+#include <mutex>
+
+/** The name of the save file in the save directory */
+#define SAVE_FILE "savedGame.json"
+
+class SaveController {
+public:
+    /** The player progression in the save file */
+    struct Progress {
+        /** The highest unlocked biome */
+        int biome;
+        /** The highest unlocked level in that biome */
+        int highestLevel;
+        /** The number of unlocked abilities */
+        int unlockCount;
+    };
+
+    /** The player options in the save file */
+    struct Settings {
+        /** Whether the attack hands are swapped */
+        bool swap;
+        /** The music volume (0-10) */
+        int music;
+        /** The sound effect volume (0-10) */
+        int sfx;
+    };
+
+protected:
+    /** The singleton save controller */
+    static SaveController* _gController;
+
+    /** The full path to the save file */
+    std::string _path;
+    /** The in-memory player progression */
+    Progress _progress;
+    /** The in-memory player options */
+    Settings _settings;
+
+    /** The single worker thread that performs file writes */
+    std::shared_ptr<cugl::ThreadPool> _writer;
+    /** Mutex guarding the pending snapshot and the writer state */
+    std::mutex _mutex;
+    /** Signalled whenever the writer finishes a flush */
+    std::condition_variable _flushed;
+    /** The most recent serialized snapshot not yet written */
+    std::string _pending;
+    /** Whether _pending holds a snapshot that must be written */
+    bool _dirty;
+    /** Whether a write task is queued or running on the worker */
+    bool _scheduled;
+
+    /**
+     * Creates an inactive save controller
+     */
+    SaveController() : _dirty(false), _scheduled(false) {}
+
+    /**
+     * Initializes the save controller, reading the save file if it exists
+     *
+     * @return true if the controller was initialized correctly
+     */
+    bool init();
+
+    /**
+     * Releases the worker thread, flushing any pending save first
+     */
+    void dispose();
+
+    /**
+     * Returns the save state as a JSON string
+     */
+    std::string serialize() const;
+
+    /**
+     * Drains pending snapshots to disk. Runs on the worker thread.
+     */
+    void drain();
+
+    /**
+     * Writes the contents to the save file via a temporary file and rename
+     *
+     * @return true if the file was replaced successfully
+     */
+    bool writeAtomic(const std::string& contents) const;
+
+public:
+    /**
+     * Starts the singleton save controller
+     *
+     * This reads the save file (creating a default one if necessary). It
+     * should be called once at application startup. If the worker thread
+     * cannot be created, saves are written synchronously instead.
+     *
+     * @return true if the controller was started successfully
+     */
+    static bool start();
+
+    /**
+     * Stops the singleton save controller, flushing any pending writes
+     */
+    static void stop();
+
+    /**
+     * Returns the singleton save controller, or nullptr if not started
+     */
+    static SaveController* get() { return _gController; }
+
+    /** Returns the in-memory player progression */
+    const Progress& getProgress() const { return _progress; }
+
+    /** Sets the in-memory player progression. Call save() to persist it. */
+    void setProgress(const Progress& progress) { _progress = progress; }
+
+    /** Returns the in-memory player options */
+    const Settings& getSettings() const { return _settings; }
+
+    /** Sets the in-memory player options. Call save() to persist it. */
+    void setSettings(const Settings& settings) { _settings = settings; }
+
+    /**
+     * Schedules the current state to be written to disk
+     *
+     * This method never touches the file system on the calling thread, unless
+     * the worker thread failed to start. If a write is already pending, the
+     * new snapshot simply replaces it.
+     */
+    void save();
+
+    /**
+     * Blocks until every scheduled save has been written to disk
+     *
+     * Call this when the application may be terminated, such as on suspend.
+     */
+    void flush();
+};
+
+#endif /* __SAVE_CONTROLLER_HPP__ */
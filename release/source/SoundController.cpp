@@ -10,117 +10,90 @@
 #define FADE 1.5
 #define MAX_LAYER_VOLUME 0.3
 
+// Voice priorities. When every slot is busy, a sound effect may only steal
+// the slot of a voice with an equal or lower priority.
+#define ENEMY_SFX_PRIORITY  0
+#define PLAYER_SFX_PRIORITY 1
+#define DEATH_SFX_PRIORITY  2
+
 #include "SoundController.hpp"
+#include "Random.hpp"
+
+/** The maximum volume of each enemy layer, relative to MAX_LAYER_VOLUME */
+static const float LAYER_VOLUME[SoundController::layerCount] = {1.3f, 1.1f, 0.4f, 1.1f, 1.1f};
 
-SoundController::LevelMusic::LevelMusic() {};
+SoundController::LevelMusic::LevelMusic() :
+_level(LOAD),
+_layers(0) {};
 
 /**
- * Initializes the level music class with the name and assets. Also creates the mixer and attaches the audio assets to the mixer.
+ * Initializes the level music class with the name and assets. Also creates the stem mixer and attaches the audio assets to it.
  * @param biome     The name of the biome along with a number representing which track it is
  * @param assets   The Asset manager to get the appropriate sound files
  */
 void SoundController::LevelMusic::init(string biome, std::shared_ptr<cugl::AssetManager> &assets) {
     _biome = biome;
-    _themeAsset = assets->get<cugl::Sound>(biome);
-    
-    _glutton = assets->get<cugl::Sound>(biome + "Glutton");
-    _glutton->setVolume(0.0);
-    _gNode = _glutton->createNode();
-    
-    _phantom = assets->get<cugl::Sound>(biome + "Phantom");
-    _phantom->setVolume(0.0);
-    _pNode = _phantom->createNode();
     
-    _mirror = assets->get<cugl::Sound>(biome + "Mirror");
-    _mirror->setVolume(0.0);
-    _mNode = _mirror->createNode();
-    
-    _spawner = assets->get<cugl::Sound>(biome + "Spawner");
-    _spawner->setVolume(0.0);
-    _spNode = _spawner->createNode();
-    
-    _seeker = assets->get<cugl::Sound>(biome + "Seeker");
-    _seeker->setVolume(0.0);
-    _sNode = _seeker->createNode();
+    string b = biome;
+    b.pop_back();
+    if (b == "cave") {
+        _level = LEVEL_CAVE;
+    } else if (b == "mushroom") {
+        _level = LEVEL_SHROOM;
+    } else {
+        _level = LEVEL_FOREST;
+    }
     
-    _mixer = cugl::audio::AudioMixer::alloc(6);
+    // The stem order must match the layer enum, with the theme last
+    std::vector<std::shared_ptr<cugl::audio::AudioNode>> stems;
+    stems.push_back(assets->get<cugl::Sound>(biome + "Glutton")->createNode());
+    stems.push_back(assets->get<cugl::Sound>(biome + "Phantom")->createNode());
+    stems.push_back(assets->get<cugl::Sound>(biome + "Mirror")->createNode());
+    stems.push_back(assets->get<cugl::Sound>(biome + "Spawner")->createNode());
+    stems.push_back(assets->get<cugl::Sound>(biome + "Seeker")->createNode());
+    stems.push_back(assets->get<cugl::Sound>(biome)->createNode());
+    for(auto it = stems.begin(); it != stems.end()-1; ++it) {
+        (*it)->setGain(1.0f);
+    }
     
-    _mixer->attach(5, _themeAsset->createNode());
-    _mixer->attach(0, _gNode);
-    _mixer->attach(1, _pNode);
-    _mixer->attach(2, _mNode);
-    _mixer->attach(3, _spNode);
-    _mixer->attach(4, _sNode);
+    _stems = cugl::audio::AudioStems::alloc(stems);
+    _stems->setTargets(std::vector<float>(layerCount, 0.0f), 0);
+    _layers = 0;
 };
 
 /**
  * Plays the music for the specified level class.
+ *
+ * The layer targets are only sent to the audio thread when the
+ * mask changes, so this is cheap to call every frame.
+ *
+ * @param layers    The mask of the enemy layers to play
+ * @param s         The current game state
  */
-void SoundController::LevelMusic::play_music(std::vector<bool> e, GameState s) {
-    
-    string b = _biome;
-    b.pop_back();
-    
-    
-    if ((s != LEVEL_CAVE && b == "cave")  ||  (s != LEVEL_SHROOM && b == "mushroom") || (s != LEVEL_FOREST && b == "forest")) {
+void SoundController::LevelMusic::play_music(Uint8 layers, GameState s) {
+    if (s != _level) {
         cugl::AudioEngine::get()->getMusicQueue()->clear(0.1);
-        cugl::AudioEngine::get()->getMusicQueue()->enqueue(_mixer, true, 0.4);
-        
-        
+        cugl::AudioEngine::get()->getMusicQueue()->enqueue(_stems, true, 0.4);
     }
     
-    for (int i = 0; i < 7; i++) {
-        switch (i) {
-            case 0:
-                if (e[0]) {
-                    _gNode->setGain(clampf(_gNode->getGain() + (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.3f));
-                } else {
-                    _gNode->setGain(clampf(_gNode->getGain() - (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.3f));
-                }
-                break;
-            case 1:
-                if (e[1]) {
-                    _pNode->setGain(clampf(_pNode->getGain() + (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                } else {
-                    _pNode->setGain(clampf(_pNode->getGain() - (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                }
-                break;
-            case 2:
-                if (e[2]) {
-                    _mNode->setGain(clampf(_mNode->getGain() + (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 0.4f));
-                } else {
-                    _mNode->setGain(clampf(_mNode->getGain() - (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 0.4f));
-                }
-            case 3:
-                if (e[3]) {
-                    _spNode->setGain(clampf(_spNode->getGain() + (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                } else {
-                    _spNode->setGain(clampf(_spNode->getGain() - (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                }
-            case 4:
-                if (e[4]) {
-                    _sNode->setGain(clampf(_sNode->getGain() + (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                } else {
-                    _sNode->setGain(clampf(_sNode->getGain() - (MAX_LAYER_VOLUME / (FADE * 60.0f)), 0.0f, MAX_LAYER_VOLUME * 1.1f));
-                }
-            default:
-                break;
+    if (layers != _layers) {
+        _layers = layers;
+        std::vector<float> gains(layerCount);
+        for (int i = 0; i < layerCount; i++) {
+            gains[i] = (layers & (1 << i)) ? MAX_LAYER_VOLUME * LAYER_VOLUME[i] : 0.0f;
         }
+        _stems->setTargets(gains, FADE);
     }
-    
-    
 };
 
 void SoundController::LevelMusic::reset_mix() {
-    _mixer->reset();
-    _gNode->setGain(0.0f);
-    _pNode->setGain(0.0f);
-    _mNode->setGain(0.0f);
-    _spNode->setGain(0.0f);
-    _sNode->setGain(0.0f);
+    _stems->reset();
+    _stems->setTargets(std::vector<float>(layerCount, 0.0f), 0);
+    _layers = 0;
 }
 
-SoundController::EnemySFX::EnemySFX() {};
+SoundController::EnemySFX::EnemySFX() :
+_hurtVoice(cugl::AudioEngine::NO_VOICE) {};
 
 void SoundController::EnemySFX::init(string enemy, std::shared_ptr<cugl::AssetManager> &assets) {
     _enemy = enemy;
@@ -133,10 +106,13 @@ void SoundController::EnemySFX::init(string enemy, std::shared_ptr<cugl::AssetMa
 void SoundController::EnemySFX::play_sound(etype t, float vol) {
     switch (t) {
         case attack:
-            cugl::AudioEngine::get()->play(_enemy + "Attack", _attack, false, vol, true);
+            cugl::AudioEngine::get()->playVoice(_attack, ENEMY_SFX_PRIORITY, vol);
             break;
         case ehurt:
-            cugl::AudioEngine::get()->play(_enemy+ "hurt", _hurt, false, vol, false);
+            // Only one hurt sound per enemy type at a time
+            if (!cugl::AudioEngine::get()->isVoiceActive(_hurtVoice)) {
+                _hurtVoice = cugl::AudioEngine::get()->playVoice(_hurt, ENEMY_SFX_PRIORITY, vol);
+            }
             break;
     }
 }
@@ -222,6 +198,10 @@ void SoundController::init(std::shared_ptr<cugl::AssetManager> &assets) {
 };
 
 void SoundController::play_menu_music() {
+    // An uninitialized controller is silent (as in a headless simulation)
+    if (_assets == nullptr) {
+        return;
+    }
     
     cugl::AudioEngine::get()->getMusicQueue()->setVolume(_volume);
     
@@ -235,37 +215,40 @@ void SoundController::play_menu_music() {
     
 }
 
-void SoundController::play_level_music(string biome, std::vector<bool> enemies) {
+void SoundController::play_level_music(const string& biome, Uint8 layers) {
+    if (_assets == nullptr) {
+        return;
+    }
     
     cugl::AudioEngine::get()->getMusicQueue()->setVolume(_volume);
     
     if (biome == "cave") {
         if (_state != LEVEL_CAVE) {
-            _track = rand()%2;
+            _track = Random::get(Random::Stream::AUDIO).nextInt(2);
             reset_level_tracks();
         }
         switch (_track) {
             case 0:
-                _cave1->play_music(enemies, _state);
+                _cave1->play_music(layers, _state);
                 _state = LEVEL_CAVE;
                 break;
             case 1:
-                _cave2->play_music(enemies, _state);
+                _cave2->play_music(layers, _state);
                 _state = LEVEL_CAVE;
                 break;
         }
     } else if (biome == "shroom") {
         if (_state != LEVEL_SHROOM) {
-            _track = rand()%2;
+            _track = Random::get(Random::Stream::AUDIO).nextInt(2);
             reset_level_tracks();
         }
         switch (_track) {
             case 0:
-                _mushroom1->play_music(enemies, _state);
+                _mushroom1->play_music(layers, _state);
                 _state = LEVEL_SHROOM;
                 break;
             case 1:
-                _mushroom2->play_music(enemies, _state);
+                _mushroom2->play_music(layers, _state);
                 _state = LEVEL_SHROOM;
                 break;
         }
@@ -275,7 +258,7 @@ void SoundController::play_level_music(string biome, std::vector<bool> enemies)
         if (_state != LEVEL_FOREST) {
             reset_level_tracks();
         }
-            _forest1->play_music(enemies, _state);
+            _forest1->play_music(layers, _state);
             _state = LEVEL_FOREST;
     }
     
@@ -285,46 +268,49 @@ void SoundController::play_level_music(string biome, std::vector<bool> enemies)
 };
 
 void SoundController::play_player_sound(playerSType sound) {
+    if (_assets == nullptr) {
+        return;
+    }
     switch (sound) {
         case slashEmpty:
-            cugl::AudioEngine::get()->play("playerSlashEmpty", _playerSlashEmpty, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerSlashEmpty, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case slashHit:
-            cugl::AudioEngine::get()->play("playerSlashHit", _playerSlashHit, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerSlashHit, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case slashDash:
-            cugl::AudioEngine::get()->play("playerSDash", _playerDash, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerDash, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case slashDashHit:
-            cugl::AudioEngine::get()->play("playerDashHit", _playerDashHit, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerDashHit, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case shoot:
-            cugl::AudioEngine::get()->play("playerShoot", _playerShoot, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerShoot, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case shootHit:
-            cugl::AudioEngine::get()->play("playerShootHit", _playerShootHit, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerShootHit, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case shootCharge:
-            cugl::AudioEngine::get()->play("playerChargeShoot", _playerExpPckg, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerExpPckg, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case explosion:
-            cugl::AudioEngine::get()->play("playerExp", _playerExp, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerExp, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case hurt:
-            cugl::AudioEngine::get()->play("playerShoot", _playerHurt, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerHurt, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case death:
         case step:
-            cugl::AudioEngine::get()->play("playerStep", _playerStep, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerStep, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case jump:
-            cugl::AudioEngine::get()->play("playerJump", _playerJump, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerJump, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case jumpAttack:
-            cugl::AudioEngine::get()->play("playerJumpAttack", _playerJumpAttack, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerJumpAttack, PLAYER_SFX_PRIORITY, _vSFX);
             break;
         case charge:
-            cugl::AudioEngine::get()->play("playerCharge", _playerCharge, false, _vSFX, true);
+            cugl::AudioEngine::get()->playVoice(_playerCharge, PLAYER_SFX_PRIORITY, _vSFX);
             break;
     }
 }
@@ -338,6 +324,9 @@ void SoundController::reset_level_tracks() {
 }
 
 void SoundController::level_transition() {
+    if (_assets == nullptr) {
+        return;
+    }
     
     if (_state != TRANSITION) {
         cugl::AudioEngine::get()->getMusicQueue()->clear(1.0);
@@ -347,14 +336,20 @@ void SoundController::level_transition() {
 }
 
 void SoundController::play_death_sound(bool mirror) {
+    if (_assets == nullptr) {
+        return;
+    }
     if (mirror) {
-        cugl::AudioEngine::get()->play("mirrorDeath", _mirrorDeath, false, _vSFX, true);
+        cugl::AudioEngine::get()->playVoice(_mirrorDeath, DEATH_SFX_PRIORITY, _vSFX);
     } else {
-        cugl::AudioEngine::get()->play("enemyDeath", _enemyDeath, false, _vSFX, true);
+        cugl::AudioEngine::get()->playVoice(_enemyDeath, DEATH_SFX_PRIORITY, _vSFX);
     }
 }
 
 void SoundController::play_enemy_sound(enemy e, etype t) {
+    if (_assets == nullptr) {
+        return;
+    }
     switch (e) {
         case lost:
             _lost->play_sound(t, _vSFX);
@@ -56,30 +56,30 @@ public:
         TRANSITION
     };
     
+    /** The enemy music layers, as bit positions in a layer mask */
+    enum layer {
+        gluttonLayer,
+        phantomLayer,
+        mirrorLayer,
+        spawnerLayer,
+        seekerLayer,
+        layerCount
+    };
+    
     class LevelMusic {
         
     protected:
         
         string _biome;
         
-        std::shared_ptr<cugl::Sound> _themeAsset;
-        
-        std::shared_ptr<cugl::Sound> _glutton;
-        std::shared_ptr<cugl::audio::AudioNode> _gNode;
-        
-        std::shared_ptr<cugl::Sound> _phantom;
-        std::shared_ptr<cugl::audio::AudioNode> _pNode;
-        
-        std::shared_ptr<cugl::Sound> _mirror;
-        std::shared_ptr<cugl::audio::AudioNode> _mNode;
+        /** The game state in which this track plays */
+        GameState _level;
         
-        std::shared_ptr<cugl::Sound> _spawner;
-        std::shared_ptr<cugl::audio::AudioNode> _spNode;
+        /** The enemy layers followed by the theme, ramped on the audio thread */
+        std::shared_ptr<cugl::audio::AudioStems> _stems;
         
-        std::shared_ptr<cugl::Sound> _seeker;
-        std::shared_ptr<cugl::audio::AudioNode> _sNode;
-        
-        std::shared_ptr<cugl::audio::AudioMixer> _mixer;
+        /** The mask of the enemy layers currently fading in (or playing) */
+        Uint8 _layers;
         
     public:
         
@@ -87,9 +87,18 @@ public:
         
         void init(string biome, std::shared_ptr<cugl::AssetManager> &assets);
         
-        void play_music(std::vector<bool> e, SoundController::GameState s);
+        /**
+         * Plays the music for the specified level class.
+         *
+         * The layer targets are only sent to the audio thread when the
+         * mask changes, so this is cheap to call every frame.
+         *
+         * @param layers    The mask of the enemy layers to play
+         * @param s         The current game state
+         */
+        void play_music(Uint8 layers, SoundController::GameState s);
         
-        std::shared_ptr<cugl::audio::AudioMixer> getMixer() {return _mixer;}
+        std::shared_ptr<cugl::audio::AudioStems> getStems() {return _stems;}
         
         void reset_mix();
         
@@ -106,6 +115,9 @@ public:
         
         std::shared_ptr<cugl::Sound> _hurt;
         
+        /** The voice of the last hurt sound (at most one plays at a time) */
+        cugl::AudioEngine::Voice _hurtVoice;
+        
     public:
         
         EnemySFX();
@@ -191,13 +203,20 @@ protected:
     
 public:
     
+    /** Creates a silent controller, which plays nothing until it is initialized */
     SoundController();
     
     void init(std::shared_ptr<cugl::AssetManager> &assets);
     
     void play_menu_music();
     
-    void play_level_music(string biome, std::vector<bool> enemies);
+    /**
+     * Plays the music for the given biome
+     *
+     * @param biome     The biome name
+     * @param layers    The mask of the enemy layers to play (see {@link layer})
+     */
+    void play_level_music(const string& biome, Uint8 layers);
     
     void play_player_sound(playerSType sound);
     
@@ -69,14 +69,14 @@ void SwipeController::update(InputController &input, bool grounded, bool floored
     // If the left finger is pressed down, check if it has been pressed long enough for
     // a charge attack
     if(input.isLeftDown() && unlock_count >= 2) {
-        calculateChargeAttack(input.getLeftStartTime(), true);
+        calculateChargeAttack(input.getLeftHeldTime(), true);
     }
     // If left finger lifted, process left swipe
     else if (input.didLeftRelease())
     {
         _lStart = true;
         _lCoolStart = 0;
-        calculateSwipeDirection(input.getLeftStartPosition(), input.getLeftEndPosition(), true, grounded, floored, input.getLeftStartTime());
+        calculateSwipeDirection(input.getLeftStartPosition(), input.getLeftEndPosition(), true, grounded, floored, input.getLeftHeldTime());
     }
     // Otherwise note that no left swipe was completed this frame
     else
@@ -89,13 +89,13 @@ void SwipeController::update(InputController &input, bool grounded, bool floored
     // If the right finger is pressed down, check if it has been pressed long enough for
     // a charge attack
     if(input.isRightDown() && unlock_count >= 4) {
-        calculateChargeAttack(input.getRightStartTime(), false);
+        calculateChargeAttack(input.getRightHeldTime(), false);
     }
     // If right finger lifted, process right swipe
     else if(input.didRightRelease()) {
         _rStart = true;
         _rCoolStart = 0;
-        calculateSwipeDirection(input.getRightStartPosition(), input.getRightEndPosition(), false, grounded, floored, input.getRightStartTime());
+        calculateSwipeDirection(input.getRightStartPosition(), input.getRightEndPosition(), false, grounded, floored, input.getRightHeldTime());
     }
     // Otherwise note that no right swipe was completed this frame
     else
@@ -196,7 +196,7 @@ void SwipeController::update(InputController &input, bool grounded, bool floored
  * Calculates whether a finger has been pressed down long enough for a charge attack
  * and updates the state accordingly
  */
-void SwipeController::calculateChargeAttack(cugl::Timestamp startTime, bool isLeftSidedCharge) {
+void SwipeController::calculateChargeAttack(Uint64 heldTime, bool isLeftSidedCharge) {
     
     // Don't increment charge countdown on cooldown, return
 //    if (isLeftSidedCharge && _cRCool < _cRangeCount) {
@@ -213,8 +213,6 @@ void SwipeController::calculateChargeAttack(cugl::Timestamp startTime, bool isLe
     } else {
         if (hasRightChargedAttack()) return;
     }
-        
-    _currTime.mark();
     
     if (_lStart && isLeftSidedCharge) {
         _lStart = false;
@@ -226,7 +224,7 @@ void SwipeController::calculateChargeAttack(cugl::Timestamp startTime, bool isLe
         _rCoolStart = clampf(_cMCool - _cMeleeCount, 0, _cMCool);
     }
 
-    Uint64 chargeTime = cugl::Timestamp::ellapsedMillis(startTime, _currTime);
+    Uint64 chargeTime = heldTime;
     if (isLeftSidedCharge) {
         chargeTime = chargeTime - (_lCoolStart * 1000) ;
         _leftChargingTime = chargeTime;
@@ -267,7 +265,7 @@ void SwipeController::calculateChargeAttack(cugl::Timestamp startTime, bool isLe
  * @param isLeftSidedSwipe  if the swipe was on the left side of the screen
  *
  */
-void SwipeController::calculateSwipeDirection(cugl::Vec2 startPos, cugl::Vec2 endPos, bool isLeftSidedSwipe, bool grounded, bool floored, cugl::Timestamp startTime)
+void SwipeController::calculateSwipeDirection(cugl::Vec2 startPos, cugl::Vec2 endPos, bool isLeftSidedSwipe, bool grounded, bool floored, Uint64 heldTime)
 {
 
     // x increases from left to right
@@ -283,11 +281,8 @@ void SwipeController::calculateSwipeDirection(cugl::Vec2 startPos, cugl::Vec2 en
     // If the xdiff and ydiff is really small the input was a tap, no need to process swipes
     if (xdiff > -20 && xdiff < 20 && ydiff > -20 && ydiff < 20)
     {
-        _currTime.mark();
-        Uint64 tapTime = cugl::Timestamp::ellapsedMillis(startTime, _currTime);
-        
         // if the tap time is less than half a second the intent of the tap was a jump
-        if (tapTime < CHARGE_TIME) {
+        if (heldTime < CHARGE_TIME) {
             if (isLeftSidedSwipe) {
                 setLeftSwipe(jump);
             } else {
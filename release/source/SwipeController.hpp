@@ -123,9 +123,6 @@ protected:
     Uint64 _leftChargingTime;
     Uint64 _rightChargingTime;
     
-    /** Timestamp to get the current time for charge calculations */
-    cugl::Timestamp _currTime;
-    
     /**
      * Set the left sided direction
      *
@@ -176,11 +173,11 @@ protected:
      * Calculates whether a finger has been pressed down long enough for a charge attack
      * and updates the state accordingly
      *
-     * @param startTime  the timestamp for when the left finger went down
+     * @param heldTime  the milliseconds the finger has been down
      * @param isLeftSidedCharge whether the charge is on left side or not
      *
      */
-    void calculateChargeAttack(cugl::Timestamp startTime, bool isLeftSidedCharge);
+    void calculateChargeAttack(Uint64 heldTime, bool isLeftSidedCharge);
     
     /**
      * Charge the attack for the left side state
@@ -202,9 +199,10 @@ protected:
      * @param startPos  the starting position of the swipe
      * @param endPos       the ending posiition of the swipe
      * @param isLeftSidedSwipe  if the swipe was on the left side of the screen
+     * @param heldTime  the milliseconds the finger was down
      *
      */
-    void calculateSwipeDirection(cugl::Vec2 startPos, cugl::Vec2 endPos, bool isLeftSidedSwipe, bool grounded, bool floored,  cugl::Timestamp startTime);
+    void calculateSwipeDirection(cugl::Vec2 startPos, cugl::Vec2 endPos, bool isLeftSidedSwipe, bool grounded, bool floored, Uint64 heldTime);
     
     /**
      * Processes the type of swipe attack that was just completed on the left side
@@ -24,8 +24,7 @@ using namespace cugl;
  * Creates a new tilt controller.
  */
 TiltController::TiltController() :
-_xpos(0),
-_lastLandscape(cugl::Display::Orientation::LANDSCAPE)
+_xpos(0)
 {
 }
 
@@ -36,17 +35,6 @@ TiltController::~TiltController() {
     //Nothing to release
 }
 
-void TiltController::updateLandscapeOrientation() {
-    
-    if (Display::get()->getDeviceOrientation() == cugl::Display::Orientation::LANDSCAPE_REVERSED) {
-        _lastLandscape = cugl::Display::Orientation::LANDSCAPE_REVERSED;
-    }
-    else if (Display::get()->getDeviceOrientation() == cugl::Display::Orientation::LANDSCAPE) {
-        _lastLandscape = cugl::Display::Orientation::LANDSCAPE;
-    }
-    
-}
-
 /**
  * Processes the currently cached inputs.
  *
@@ -54,14 +42,12 @@ void TiltController::updateLandscapeOrientation() {
  * keyboard or accelerometer.
  */
 void TiltController::update(InputController& input, float width) {
-    updateLandscapeOrientation();
-    
 #ifdef CU_TOUCH_SCREEN
     // MOBILE CONTROLS
     Vec3 acc = input.getAcceleration();
     float xAcc = acc.x;
     
-    if (_lastLandscape == cugl::Display::Orientation::LANDSCAPE_REVERSED){
+    if (input.isReversed()){
         xAcc *= -1;
     }
     
@@ -47,6 +47,36 @@ using namespace cugl;
  * @return the exit status of the application
  */
 int main(int argc, char * argv[]) {
+#if BENCHMARK_HEADLESS
+    // Simulate the levels without a window, GL context or audio engine
+    {
+        std::string directory;
+        if (argc > 1) {
+            directory = argv[1];
+        } else {
+            char* base = SDL_GetBasePath();
+            if (base != nullptr) {
+                directory = base;
+                SDL_free(base);
+            }
+        }
+        if (!filetool::is_absolute(directory)) {
+            CULogError("The asset directory '%s' is not an absolute path", directory.c_str());
+            return 1;
+        }
+        if (directory.back() != '/' && directory.back() != '\\') {
+            directory.push_back('/');
+        }
+        Uint32 steps = argc > 2 ? (Uint32)std::strtoul(argv[2], nullptr, 10) : BENCHMARK_GAME_STEPS;
+        int wave = argc > 3 ? std::atoi(argv[3]) : BENCHMARK_GAME_WAVE;
+
+        GameBenchmark simulation(directory);
+        std::shared_ptr<InputTrace> trace = InputTrace::allocWithFile(directory+BENCHMARK_GAME_TRACE);
+        CULog("%s", simulation.run(BENCHMARK_GAME_LEVELS, steps, wave, trace).c_str());
+        return 0;
+    }
+#endif
+
     // Change this to your application class
     LiminalSpirit app;
     